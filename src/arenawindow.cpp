@@ -0,0 +1,128 @@
+#include "arenawindow.h"
+#include "theme.h"
+#include "multiboardview.h"
+#include <QHBoxLayout>
+#include <QRandomGenerator>
+#include <QVBoxLayout>
+
+ArenaWindow::ArenaWindow(int games, QWidget *parent)
+    : QWidget(parent)
+    , m_arena(0, QRandomGenerator::global()->generate64())
+    , m_stepNanos(0)
+    , m_drawNanos(0)
+    , m_cellsDrawn(0)
+    , m_frames(0)
+    , m_statsPieces(0)
+{
+    setupUI();
+
+    m_tickTimer = new QTimer(this);
+    m_tickTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_tickTimer, &QTimer::timeout, this, &ArenaWindow::tick);
+
+    setWindowTitle("俄罗斯方块 - AI 观摩");
+    resize(1280, 800);
+
+    {
+        const QSignalBlocker blocker(m_gamesBox);
+        m_gamesBox->setValue(qBound(MIN_GAMES, games, MAX_GAMES));
+    }
+    setGameCount(m_gamesBox->value());
+    m_statsClock.start();
+    m_tickTimer->start(1000 / TetrisEngine::TICKS_PER_SECOND);
+}
+
+ArenaWindow::~ArenaWindow()
+{
+    m_tickTimer->stop();
+}
+
+void ArenaWindow::setupUI()
+{
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    QHBoxLayout *controls = new QHBoxLayout();
+
+    m_gamesBox = new QSpinBox(this);
+    m_gamesBox->setRange(MIN_GAMES, MAX_GAMES);
+    m_gamesBox->setSingleStep(MIN_GAMES);
+    connect(m_gamesBox, &QSpinBox::valueChanged, this, &ArenaWindow::setGameCount);
+
+    // 每个显示帧推进的逻辑帧数
+    m_speedBox = new QComboBox(this);
+    for (int speed : {1, 2, 4, 8}) {
+        m_speedBox->addItem(QString("%1x").arg(speed), speed);
+    }
+
+    QLabel *gamesLabel = new QLabel("对局数:", this);
+    QLabel *speedLabel = new QLabel("速度:", this);
+    controls->addWidget(gamesLabel);
+    controls->addWidget(m_gamesBox);
+    controls->addSpacing(20);
+    controls->addWidget(speedLabel);
+    controls->addWidget(m_speedBox);
+    controls->addStretch(1);
+
+    m_view = new MultiBoardView(this);
+
+    m_statusLabel = new QLabel(this);
+    Theme::setLabelStyle(m_statusLabel, 12, false, Theme::SECONDARY_TEXT);
+
+    mainLayout->addLayout(controls);
+    mainLayout->addWidget(m_view, 1);
+    mainLayout->addWidget(m_statusLabel);
+}
+
+void ArenaWindow::setGameCount(int games)
+{
+    m_arena.resize(games);
+    std::vector<const TetrisEngine *> engines;
+    engines.reserve(std::size_t(games));
+    for (int i = 0; i < m_arena.size(); ++i) {
+        engines.push_back(&m_arena.engine(i));
+    }
+    // resize 可能移动了引擎，地址要重新取
+    m_view->setEngines(std::move(engines));
+}
+
+void ArenaWindow::tick()
+{
+    QElapsedTimer timer;
+    timer.start();
+    const int speed = m_speedBox->currentData().toInt();
+    for (int i = 0; i < speed; ++i) {
+        m_arena.step();
+    }
+    const qint64 stepped = timer.nsecsElapsed();
+
+    m_cellsDrawn += m_view->refresh();
+    m_stepNanos += stepped;
+    m_drawNanos += timer.nsecsElapsed() - stepped;
+    ++m_frames;
+
+    if (m_statsClock.elapsed() >= 1000) {
+        updateStatus();
+    }
+}
+
+void ArenaWindow::updateStatus()
+{
+    const double seconds = m_statsClock.restart() / 1000.0;
+    const quint64 pieces = m_arena.totalPieces();
+    const int frames = qMax(1, m_frames);
+
+    // 绘制时间只含更新后备图像，贴到窗口的部分由 Qt 在事件循环里完成
+    m_statusLabel->setText(QString("%1 局  显示 %2 帧/秒  每帧 AI %3 ms, 绘制 %4 ms, 重画 %5 格  方块 %6/秒  格子 %7 px")
+                               .arg(m_arena.size())
+                               .arg(m_frames / seconds, 0, 'f', 1)
+                               .arg(m_stepNanos / 1e6 / frames, 0, 'f', 2)
+                               .arg(m_drawNanos / 1e6 / frames, 0, 'f', 2)
+                               .arg(m_cellsDrawn / frames)
+                               .arg((pieces - m_statsPieces) / seconds, 0, 'f', 0)
+                               .arg(m_view->cellSize()));
+
+    m_statsPieces = pieces;
+    m_stepNanos = 0;
+    m_drawNanos = 0;
+    m_cellsDrawn = 0;
+    m_frames = 0;
+}
@@ -0,0 +1,50 @@
+#ifndef ARENAWINDOW_H
+#define ARENAWINDOW_H
+
+#include <QComboBox>
+#include <QElapsedTimer>
+#include <QLabel>
+#include <QSpinBox>
+#include <QTimer>
+#include <QWidget>
+#include "botarena.h"
+
+class MultiBoardView;
+
+// AI 观摩窗口：16 到 256 局 AI 对局同时进行，平铺在一个 MultiBoardView 中
+class ArenaWindow : public QWidget
+{
+    Q_OBJECT
+
+public:
+    static constexpr int MIN_GAMES = 16;
+    static constexpr int MAX_GAMES = 256;
+
+    explicit ArenaWindow(int games = 64, QWidget *parent = nullptr);
+    ~ArenaWindow();
+
+private slots:
+    void tick();
+    void setGameCount(int games);
+
+private:
+    void setupUI();
+    void updateStatus();
+
+    BotArena m_arena;
+    MultiBoardView *m_view;
+    QSpinBox *m_gamesBox;
+    QComboBox *m_speedBox;
+    QLabel *m_statusLabel;
+    QTimer *m_tickTimer;
+
+    // 每秒汇总一次的帧统计
+    QElapsedTimer m_statsClock;
+    qint64 m_stepNanos;
+    qint64 m_drawNanos;
+    qint64 m_cellsDrawn;
+    int m_frames;
+    quint64 m_statsPieces;
+};
+
+#endif // ARENAWINDOW_H
@@ -0,0 +1,232 @@
+#include "boardanimation.h"
+#include "boardpainter.h"
+#include <QPainter>
+#include <QtMath>
+
+namespace {
+
+// 消行：前半段闪烁，后半段上方的行落下
+constexpr int CLEAR_DURATION_MS = 240;
+constexpr int LOCK_DURATION_MS = 120;
+
+} // namespace
+
+BoardAnimation::BoardAnimation(QObject *parent)
+    : QObject(parent)
+    , m_last{}
+    , m_preRows{}
+    , m_clearedRows(0)
+    , m_stripCell(0)
+    , m_stripRatio(0)
+    , m_lockCells{}
+    , m_enabled(true)
+    , m_overBudget(0)
+{
+    m_clearAnimation = new QVariantAnimation(this);
+    m_clearAnimation->setStartValue(0.0);
+    m_clearAnimation->setEndValue(1.0);
+    m_clearAnimation->setDuration(CLEAR_DURATION_MS);
+
+    m_lockAnimation = new QVariantAnimation(this);
+    m_lockAnimation->setStartValue(1.0);
+    m_lockAnimation->setEndValue(0.0);
+    m_lockAnimation->setDuration(LOCK_DURATION_MS);
+
+    // 动画由动画时钟驱动，每一步只请求重绘
+    for (QVariantAnimation *animation : {m_clearAnimation, m_lockAnimation}) {
+        connect(animation, &QVariantAnimation::valueChanged, this, &BoardAnimation::frameRequested);
+        connect(animation, &QVariantAnimation::finished, this, &BoardAnimation::frameRequested);
+    }
+}
+
+void BoardAnimation::observe(const TetrisEngine &engine, const TetrisGame::LockedPiece *lock)
+{
+    const Snapshot current = snapshot(engine);
+
+    // 只在恰好锁定一个方块时播放；开局、恢复存档等跳变直接跳过
+    if (current.pieceCount != m_last.pieceCount) {
+        m_clearAnimation->stop();
+        m_lockAnimation->stop();
+        if (m_enabled && m_last.active && current.pieceCount == m_last.pieceCount + 1) {
+            if (lock && lock->pieceCount == current.pieceCount) {
+                startLock(m_last, current, *lock);
+            } else {
+                startLock(m_last, current, {m_last.type, m_last.rotation, m_last.pieceX,
+                                            m_last.shadowY, current.pieceCount});
+            }
+        }
+    }
+    m_last = current;
+}
+
+void BoardAnimation::reset()
+{
+    m_clearAnimation->stop();
+    m_lockAnimation->stop();
+    m_last = Snapshot{};
+}
+
+bool BoardAnimation::isAnimating() const
+{
+    return m_clearAnimation->state() == QAbstractAnimation::Running
+        || m_lockAnimation->state() == QAbstractAnimation::Running;
+}
+
+bool BoardAnimation::isClearing() const
+{
+    return m_clearAnimation->state() == QAbstractAnimation::Running;
+}
+
+BoardAnimation::Snapshot BoardAnimation::snapshot(const TetrisEngine &engine)
+{
+    Snapshot result;
+    for (int y = 0; y < TetrisEngine::BOARD_HEIGHT; ++y) {
+        result.rows[y] = engine.getRowMask(y);
+    }
+    result.active = engine.isGameStarted() && !engine.isGameOver();
+    result.type = engine.getCurrentTetromino();
+    result.rotation = engine.getCurrentRotation();
+    result.pieceX = engine.getPieceX();
+    result.shadowY = result.active ? engine.getShadowY() : engine.getPieceY();
+    result.pieceCount = engine.getPieceCount();
+    result.pendingGarbage = engine.getPendingGarbage();
+    return result;
+}
+
+void BoardAnimation::startLock(const Snapshot &before, const Snapshot &after, const TetrisGame::LockedPiece &lock)
+{
+    // 移动不改变棋盘，锁定前的棋盘就是上次快照的棋盘加上锁定的方块
+    std::array<quint16, TetrisEngine::BOARD_HEIGHT> rows = before.rows;
+    const PieceCells &cells = tetrominoCells(lock.type, lock.rotation);
+    for (int i = 0; i < 4; ++i) {
+        const int x = lock.x + cells[i].x;
+        const int y = lock.y + cells[i].y;
+        m_lockCells[i] = QPoint(x, y);
+        if (y >= 0 && y < TetrisEngine::BOARD_HEIGHT) {
+            rows[y] |= quint16(1u << x);
+        }
+    }
+
+    quint32 cleared = 0;
+    for (int y = 0; y < TetrisEngine::BOARD_HEIGHT; ++y) {
+        if (rows[y] == TetrisEngine::FULL_ROW) {
+            cleared |= 1u << y;
+        }
+    }
+
+    if (cleared) {
+        m_preRows = rows;
+        m_clearedRows = cleared;
+        m_stripCell = 0;
+        m_clearAnimation->start();
+        return;
+    }
+
+    // 没有消行时可能顶上来了垃圾行，闪光跟着方块一起上移
+    if (after.rows != rows) {
+        for (QPoint &cell : m_lockCells) {
+            cell.ry() -= before.pendingGarbage;
+        }
+    }
+    m_lockAnimation->start();
+}
+
+void BoardAnimation::buildStrips(int cellSize, qreal devicePixelRatio)
+{
+    if (m_stripCell == cellSize && m_stripRatio == devicePixelRatio) return;
+
+    const QSize size(TetrisEngine::BOARD_WIDTH * cellSize, cellSize);
+    for (int y = 0; y < TetrisEngine::BOARD_HEIGHT; ++y) {
+        if (m_preRows[y] == 0) {
+            m_strips[y] = QPixmap();
+            continue;
+        }
+        QPixmap strip(size * devicePixelRatio);
+        strip.setDevicePixelRatio(devicePixelRatio);
+        strip.fill(Qt::transparent);
+        QPainter painter(&strip);
+        painter.setRenderHint(QPainter::Antialiasing);
+        BoardPainter::drawRow(painter, m_preRows[y], 0, cellSize);
+        m_strips[y] = strip;
+    }
+    m_stripCell = cellSize;
+    m_stripRatio = devicePixelRatio;
+}
+
+void BoardAnimation::paintRows(QPainter &painter, int cellSize, qreal devicePixelRatio)
+{
+    buildStrips(cellSize, devicePixelRatio);
+
+    const qreal t = m_clearAnimation->currentValue().toReal();
+    const int width = TetrisEngine::BOARD_WIDTH * cellSize;
+
+    if (t < 0.5) {
+        // 闪烁：被消除的行叠加一层渐亮再渐暗的白色
+        const int alpha = int(200 * qSin(t * 2 * M_PI));
+        for (int y = 0; y < TetrisEngine::BOARD_HEIGHT; ++y) {
+            if (m_strips[y].isNull()) continue;
+            painter.drawPixmap(0, y * cellSize, m_strips[y]);
+            if (m_clearedRows & (1u << y)) {
+                painter.fillRect(0, y * cellSize, width, cellSize, QColor(255, 255, 255, alpha));
+            }
+        }
+        return;
+    }
+
+    // 下落：被消除的行收缩淡出，上方的行按下方消除的行数插值下移
+    const qreal phase = (t - 0.5) * 2;
+    const qreal eased = 1 - (1 - phase) * (1 - phase) * (1 - phase);
+    int clearedBelow = 0;
+    for (int y = TetrisEngine::BOARD_HEIGHT - 1; y >= 0; --y) {
+        if (m_clearedRows & (1u << y)) {
+            ++clearedBelow;
+            const qreal height = cellSize * (1 - eased);
+            painter.setOpacity(1 - eased);
+            painter.drawPixmap(QRectF(0, y * cellSize + (cellSize - height) / 2, width, height),
+                               m_strips[y], QRectF(m_strips[y].rect()));
+            painter.setOpacity(1);
+            continue;
+        }
+        if (m_strips[y].isNull()) continue;
+        painter.drawPixmap(QPointF(0, (y + clearedBelow * eased) * cellSize), m_strips[y]);
+    }
+}
+
+void BoardAnimation::paintOverlay(QPainter &painter, int cellSize)
+{
+    if (m_lockAnimation->state() != QAbstractAnimation::Running) return;
+
+    const QColor flash(255, 255, 255, int(160 * m_lockAnimation->currentValue().toReal()));
+    for (const QPoint &cell : m_lockCells) {
+        if (cell.y() < 0) continue;
+        painter.fillRect(cell.x() * cellSize, cell.y() * cellSize, cellSize, cellSize, flash);
+    }
+}
+
+void BoardAnimation::reportPaintTime(qint64 nanoseconds)
+{
+    if (nanoseconds <= FRAME_BUDGET_NS) {
+        m_overBudget = 0;
+        return;
+    }
+    if (++m_overBudget >= OVER_BUDGET_LIMIT) {
+        qWarning("动画帧绘制耗时 %lld ns，超出 %lld ns 预算，已停用动画",
+                 static_cast<long long>(nanoseconds), static_cast<long long>(FRAME_BUDGET_NS));
+        setEnabled(false);
+    }
+}
+
+bool BoardAnimation::isEnabled() const
+{
+    return m_enabled;
+}
+
+void BoardAnimation::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+    m_overBudget = 0;
+    if (!enabled) {
+        m_clearAnimation->stop();
+        m_lockAnimation->stop();
+    }
+}
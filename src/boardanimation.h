@@ -0,0 +1,88 @@
+#ifndef BOARDANIMATION_H
+#define BOARDANIMATION_H
+
+#include <QObject>
+#include <QPixmap>
+#include <QPoint>
+#include <QVariantAnimation>
+#include <array>
+#include "tetrisengine.h"
+#include "tetrisgame.h"
+
+class QPainter;
+
+// 消行和锁定动画，只存在于绘制端
+//
+// 引擎立即消行、继续运行；这里在每次刷新时比较前后两次的引擎快照，
+// 结合锁定位置得出被消除的行，然后用消行前的行图（按行缓存的
+// QPixmap）插值绘制闪烁和下落。动画帧超出绘制预算时自动停用。
+class BoardAnimation : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 动画帧的绘制预算（纳秒）
+    static constexpr qint64 FRAME_BUDGET_NS = 1000000;
+    // 连续超出预算这么多帧后停用动画
+    static constexpr int OVER_BUDGET_LIMIT = 3;
+
+    explicit BoardAnimation(QObject *parent = nullptr);
+
+    // 每次棋盘刷新时调用；lock 为最近一次锁定的落点，没有时按上次快照的
+    // 落点推断（只在每次移动后都刷新时准确）
+    void observe(const TetrisEngine &engine, const TetrisGame::LockedPiece *lock = nullptr);
+    // 切换显示的引擎或重新开局时调用，丢弃快照和进行中的动画
+    void reset();
+
+    bool isAnimating() const;
+    bool isClearing() const;
+
+    // 消行动画期间代替已放置的方块绘制
+    void paintRows(QPainter &painter, int cellSize, qreal devicePixelRatio);
+    // 锁定闪光，画在最上层
+    void paintOverlay(QPainter &painter, int cellSize);
+
+    // 报告动画帧的绘制耗时
+    void reportPaintTime(qint64 nanoseconds);
+
+    bool isEnabled() const;
+    void setEnabled(bool enabled);
+
+signals:
+    void frameRequested();
+
+private:
+    struct Snapshot {
+        std::array<quint16, TetrisEngine::BOARD_HEIGHT> rows;
+        Tetromino type;
+        Rotation rotation;
+        int pieceX;
+        int shadowY;
+        int pieceCount;
+        int pendingGarbage;
+        bool active;
+    };
+
+    static Snapshot snapshot(const TetrisEngine &engine);
+    void startLock(const Snapshot &before, const Snapshot &after, const TetrisGame::LockedPiece &lock);
+    void buildStrips(int cellSize, qreal devicePixelRatio);
+
+    Snapshot m_last;
+    QVariantAnimation *m_clearAnimation;
+    QVariantAnimation *m_lockAnimation;
+
+    // 消行前的棋盘和被消除的行（bit y 表示第 y 行）
+    std::array<quint16, TetrisEngine::BOARD_HEIGHT> m_preRows;
+    quint32 m_clearedRows;
+    std::array<QPixmap, TetrisEngine::BOARD_HEIGHT> m_strips;
+    int m_stripCell;
+    qreal m_stripRatio;
+
+    // 刚锁定的方块格子（棋盘坐标）
+    std::array<QPoint, 4> m_lockCells;
+
+    bool m_enabled;
+    int m_overBudget;
+};
+
+#endif // BOARDANIMATION_H
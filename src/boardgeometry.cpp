@@ -0,0 +1,157 @@
+#include "boardgeometry.h"
+#include "tetrisengine.h"
+#include "tetrisgame.h"
+#include <bit>
+
+namespace {
+
+constexpr QRgb BACKGROUND = qRgb(20, 20, 30);
+constexpr QRgb LOCKED_FILL = qRgb(100, 100, 150);
+constexpr QRgb LOCKED_BORDER = qRgb(150, 150, 200);
+constexpr QRgb GRID = qRgb(50, 50, 70);
+constexpr QRgb HIGHLIGHT = qRgba(255, 255, 255, 100);
+constexpr QRgb SHADE = qRgba(0, 0, 0, 100);
+constexpr QRgb OUTLINE = qRgb(0, 0, 0);
+constexpr QRgb GHOST_BORDER = qRgba(255, 255, 255, 150);
+
+} // namespace
+
+void BoardGeometry::build(const TetrisEngine &engine, int cellSize, int width, int height)
+{
+    m_vertices.clear();
+
+    const int columns = TetrisEngine::BOARD_WIDTH;
+    const int rows = TetrisEngine::BOARD_HEIGHT;
+
+    addRect(0, 0, width, height, BACKGROUND);
+
+    // 已放置的方块
+    for (int y = 0; y < rows; ++y) {
+        quint16 row = engine.getRowMask(y);
+        while (row) {
+            const int x = std::countr_zero(row);
+            row &= row - 1;
+            addRect(x * cellSize, y * cellSize, cellSize, cellSize, LOCKED_FILL);
+            addFrame(x * cellSize, y * cellSize, cellSize, cellSize, LOCKED_BORDER);
+        }
+    }
+
+    const bool active = engine.isGameStarted() && !engine.isGameOver();
+    if (active) {
+        const Tetromino type = engine.getCurrentTetromino();
+        const QColor color = TetrisGame::getTetrominoColor(type);
+        const PieceCells &cells = tetrominoCells(type, engine.getCurrentRotation());
+        const int pieceX = engine.getPieceX();
+        const int pieceY = engine.getPieceY();
+        const int shadowY = engine.getShadowY();
+
+        // 阴影
+        if (shadowY != pieceY) {
+            QColor ghost = color;
+            ghost.setAlpha(80);
+            for (const PieceCell &cell : cells) {
+                const int x = (pieceX + cell.x) * cellSize;
+                const int y = (shadowY + cell.y) * cellSize;
+                addRect(x, y, cellSize, cellSize, ghost.rgba());
+                addDashedFrame(x, y, cellSize, cellSize, GHOST_BORDER);
+            }
+        }
+
+        // 当前方块
+        for (const PieceCell &cell : cells) {
+            addCell((pieceX + cell.x) * cellSize, (pieceY + cell.y) * cellSize, cellSize, color.rgb());
+        }
+    }
+
+    // 网格
+    for (int x = 0; x <= columns; ++x) {
+        addRect(x * cellSize, 0, 1, rows * cellSize, GRID);
+    }
+    for (int y = 0; y <= rows; ++y) {
+        addRect(0, y * cellSize, columns * cellSize, 1, GRID);
+    }
+
+    // 下一个方块
+    m_labelX = columns * cellSize + 20;
+    m_labelBaseline = 40;
+    const int startY = 50;
+    const Tetromino next = engine.getNextTetromino();
+    const QRgb nextColor = TetrisGame::getTetrominoColor(next).rgb();
+    for (const PieceCell &cell : tetrominoCells(next, Rotation::North)) {
+        const int x = m_labelX + cell.x * cellSize;
+        const int y = startY + cell.y * cellSize;
+        addRect(x, y, cellSize, cellSize, nextColor);
+        addFrame(x, y, cellSize, cellSize, OUTLINE);
+    }
+}
+
+const BoardVertex *BoardGeometry::vertexData() const
+{
+    return m_vertices.data();
+}
+
+int BoardGeometry::vertexCount() const
+{
+    return static_cast<int>(m_vertices.size());
+}
+
+int BoardGeometry::labelX() const
+{
+    return m_labelX;
+}
+
+int BoardGeometry::labelBaseline() const
+{
+    return m_labelBaseline;
+}
+
+void BoardGeometry::addRect(float x, float y, float w, float h, QRgb color)
+{
+    // 场景图的顶点颜色材质要求预乘 alpha；每个矩形两个三角形
+    const QRgb c = qPremultiply(color);
+    const quint8 r = quint8(qRed(c));
+    const quint8 g = quint8(qGreen(c));
+    const quint8 b = quint8(qBlue(c));
+    const quint8 a = quint8(qAlpha(c));
+    const BoardVertex topLeft = {x, y, r, g, b, a};
+    const BoardVertex topRight = {x + w, y, r, g, b, a};
+    const BoardVertex bottomLeft = {x, y + h, r, g, b, a};
+    const BoardVertex bottomRight = {x + w, y + h, r, g, b, a};
+    m_vertices.insert(m_vertices.end(), {topLeft, topRight, bottomLeft, bottomLeft, topRight, bottomRight});
+}
+
+void BoardGeometry::addFrame(float x, float y, float w, float h, QRgb color)
+{
+    addRect(x, y, w, 1, color);
+    addRect(x, y + h - 1, w, 1, color);
+    addRect(x, y + 1, 1, h - 2, color);
+    addRect(x + w - 1, y + 1, 1, h - 2, color);
+}
+
+void BoardGeometry::addDashedFrame(float x, float y, float w, float h, QRgb color)
+{
+    // 与 Qt::DashLine 相同的节奏：4 像素实线、2 像素间隔
+    constexpr float DASH = 4;
+    constexpr float STEP = 6;
+    for (float offset = 0; offset < w; offset += STEP) {
+        const float length = qMin(DASH, w - offset);
+        addRect(x + offset, y, length, 1, color);
+        addRect(x + offset, y + h - 1, length, 1, color);
+    }
+    for (float offset = 0; offset < h; offset += STEP) {
+        const float length = qMin(DASH, h - offset);
+        addRect(x, y + offset, 1, length, color);
+        addRect(x + w - 1, y + offset, 1, length, color);
+    }
+}
+
+void BoardGeometry::addCell(int x, int y, int size, QRgb color)
+{
+    addRect(x, y, size, size, color);
+    // 高光（上、左）和暗边（下、右），最后是黑色边框
+    addRect(x, y, size, 1, HIGHLIGHT);
+    addRect(x, y, 1, size, HIGHLIGHT);
+    addRect(x, y + size - 1, size, 1, SHADE);
+    addRect(x + size - 1, y, 1, size, SHADE);
+    addFrame(x, y, size, size, OUTLINE);
+}
@@ -0,0 +1,48 @@
+#ifndef BOARDGEOMETRY_H
+#define BOARDGEOMETRY_H
+
+#include <QRgb>
+#include <QtGlobal>
+#include <vector>
+
+class TetrisEngine;
+
+// 与 QSGGeometry::ColoredPoint2D 布局一致的顶点：坐标 + 预乘 RGBA
+struct BoardVertex {
+    float x;
+    float y;
+    quint8 r;
+    quint8 g;
+    quint8 b;
+    quint8 a;
+};
+
+// 棋盘的批量几何
+//
+// 把背景、已放置的格子、阴影、当前方块、网格和预览全部展开成带颜色的三角形，
+// 整块棋盘只需一次绘制提交。绘制顺序和 TetrisBoard 的 QPainter 路径一致，
+// 顶点缓冲在帧之间复用，稳定后不再分配内存。
+class BoardGeometry
+{
+public:
+    void build(const TetrisEngine &engine, int cellSize, int width, int height);
+
+    const BoardVertex *vertexData() const;
+    int vertexCount() const;
+
+    // 预览区域标签的左上角（标签文字由调用方单独绘制）
+    int labelX() const;
+    int labelBaseline() const;
+
+private:
+    void addRect(float x, float y, float w, float h, QRgb color);
+    void addFrame(float x, float y, float w, float h, QRgb color);
+    void addDashedFrame(float x, float y, float w, float h, QRgb color);
+    void addCell(int x, int y, int size, QRgb color);
+
+    std::vector<BoardVertex> m_vertices;
+    int m_labelX = 0;
+    int m_labelBaseline = 0;
+};
+
+#endif // BOARDGEOMETRY_H
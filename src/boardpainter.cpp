@@ -0,0 +1,212 @@
+#include "boardpainter.h"
+#include "tetrisgame.h"
+#include "trace.h"
+#include <QPen>
+#include <bit>
+
+namespace {
+
+constexpr int PREVIEW_OFFSET = 20;
+constexpr int PREVIEW_TOP = 50;
+
+} // namespace
+
+BoardPainter::BoardPainter()
+    : m_layerRows{}
+    , m_layerRatio(0)
+{
+}
+
+int BoardPainter::cellSize(const QSize &size)
+{
+    return qMin(size.width() / (TetrisEngine::BOARD_WIDTH + 4), size.height() / TetrisEngine::BOARD_HEIGHT);
+}
+
+void BoardPainter::paint(QPainter &painter, const TetrisEngine &engine, const QSize &size, qreal devicePixelRatio)
+{
+    TRACE_SCOPE("BoardPainter::paint");
+    updateLayer(engine, size, devicePixelRatio);
+    painter.drawImage(0, 0, m_layer);
+    drawActive(painter, engine, cellSize(size));
+}
+
+void BoardPainter::paint(QPainter &painter, const TetrisEngine &engine, const QSize &size,
+                         qreal devicePixelRatio, const LockedPainter &locked)
+{
+    TRACE_SCOPE("BoardPainter::paint");
+    Q_UNUSED(devicePixelRatio);
+
+    const int cell = cellSize(size);
+    painter.setRenderHint(QPainter::Antialiasing);
+    drawStatic(painter, size, cell, locked);
+    drawActive(painter, engine, cell);
+}
+
+void BoardPainter::drawRow(QPainter &painter, quint16 mask, int y, int cell)
+{
+    painter.setPen(QColor(150, 150, 200));
+    while (mask) {
+        const int x = std::countr_zero(mask);
+        mask &= mask - 1;
+        QRect rect(x * cell, y * cell, cell, cell);
+        painter.fillRect(rect, QColor(100, 100, 150));
+        painter.drawRect(rect);
+    }
+}
+
+void BoardPainter::drawActive(QPainter &painter, const TetrisEngine &engine, int cell)
+{
+    const bool active = engine.isGameStarted() && !engine.isGameOver();
+    if (active) {
+        const Tetromino type = engine.getCurrentTetromino();
+        const PieceCells &cells = tetrominoCells(type, engine.getCurrentRotation());
+        const QColor color = TetrisGame::getTetrominoColor(type);
+        const int pieceX = engine.getPieceX();
+        const int pieceY = engine.getPieceY();
+        const int shadowY = engine.getShadowY();
+
+        painter.setRenderHint(QPainter::Antialiasing);
+
+        // 阴影（如果阴影位置与当前位置不同）
+        if (shadowY != pieceY) {
+            drawShadow(painter, cells, pieceX, shadowY, cell, color);
+            drawCellGrid(painter, cells, pieceX, shadowY, cell);
+        }
+
+        // 当前方块，网格线画在方块之上
+        drawPiece(painter, cells, pieceX, pieceY, cell, color);
+        drawCellGrid(painter, cells, pieceX, pieceY, cell);
+    }
+
+    drawNextPiece(painter, engine, cell);
+}
+
+void BoardPainter::updateLayer(const TetrisEngine &engine, const QSize &size, qreal devicePixelRatio)
+{
+    TRACE_SCOPE("BoardPainter::updateLayer");
+    bool valid = !m_layer.isNull() && size == m_layerSize && devicePixelRatio == m_layerRatio;
+    for (int y = 0; valid && y < TetrisEngine::BOARD_HEIGHT; ++y) {
+        valid = m_layerRows[y] == engine.getRowMask(y);
+    }
+    if (valid) return;
+
+    if (m_layer.isNull() || size != m_layerSize || devicePixelRatio != m_layerRatio) {
+        m_layer = QImage(size * devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+        m_layer.setDevicePixelRatio(devicePixelRatio);
+        m_layerSize = size;
+        m_layerRatio = devicePixelRatio;
+    }
+    for (int y = 0; y < TetrisEngine::BOARD_HEIGHT; ++y) {
+        m_layerRows[y] = engine.getRowMask(y);
+    }
+
+    QPainter painter(&m_layer);
+    painter.setRenderHint(QPainter::Antialiasing);
+    drawStatic(painter, size, cellSize(size), [&engine](QPainter &p, int cell) {
+        for (int y = 0; y < TetrisEngine::BOARD_HEIGHT; ++y) {
+            drawRow(p, engine.getRowMask(y), y, cell);
+        }
+    });
+}
+
+void BoardPainter::drawStatic(QPainter &painter, const QSize &size, int cell, const LockedPainter &locked)
+{
+    // 绘制背景
+    painter.fillRect(QRect(QPoint(0, 0), size), QColor(20, 20, 30));
+
+    // 已放置的方块和网格
+    locked(painter, cell);
+    drawGrid(painter, cell);
+
+    // “下一个”标签位置固定
+    painter.setPen(QColor(255, 255, 255));
+    painter.setFont(QFont("Arial", 12, QFont::Bold));
+    painter.drawText(TetrisEngine::BOARD_WIDTH * cell + PREVIEW_OFFSET, PREVIEW_TOP - 10, "下一个:");
+}
+
+void BoardPainter::drawGrid(QPainter &painter, int cell)
+{
+    TRACE_SCOPE("BoardPainter::drawGrid");
+    painter.setPen(QPen(QColor(50, 50, 70), 1));
+
+    // 绘制垂直线
+    for (int x = 0; x <= TetrisEngine::BOARD_WIDTH; ++x) {
+        painter.drawLine(x * cell, 0, x * cell, TetrisEngine::BOARD_HEIGHT * cell);
+    }
+
+    // 绘制水平线
+    for (int y = 0; y <= TetrisEngine::BOARD_HEIGHT; ++y) {
+        painter.drawLine(0, y * cell, TetrisEngine::BOARD_WIDTH * cell, y * cell);
+    }
+}
+
+void BoardPainter::drawPiece(QPainter &painter, const PieceCells &cells, int pieceX, int pieceY,
+                             int cell, const QColor &color)
+{
+    for (const PieceCell &point : cells) {
+        QRect rect((pieceX + point.x) * cell, (pieceY + point.y) * cell, cell, cell);
+
+        // 绘制方块主体
+        painter.fillRect(rect, color);
+
+        // 绘制高光效果
+        painter.setPen(QColor(255, 255, 255, 100));
+        painter.drawLine(rect.topLeft(), rect.topRight());
+        painter.drawLine(rect.topLeft(), rect.bottomLeft());
+
+        // 绘制阴影效果
+        painter.setPen(QColor(0, 0, 0, 100));
+        painter.drawLine(rect.bottomRight(), rect.bottomLeft());
+        painter.drawLine(rect.bottomRight(), rect.topRight());
+
+        // 绘制边框
+        painter.setPen(QColor(0, 0, 0));
+        painter.drawRect(rect);
+    }
+}
+
+void BoardPainter::drawShadow(QPainter &painter, const PieceCells &cells, int pieceX, int pieceY,
+                              int cell, const QColor &color)
+{
+    // 半透明填充和虚线边框
+    QColor shadowColor = color;
+    shadowColor.setAlpha(80);
+    QPen pen(QColor(255, 255, 255, 150), 1);
+    pen.setStyle(Qt::DashLine);
+    painter.setPen(pen);
+
+    for (const PieceCell &point : cells) {
+        QRect rect((pieceX + point.x) * cell, (pieceY + point.y) * cell, cell, cell);
+        painter.fillRect(rect, shadowColor);
+        painter.drawRect(rect);
+    }
+}
+
+void BoardPainter::drawCellGrid(QPainter &painter, const PieceCells &cells, int pieceX, int pieceY, int cell)
+{
+    // 网格在缓存图层里，方块盖住的部分在这里补画
+    painter.setPen(QPen(QColor(50, 50, 70), 1));
+    for (const PieceCell &point : cells) {
+        const int x = (pieceX + point.x) * cell;
+        const int y = (pieceY + point.y) * cell;
+        if (y < 0) continue;
+        painter.drawLine(x, y, x + cell, y);
+        painter.drawLine(x, y + cell, x + cell, y + cell);
+        painter.drawLine(x, y, x, y + cell);
+        painter.drawLine(x + cell, y, x + cell, y + cell);
+    }
+}
+
+void BoardPainter::drawNextPiece(QPainter &painter, const TetrisEngine &engine, int cell)
+{
+    const Tetromino next = engine.getNextTetromino();
+    const QColor color = TetrisGame::getTetrominoColor(next);
+    const int startX = TetrisEngine::BOARD_WIDTH * cell + PREVIEW_OFFSET;
+
+    painter.setPen(QColor(0, 0, 0));
+    for (const PieceCell &point : tetrominoCells(next, Rotation::North)) {
+        QRect rect(startX + point.x * cell, PREVIEW_TOP + point.y * cell, cell, cell);
+        painter.fillRect(rect, color);
+        painter.drawRect(rect);
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef BOARDPAINTER_H
+#define BOARDPAINTER_H
+
+#include <QImage>
+#include <QPainter>
+#include <QSize>
+#include <array>
+#include <functional>
+#include "tetrisengine.h"
+
+// 棋盘的 QPainter 绘制
+//
+// 背景、已放置的方块、网格和“下一个”标签缓存在一张图层里，只在棋盘行
+// 或尺寸变化时重画；每帧只需贴图并绘制当前方块、阴影和预览。
+// 不依赖窗口，可在任意线程向 QImage 绘制（每个线程各用一个实例）。
+class BoardPainter
+{
+public:
+    BoardPainter();
+
+    void paint(QPainter &painter, const TetrisEngine &engine, const QSize &size, qreal devicePixelRatio = 1.0);
+
+    // 已放置的方块由调用方绘制（消行动画），此时不使用缓存图层
+    using LockedPainter = std::function<void(QPainter &painter, int cellSize)>;
+    void paint(QPainter &painter, const TetrisEngine &engine, const QSize &size,
+               qreal devicePixelRatio, const LockedPainter &locked);
+
+    // 布局：棋盘左侧 10 列，右侧留 4 列给预览
+    static int cellSize(const QSize &size);
+
+    // 在第 y 行绘制已放置的方块
+    static void drawRow(QPainter &painter, quint16 mask, int y, int cell);
+
+private:
+    void updateLayer(const TetrisEngine &engine, const QSize &size, qreal devicePixelRatio);
+    void drawStatic(QPainter &painter, const QSize &size, int cell, const LockedPainter &locked);
+    void drawActive(QPainter &painter, const TetrisEngine &engine, int cell);
+    void drawGrid(QPainter &painter, int cell);
+    void drawPiece(QPainter &painter, const PieceCells &cells, int pieceX, int pieceY,
+                   int cell, const QColor &color);
+    void drawShadow(QPainter &painter, const PieceCells &cells, int pieceX, int pieceY,
+                    int cell, const QColor &color);
+    void drawCellGrid(QPainter &painter, const PieceCells &cells, int pieceX, int pieceY, int cell);
+    void drawNextPiece(QPainter &painter, const TetrisEngine &engine, int cell);
+
+    // 缓存图层及其对应的棋盘行和尺寸
+    QImage m_layer;
+    std::array<quint16, TetrisEngine::BOARD_HEIGHT> m_layerRows;
+    QSize m_layerSize;
+    qreal m_layerRatio;
+};
+
+#endif // BOARDPAINTER_H
@@ -0,0 +1,151 @@
+#include "bot.h"
+#include "trace.h"
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
+namespace {
+
+// 落点的格子集合（排序后打包），用于合并最终位置相同的落点
+std::uint32_t placementKey(Tetromino type, Rotation rotation, int x, int y)
+{
+    std::uint8_t cells[4];
+    int count = 0;
+    for (const PieceCell &cell : tetrominoCells(type, rotation)) {
+        // 出生时方块可能高出顶部几行，偏移后保证非负
+        cells[count++] = static_cast<std::uint8_t>((y + cell.y + 4) * TetrisEngine::BOARD_WIDTH + x + cell.x);
+    }
+    std::sort(cells, cells + 4);
+    return std::uint32_t(cells[0]) | std::uint32_t(cells[1]) << 8 | std::uint32_t(cells[2]) << 16
+         | std::uint32_t(cells[3]) << 24;
+}
+
+} // namespace
+
+Bot::Bot()
+{
+}
+
+Bot::Bot(const Weights &weights)
+    : m_weights(weights)
+{
+}
+
+void Bot::setWeights(const Weights &weights)
+{
+    m_weights = weights;
+}
+
+const Bot::Weights &Bot::weights() const
+{
+    return m_weights;
+}
+
+void Bot::generatePlacements(const TetrisEngineBase &engine, std::vector<Placement> &placements)
+{
+    TRACE_SCOPE("Bot::generatePlacements");
+    placements.clear();
+    if (engine.isGameOver() || !engine.isGameStarted()) return;
+
+    const Tetromino type = engine.getCurrentTetromino();
+    std::uint32_t keys[4 * 2 * TetrisEngine::BOARD_WIDTH];
+    int keyCount = 0;
+
+    // 平移和旋转与规则无关，在基类副本上进行
+    TetrisEngineBase rotatedEngine = engine;
+    for (int rotations = 0; rotations < ROTATION_COUNT; ++rotations) {
+        if (rotations > 0 && !rotatedEngine.rotate(RotationDirection::Clockwise)) {
+            break;
+        }
+
+        // 向左、向右各平移到底，0列只在向右时记录一次
+        for (int direction = -1; direction <= 1; direction += 2) {
+            TetrisEngineBase shifted = rotatedEngine;
+            for (int shift = direction < 0 ? -1 : 0;; shift += direction) {
+                if (shift != 0) {
+                    const bool moved = direction < 0 ? shifted.moveLeft() : shifted.moveRight();
+                    if (!moved) break;
+                }
+
+                const int x = shifted.getPieceX();
+                const int y = shifted.getShadowY();
+                const Rotation rotation = shifted.getCurrentRotation();
+                const std::uint32_t key = placementKey(type, rotation, x, y);
+                if (std::find(keys, keys + keyCount, key) == keys + keyCount) {
+                    keys[keyCount++] = key;
+                    placements.push_back({rotation, static_cast<std::int8_t>(x), static_cast<std::int8_t>(y),
+                                          static_cast<std::int8_t>(rotations), static_cast<std::int8_t>(shift)});
+                }
+            }
+        }
+    }
+}
+
+bool Bot::applyPath(TetrisEngineBase &engine, const Placement &placement)
+{
+    for (int i = 0; i < placement.rotations; ++i) {
+        if (!engine.rotate(RotationDirection::Clockwise)) return false;
+    }
+    for (int i = 0; i < std::abs(placement.shift); ++i) {
+        if (!(placement.shift < 0 ? engine.moveLeft() : engine.moveRight())) return false;
+    }
+    return true;
+}
+
+int Bot::inputsFor(const Placement &placement, std::uint8_t *inputs)
+{
+    int count = 0;
+    for (int i = 0; i < placement.rotations; ++i) {
+        inputs[count++] = TetrisEngine::InputRotateCW;
+    }
+    for (int i = 0; i < std::abs(placement.shift); ++i) {
+        inputs[count++] = placement.shift < 0 ? TetrisEngine::InputLeft : TetrisEngine::InputRight;
+    }
+    inputs[count++] = TetrisEngine::InputHardDrop;
+    return count;
+}
+
+float Bot::evaluate(const TetrisEngineBase &before, const TetrisEngineBase &after) const
+{
+    if (after.isGameOver()) {
+        return after.isGoalReached() ? std::numeric_limits<float>::infinity()
+                                     : -std::numeric_limits<float>::infinity();
+    }
+
+    const TetrisEngine::Features &features = after.getFeatures();
+    return m_weights.aggregateHeight * features.aggregateHeight
+         + m_weights.holes * features.holes
+         + m_weights.bumpiness * features.bumpiness
+         + m_weights.lines * (after.getLines() - before.getLines())
+         + m_weights.wells * features.wells
+         + m_weights.rowTransitions * features.rowTransitions
+         + m_weights.columnTransitions * features.columnTransitions;
+}
+
+template <typename Rules>
+bool Bot::choose(const BasicTetrisEngine<Rules> &engine, Placement &best) const
+{
+    TRACE_SCOPE("Bot::choose");
+    generatePlacements(engine, m_placements);
+
+    bool found = false;
+    float bestScore = 0.0f;
+    for (const Placement &placement : m_placements) {
+        BasicTetrisEngine<Rules> trial = engine;
+        applyPath(trial, placement);
+        trial.hardDrop();
+        const float score = evaluate(engine, trial);
+        // 所有落点都导致结束时仍返回第一个，由调用方照常执行
+        if (!found || score > bestScore) {
+            best = placement;
+            bestScore = score;
+            found = true;
+        }
+    }
+    return found;
+}
+
+template bool Bot::choose(const BasicTetrisEngine<StandardRules> &, Placement &) const;
+template bool Bot::choose(const BasicTetrisEngine<GuidelineRules> &, Placement &) const;
+template bool Bot::choose(const BasicTetrisEngine<ClassicRules> &, Placement &) const;
+template bool Bot::choose(const BasicTetrisEngine<MarathonRules> &, Placement &) const;
@@ -0,0 +1,72 @@
+#ifndef BOT_H
+#define BOT_H
+
+#include "tetrisengine.h"
+#include <cstdint>
+#include <vector>
+
+// 无Qt依赖的落点搜索 AI
+//
+// 枚举当前方块从出生位置出发"先旋转、再平移、最后硬降"能到达的全部落点，
+// 在引擎副本上试放，按棋盘特征的加权和评分。只看当前方块（一层搜索）。
+// 内部复用落点缓冲，一个 Bot 对象只在一个线程中使用。
+// 枚举和评分与规则无关；choose 需要在副本上硬降，对随附的每个规则集各有一份实例。
+class Bot
+{
+public:
+    // 评分权重，作用于落下并消行之后的棋盘特征
+    struct Weights {
+        float aggregateHeight = -0.51f;
+        float holes = -0.36f;
+        float bumpiness = -0.18f;
+        float lines = 0.76f;
+        float wells = 0.0f;
+        float rowTransitions = 0.0f;
+        float columnTransitions = 0.0f;
+    };
+
+    // 落点及到达它的操作：顺时针旋转 rotations 次，再平移 shift 列（负数向左）
+    struct Placement {
+        Rotation rotation;
+        std::int8_t x;
+        std::int8_t y;
+        std::int8_t rotations;
+        std::int8_t shift;
+    };
+
+    // 一个落点最多需要的输入帧数：3次旋转 + 9次平移 + 硬降
+    static constexpr int MAX_INPUTS = 13;
+
+    Bot();
+    explicit Bot(const Weights &weights);
+
+    void setWeights(const Weights &weights);
+    const Weights &weights() const;
+
+    // 当前方块的全部落点，最终位置相同的只保留操作最少的一个
+    static void generatePlacements(const TetrisEngineBase &engine, std::vector<Placement> &placements);
+
+    // 在副本上执行落点的操作（不含硬降），返回是否按预期到达
+    static bool applyPath(TetrisEngineBase &engine, const Placement &placement);
+
+    // 落点对应的逐帧输入，每帧一个动作，最后一帧硬降；返回帧数
+    static int inputsFor(const Placement &placement, std::uint8_t *inputs);
+
+    float evaluate(const TetrisEngineBase &before, const TetrisEngineBase &after) const;
+
+    // 选出评分最高的落点，没有可用落点时返回 false
+    template <typename Rules>
+    bool choose(const BasicTetrisEngine<Rules> &engine, Placement &best) const;
+
+private:
+    Weights m_weights;
+    // 复用的落点缓冲，避免每步分配
+    mutable std::vector<Placement> m_placements;
+};
+
+extern template bool Bot::choose(const BasicTetrisEngine<StandardRules> &, Placement &) const;
+extern template bool Bot::choose(const BasicTetrisEngine<GuidelineRules> &, Placement &) const;
+extern template bool Bot::choose(const BasicTetrisEngine<ClassicRules> &, Placement &) const;
+extern template bool Bot::choose(const BasicTetrisEngine<MarathonRules> &, Placement &) const;
+
+#endif // BOT_H
@@ -0,0 +1,80 @@
+#include "botarena.h"
+
+BotArena::BotArena(int games, std::uint64_t seed)
+    : m_nextSeed(seed)
+    , m_totalPieces(0)
+{
+    resize(games);
+}
+
+void BotArena::resize(int games)
+{
+    const std::size_t previous = m_games.size();
+    m_games.resize(std::size_t(games > 0 ? games : 0));
+    for (std::size_t i = previous; i < m_games.size(); ++i) {
+        restart(m_games[i]);
+    }
+}
+
+int BotArena::size() const
+{
+    return int(m_games.size());
+}
+
+void BotArena::step()
+{
+    for (Game &game : m_games) {
+        if (game.engine.isGameOver()) {
+            if (--game.restartFrames <= 0) {
+                restart(game);
+            }
+            continue;
+        }
+
+        if (game.nextInput >= game.inputCount) {
+            plan(game);
+        }
+        const std::uint8_t input = game.nextInput < game.inputCount ? game.inputs[game.nextInput++] : 0;
+        game.engine.tick(input);
+
+        // 重力可能让方块提前锁定，剩下的路径作废
+        const int pieceCount = game.engine.getPieceCount();
+        if (pieceCount != game.pieceCount) {
+            m_totalPieces += std::uint64_t(pieceCount - game.pieceCount);
+            game.pieceCount = pieceCount;
+            game.inputCount = 0;
+            game.nextInput = 0;
+        }
+        if (game.engine.isGameOver()) {
+            game.restartFrames = RESTART_FRAMES;
+        }
+    }
+}
+
+const TetrisEngine &BotArena::engine(int index) const
+{
+    return m_games[std::size_t(index)].engine;
+}
+
+std::uint64_t BotArena::totalPieces() const
+{
+    return m_totalPieces;
+}
+
+void BotArena::restart(Game &game)
+{
+    game.engine.reset(m_nextSeed++);
+    game.engine.start();
+    game.inputCount = 0;
+    game.nextInput = 0;
+    game.pieceCount = game.engine.getPieceCount();
+    game.restartFrames = 0;
+}
+
+void BotArena::plan(Game &game)
+{
+    Bot::Placement placement;
+    game.nextInput = 0;
+    game.inputCount = m_bot.choose(game.engine, placement)
+        ? std::int8_t(Bot::inputsFor(placement, game.inputs)) : 0;
+}
@@ -0,0 +1,52 @@
+#ifndef BOTARENA_H
+#define BOTARENA_H
+
+#include "bot.h"
+#include "tetrisengine.h"
+#include <cstdint>
+#include <vector>
+
+// 一组同时进行的 AI 对局，供多棋盘观摩窗口显示
+//
+// 每局每个逻辑帧执行 AI 路径中的一个输入（TetrisEngine::tick，重力照常生效），
+// 方块锁定后重新选择落点；结束的对局停留片刻后换一个种子重开。
+// 所有对局共用一个 Bot。不依赖 Qt，只在一个线程中使用。
+class BotArena
+{
+public:
+    // 对局结束后停留的帧数
+    static constexpr int RESTART_FRAMES = 90;
+
+    explicit BotArena(int games = 0, std::uint64_t seed = 1);
+
+    // 调整对局数，保留已有的对局
+    void resize(int games);
+    int size() const;
+
+    // 所有对局推进一个逻辑帧
+    void step();
+
+    const TetrisEngine &engine(int index) const;
+    // 自开始以来所有对局锁定的方块总数
+    std::uint64_t totalPieces() const;
+
+private:
+    struct Game {
+        TetrisEngine engine;
+        std::uint8_t inputs[Bot::MAX_INPUTS];
+        std::int8_t inputCount = 0;
+        std::int8_t nextInput = 0;
+        int pieceCount = 0;
+        int restartFrames = 0;
+    };
+
+    void restart(Game &game);
+    void plan(Game &game);
+
+    std::vector<Game> m_games;
+    Bot m_bot;
+    std::uint64_t m_nextSeed;
+    std::uint64_t m_totalPieces;
+};
+
+#endif // BOTARENA_H
@@ -0,0 +1,144 @@
+#include "botprotocol.h"
+#include "wireformat.h"
+#include <algorithm>
+
+using namespace WireFormat;
+
+BotRequest makeBotRequest(std::uint32_t id, const TetrisEngineBase &engine, const std::vector<Bot::Placement> &placements)
+{
+    BotRequest request = {};
+    request.id = id;
+    for (int y = 0; y < TetrisEngine::BOARD_HEIGHT; ++y) {
+        request.rows[y] = engine.getRowMask(y);
+    }
+    request.piece = engine.getCurrentTetromino();
+    request.rotation = engine.getCurrentRotation();
+    request.x = static_cast<std::int8_t>(engine.getPieceX());
+    request.y = static_cast<std::int8_t>(engine.getPieceY());
+    for (int i = 0; i < TetrisEngine::QUEUE_SIZE; ++i) {
+        request.queue[i] = engine.getQueuedTetromino(i);
+    }
+    request.score = engine.getScore();
+    request.level = engine.getLevel();
+    request.lines = engine.getLines();
+    request.combo = static_cast<std::uint8_t>(engine.getCombo());
+    request.backToBack = engine.isBackToBack();
+
+    const std::size_t count = std::min(placements.size(), std::size_t(BotRequest::MAX_PLACEMENTS));
+    request.placementCount = static_cast<std::uint8_t>(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        request.placements[i] = {placements[i].rotation, placements[i].x, placements[i].y};
+    }
+    return request;
+}
+
+bool restoreBotRequest(const BotRequest &request, TetrisEngine &engine)
+{
+    // 随机流等请求里没有的字段取自一局新开的对局
+    TetrisEngine fresh;
+    fresh.reset(0);
+    fresh.start();
+    TetrisEngine::State state = fresh.saveState();
+
+    state.rows = request.rows;
+    state.currentTetromino = request.piece;
+    state.currentRotation = request.rotation;
+    state.pieceX = request.x;
+    state.pieceY = request.y;
+    state.queue = request.queue;
+    state.score = request.score;
+    state.level = request.level;
+    state.lines = request.lines;
+    state.combo = request.combo;
+    state.ruleFlags = request.backToBack ? TetrisEngine::BackToBack : 0;
+    if (!TetrisEngine::isValidState(state)) {
+        return false;
+    }
+    engine.restoreState(state);
+    return true;
+}
+
+std::size_t encodeBotRequest(const BotRequest &request, std::uint8_t *out)
+{
+    std::uint8_t *p = put32(out + BOT_HEADER_SIZE, request.id);
+    for (std::uint16_t row : request.rows) {
+        p = put16(p, row);
+    }
+    *p++ = static_cast<std::uint8_t>(request.piece);
+    *p++ = static_cast<std::uint8_t>(request.rotation);
+    *p++ = static_cast<std::uint8_t>(request.x);
+    *p++ = static_cast<std::uint8_t>(request.y);
+    for (Tetromino type : request.queue) {
+        *p++ = static_cast<std::uint8_t>(type);
+    }
+    p = put32(p, static_cast<std::uint32_t>(request.score));
+    p = put32(p, static_cast<std::uint32_t>(request.level));
+    p = put32(p, static_cast<std::uint32_t>(request.lines));
+    *p++ = request.combo;
+    *p++ = request.backToBack ? 1 : 0;
+
+    const int count = std::min<int>(request.placementCount, BotRequest::MAX_PLACEMENTS);
+    *p++ = static_cast<std::uint8_t>(count);
+    for (int i = 0; i < count; ++i) {
+        *p++ = static_cast<std::uint8_t>(request.placements[i].rotation);
+        *p++ = static_cast<std::uint8_t>(request.placements[i].x);
+        *p++ = static_cast<std::uint8_t>(request.placements[i].y);
+    }
+    return finishMessage(out, BotMessageType::Request, p);
+}
+
+std::size_t encodeBotReply(const BotReply &reply, std::uint8_t *out)
+{
+    std::uint8_t *p = put32(out + BOT_HEADER_SIZE, reply.id);
+    return finishMessage(out, BotMessageType::Reply, put16(p, reply.placement));
+}
+
+bool decodeBotRequest(const std::uint8_t *payload, std::size_t size, BotRequest &request)
+{
+    constexpr std::size_t FIXED_SIZE = 4 + 2 * TetrisEngine::BOARD_HEIGHT + 4 + TetrisEngine::QUEUE_SIZE + 12 + 3;
+    if (size < FIXED_SIZE) return false;
+
+    const std::uint8_t *p = payload;
+    request.id = get32(p);
+    p += 4;
+    for (std::uint16_t &row : request.rows) {
+        row = get16(p);
+        p += 2;
+        if (row & ~TetrisEngine::FULL_ROW) return false;
+    }
+    if (p[0] >= TETROMINO_COUNT || p[1] >= ROTATION_COUNT) return false;
+    request.piece = static_cast<Tetromino>(p[0]);
+    request.rotation = static_cast<Rotation>(p[1]);
+    request.x = static_cast<std::int8_t>(p[2]);
+    request.y = static_cast<std::int8_t>(p[3]);
+    p += 4;
+    for (Tetromino &type : request.queue) {
+        if (*p >= TETROMINO_COUNT) return false;
+        type = static_cast<Tetromino>(*p++);
+    }
+    request.score = static_cast<std::int32_t>(get32(p));
+    request.level = static_cast<std::int32_t>(get32(p + 4));
+    request.lines = static_cast<std::int32_t>(get32(p + 8));
+    p += 12;
+    request.combo = *p++;
+    request.backToBack = (*p++ & 1) != 0;
+
+    const std::uint8_t count = *p++;
+    if (count > BotRequest::MAX_PLACEMENTS || size != FIXED_SIZE + std::size_t(count) * 3) return false;
+    request.placementCount = count;
+    for (int i = 0; i < count; ++i) {
+        if (p[0] >= ROTATION_COUNT) return false;
+        request.placements[i] = {static_cast<Rotation>(p[0]), static_cast<std::int8_t>(p[1]),
+                                 static_cast<std::int8_t>(p[2])};
+        p += 3;
+    }
+    return true;
+}
+
+bool decodeBotReply(const std::uint8_t *payload, std::size_t size, BotReply &reply)
+{
+    if (size != BOT_REPLY_SIZE - BOT_HEADER_SIZE) return false;
+    reply.id = get32(payload);
+    reply.placement = get16(payload + 4);
+    return true;
+}
@@ -0,0 +1,89 @@
+#ifndef BOTPROTOCOL_H
+#define BOTPROTOCOL_H
+
+#include "bot.h"
+#include "tetrisengine.h"
+#include "wireformat.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 外部 AI 进程的管道协议：游戏经 stdin 发出局面，AI 经 stdout 回复选中的落点
+//
+// 局面里带有游戏一方用 Bot::generatePlacements 枚举出的全部合法落点，外部 AI
+// 不需要实现移动和旋转规则，只需从中选一个。请求带编号，游戏方可以连续发出
+// 多条请求而不等回复（流水线），回复可以乱序，按编号对应。
+//
+// 二进制模式，所有整数为小端，消息为 [载荷长度 u16][类型 u8][载荷]：
+//   Request 载荷  编号 u32, 行掩码 20 × u16（第 0 行在顶部，位 x 为第 x 列）,
+//                 当前方块 种类 u8, 朝向 u8, x i8, y i8, 预览队列 5 × u8,
+//                 分数 i32, 等级 i32, 行数 i32, 连击 u8, 标志 u8（位0 背靠背）,
+//                 落点数 u8, 每个落点 朝向 u8, x i8, y i8（硬降后的位置）
+//   Reply 载荷    编号 u32, 落点序号 u16（NO_PLACEMENT 表示放弃）
+// 种类按 I O T S Z J L 编号为 0..6，朝向按 N E S W 编号为 0..3。
+//
+// JSON 模式每条消息一行，字段同上：
+//   {"id":7,"rows":[...],"piece":"T","rotation":0,"x":3,"y":0,"queue":"IOLJS",
+//    "score":0,"level":1,"lines":0,"combo":0,"backToBack":false,"placements":[[0,3,18],...]}
+//   {"id":7,"placement":12}
+// 输入结束（stdin 关闭）时外部 AI 应当退出。
+
+enum class BotMessageType : std::uint8_t {
+    Request = 1,
+    Reply = 2
+};
+
+struct BotPlacement {
+    Rotation rotation;
+    std::int8_t x;
+    std::int8_t y;
+};
+
+struct BotRequest {
+    // 落点数上限：4 个朝向 × 向左/向右平移到底
+    static constexpr int MAX_PLACEMENTS = 4 * 2 * TetrisEngine::BOARD_WIDTH;
+
+    std::uint32_t id;
+    std::array<std::uint16_t, TetrisEngine::BOARD_HEIGHT> rows;
+    Tetromino piece;
+    Rotation rotation;
+    std::int8_t x;
+    std::int8_t y;
+    std::array<Tetromino, TetrisEngine::QUEUE_SIZE> queue;
+    std::int32_t score;
+    std::int32_t level;
+    std::int32_t lines;
+    std::uint8_t combo;
+    bool backToBack;
+    std::uint8_t placementCount;
+    std::array<BotPlacement, MAX_PLACEMENTS> placements;
+};
+
+struct BotReply {
+    static constexpr std::uint16_t NO_PLACEMENT = 0xFFFF;
+
+    std::uint32_t id;
+    std::uint16_t placement;
+};
+
+constexpr std::size_t BOT_HEADER_SIZE = WireFormat::HEADER_SIZE;
+// 最大的请求：头 3 + 编号 4 + 行 40 + 方块 4 + 队列 5 + 统计 12 + 连击与标志 2 + 落点数 1 + 落点 80 × 3
+constexpr std::size_t BOT_MAX_MESSAGE_SIZE = 311;
+constexpr std::size_t BOT_REPLY_SIZE = BOT_HEADER_SIZE + 6;
+
+// 从引擎当前局面和枚举出的落点生成请求
+BotRequest makeBotRequest(std::uint32_t id, const TetrisEngineBase &engine, const std::vector<Bot::Placement> &placements);
+
+// 按请求中的局面构造引擎（外部 AI 一方用），局面不自洽时返回 false
+bool restoreBotRequest(const BotRequest &request, TetrisEngine &engine);
+
+// 编码一条消息，返回总字节数（含消息头）；out 至少 BOT_MAX_MESSAGE_SIZE 字节
+std::size_t encodeBotRequest(const BotRequest &request, std::uint8_t *out);
+std::size_t encodeBotReply(const BotReply &reply, std::uint8_t *out);
+
+// 解码载荷（不含消息头），载荷不完整或字段越界时返回 false
+bool decodeBotRequest(const std::uint8_t *payload, std::size_t size, BotRequest &request);
+bool decodeBotReply(const std::uint8_t *payload, std::size_t size, BotReply &reply);
+
+#endif // BOTPROTOCOL_H
@@ -0,0 +1,245 @@
+#include "checkpointfile.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QStandardPaths>
+#include <cstring>
+#include <type_traits>
+
+#ifdef Q_OS_WIN
+#define NOMINMAX
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace {
+
+constexpr char MAGIC[4] = {'T', 'C', 'K', 'P'};
+constexpr quint32 VERSION = 3;
+
+quint64 fnv1a(const void *data, std::size_t size, quint64 hash = 1469598103934665603ull)
+{
+    const auto *bytes = static_cast<const unsigned char *>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+} // namespace
+
+// 槽位：序号和校验和在前，状态在后；校验和覆盖除自身之外的全部字段
+struct CheckpointFile::Slot {
+    quint64 sequence;
+    quint64 checksum;
+    TetrisEngine::State state;
+    qint64 playTimeMs;
+    quint8 active;
+    quint8 reserved[7];
+
+    quint64 computeChecksum() const
+    {
+        const quint64 hash = fnv1a(&sequence, sizeof(sequence));
+        return fnv1a(&state, sizeof(Slot) - offsetof(Slot, state), hash);
+    }
+};
+
+struct CheckpointFile::Layout {
+    char magic[4];
+    quint32 version;
+    quint32 stateSize;
+    quint32 reserved;
+    Slot slots[2];
+};
+
+static_assert(std::is_trivially_copyable_v<CheckpointFile::Checkpoint>);
+
+CheckpointFile::CheckpointFile()
+    : m_map(nullptr)
+    , m_sequence(0)
+    , m_flushThread(nullptr)
+    , m_dirty(false)
+    , m_stopping(false)
+{
+    static_assert(std::has_unique_object_representations_v<Slot>, "槽位不能含有隐式填充");
+}
+
+CheckpointFile::~CheckpointFile()
+{
+    close();
+}
+
+bool CheckpointFile::open(const QString &path)
+{
+    close();
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        return false;
+    }
+
+    // 文件大小或格式不符时重新初始化
+    bool valid = m_file.size() == qint64(sizeof(Layout));
+    if (!valid && !m_file.resize(sizeof(Layout))) {
+        m_file.close();
+        return false;
+    }
+
+    m_map = m_file.map(0, sizeof(Layout));
+    if (!m_map) {
+        m_file.close();
+        return false;
+    }
+
+    Layout *data = layout();
+    if (valid) {
+        valid = std::memcmp(data->magic, MAGIC, sizeof(MAGIC)) == 0
+             && data->version == VERSION
+             && data->stateSize == sizeof(TetrisEngine::State);
+    }
+    if (!valid) {
+        std::memset(data, 0, sizeof(Layout));
+        std::memcpy(data->magic, MAGIC, sizeof(MAGIC));
+        data->version = VERSION;
+        data->stateSize = sizeof(TetrisEngine::State);
+    }
+
+    m_sequence = qMax(data->slots[0].sequence, data->slots[1].sequence);
+
+    m_stopping = false;
+    m_dirty = !valid;
+    m_flushThread = QThread::create([this]() { flushLoop(); });
+    m_flushThread->start(QThread::LowPriority);
+    return true;
+}
+
+void CheckpointFile::close()
+{
+    if (m_flushThread) {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_stopping = true;
+        }
+        m_wake.wakeOne();
+        m_flushThread->wait();
+        delete m_flushThread;
+        m_flushThread = nullptr;
+    }
+
+    if (m_map) {
+        flushMapping();
+        m_file.unmap(m_map);
+        m_map = nullptr;
+    }
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+}
+
+bool CheckpointFile::isOpen() const
+{
+    return m_map != nullptr;
+}
+
+bool CheckpointFile::load(Checkpoint &checkpoint) const
+{
+    if (!m_map) return false;
+
+    // 取校验通过且序号最大的槽位
+    const Slot *best = nullptr;
+    for (const Slot &slot : layout()->slots) {
+        if (slot.sequence == 0 || slot.checksum != slot.computeChecksum()) continue;
+        if (!best || slot.sequence > best->sequence) {
+            best = &slot;
+        }
+    }
+
+    if (!best || !best->active || !TetrisEngine::isValidState(best->state)) {
+        return false;
+    }
+    if (!best->state.gameStarted || best->state.gameOver) {
+        return false;
+    }
+
+    checkpoint.state = best->state;
+    checkpoint.playTimeMs = qMax<qint64>(0, best->playTimeMs);
+    return true;
+}
+
+void CheckpointFile::write(const TetrisEngine::State &state, qint64 playTimeMs)
+{
+    writeSlot(state, true, playTimeMs);
+}
+
+void CheckpointFile::clear()
+{
+    writeSlot(TetrisEngine::State{}, false, 0);
+}
+
+QString CheckpointFile::defaultPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)
+         + QStringLiteral("/checkpoint.bin");
+}
+
+CheckpointFile::Layout *CheckpointFile::layout() const
+{
+    return reinterpret_cast<Layout *>(m_map);
+}
+
+void CheckpointFile::writeSlot(const TetrisEngine::State &state, bool active, qint64 playTimeMs)
+{
+    if (!m_map) return;
+
+    // 覆盖较旧的槽位，最新的完整槽位在写入过程中保持不变
+    const quint64 sequence = ++m_sequence;
+    Slot &slot = layout()->slots[sequence & 1];
+    slot.sequence = sequence;
+    slot.state = state;
+    slot.playTimeMs = playTimeMs;
+    slot.active = active ? 1 : 0;
+    std::memset(slot.reserved, 0, sizeof(slot.reserved));
+    slot.checksum = slot.computeChecksum();
+
+    requestFlush();
+}
+
+void CheckpointFile::requestFlush()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_dirty = true;
+    }
+    m_wake.wakeOne();
+}
+
+void CheckpointFile::flushLoop()
+{
+    QMutexLocker locker(&m_mutex);
+    while (true) {
+        while (!m_dirty && !m_stopping) {
+            m_wake.wait(&m_mutex);
+        }
+        if (m_stopping) break;
+
+        // 落盘期间产生的新写入会再次置位，在下一轮合并处理
+        m_dirty = false;
+        locker.unlock();
+        flushMapping();
+        locker.relock();
+    }
+}
+
+void CheckpointFile::flushMapping()
+{
+#ifdef Q_OS_WIN
+    FlushViewOfFile(m_map, sizeof(Layout));
+    FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(m_file.handle())));
+#else
+    msync(m_map, sizeof(Layout), MS_SYNC);
+#endif
+}
@@ -0,0 +1,63 @@
+#ifndef CHECKPOINTFILE_H
+#define CHECKPOINTFILE_H
+
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+#include "tetrisengine.h"
+
+// 进行中对局的持续存档：定长二进制文件通过内存映射写入
+//
+// 文件内有两个槽位交替写入，每个槽位带序号和校验和；写到一半断电时
+// 另一个槽位仍然完整，最多丢失一步。写入只是向映射内存复制一个结构体，
+// 落盘（msync/FlushViewOfFile）由后台线程合并完成，不阻塞界面线程。
+class CheckpointFile
+{
+public:
+    struct Checkpoint {
+        TetrisEngine::State state;
+        // 存档时已进行的时长，恢复后接着累计（每秒方块数和成绩记录的时长依赖它）
+        qint64 playTimeMs;
+    };
+
+    CheckpointFile();
+    ~CheckpointFile();
+
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const;
+
+    // 读取最近一次有效的进行中对局，没有时返回 false
+    bool load(Checkpoint &checkpoint) const;
+
+    void write(const TetrisEngine::State &state, qint64 playTimeMs);
+    // 对局结束或重置后清除，下次启动不再提示继续
+    void clear();
+
+    static QString defaultPath();
+
+private:
+    struct Slot;
+    struct Layout;
+
+    Layout *layout() const;
+    void writeSlot(const TetrisEngine::State &state, bool active, qint64 playTimeMs);
+    void requestFlush();
+    void flushLoop();
+    void flushMapping();
+
+    QFile m_file;
+    uchar *m_map;
+    quint64 m_sequence;
+
+    // 后台落盘线程
+    QThread *m_flushThread;
+    QMutex m_mutex;
+    QWaitCondition m_wake;
+    bool m_dirty;
+    bool m_stopping;
+};
+
+#endif // CHECKPOINTFILE_H
@@ -0,0 +1,121 @@
+#include "framescheduler.h"
+#include <QCoreApplication>
+#include <QScreen>
+#include <QTimer>
+#include <algorithm>
+#include <utility>
+
+#ifdef Q_OS_WIN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+constexpr qint64 DEFAULT_INTERVAL_NS = 1000000000 / 60;
+
+} // namespace
+
+FrameScheduler &FrameScheduler::instance()
+{
+    // 随应用对象销毁，定时器不会比事件循环活得更久
+    static FrameScheduler *scheduler = new FrameScheduler(QCoreApplication::instance());
+    return *scheduler;
+}
+
+FrameScheduler::FrameScheduler(QObject *parent)
+    : QObject(parent)
+    , m_timer(new QTimer(this))
+    , m_lastFrameNs(-DEFAULT_INTERVAL_NS)
+    , m_startCpuMs(processCpuTimeMs())
+    , m_stats{}
+{
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &FrameScheduler::presentFrame);
+    m_clock.start();
+}
+
+void FrameScheduler::requestFrame(QWidget *widget)
+{
+    ++m_stats.requests;
+    for (const QPointer<QWidget> &pending : std::as_const(m_pending)) {
+        if (pending == widget) {
+            ++m_stats.coalesced;
+            return;
+        }
+    }
+    m_pending.append(widget);
+    if (m_timer->isActive()) return;
+
+    // 下一个刷新时刻，向上取整到毫秒
+    const qint64 dueNs = m_lastFrameNs + frameIntervalNs(widget);
+    const qint64 delayNs = std::max<qint64>(0, dueNs - m_clock.nsecsElapsed());
+    m_timer->start(int((delayNs + 999999) / 1000000));
+}
+
+void FrameScheduler::reportSkipped()
+{
+    ++m_stats.skipped;
+}
+
+void FrameScheduler::reportPaint(qint64 nanoseconds)
+{
+    ++m_stats.paints;
+    m_stats.paintNs += nanoseconds;
+}
+
+void FrameScheduler::presentFrame()
+{
+    ++m_stats.wakeups;
+    m_lastFrameNs = m_clock.nsecsElapsed();
+    const QList<QPointer<QWidget>> pending = std::exchange(m_pending, {});
+    for (const QPointer<QWidget> &widget : pending) {
+        if (widget) {
+            widget->update();
+            ++m_stats.frames;
+        }
+    }
+}
+
+FrameScheduler::Stats FrameScheduler::stats() const
+{
+    Stats result = m_stats;
+    result.cpuMs = processCpuTimeMs() - m_startCpuMs;
+    result.wallMs = m_clock.elapsed();
+    return result;
+}
+
+qint64 FrameScheduler::estimatedSavedMs() const
+{
+    if (m_stats.paints == 0) return 0;
+    const qint64 averageNs = m_stats.paintNs / qint64(m_stats.paints);
+    return qint64(m_stats.skipped + m_stats.coalesced) * averageNs / 1000000;
+}
+
+qint64 FrameScheduler::frameIntervalNs(const QWidget *widget)
+{
+    const QScreen *screen = widget ? widget->screen() : nullptr;
+    const qreal rate = screen ? screen->refreshRate() : 0;
+    return rate >= 1 ? qint64(1e9 / rate) : DEFAULT_INTERVAL_NS;
+}
+
+qint64 FrameScheduler::processCpuTimeMs()
+{
+#ifdef Q_OS_WIN
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) return 0;
+    const auto ticks = [](const FILETIME &time) {
+        return (qint64(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    };
+    // FILETIME 以 100ns 为单位
+    return (ticks(kernel) + ticks(user)) / 10000;
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return qint64(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000
+         + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000;
+#endif
+}
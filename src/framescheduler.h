@@ -0,0 +1,65 @@
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QWidget>
+
+class QTimer;
+
+// 帧调度：把各处的重绘请求合并到显示器的刷新节拍上
+//
+// 请求只登记控件，由一个单次定时器在下一个刷新时刻统一 update()；
+// 同一帧内的重复请求直接合并。距上一帧已超过一个刷新间隔时立即出帧，
+// 输入延迟不会增加。没有请求时定时器不启动，暂停和结束画面不产生唤醒。
+// 调用方在请求之前判断内容是否变化，没变化的只记一次跳过。
+class FrameScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 统计自第一次使用起累计
+    struct Stats {
+        quint64 requests;   // 内容变化后的重绘请求
+        quint64 skipped;    // 内容没变、没有请求的刷新
+        quint64 coalesced;  // 同一控件在同一帧内的重复请求
+        quint64 frames;     // 发出的控件重绘
+        quint64 wakeups;    // 定时器唤醒
+        quint64 paints;     // 实际执行的绘制
+        qint64 paintNs;     // 绘制总耗时
+        qint64 cpuMs;       // 进程 CPU 时间
+        qint64 wallMs;
+    };
+
+    static FrameScheduler &instance();
+
+    void requestFrame(QWidget *widget);
+    void reportSkipped();
+    void reportPaint(qint64 nanoseconds);
+
+    Stats stats() const;
+    // 按平均绘制耗时估算跳过和合并的请求省下的 CPU 时间
+    qint64 estimatedSavedMs() const;
+
+    static qint64 processCpuTimeMs();
+
+private slots:
+    void presentFrame();
+
+private:
+    explicit FrameScheduler(QObject *parent);
+
+    // 请求所在屏幕的刷新间隔，取不到时按 60Hz
+    static qint64 frameIntervalNs(const QWidget *widget);
+
+    QTimer *m_timer;
+    QList<QPointer<QWidget>> m_pending;
+    QElapsedTimer m_clock;
+    qint64 m_lastFrameNs;
+    qint64 m_startCpuMs;
+    Stats m_stats;
+};
+
+#endif // FRAMESCHEDULER_H
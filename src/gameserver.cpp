@@ -0,0 +1,236 @@
+#include "gameserver.h"
+#include "serverprotocol.h"
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QRandomGenerator>
+#include <QTimer>
+
+namespace {
+
+// 客户端读得太慢时暂停给它发增量；发送状态不更新，积压写出后由 resumeClient 把它的会话全部补齐
+constexpr qint64 MAX_BACKLOG_BYTES = 1 << 20;
+
+void appendMessage(QByteArray &output, const std::uint8_t *message, std::size_t size)
+{
+    output.append(reinterpret_cast<const char *>(message), qsizetype(size));
+}
+
+} // namespace
+
+GameServer::GameServer(int maxSessions, QObject *parent)
+    : QObject(parent)
+    , m_server(new QLocalServer(this))
+    , m_tickTimer(new QTimer(this))
+    , m_pool(maxSessions)
+    , m_owners(std::size_t(m_pool.capacity()), nullptr)
+    , m_sent(std::size_t(m_pool.capacity()))
+    , m_bytesSent(0)
+{
+    m_dirty.reserve(std::size_t(m_pool.capacity()));
+    m_clock.start();
+
+    // 所有会话共用一个定时器，时间轮按毫秒推进
+    m_tickTimer->setTimerType(Qt::PreciseTimer);
+    m_tickTimer->setInterval(1);
+    connect(m_tickTimer, &QTimer::timeout, this, &GameServer::tick);
+    connect(m_server, &QLocalServer::newConnection, this, &GameServer::acceptClients);
+}
+
+GameServer::~GameServer()
+{
+    m_tickTimer->stop();
+}
+
+bool GameServer::listen(const QString &name)
+{
+    // 上次异常退出留下的套接字文件会让 listen 失败
+    QLocalServer::removeServer(name);
+    return m_server->listen(name);
+}
+
+QString GameServer::errorString() const
+{
+    return m_server->errorString();
+}
+
+GameServer::Stats GameServer::takeStats()
+{
+    Stats stats;
+    stats.sessions = m_pool.size();
+    stats.clients = int(m_clients.size());
+    stats.drops = m_pool.dropCount();
+    stats.maxLatenessMs = m_pool.takeMaxLateness();
+    stats.bytesSent = m_bytesSent;
+    stats.memoryBytes = qsizetype(m_pool.memoryUsage() + m_owners.capacity() * sizeof(QLocalSocket *)
+                                  + m_sent.capacity() * sizeof(TetrisEngine::State));
+    return stats;
+}
+
+void GameServer::acceptClients()
+{
+    while (QLocalSocket *socket = m_server->nextPendingConnection()) {
+        m_clients.insert(socket, Client());
+        connect(socket, &QLocalSocket::readyRead, this, &GameServer::readClient);
+        connect(socket, &QLocalSocket::disconnected, this, &GameServer::dropClient);
+        connect(socket, &QLocalSocket::bytesWritten, this, &GameServer::resumeClient);
+    }
+}
+
+void GameServer::readClient()
+{
+    auto *socket = qobject_cast<QLocalSocket *>(sender());
+    auto it = m_clients.find(socket);
+    if (it == m_clients.end()) return;
+
+    Client &client = it.value();
+    client.input.append(socket->readAll());
+    qsizetype offset = 0;
+    for (; offset + qsizetype(COMMAND_SIZE) <= client.input.size(); offset += COMMAND_SIZE) {
+        handleCommand(socket, client, reinterpret_cast<const std::uint8_t *>(client.input.constData() + offset));
+    }
+    client.input.remove(0, offset);
+
+    // 输入的结果立即发回，不等下一次定时推进
+    queueDeltas();
+    flush();
+}
+
+void GameServer::dropClient()
+{
+    auto *socket = qobject_cast<QLocalSocket *>(sender());
+    const auto it = m_clients.find(socket);
+    if (it != m_clients.end()) {
+        for (SessionPool::SessionId id : it->sessions) {
+            m_pool.destroy(id);
+            m_owners[SessionPool::slotIndex(id)] = nullptr;
+        }
+        m_clients.erase(it);
+    }
+    socket->deleteLater();
+}
+
+void GameServer::resumeClient()
+{
+    auto *socket = qobject_cast<QLocalSocket *>(sender());
+    const auto it = m_clients.find(socket);
+    if (it == m_clients.end() || !it->backlogged || socket->bytesToWrite() > MAX_BACKLOG_BYTES) return;
+
+    // 跳过的会话之后可能不再变化（已结束或玩家不操作），不能等下一次变化再发
+    it->backlogged = false;
+    for (SessionPool::SessionId id : std::as_const(it->sessions)) {
+        queueDelta(it.value(), id);
+    }
+    flush();
+}
+
+void GameServer::tick()
+{
+    m_pool.advance(nowMs());
+    queueDeltas();
+    flush();
+
+    // 已结束但没关闭的对局不再下落，不必每毫秒唤醒；新开局时重新启动
+    if (m_pool.scheduledCount() == 0) {
+        m_tickTimer->stop();
+    }
+}
+
+void GameServer::handleCommand(QLocalSocket *socket, Client &client, const std::uint8_t *packet)
+{
+    const ClientCommand command = decodeCommand(packet);
+    std::uint8_t message[MAX_MESSAGE_SIZE];
+
+    if (command.type == ClientCommandType::Create) {
+        const quint64 seed = command.session ? command.session : QRandomGenerator::global()->generate64();
+        const SessionPool::SessionId id = m_pool.create(seed, nowMs());
+        if (id == SessionPool::INVALID_SESSION) {
+            appendMessage(client.output, message, encodeRejected(0, RejectReason::ServerFull, message));
+            return;
+        }
+
+        const std::uint32_t index = SessionPool::slotIndex(id);
+        m_owners[index] = socket;
+        m_sent[index] = m_pool.engine(id)->saveState();
+        client.sessions.append(id);
+        appendMessage(client.output, message, encodeSessionMessage(ServerMessageType::Created, id, message));
+        appendMessage(client.output, message, encodeDelta(id, m_sent[index], m_sent[index], true, message));
+        if (!m_tickTimer->isActive()) {
+            m_tickTimer->start();
+        }
+        return;
+    }
+
+    // 只能操作自己创建的会话
+    const bool owned = m_pool.contains(command.session) && m_owners[SessionPool::slotIndex(command.session)] == socket;
+    if (!owned) {
+        appendMessage(client.output, message, encodeRejected(command.session, RejectReason::UnknownSession, message));
+        return;
+    }
+
+    switch (command.type) {
+    case ClientCommandType::Input:
+        m_pool.input(command.session, command.arg, nowMs());
+        break;
+    case ClientCommandType::Close:
+        closeSession(client, command.session);
+        appendMessage(client.output, message, encodeSessionMessage(ServerMessageType::Closed, command.session, message));
+        break;
+    default:
+        appendMessage(client.output, message, encodeRejected(command.session, RejectReason::BadCommand, message));
+        break;
+    }
+}
+
+void GameServer::closeSession(Client &client, SessionPool::SessionId id)
+{
+    m_pool.destroy(id);
+    m_owners[SessionPool::slotIndex(id)] = nullptr;
+    client.sessions.removeOne(id);
+}
+
+void GameServer::queueDeltas()
+{
+    m_pool.takeDirty(m_dirty);
+    for (SessionPool::SessionId id : m_dirty) {
+        if (!m_pool.contains(id)) continue;     // 变化后已被关闭
+
+        QLocalSocket *socket = m_owners[SessionPool::slotIndex(id)];
+        const auto it = m_clients.find(socket);
+        if (it == m_clients.end()) continue;
+        if (socket->bytesToWrite() > MAX_BACKLOG_BYTES) {
+            it->backlogged = true;
+            continue;
+        }
+        queueDelta(it.value(), id);
+    }
+}
+
+void GameServer::queueDelta(Client &client, SessionPool::SessionId id)
+{
+    const TetrisEngine *engine = m_pool.engine(id);
+    if (!engine) return;
+
+    const std::uint32_t index = SessionPool::slotIndex(id);
+    const TetrisEngine::State current = engine->saveState();
+    std::uint8_t message[MAX_MESSAGE_SIZE];
+    const std::size_t size = encodeDelta(id, m_sent[index], current, false, message);
+    if (size > 0) {
+        appendMessage(client.output, message, size);
+        m_sent[index] = current;
+    }
+}
+
+void GameServer::flush()
+{
+    for (auto it = m_clients.begin(); it != m_clients.end(); ++it) {
+        if (it->output.isEmpty()) continue;
+        it.key()->write(it->output);
+        m_bytesSent += quint64(it->output.size());
+        it->output.truncate(0);     // 保留容量，下一轮不重新分配
+    }
+}
+
+quint64 GameServer::nowMs() const
+{
+    return quint64(m_clock.elapsed());
+}
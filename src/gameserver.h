@@ -0,0 +1,79 @@
+#ifndef GAMESERVER_H
+#define GAMESERVER_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <vector>
+#include "sessionpool.h"
+
+class QLocalServer;
+class QLocalSocket;
+class QTimer;
+
+// 无界面的多会话服务器：在本地套接字上接受客户端，每个客户端可以开多局，
+// 对局全部放在一个 SessionPool 中，由一个 1ms 的精确定时器推进时间轮。
+// 协议见 serverprotocol.h；每次推进后把变化的会话编码为增量，按客户端合并成一次写入。
+class GameServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Stats {
+        int sessions;
+        int clients;
+        quint64 drops;              // 累计重力下落次数
+        quint64 maxLatenessMs;      // 上次取统计以来最大的下落延迟
+        quint64 bytesSent;
+        qsizetype memoryBytes;      // 会话池和发送状态占用
+    };
+
+    explicit GameServer(int maxSessions, QObject *parent = nullptr);
+    ~GameServer();
+
+    bool listen(const QString &name);
+    QString errorString() const;
+
+    Stats takeStats();
+
+private slots:
+    void acceptClients();
+    void readClient();
+    void dropClient();
+    void resumeClient();
+    void tick();
+
+private:
+    struct Client {
+        QByteArray input;                       // 未凑满一条命令的字节
+        QByteArray output;                      // 本轮待写出的消息
+        QVector<SessionPool::SessionId> sessions;
+        // 因积压跳过过增量，积压消化后要把全部会话补发一次
+        bool backlogged = false;
+    };
+
+    void handleCommand(QLocalSocket *socket, Client &client, const std::uint8_t *packet);
+    void closeSession(Client &client, SessionPool::SessionId id);
+    void queueDeltas();
+    void queueDelta(Client &client, SessionPool::SessionId id);
+    void flush();
+    quint64 nowMs() const;
+
+    QLocalServer *m_server;
+    QTimer *m_tickTimer;
+    QElapsedTimer m_clock;
+
+    SessionPool m_pool;
+    // 按槽位索引：会话所属的客户端和最近一次发给它的状态，增量相对它计算
+    std::vector<QLocalSocket *> m_owners;
+    std::vector<TetrisEngine::State> m_sent;
+    std::vector<SessionPool::SessionId> m_dirty;
+
+    QHash<QLocalSocket *, Client> m_clients;
+    quint64 m_bytesSent;
+};
+
+#endif // GAMESERVER_H
@@ -0,0 +1,115 @@
+#include "hudpanel.h"
+#include "theme.h"
+#include <QFontMetrics>
+#include <QPaintEvent>
+#include <QPainter>
+
+namespace {
+
+// 布局按这么多位数字预留宽度
+constexpr int MAX_DIGITS = 9;
+constexpr int CAPTION_SPACING = 4;
+constexpr int ITEM_SPACING = 20;
+constexpr int MIN_WIDTH = 120;
+
+struct FieldStyle {
+    const char *caption;
+    QRgb color;
+};
+
+constexpr FieldStyle FIELD_STYLES[HudPanel::FieldCount] = {
+    {"分数:", qRgb(0x00, 0xff, 0x00)},
+    {"等级:", qRgb(0xff, 0xff, 0x00)},
+    {"行数:", qRgb(0x00, 0xff, 0xff)},
+    {"方块:", qRgb(0xff, 0xff, 0xff)},
+    {"每秒方块:", qRgb(0xff, 0x98, 0x00)}
+};
+
+} // namespace
+
+HudPanel::HudPanel(QWidget *parent)
+    : QWidget(parent)
+{
+    m_captionFont = font();
+    m_captionFont.setPixelSize(14);
+    m_captionFont.setBold(true);
+    m_valueFont = font();
+    m_valueFont.setPixelSize(24);
+    m_valueFont.setBold(true);
+
+    // 只重画数值所在的矩形，背景自己填
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
+
+    const QFontMetrics captionMetrics(m_captionFont);
+    const QFontMetrics valueMetrics(m_valueFont);
+    const int width = qMax(MIN_WIDTH, valueMetrics.horizontalAdvance(QString(MAX_DIGITS, QLatin1Char('0'))));
+
+    int y = 0;
+    for (int i = 0; i < FieldCount; ++i) {
+        Item &item = m_items[i];
+        item.caption.setText(QString::fromUtf8(FIELD_STYLES[i].caption));
+        item.caption.setTextFormat(Qt::PlainText);
+        item.caption.prepare(QTransform(), m_captionFont);
+        item.value.setTextFormat(Qt::PlainText);
+        item.color = FIELD_STYLES[i].color;
+        item.captionY = y;
+        y += captionMetrics.height() + CAPTION_SPACING;
+        item.valueRect = QRect(0, y, width, valueMetrics.height());
+        y += valueMetrics.height() + ITEM_SPACING;
+    }
+    m_size = QSize(width, y - ITEM_SPACING);
+
+    for (int i = 0; i < FieldCount; ++i) {
+        setValue(Field(i), i == Level ? 1 : 0);
+    }
+    setPiecesPerSecond(0.0);
+}
+
+void HudPanel::setValue(Field field, qint64 value)
+{
+    setText(field, QString::number(value));
+}
+
+void HudPanel::setPiecesPerSecond(double piecesPerSecond)
+{
+    setText(PiecesPerSecond, QString::number(piecesPerSecond, 'f', 2));
+}
+
+QSize HudPanel::sizeHint() const
+{
+    return m_size;
+}
+
+void HudPanel::setText(Field field, const QString &text)
+{
+    Item &item = m_items[field];
+    if (item.text == text) return;
+
+    item.text = text;
+    item.value.setText(text);
+    item.value.prepare(QTransform(), m_valueFont);
+    update(item.valueRect);
+}
+
+void HudPanel::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    painter.fillRect(event->rect(), QColor(Theme::BACKGROUND));
+
+    for (const Item &item : m_items) {
+        const QRect captionRect(0, item.captionY, width(), item.valueRect.top() - item.captionY);
+        if (event->region().intersects(captionRect)) {
+            painter.setFont(m_captionFont);
+            painter.setPen(QColor(Theme::TEXT));
+            painter.drawStaticText(0, item.captionY, item.caption);
+        }
+        if (event->region().intersects(item.valueRect)) {
+            // 数值居中
+            const int x = item.valueRect.left() + (item.valueRect.width() - int(item.value.size().width())) / 2;
+            painter.setFont(m_valueFont);
+            painter.setPen(QColor(item.color));
+            painter.drawStaticText(x, item.valueRect.top(), item.value);
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef HUDPANEL_H
+#define HUDPANEL_H
+
+#include <QFont>
+#include <QRgb>
+#include <QStaticText>
+#include <QWidget>
+#include <array>
+
+// 分数面板：分数、等级、行数、方块数和每秒方块数画在一个控件里
+//
+// 布局在构造时按最长的数字固定下来，数值变化不会改变尺寸提示，也不会
+// 触发布局；每个数值的文字排版缓存在 QStaticText 里，只在值变化时重排，
+// 并且只重画该数值所在的矩形。
+class HudPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    enum Field {
+        Score,
+        Level,
+        Lines,
+        Pieces,
+        PiecesPerSecond,
+        FieldCount
+    };
+
+    explicit HudPanel(QWidget *parent = nullptr);
+
+    void setValue(Field field, qint64 value);
+    void setPiecesPerSecond(double piecesPerSecond);
+
+    QSize sizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    struct Item {
+        QStaticText caption;
+        QStaticText value;
+        QString text;
+        QRgb color;
+        int captionY;
+        QRect valueRect;
+    };
+
+    void setText(Field field, const QString &text);
+
+    QFont m_captionFont;
+    QFont m_valueFont;
+    std::array<Item, FieldCount> m_items;
+    QSize m_size;
+};
+
+#endif // HUDPANEL_H
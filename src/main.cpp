@@ -1,10 +1,58 @@
 #include <QApplication>
 #include <QIcon>
+#include <cstring>
 #include "mainwindow.h"
+#include "tetrisboard.h"
+#include "startupprofile.h"
+#include "theme.h"
+
+#ifdef TETRIS_HAVE_QUICK
+#include <QQuickWindow>
+#endif
+
+#ifdef TETRIS_HAVE_NETWORK
+#include "spectatorfeed.h"
+#include "spectatorwindow.h"
+#endif
 
 int main(int argc, char *argv[])
 {
+    StartupProfile::start();
+
+    // 渲染后端：--renderer=painter|scenegraph，或环境变量 TETRIS_RENDERER；
+    // --software-gl 让场景图在没有显卡的机器上使用软件 OpenGL 光栅化
+    QByteArray rendererName = qgetenv("TETRIS_RENDERER");
+    bool softwareGl = qEnvironmentVariableIsSet("TETRIS_SOFTWARE_GL");
+    // --spectate[=名称] 只打开观战窗口，连接另一个进程的观战广播
+    bool spectate = false;
+    QByteArray feedName;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--renderer=", 11) == 0) {
+            rendererName = argv[i] + 11;
+        } else if (std::strcmp(argv[i], "--software-gl") == 0) {
+            softwareGl = true;
+        } else if (std::strcmp(argv[i], "--spectate") == 0) {
+            spectate = true;
+        } else if (std::strncmp(argv[i], "--spectate=", 11) == 0) {
+            spectate = true;
+            feedName = argv[i] + 11;
+        }
+    }
+    const bool sceneGraph = rendererName == "scenegraph";
+
+#ifdef TETRIS_HAVE_QUICK
+    if (sceneGraph && softwareGl) {
+        // Windows 上加载 opengl32sw（llvmpipe），Linux 上让 Mesa 使用 llvmpipe
+        QCoreApplication::setAttribute(Qt::AA_UseSoftwareOpenGL);
+        qputenv("LIBGL_ALWAYS_SOFTWARE", "1");
+        QQuickWindow::setGraphicsApi(QSGRendererInterface::OpenGL);
+    }
+#else
+    Q_UNUSED(softwareGl);
+#endif
+
     QApplication app(argc, argv);
+    StartupProfile::mark("QApplication");
 
     // 设置应用程序信息
     QApplication::setApplicationName("俄罗斯方块");
@@ -14,9 +62,30 @@ int main(int argc, char *argv[])
     // 设置应用程序图标（窗口和任务栏图标）
     app.setWindowIcon(QIcon(":/tetris_icon.svg"));
 
+    // 全部窗口共用一套风格和调色板，不解析样式表
+    Theme::apply(app);
+    StartupProfile::mark("主题");
+
+    TetrisBoard::setDefaultRenderer(sceneGraph ? TetrisBoard::Renderer::SceneGraph
+                                               : TetrisBoard::Renderer::Painter);
+
+#ifdef TETRIS_HAVE_NETWORK
+    if (spectate) {
+        SpectatorWindow viewer(feedName.isEmpty() ? SpectatorFeed::defaultName() : QString::fromUtf8(feedName));
+        viewer.show();
+        StartupProfile::mark("观战窗口");
+        return app.exec();
+    }
+#else
+    Q_UNUSED(spectate);
+    Q_UNUSED(feedName);
+#endif
+
     // 创建并显示主窗口
     MainWindow window;
+    StartupProfile::mark("主窗口");
     window.show();
+    StartupProfile::mark("显示");
 
     return app.exec();
-}
\ No newline at end of file
+}
@@ -1,8 +1,27 @@
 #include "mainwindow.h"
 #include "tetrisgame.h"
 #include "tetrisboard.h"
+#include "rotationsystem.h"
+#include "versuswindow.h"
+#include "arenawindow.h"
+#include "puzzlewindow.h"
+#include "checkpointfile.h"
+#include "scorestore.h"
+#include "telemetry.h"
+#include "framescheduler.h"
+#include "startupprofile.h"
+#include "theme.h"
+#include "hudpanel.h"
+#ifdef TETRIS_HAVE_NETWORK
+#include "spectatorfeed.h"
+#endif
 #include <QMessageBox>
 #include <QMenuBar>
+#include <QActionGroup>
+#include <QTimer>
+#include <QDateTime>
+#include <QInputDialog>
+#include <QSettings>
 #include <QStatusBar>
 #include <QApplication>
 
@@ -10,6 +29,10 @@ MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , m_board(nullptr)
     , m_game(nullptr)
+    , m_checkpoint(nullptr)
+    , m_scores(nullptr)
+    , m_telemetry(nullptr)
+    , m_spectatorFeed(nullptr)
 {
     // 创建游戏对象
     m_game = new TetrisGame(this);
@@ -24,10 +47,32 @@ MainWindow::MainWindow(QWidget *parent)
     
     setWindowTitle("俄罗斯方块");
     resize(600, 700);
+    
+    // 打开持续存档，窗口显示后再询问是否继续上次的对局
+    m_checkpoint = new CheckpointFile();
+    if (m_checkpoint->open(CheckpointFile::defaultPath())) {
+        QTimer::singleShot(0, this, &MainWindow::offerResume);
+    }
+    
+    // 遥测事件流（设置 TETRIS_TELEMETRY=文件路径 时开启）
+    const QString telemetryPath = qEnvironmentVariable("TETRIS_TELEMETRY");
+    if (!telemetryPath.isEmpty()) {
+        m_telemetry = new Telemetry();
+        if (m_telemetry->open(telemetryPath)) {
+            m_game->setTelemetry(m_telemetry);
+        } else {
+            delete m_telemetry;
+            m_telemetry = nullptr;
+        }
+    }
 }
 
 MainWindow::~MainWindow()
 {
+    m_game->setTelemetry(nullptr);
+    delete m_telemetry;
+    delete m_scores;
+    delete m_checkpoint;
 }
 
 void MainWindow::setupUI()
@@ -44,50 +89,23 @@ void MainWindow::setupUI()
     m_infoLayout = new QVBoxLayout();
     m_infoLayout->setSpacing(15);
 
-    // 分数标签
-    m_scoreLabel = new QLabel("分数:", this);
-    m_scoreLabel->setStyleSheet("QLabel { font-size: 14px; font-weight: bold; color: white; }");
-    m_scoreValue = new QLabel("0", this);
-    m_scoreValue->setStyleSheet("QLabel { font-size: 24px; font-weight: bold; color: #00ff00; }");
-    m_scoreValue->setAlignment(Qt::AlignCenter);
-
-    // 等级标签
-    m_levelLabel = new QLabel("等级:", this);
-    m_levelLabel->setStyleSheet("QLabel { font-size: 14px; font-weight: bold; color: white; }");
-    m_levelValue = new QLabel("1", this);
-    m_levelValue->setStyleSheet("QLabel { font-size: 24px; font-weight: bold; color: #ffff00; }");
-    m_levelValue->setAlignment(Qt::AlignCenter);
-
-    // 行数标签
-    m_linesLabel = new QLabel("行数:", this);
-    m_linesLabel->setStyleSheet("QLabel { font-size: 14px; font-weight: bold; color: white; }");
-    m_linesValue = new QLabel("0", this);
-    m_linesValue->setStyleSheet("QLabel { font-size: 24px; font-weight: bold; color: #00ffff; }");
-    m_linesValue->setAlignment(Qt::AlignCenter);
-
-    // 添加到信息布局
-    m_infoLayout->addWidget(m_scoreLabel);
-    m_infoLayout->addWidget(m_scoreValue);
-    m_infoLayout->addSpacing(20);
-    m_infoLayout->addWidget(m_levelLabel);
-    m_infoLayout->addWidget(m_levelValue);
-    m_infoLayout->addSpacing(20);
-    m_infoLayout->addWidget(m_linesLabel);
-    m_infoLayout->addWidget(m_linesValue);
+    // 分数、等级、行数等数值画在一个固定布局的面板里
+    m_hud = new HudPanel(this);
+    m_infoLayout->addWidget(m_hud, 0, Qt::AlignHCenter);
     m_infoLayout->addSpacing(30);
 
     // 创建按钮
     m_startButton = new QPushButton("开始游戏", this);
-    m_startButton->setStyleSheet("QPushButton { font-size: 14px; padding: 12px; background-color: #4CAF50; color: white; border: none; border-radius: 5px; } QPushButton:hover { background-color: #45a049; }");
+    Theme::setButtonColor(m_startButton, Theme::START);
     m_startButton->setMinimumWidth(120);
 
     m_pauseButton = new QPushButton("暂停", this);
-    m_pauseButton->setStyleSheet("QPushButton { font-size: 14px; padding: 12px; background-color: #ff9800; color: white; border: none; border-radius: 5px; } QPushButton:hover { background-color: #e68a00; }");
+    Theme::setButtonColor(m_pauseButton, Theme::PAUSE);
     m_pauseButton->setEnabled(false);
     m_pauseButton->setMinimumWidth(120);
 
     m_resetButton = new QPushButton("重置", this);
-    m_resetButton->setStyleSheet("QPushButton { font-size: 14px; padding: 12px; background-color: #f44336; color: white; border: none; border-radius: 5px; } QPushButton:hover { background-color: #da190b; }");
+    Theme::setButtonColor(m_resetButton, Theme::RESET);
     m_resetButton->setMinimumWidth(120);
 
     m_infoLayout->addWidget(m_startButton);
@@ -106,9 +124,6 @@ void MainWindow::setupUI()
     // 添加到主布局：左侧控制面板 + 中间游戏板
     m_mainLayout->addLayout(m_infoLayout);
     m_mainLayout->addLayout(m_gameLayout, 1);
-
-    // 设置背景色
-    centralWidget->setStyleSheet("QWidget { background-color: #1a1a2e; }");
 }
 
 void MainWindow::createMenuBar()
@@ -134,6 +149,54 @@ void MainWindow::createMenuBar()
     
     gameMenu->addSeparator();
     
+    QAction *leaderboardAction = gameMenu->addAction("排行榜(&B)");
+    leaderboardAction->setShortcut(QKeySequence("Ctrl+B"));
+    connect(leaderboardAction, &QAction::triggered, this, &MainWindow::showLeaderboard);
+    
+    QAction *playerAction = gameMenu->addAction("玩家名(&N)...");
+    connect(playerAction, &QAction::triggered, this, &MainWindow::changePlayerName);
+    
+    gameMenu->addSeparator();
+    
+    QAction *versusAction = gameMenu->addAction("双人对战(&V)");
+    versusAction->setShortcut(QKeySequence("Ctrl+D"));
+    connect(versusAction, &QAction::triggered, this, &MainWindow::openVersus);
+    
+    QAction *arenaAction = gameMenu->addAction("AI 观摩(&I)");
+    arenaAction->setShortcut(QKeySequence("Ctrl+I"));
+    connect(arenaAction, &QAction::triggered, this, &MainWindow::openArena);
+    
+    QAction *puzzleAction = gameMenu->addAction("谜题(&U)");
+    puzzleAction->setShortcut(QKeySequence("Ctrl+U"));
+    connect(puzzleAction, &QAction::triggered, this, &MainWindow::openPuzzles);
+    
+#ifdef TETRIS_HAVE_NETWORK
+    QAction *spectateAction = gameMenu->addAction("观战广播(&W)");
+    spectateAction->setCheckable(true);
+    connect(spectateAction, &QAction::toggled, this, &MainWindow::toggleSpectatorFeed);
+    
+#endif
+    gameMenu->addSeparator();
+    
+    // 旋转系统选择：第一次展开时才创建选项
+    QMenu *rotationMenu = gameMenu->addMenu("旋转系统(&T)");
+    connect(rotationMenu, &QMenu::aboutToShow, this, [this, rotationMenu]() {
+        if (!rotationMenu->isEmpty()) return;
+        QActionGroup *rotationGroup = new QActionGroup(rotationMenu);
+        for (const RotationSystem *system : RotationSystem::available()) {
+            QAction *action = rotationMenu->addAction(QString::fromUtf8(system->displayName()));
+            action->setCheckable(true);
+            action->setChecked(system == m_game->rotationSystem());
+            rotationGroup->addAction(action);
+            connect(action, &QAction::triggered, this, [this, system]() {
+                m_game->setRotationSystem(system);
+                m_board->setFocus();
+            });
+        }
+    });
+    
+    gameMenu->addSeparator();
+    
     QAction *exitAction = gameMenu->addAction("退出(&X)");
     exitAction->setShortcut(QKeySequence("Ctrl+Q"));
     connect(exitAction, &QAction::triggered, this, &QWidget::close);
@@ -141,35 +204,122 @@ void MainWindow::createMenuBar()
     // 帮助菜单
     QMenu *helpMenu = menuBar->addMenu("帮助(&H)");
     
+    QAction *frameStatsAction = helpMenu->addAction("绘制统计(&F)");
+    connect(frameStatsAction, &QAction::triggered, this, &MainWindow::showFrameStats);
+    
     QAction *aboutAction = helpMenu->addAction("关于(&A)");
-    connect(aboutAction, &QAction::triggered, [this]() {
-        QString aboutText = QString::fromUtf8(
-            "<h2>俄罗斯方块 v1.0</h2>"
-
-            "<h3>游戏控制</h3>"
-            "<table border='1' cellpadding='4' cellspacing='0' style='width:100%'>"
-            "<tr><td colspan='2'><b>方向键 / Vim</b></td><td><b>功能</b></td></tr>"
-            "<tr><td>← / h</td><td>→ / l</td><td>左右移动</td></tr>"
-            "<tr><td>↓ / j</td><td>↑ / k</td><td>加速下落 / 旋转</td></tr>"
-            "<tr><td colspan='2'><b>空格</b></td><td>直接落地</td></tr>"
-            "<tr><td colspan='3'><hr></td></tr>"
-            "<tr><td>Ctrl+S</td><td>Ctrl+P</td><td>开始 / 暂停</td></tr>"
-            "<tr><td>Ctrl+R</td><td>Ctrl+Q</td><td>重置 / 退出</td></tr>"
-            "</table>"
-
-            "<h3>得分规则</h3>"
-            "<ul>"
-            "<li>消除1行: 100 × 等级</li>"
-            "<li>消除2行: 300 × 等级</li>"
-            "<li>消除3行: 500 × 等级</li>"
-            "<li>消除4行: 800 × 等级</li>"
-            "<li>每消除10行升一级</li>"
-            "</ul>"
-
-            "<p style='margin:5px 0;'><i>祝您游戏愉快！</i></p>"
-        );
-        QMessageBox::about(this, "关于俄罗斯方块", aboutText);
-    });
+    connect(aboutAction, &QAction::triggered, this, &MainWindow::showAbout);
+}
+
+void MainWindow::showAbout()
+{
+    QString aboutText = QString::fromUtf8(
+        "<h2>俄罗斯方块 v1.0</h2>"
+
+        "<h3>游戏控制</h3>"
+        "<table border='1' cellpadding='4' cellspacing='0' style='width:100%'>"
+        "<tr><td colspan='2'><b>方向键 / Vim</b></td><td><b>功能</b></td></tr>"
+        "<tr><td>← / h</td><td>→ / l</td><td>左右移动</td></tr>"
+        "<tr><td>↓ / j</td><td>↑ / k</td><td>加速下落 / 顺时针旋转</td></tr>"
+        "<tr><td>z</td><td>a</td><td>逆时针旋转 / 180度旋转</td></tr>"
+        "<tr><td colspan='2'><b>空格</b></td><td>直接落地</td></tr>"
+        "<tr><td colspan='3'><hr></td></tr>"
+        "<tr><td>Ctrl+S</td><td>Ctrl+P</td><td>开始 / 暂停</td></tr>"
+        "<tr><td>Ctrl+R</td><td>Ctrl+Q</td><td>重置 / 退出</td></tr>"
+        "</table>"
+
+        "<h3>得分规则</h3>"
+        "<ul>"
+        "<li>消除1行: 100 × 等级</li>"
+        "<li>消除2行: 300 × 等级</li>"
+        "<li>消除3行: 500 × 等级</li>"
+        "<li>消除4行: 800 × 等级</li>"
+        "<li>每消除10行升一级</li>"
+        "</ul>"
+
+        "<p style='margin:5px 0;'><i>祝您游戏愉快！</i></p>"
+    );
+    QMessageBox::about(this, "关于俄罗斯方块", aboutText);
+}
+
+void MainWindow::showFrameStats()
+{
+    const FrameScheduler &scheduler = FrameScheduler::instance();
+    const FrameScheduler::Stats stats = scheduler.stats();
+    const double averageMs = stats.paints ? double(stats.paintNs) / double(stats.paints) / 1e6 : 0.0;
+    const QString text = QString(
+        "运行 %1 秒，进程 CPU 时间 %2 ms\n\n"
+        "重绘请求 %3 次，画面未变跳过 %4 次，同一帧内合并 %5 次\n"
+        "定时器唤醒 %6 次，发出重绘 %7 次\n"
+        "实际绘制 %8 次，平均 %9 ms\n\n"
+        "估计省下 CPU 时间 %10 ms\n\n"
+        "启动耗时（自 main() 起）:\n%11")
+        .arg(stats.wallMs / 1000)
+        .arg(stats.cpuMs)
+        .arg(stats.requests)
+        .arg(stats.skipped)
+        .arg(stats.coalesced)
+        .arg(stats.wakeups)
+        .arg(stats.frames)
+        .arg(stats.paints)
+        .arg(averageMs, 0, 'f', 3)
+        .arg(scheduler.estimatedSavedMs())
+        .arg(StartupProfile::report());
+    QMessageBox::information(this, "绘制统计", text);
+}
+
+void MainWindow::openArena()
+{
+    if (m_game->isGameStarted() && !m_game->isPaused() && !m_game->isGameOver()) {
+        pauseGame();
+    }
+
+    ArenaWindow *arena = new ArenaWindow();
+    arena->setAttribute(Qt::WA_DeleteOnClose);
+    arena->setWindowIcon(windowIcon());
+    arena->show();
+}
+
+void MainWindow::openPuzzles()
+{
+    if (m_game->isGameStarted() && !m_game->isPaused() && !m_game->isGameOver()) {
+        pauseGame();
+    }
+
+    PuzzleWindow *puzzles = new PuzzleWindow();
+    puzzles->setAttribute(Qt::WA_DeleteOnClose);
+    puzzles->setWindowIcon(windowIcon());
+    puzzles->show();
+}
+
+void MainWindow::toggleSpectatorFeed(bool enabled)
+{
+#ifdef TETRIS_HAVE_NETWORK
+    if (!enabled) {
+        if (m_spectatorFeed) {
+            m_spectatorFeed->close();
+        }
+        statusBar()->showMessage("观战广播已关闭", 3000);
+        return;
+    }
+
+    // 第一次打开时才创建，不观战时不占用套接字
+    if (!m_spectatorFeed) {
+        m_spectatorFeed = new SpectatorFeed(m_game, this);
+    }
+    if (m_spectatorFeed->listen(SpectatorFeed::defaultName())) {
+        statusBar()->showMessage(QString("观战广播已开启，用 --spectate 打开观战窗口"), 5000);
+    } else {
+        QMessageBox::warning(this, "观战广播", "无法开启观战广播：" + m_spectatorFeed->errorString());
+        if (auto *action = qobject_cast<QAction *>(sender())) {
+            const QSignalBlocker blocker(action);
+            action->setChecked(false);
+        }
+    }
+    m_board->setFocus();
+#else
+    Q_UNUSED(enabled);
+#endif
 }
 
 void MainWindow::createStatusBar()
@@ -180,13 +330,8 @@ void MainWindow::createStatusBar()
 
 void MainWindow::connectSignals()
 {
-    // 连接游戏信号
-    connect(m_game, &TetrisGame::boardChanged, m_board, QOverload<>::of(&TetrisBoard::update));
-    connect(m_game, &TetrisGame::pieceChanged, m_board, QOverload<>::of(&TetrisBoard::update));
-    connect(m_game, &TetrisGame::scoreChanged, this, &MainWindow::updateScore);
-    connect(m_game, &TetrisGame::levelChanged, this, &MainWindow::updateLevel);
-    connect(m_game, &TetrisGame::linesChanged, this, &MainWindow::updateLines);
-    connect(m_game, &TetrisGame::gameOverSignal, this, &MainWindow::handleGameOver);
+    // 连接游戏信号：一轮事件循环内的变化合并为一次通知
+    connect(m_game, &TetrisGame::stateChanged, this, &MainWindow::handleStateChanged);
     
     // 连接按钮信号
     connect(m_startButton, &QPushButton::clicked, this, &MainWindow::startGame);
@@ -201,6 +346,7 @@ void MainWindow::startGame()
         m_pauseButton->setText("暂停");
         m_pauseButton->setEnabled(true);
         statusBar()->showMessage("游戏继续");
+        saveCheckpoint();
     } else {
         m_game->start();
         m_startButton->setText("重新开始");
@@ -222,6 +368,7 @@ void MainWindow::pauseGame()
         m_pauseButton->setText("继续");
         statusBar()->showMessage("游戏暂停");
     }
+    saveCheckpoint();
     
     m_board->setFocus();
 }
@@ -229,6 +376,7 @@ void MainWindow::pauseGame()
 void MainWindow::resetGame()
 {
     m_game->reset();
+    m_checkpoint->clear();
     m_startButton->setText("开始游戏");
     m_pauseButton->setText("暂停");
     m_pauseButton->setEnabled(false);
@@ -237,30 +385,98 @@ void MainWindow::resetGame()
     m_board->setFocus();
 }
 
+void MainWindow::openVersus()
+{
+    // 对战窗口独立运行，打开时暂停单人游戏
+    if (m_game->isGameStarted() && !m_game->isPaused() && !m_game->isGameOver()) {
+        pauseGame();
+    }
+
+    VersusWindow *versus = new VersusWindow();
+    versus->setAttribute(Qt::WA_DeleteOnClose);
+    versus->setWindowIcon(windowIcon());
+    versus->show();
+}
+
+void MainWindow::handleStateChanged(TetrisGame::Changes changes)
+{
+    // 只更新发生变化的部分
+    if (changes & (TetrisGame::BoardChange | TetrisGame::PieceChange)) {
+        m_board->refresh();
+        // 每次变化都写入存档，崩溃或断电最多丢失一步
+        saveCheckpoint();
+    }
+    if (changes & TetrisGame::PieceChange) {
+        updatePieces(m_game->getPieceCount());
+    }
+    if (changes & TetrisGame::ScoreChange) {
+        updateScore(m_game->getScore());
+    }
+    if (changes & TetrisGame::LevelChange) {
+        updateLevel(m_game->getLevel());
+    }
+    if (changes & TetrisGame::LinesChange) {
+        updateLines(m_game->getLines());
+    }
+    if (changes & TetrisGame::GameOverChange) {
+        handleGameOver();
+    }
+}
+
 void MainWindow::updateScore(int score)
 {
-    m_scoreValue->setText(QString::number(score));
+    m_hud->setValue(HudPanel::Score, score);
 }
 
 void MainWindow::updateLevel(int level)
 {
-    m_levelValue->setText(QString::number(level));
+    m_hud->setValue(HudPanel::Level, level);
 }
 
 void MainWindow::updateLines(int lines)
 {
-    m_linesValue->setText(QString::number(lines));
+    m_hud->setValue(HudPanel::Lines, lines);
+}
+
+void MainWindow::updatePieces(int pieces)
+{
+    // 每秒方块数只在锁定时更新，不为它单独开定时器
+    const qint64 playTimeMs = m_game->getPlayTimeMs();
+    m_hud->setValue(HudPanel::Pieces, pieces);
+    m_hud->setPiecesPerSecond(playTimeMs > 0 ? pieces * 1000.0 / double(playTimeMs) : 0.0);
 }
 
 void MainWindow::handleGameOver()
 {
+    m_checkpoint->clear();
     m_pauseButton->setEnabled(false);
     statusBar()->showMessage("游戏结束");
     
+    // 记录成绩
+    QString rankText;
+    if (scores()->isOpen()) {
+        GameRecord record = {};
+        record.finishedAt = QDateTime::currentMSecsSinceEpoch();
+        record.seed = m_game->getSeed();
+        record.replayOffset = m_game->replay().isEmpty() ? -1
+                            : m_game->replay().appendToFile(scores()->replayPath());
+        record.score = m_game->getScore();
+        record.lines = m_game->getLines();
+        record.level = m_game->getLevel();
+        record.durationMs = static_cast<quint32>(m_game->getPlayTimeMs());
+        record.pieces = static_cast<quint32>(m_game->getPieceCount());
+        record.piecesPerSecond = record.durationMs > 0
+            ? float(record.pieces) * 1000.0f / float(record.durationMs) : 0.0f;
+        record.setPlayerName(playerName());
+        if (m_scores->append(record) >= 0) {
+            rankText = QString("\n排名: 第 %1 / %2").arg(m_scores->rankOf(record.score)).arg(m_scores->recordCount());
+        }
+    }
+    
     QMessageBox::StandardButton reply = QMessageBox::question(
         this,
         "游戏结束",
-        QString("游戏结束！\n最终分数: %1\n\n是否重新开始？").arg(m_game->getScore()),
+        QString("游戏结束！\n最终分数: %1%2\n\n是否重新开始？").arg(m_game->getScore()).arg(rankText),
         QMessageBox::Yes | QMessageBox::No
     );
     
@@ -268,4 +484,123 @@ void MainWindow::handleGameOver()
         resetGame();
         startGame();
     }
+}
+
+void MainWindow::saveCheckpoint()
+{
+    if (!m_game->isGameStarted() || m_game->isGameOver()) {
+        return;
+    }
+    m_checkpoint->write(m_game->saveState(), m_game->getPlayTimeMs());
+}
+
+void MainWindow::offerResume()
+{
+    CheckpointFile::Checkpoint checkpoint;
+    if (!m_checkpoint->load(checkpoint)) {
+        return;
+    }
+
+    QMessageBox::StandardButton reply = QMessageBox::question(
+        this,
+        "继续游戏",
+        QString("检测到未完成的游戏\n分数: %1  等级: %2  行数: %3\n\n是否继续？")
+            .arg(checkpoint.state.score)
+            .arg(checkpoint.state.level)
+            .arg(checkpoint.state.lines),
+        QMessageBox::Yes | QMessageBox::No
+    );
+
+    if (reply != QMessageBox::Yes) {
+        m_checkpoint->clear();
+        return;
+    }
+
+    // 恢复后处于暂停状态，由玩家按继续开始
+    m_game->restoreState(checkpoint.state, checkpoint.playTimeMs);
+    m_game->pause();
+    m_startButton->setText("重新开始");
+    m_pauseButton->setText("继续");
+    m_pauseButton->setEnabled(true);
+    statusBar()->showMessage("已恢复上次的游戏，按继续开始");
+    saveCheckpoint();
+
+    m_board->setFocus();
+}
+
+ScoreStore *MainWindow::scores()
+{
+    // 成绩记录在第一局结束或打开排行榜时才载入，不占用启动时间
+    if (!m_scores) {
+        m_scores = new ScoreStore();
+        m_scores->open(ScoreStore::defaultDirectory());
+    }
+    return m_scores;
+}
+
+QString MainWindow::playerName() const
+{
+    QSettings settings;
+    QString fallback = qEnvironmentVariable("USERNAME", qEnvironmentVariable("USER", "玩家"));
+    // 与成绩记录中保存的名字一致，统计才能按名字查到
+    return GameRecord::normalizedName(settings.value("playerName", fallback).toString());
+}
+
+void MainWindow::changePlayerName()
+{
+    bool ok = false;
+    QString name = QInputDialog::getText(this, "玩家名", "玩家名（最多16字节）:",
+                                         QLineEdit::Normal, playerName(), &ok).trimmed();
+    if (ok && !name.isEmpty()) {
+        QSettings settings;
+        settings.setValue("playerName", GameRecord::normalizedName(name));
+    }
+    m_board->setFocus();
+}
+
+void MainWindow::showLeaderboard()
+{
+    QString html = "<h3>排行榜</h3>"
+                   "<table border='1' cellpadding='4' cellspacing='0' style='width:100%'>"
+                   "<tr><td><b>名次</b></td><td><b>玩家</b></td><td><b>分数</b></td>"
+                   "<td><b>行数</b></td><td><b>等级</b></td><td><b>PPS</b></td><td><b>日期</b></td></tr>";
+
+    const QVector<GameRecord> top = scores()->topScores(10);
+    for (int i = 0; i < top.size(); ++i) {
+        const GameRecord &record = top[i];
+        html += QString("<tr><td>%1</td><td>%2</td><td>%3</td><td>%4</td><td>%5</td><td>%6</td><td>%7</td></tr>")
+                    .arg(i + 1)
+                    .arg(record.playerName().toHtmlEscaped())
+                    .arg(record.score)
+                    .arg(record.lines)
+                    .arg(record.level)
+                    .arg(record.piecesPerSecond, 0, 'f', 2)
+                    .arg(QDateTime::fromMSecsSinceEpoch(record.finishedAt).toString("yyyy-MM-dd"));
+    }
+    html += "</table>";
+
+    // 当前玩家的汇总统计
+    const QString name = playerName();
+    const ScoreStore::PlayerStats stats = scores()->playerStats(name);
+    if (stats.games > 0) {
+        const double hours = stats.totalDurationMs / 3600000.0;
+        const double pps = stats.totalDurationMs > 0 ? stats.totalPieces * 1000.0 / stats.totalDurationMs : 0.0;
+        html += QString("<h3>%1 的统计</h3><ul>"
+                        "<li>游戏局数: %2</li>"
+                        "<li>最高分: %3</li>"
+                        "<li>平均分: %4</li>"
+                        "<li>总消除行数: %5</li>"
+                        "<li>总游戏时长: %6 小时</li>"
+                        "<li>平均PPS: %7</li></ul>")
+                    .arg(name.toHtmlEscaped())
+                    .arg(stats.games)
+                    .arg(stats.bestScore)
+                    .arg(stats.totalScore / stats.games)
+                    .arg(stats.totalLines)
+                    .arg(hours, 0, 'f', 1)
+                    .arg(pps, 0, 'f', 2);
+    }
+
+    QMessageBox::information(this, "排行榜", html);
+    m_board->setFocus();
 }
\ No newline at end of file
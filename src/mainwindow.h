@@ -2,14 +2,18 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
-#include <QLabel>
 #include <QPushButton>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGroupBox>
+#include "tetrisgame.h"
 
-class TetrisGame;
 class TetrisBoard;
+class HudPanel;
+class CheckpointFile;
+class ScoreStore;
+class Telemetry;
+class SpectatorFeed;
 
 class MainWindow : public QMainWindow
 {
@@ -23,27 +27,40 @@ private slots:
     void startGame();
     void pauseGame();
     void resetGame();
+    void openVersus();
+    void openArena();
+    void openPuzzles();
+    void toggleSpectatorFeed(bool enabled);
+    void handleStateChanged(TetrisGame::Changes changes);
     void updateScore(int score);
     void updateLevel(int level);
     void updateLines(int lines);
+    void updatePieces(int pieces);
     void handleGameOver();
+    void saveCheckpoint();
+    void offerResume();
+    void showLeaderboard();
+    void changePlayerName();
+    void showAbout();
+    void showFrameStats();
 
 private:
     void setupUI();
     void createMenuBar();
     void createStatusBar();
     void connectSignals();
+    QString playerName() const;
+    ScoreStore *scores();
 
     // UI组件
     TetrisBoard *m_board;
     TetrisGame *m_game;
+    CheckpointFile *m_checkpoint;
+    ScoreStore *m_scores;
+    Telemetry *m_telemetry;
+    SpectatorFeed *m_spectatorFeed;
 
-    QLabel *m_scoreLabel;
-    QLabel *m_scoreValue;
-    QLabel *m_levelLabel;
-    QLabel *m_levelValue;
-    QLabel *m_linesLabel;
-    QLabel *m_linesValue;
+    HudPanel *m_hud;
 
     QPushButton *m_startButton;
     QPushButton *m_pauseButton;
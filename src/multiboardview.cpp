@@ -0,0 +1,215 @@
+#include "multiboardview.h"
+#include "tetrisgame.h"
+#include <QPaintEvent>
+#include <QPainter>
+
+namespace {
+
+const QColor BACKGROUND(12, 12, 18);
+const QColor EMPTY_COLOR(20, 20, 30);
+const QColor GRID_COLOR(50, 50, 70);
+const QColor LOCKED_COLOR(100, 100, 150);
+const QColor LOCKED_BORDER(150, 150, 200);
+const QColor DEAD_COLOR(60, 60, 70);
+
+// 棋盘之间的间隔
+constexpr int TILE_GAP = 4;
+
+} // namespace
+
+MultiBoardView::MultiBoardView(QWidget *parent)
+    : QWidget(parent)
+    , m_columns(1)
+    , m_cell(0)
+{
+    // 后备图像覆盖整个控件，不需要 Qt 先擦除背景
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setMinimumSize(320, 240);
+}
+
+void MultiBoardView::setEngines(std::vector<const TetrisEngine *> engines)
+{
+    m_engines = std::move(engines);
+    layoutTiles();
+}
+
+int MultiBoardView::cellSize() const
+{
+    return m_cell;
+}
+
+int MultiBoardView::refresh()
+{
+    if (m_canvas.isNull() || m_cell <= 0) return 0;
+
+    QPainter painter;
+    QRegion dirty;
+    int drawn = 0;
+    Cells cells;
+    for (std::size_t i = 0; i < m_engines.size(); ++i) {
+        composeCells(*m_engines[i], cells);
+        Cells &previous = m_drawn[i];
+        if (cells == previous) continue;
+
+        const QPoint origin = tileOrigin(int(i));
+        int left = TetrisEngine::BOARD_WIDTH, right = -1, top = TetrisEngine::BOARD_HEIGHT, bottom = -1;
+        for (int index = 0; index < int(cells.size()); ++index) {
+            if (cells[index] == previous[index]) continue;
+
+            if (!painter.isActive()) painter.begin(&m_canvas);
+            const int x = index % TetrisEngine::BOARD_WIDTH;
+            const int y = index / TetrisEngine::BOARD_WIDTH;
+            painter.drawImage(origin.x() + x * m_cell, origin.y() + y * m_cell,
+                              m_atlas, cells[index] * m_cell, 0, m_cell, m_cell);
+            left = qMin(left, x);
+            right = qMax(right, x);
+            top = qMin(top, y);
+            bottom = qMax(bottom, y);
+            ++drawn;
+        }
+        previous = cells;
+        dirty += QRect(origin.x() + left * m_cell, origin.y() + top * m_cell,
+                       (right - left + 1) * m_cell, (bottom - top + 1) * m_cell);
+    }
+
+    if (painter.isActive()) {
+        painter.end();
+        update(dirty);
+    }
+    return drawn;
+}
+
+void MultiBoardView::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    for (const QRect &rect : event->region()) {
+        painter.drawImage(rect, m_canvas, rect);
+    }
+}
+
+void MultiBoardView::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    layoutTiles();
+}
+
+void MultiBoardView::layoutTiles()
+{
+    const int count = int(m_engines.size());
+    const QSize area = size();
+    m_canvas = QImage(area, QImage::Format_RGB32);
+    m_canvas.fill(BACKGROUND);
+    m_drawn.assign(m_engines.size(), Cells());
+    for (Cells &cells : m_drawn) {
+        cells.fill(ColorUnknown);
+    }
+
+    // 选取格子最大的列数
+    m_cell = 0;
+    m_columns = 1;
+    for (int columns = 1; columns <= count; ++columns) {
+        const int rows = (count + columns - 1) / columns;
+        const int cell = qMin((area.width() - (columns + 1) * TILE_GAP) / (columns * TetrisEngine::BOARD_WIDTH),
+                              (area.height() - (rows + 1) * TILE_GAP) / (rows * TetrisEngine::BOARD_HEIGHT));
+        if (cell > m_cell) {
+            m_cell = cell;
+            m_columns = columns;
+        }
+    }
+    if (m_cell <= 0) {
+        update();
+        return;
+    }
+
+    // 整体居中
+    const int rows = (count + m_columns - 1) / m_columns;
+    m_offset = QPoint((area.width() - m_columns * (TetrisEngine::BOARD_WIDTH * m_cell + TILE_GAP) + TILE_GAP) / 2,
+                      (area.height() - rows * (TetrisEngine::BOARD_HEIGHT * m_cell + TILE_GAP) + TILE_GAP) / 2);
+
+    buildAtlas();
+
+    // 棋盘外框只在布局时画一次，格子只画上边和左边的网格线
+    if (m_cell >= DETAIL_CELL_SIZE) {
+        QPainter painter(&m_canvas);
+        painter.setPen(GRID_COLOR);
+        for (int i = 0; i < count; ++i) {
+            const QPoint origin = tileOrigin(i);
+            painter.drawRect(origin.x(), origin.y(), TetrisEngine::BOARD_WIDTH * m_cell,
+                             TetrisEngine::BOARD_HEIGHT * m_cell);
+        }
+    }
+
+    refresh();
+    update();
+}
+
+void MultiBoardView::buildAtlas()
+{
+    m_atlas = QImage(ColorCount * m_cell, m_cell, QImage::Format_RGB32);
+    QPainter painter(&m_atlas);
+    const bool detail = m_cell >= DETAIL_CELL_SIZE;
+
+    for (int color = 0; color < ColorCount; ++color) {
+        const QRect rect(color * m_cell, 0, m_cell, m_cell);
+        if (color == ColorEmpty) {
+            painter.fillRect(rect, EMPTY_COLOR);
+            if (detail) {
+                painter.setPen(GRID_COLOR);
+                painter.drawLine(rect.topLeft(), rect.topRight());
+                painter.drawLine(rect.topLeft(), rect.bottomLeft());
+            }
+        } else if (color == ColorLocked) {
+            painter.fillRect(rect, LOCKED_COLOR);
+            if (detail) {
+                painter.setPen(LOCKED_BORDER);
+                painter.drawRect(rect.adjusted(0, 0, -1, -1));
+            }
+        } else if (color == ColorDead) {
+            painter.fillRect(rect, DEAD_COLOR);
+        } else {
+            painter.fillRect(rect, TetrisGame::getTetrominoColor(Tetromino(color - ColorPiece)));
+            if (detail) {
+                // 与 BoardPainter 的方块相同的高光和阴影边
+                painter.setPen(QColor(255, 255, 255, 100));
+                painter.drawLine(rect.topLeft(), rect.topRight());
+                painter.drawLine(rect.topLeft(), rect.bottomLeft());
+                painter.setPen(QColor(0, 0, 0, 100));
+                painter.drawLine(rect.bottomRight(), rect.bottomLeft());
+                painter.drawLine(rect.bottomRight(), rect.topRight());
+            }
+        }
+    }
+}
+
+void MultiBoardView::composeCells(const TetrisEngine &engine, Cells &cells)
+{
+    // 已结束的对局整盘变暗
+    const quint8 locked = engine.isGameOver() ? ColorDead : ColorLocked;
+    for (int y = 0; y < TetrisEngine::BOARD_HEIGHT; ++y) {
+        quint8 *row = cells.data() + y * TetrisEngine::BOARD_WIDTH;
+        const quint16 mask = engine.getRowMask(y);
+        for (int x = 0; x < TetrisEngine::BOARD_WIDTH; ++x) {
+            row[x] = (mask >> x) & 1 ? locked : quint8(ColorEmpty);
+        }
+    }
+
+    if (!engine.isGameStarted() || engine.isGameOver()) return;
+
+    const Tetromino type = engine.getCurrentTetromino();
+    const quint8 color = quint8(ColorPiece + int(type));
+    for (const PieceCell &point : tetrominoCells(type, engine.getCurrentRotation())) {
+        const int x = engine.getPieceX() + point.x;
+        const int y = engine.getPieceY() + point.y;
+        if (x >= 0 && x < TetrisEngine::BOARD_WIDTH && y >= 0 && y < TetrisEngine::BOARD_HEIGHT) {
+            cells[std::size_t(y * TetrisEngine::BOARD_WIDTH + x)] = color;
+        }
+    }
+}
+
+QPoint MultiBoardView::tileOrigin(int index) const
+{
+    const int column = index % m_columns;
+    const int row = index / m_columns;
+    return m_offset + QPoint(column * (TetrisEngine::BOARD_WIDTH * m_cell + TILE_GAP),
+                             row * (TetrisEngine::BOARD_HEIGHT * m_cell + TILE_GAP));
+}
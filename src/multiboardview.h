@@ -0,0 +1,68 @@
+#ifndef MULTIBOARDVIEW_H
+#define MULTIBOARDVIEW_H
+
+#include <QImage>
+#include <QRegion>
+#include <QWidget>
+#include <array>
+#include <vector>
+#include "tetrisengine.h"
+
+// 在一个控件里平铺显示大量只读棋盘（AI 观摩）
+//
+// 不为每局创建 TetrisBoard：所有棋盘画在一张后备图像上，每个格子从
+// 按颜色预先画好的图集里贴图。refresh 时逐格比较上次画出的颜色，只重画
+// 变化的格子，并只请求重绘这些格子所在的区域；没有变化的棋盘不产生任何绘制。
+// 格子小于 DETAIL_CELL_SIZE 时图集改为纯色块，不画网格和高光。
+class MultiBoardView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DETAIL_CELL_SIZE = 8;
+
+    explicit MultiBoardView(QWidget *parent = nullptr);
+
+    // 要显示的引擎，由调用方持有，在下次 setEngines 之前保持有效
+    void setEngines(std::vector<const TetrisEngine *> engines);
+
+    // 按引擎当前状态更新后备图像，返回本次重画的格子数
+    int refresh();
+
+    int cellSize() const;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    // 图集中的颜色序号：空格、七种方块、已放置、已结束
+    enum CellColor : quint8 {
+        ColorEmpty = 0,
+        ColorPiece = 1,
+        ColorLocked = ColorPiece + 7,
+        ColorDead,
+        ColorCount,
+        // 尚未画过，布局变化后强制重画
+        ColorUnknown = 0xFF
+    };
+
+    using Cells = std::array<quint8, TetrisEngine::BOARD_WIDTH * TetrisEngine::BOARD_HEIGHT>;
+
+    void layoutTiles();
+    void buildAtlas();
+    static void composeCells(const TetrisEngine &engine, Cells &cells);
+    QPoint tileOrigin(int index) const;
+
+    std::vector<const TetrisEngine *> m_engines;
+    // 每块棋盘上次画出的颜色
+    std::vector<Cells> m_drawn;
+
+    QImage m_canvas;
+    QImage m_atlas;
+    int m_columns;
+    int m_cell;
+    QPoint m_offset;
+};
+
+#endif // MULTIBOARDVIEW_H
@@ -0,0 +1,270 @@
+#include "puzzle.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+
+namespace {
+
+constexpr int WIDTH = TetrisEngine::BOARD_WIDTH;
+constexpr int HEIGHT = TetrisEngine::BOARD_HEIGHT;
+
+// 方块位置的编号范围：包围盒左上角 x 在 [-3, WIDTH)，出生时 y 可能为负
+constexpr int POSITION_OFFSET = 4;
+constexpr int POSITION_SPAN_X = WIDTH + POSITION_OFFSET;
+constexpr int POSITION_SPAN_Y = HEIGHT + POSITION_OFFSET;
+constexpr int POSITION_COUNT = ROTATION_COUNT * POSITION_SPAN_Y * POSITION_SPAN_X;
+
+std::uint64_t fnv1a(std::uint64_t hash, std::uint64_t value)
+{
+    for (int i = 0; i < 8; ++i) {
+        hash ^= (value >> (i * 8)) & 0xff;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// 锁定结果：棋盘、累计消行和规则标志，决定之后的全部走法
+std::uint64_t outcomeKey(const TetrisEngineBase &engine)
+{
+    std::uint64_t hash = 1469598103934665603ull;
+    for (int y = 0; y < HEIGHT; y += 4) {
+        hash = fnv1a(hash, std::uint64_t(engine.getRowMask(y)) | std::uint64_t(engine.getRowMask(y + 1)) << 16
+                               | std::uint64_t(engine.getRowMask(y + 2)) << 32
+                               | std::uint64_t(engine.getRowMask(y + 3)) << 48);
+    }
+    return fnv1a(hash, std::uint64_t(engine.getLines()) | std::uint64_t(engine.isBackToBack()) << 32
+                           | std::uint64_t(engine.getPieceCount()) << 40);
+}
+
+bool isBoardEmpty(const TetrisEngineBase &engine)
+{
+    for (int y = 0; y < HEIGHT; ++y) {
+        if (engine.getRowMask(y)) return false;
+    }
+    return true;
+}
+
+// 剩下的方块是否还有可能完成目标，只做简单的必要条件检查，用于剪枝
+bool canStillSolve(const Puzzle &puzzle, const TetrisEngineBase &engine)
+{
+    const int placed = engine.getPieceCount();
+    const int remaining = puzzle.pieceCount - placed;
+    switch (puzzle.tag) {
+    case PuzzleTag::TSpin:
+        // 之后还要有 T
+        for (int i = placed; i < puzzle.pieceCount; ++i) {
+            if (puzzle.pieces[i] == Tetromino::T) return true;
+        }
+        return false;
+    case PuzzleTag::Dig: {
+        // 还要消的行里空格最少的那几行也要能用剩下的方块填满
+        const int needed = puzzle.goalLines - engine.getLines();
+        if (needed <= 0) return true;
+        std::array<int, HEIGHT> empty;
+        for (int y = 0; y < HEIGHT; ++y) {
+            empty[y] = WIDTH - std::popcount(unsigned(engine.getRowMask(y)));
+        }
+        std::partial_sort(empty.begin(), empty.begin() + needed, empty.end());
+        int cells = 0;
+        for (int i = 0; i < needed; ++i) {
+            cells += empty[i];
+        }
+        return cells <= remaining * 4;
+    }
+    case PuzzleTag::PerfectClear:
+        // 不能堆出目标行数之外
+        return engine.getRowMask(HEIGHT - puzzle.goalLines - 1) == 0;
+    }
+    return true;
+}
+
+} // namespace
+
+bool isValidPuzzle(const Puzzle &puzzle)
+{
+    if (static_cast<int>(puzzle.tag) >= PUZZLE_TAG_COUNT
+        || puzzle.pieceCount < 1 || puzzle.pieceCount > Puzzle::MAX_PIECES
+        || puzzle.difficulty < 1 || puzzle.difficulty > PUZZLE_MAX_DIFFICULTY
+        || puzzle.goalLines < 1 || puzzle.goalLines > HEIGHT) {
+        return false;
+    }
+    for (int i = 0; i < puzzle.pieceCount; ++i) {
+        if (static_cast<int>(puzzle.pieces[i]) >= TETROMINO_COUNT) return false;
+    }
+    // 不能有已经满的行
+    for (std::uint16_t row : puzzle.rows) {
+        if ((row & ~TetrisEngine::FULL_ROW) || row == TetrisEngine::FULL_ROW) return false;
+    }
+    return true;
+}
+
+void setupPuzzle(TetrisEngineBase &engine, const Puzzle &puzzle)
+{
+    // 出块在引擎内部进行：先把序列放进预览队列，再由 start() 取出第一个方块
+    engine.reset(puzzle.id);
+    TetrisEngineBase::State state = engine.saveState();
+    state.rows = puzzle.rows;
+    for (int i = 0; i < TetrisEngine::QUEUE_SIZE && i < puzzle.pieceCount; ++i) {
+        state.queue[i] = puzzle.pieces[i];
+    }
+    engine.restoreState(state);
+    engine.start();
+
+    // 开局时队列前移了一位，补上最后一个
+    if (puzzle.pieceCount > TetrisEngine::QUEUE_SIZE) {
+        state = engine.saveState();
+        state.queue[TetrisEngine::QUEUE_SIZE - 1] = puzzle.pieces[TetrisEngine::QUEUE_SIZE];
+        engine.restoreState(state);
+    }
+}
+
+PuzzleStatus puzzleStatus(const Puzzle &puzzle, const TetrisEngineBase &before, const TetrisEngineBase &after)
+{
+    const int cleared = after.getLines() - before.getLines();
+    bool solved = false;
+    switch (puzzle.tag) {
+    case PuzzleTag::TSpin:
+        // 指南规则下只有四消和 T-spin 消行会设置背靠背
+        solved = cleared >= puzzle.goalLines && cleared < 4 && after.isBackToBack();
+        break;
+    case PuzzleTag::Dig:
+        solved = after.getLines() >= puzzle.goalLines;
+        break;
+    case PuzzleTag::PerfectClear:
+        solved = cleared > 0 && isBoardEmpty(after);
+        break;
+    }
+
+    if (solved) return PuzzleStatus::Solved;
+    if (after.isGameOver() || after.getPieceCount() >= puzzle.pieceCount) return PuzzleStatus::Failed;
+    return PuzzleStatus::Playing;
+}
+
+PuzzleSolver::PuzzleSolver()
+    : m_puzzle(nullptr)
+    , m_nodes(0)
+    , m_nodeLimit(0)
+    , m_aborted(false)
+{
+}
+
+PuzzleSolver::Result PuzzleSolver::solve(const Puzzle &puzzle, std::uint64_t nodeLimit)
+{
+    m_puzzle = &puzzle;
+    m_nodes = 0;
+    m_nodeLimit = nodeLimit;
+    m_aborted = false;
+    m_failed.clear();
+
+    PuzzleEngine engine;
+    setupPuzzle(engine, puzzle);
+    const bool solved = !engine.isGameOver() && search(engine, 0);
+    m_puzzle = nullptr;
+    return {solved, !solved && !m_aborted, m_nodes};
+}
+
+void PuzzleSolver::lockedPlacements(const PuzzleEngine &engine, std::vector<PuzzleEngine> &out)
+{
+    out.clear();
+    if (engine.isGameOver() || !engine.isGameStarted()) return;
+
+    const Tetromino type = engine.getCurrentTetromino();
+    // 只有 T 方块需要区分最后一步是否为旋转
+    const bool spins = type == Tetromino::T;
+
+    std::vector<bool> visited(std::size_t(POSITION_COUNT) * 2);
+    std::vector<std::uint64_t> outcomes;
+    std::vector<PuzzleEngine> frontier;
+    frontier.reserve(64);
+
+    auto visit = [&](const PuzzleEngine &next) {
+        const int index = (int(next.getCurrentRotation()) * POSITION_SPAN_Y + next.getPieceY() + POSITION_OFFSET)
+                        * POSITION_SPAN_X + next.getPieceX() + POSITION_OFFSET;
+        const bool rotated = spins && (next.saveState().ruleFlags & TetrisEngineBase::LastMoveRotate);
+        const std::size_t slot = std::size_t(index) * 2 + (rotated ? 1 : 0);
+        if (visited[slot]) return;
+        visited[slot] = true;
+        frontier.push_back(next);
+    };
+
+    visit(engine);
+    while (!frontier.empty()) {
+        const PuzzleEngine current = frontier.back();
+        frontier.pop_back();
+
+        const int x = current.getPieceX();
+        const int y = current.getPieceY();
+        const Rotation rotation = current.getCurrentRotation();
+
+        if (current.checkCollision(type, rotation, x, y + 1)) {
+            // 已经着地：原地硬降不移动方块，保留最后一步是旋转的标志
+            PuzzleEngine locked = current;
+            locked.hardDrop();
+            const std::uint64_t key = outcomeKey(locked);
+            if (std::find(outcomes.begin(), outcomes.end(), key) == outcomes.end()) {
+                outcomes.push_back(key);
+                out.push_back(locked);
+            }
+        } else {
+            PuzzleEngine next = current;
+            next.moveDown();
+            visit(next);
+        }
+
+        PuzzleEngine next = current;
+        if (next.moveLeft()) visit(next);
+        next = current;
+        if (next.moveRight()) visit(next);
+        for (RotationDirection direction : {RotationDirection::Clockwise, RotationDirection::CounterClockwise,
+                                            RotationDirection::Half}) {
+            next = current;
+            if (next.rotate(direction)) visit(next);
+        }
+    }
+}
+
+int PuzzleSolver::difficultyFor(std::uint64_t nodes)
+{
+    // 展开的局面数大约每增加到 3 倍难度加一，默认节点上限附近为最高难度
+    const int level = 1 + (int(std::bit_width(std::max<std::uint64_t>(nodes, 1))) - 1) * 2 / 3;
+    return std::clamp(level, 1, PUZZLE_MAX_DIFFICULTY);
+}
+
+std::uint64_t PuzzleSolver::positionKey(const TetrisEngineBase &engine)
+{
+    return outcomeKey(engine);
+}
+
+bool PuzzleSolver::search(const PuzzleEngine &engine, int depth)
+{
+    if (++m_nodes > m_nodeLimit) {
+        m_aborted = true;
+        return false;
+    }
+    const std::uint64_t key = positionKey(engine);
+    if (m_failed.count(key)) return false;
+
+    Level &level = m_levels[depth];
+    lockedPlacements(engine, level.placements);
+    level.order.clear();
+    for (int i = 0; i < int(level.placements.size()); ++i) {
+        level.order.push_back({m_bot.evaluate(engine, level.placements[i]), i});
+    }
+    std::sort(level.order.begin(), level.order.end(), [](const auto &a, const auto &b) {
+        return a.first > b.first;
+    });
+
+    for (const auto &[score, index] : level.order) {
+        const PuzzleEngine &after = level.placements[index];
+        const PuzzleStatus status = puzzleStatus(*m_puzzle, engine, after);
+        if (status == PuzzleStatus::Solved) return true;
+        if (status == PuzzleStatus::Failed) continue;
+        if (!canStillSolve(*m_puzzle, after)) continue;
+
+        if (search(after, depth + 1)) return true;
+        if (m_aborted) return false;
+    }
+
+    m_failed.insert(key);
+    return false;
+}
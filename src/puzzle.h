@@ -0,0 +1,112 @@
+#ifndef PUZZLE_H
+#define PUZZLE_H
+
+#include "bot.h"
+#include "tetrisengine.h"
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// 谜题与训练场景：给定棋盘和方块序列，在序列用完之前达成目标
+//
+// 谜题按指南规则进行（需要 T-spin 判定），没有重力，方块只在玩家落下时锁定。
+// 不依赖 Qt，界面、谜题库和生成工具共用。
+
+enum class PuzzleTag : std::uint8_t {
+    TSpin,          // 用 T-spin 一次消除至少 goalLines 行
+    Dig,            // 累计消除至少 goalLines 行（挖开底部的垃圾行）
+    PerfectClear    // 清空棋盘，goalLines 为参与全消的行数
+};
+
+constexpr int PUZZLE_TAG_COUNT = 3;
+
+// 难度 1..MAX_DIFFICULTY，由生成工具按求解难度给出
+constexpr int PUZZLE_MAX_DIFFICULTY = 10;
+
+using PuzzleEngine = BasicTetrisEngine<GuidelineRules>;
+
+// 一道谜题，定长64字节，按原样存入谜题库
+struct Puzzle {
+    // 当前方块加预览队列，全部可见
+    static constexpr int MAX_PIECES = 1 + TetrisEngine::QUEUE_SIZE;
+
+    std::array<std::uint16_t, TetrisEngine::BOARD_HEIGHT> rows;
+    std::uint32_t id;
+    std::array<Tetromino, MAX_PIECES> pieces;
+    PuzzleTag tag;
+    std::uint8_t difficulty;
+    std::uint8_t pieceCount;
+    std::uint8_t goalLines;
+    std::uint8_t reserved[10];
+};
+
+static_assert(sizeof(Puzzle) == 64);
+static_assert(std::is_trivially_copyable_v<Puzzle>);
+
+enum class PuzzleStatus : std::uint8_t {
+    Playing,
+    Solved,
+    Failed
+};
+
+// 检查来自外部（谜题库文件）的谜题是否自洽
+bool isValidPuzzle(const Puzzle &puzzle);
+
+// 把引擎设置为谜题的开局：棋盘、当前方块和预览队列，不计分、不计方块数
+void setupPuzzle(TetrisEngineBase &engine, const Puzzle &puzzle);
+
+// 每锁定一个方块后判断结果；before 为这次锁定之前的引擎
+PuzzleStatus puzzleStatus(const Puzzle &puzzle, const TetrisEngineBase &before, const TetrisEngineBase &after);
+
+// 谜题求解：在引擎副本上深度优先搜索，证明谜题在给定序列内可以完成
+//
+// 每个方块的落点包括移动、旋转和软降能到达的全部锁定位置（可以塞进悬空的
+// 缝隙，也可以旋转进入 T-spin 位置），落点按内置 AI 的评分从高到低尝试，
+// 已经证明走不通的局面记录下来不再展开。超出节点上限时放弃，结果记为未解出。
+// 一个求解器对象只在一个线程中使用。
+class PuzzleSolver
+{
+public:
+    static constexpr std::uint64_t DEFAULT_NODE_LIMIT = 20000;
+
+    PuzzleSolver();
+
+    struct Result {
+        bool solved;
+        bool exhausted;         // 搜索完整个空间仍无解（没有超出节点上限）
+        std::uint64_t nodes;    // 找到解或放弃时展开的局面数
+    };
+
+    Result solve(const Puzzle &puzzle, std::uint64_t nodeLimit = DEFAULT_NODE_LIMIT);
+
+    // 当前方块全部可达落点锁定之后的引擎；锁定结果（棋盘、消行数、背靠背）
+    // 相同的落点只保留一个；同一位置的 T-spin 和普通放置结果不同，分别保留
+    static void lockedPlacements(const PuzzleEngine &engine, std::vector<PuzzleEngine> &out);
+
+    // 按求解时展开的局面数给出难度
+    static int difficultyFor(std::uint64_t nodes);
+
+private:
+    bool search(const PuzzleEngine &engine, int depth);
+    static std::uint64_t positionKey(const TetrisEngineBase &engine);
+
+    const Puzzle *m_puzzle;
+    Bot m_bot;
+    std::uint64_t m_nodes;
+    std::uint64_t m_nodeLimit;
+    bool m_aborted;
+    // 已证明无解的局面
+    std::unordered_set<std::uint64_t> m_failed;
+
+    // 每层复用的落点缓冲和尝试顺序
+    struct Level {
+        std::vector<PuzzleEngine> placements;
+        std::vector<std::pair<float, int>> order;
+    };
+    std::array<Level, Puzzle::MAX_PIECES> m_levels;
+};
+
+#endif // PUZZLE_H
@@ -0,0 +1,185 @@
+#include "puzzledatabase.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr char MAGIC[4] = {'T', 'P', 'Z', 'L'};
+constexpr quint32 VERSION = 1;
+
+struct Header {
+    char magic[4];
+    quint32 version;
+    quint32 puzzleSize;
+    quint32 count;
+};
+
+static_assert(sizeof(Header) == 16);
+
+} // namespace
+
+PuzzleDatabase::PuzzleDatabase()
+    : m_map(nullptr)
+    , m_puzzles(nullptr)
+    , m_index(nullptr)
+    , m_count(0)
+{
+    static_assert(sizeof(IndexEntry) == 8);
+}
+
+PuzzleDatabase::~PuzzleDatabase()
+{
+    close();
+}
+
+bool PuzzleDatabase::open(const QString &path)
+{
+    close();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly) || m_file.size() < qint64(sizeof(Header))) {
+        m_file.close();
+        return false;
+    }
+
+    m_map = m_file.map(0, m_file.size());
+    if (!m_map) {
+        m_file.close();
+        return false;
+    }
+
+    const auto *header = reinterpret_cast<const Header *>(m_map);
+    const qint64 expectedSize = sizeof(Header) + qint64(header->count) * (sizeof(Puzzle) + sizeof(IndexEntry));
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0
+        || header->version != VERSION
+        || header->puzzleSize != sizeof(Puzzle)
+        || expectedSize != m_file.size()) {
+        close();
+        return false;
+    }
+
+    // 记录不在这里逐条检查：打开大文件不必读遍整个映射，记录在 puzzle() 和 find() 交出时检查
+    const auto *puzzles = reinterpret_cast<const Puzzle *>(m_map + sizeof(Header));
+    const auto *index = reinterpret_cast<const IndexEntry *>(puzzles + header->count);
+
+    m_puzzles = puzzles;
+    m_index = index;
+    m_count = int(header->count);
+    return true;
+}
+
+void PuzzleDatabase::close()
+{
+    if (m_map) {
+        m_file.unmap(m_map);
+        m_map = nullptr;
+    }
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+    m_puzzles = nullptr;
+    m_index = nullptr;
+    m_count = 0;
+}
+
+bool PuzzleDatabase::isOpen() const
+{
+    return m_map != nullptr;
+}
+
+int PuzzleDatabase::count() const
+{
+    return m_count;
+}
+
+const Puzzle *PuzzleDatabase::puzzle(int index) const
+{
+    if (index < 0 || index >= m_count || !isValidPuzzle(m_puzzles[index])) return nullptr;
+    return &m_puzzles[index];
+}
+
+int PuzzleDatabase::countMatching(PuzzleTag tag, int minDifficulty, int maxDifficulty) const
+{
+    const auto [first, last] = range(tag, minDifficulty, maxDifficulty);
+    return int(last - first);
+}
+
+int PuzzleDatabase::find(PuzzleTag tag, int minDifficulty, int maxDifficulty, int n) const
+{
+    const auto [first, last] = range(tag, minDifficulty, maxDifficulty);
+    if (n < 0 || n >= last - first) return -1;
+    const IndexEntry &entry = first[n];
+    const Puzzle *record = puzzle(int(entry.record));
+    if (!record || record->tag != entry.tag || record->difficulty != entry.difficulty) return -1;
+    return int(entry.record);
+}
+
+bool PuzzleDatabase::validate() const
+{
+    for (int i = 0; i < m_count; ++i) {
+        if (!puzzle(i)
+            || m_index[i].record >= std::uint32_t(m_count)
+            || (i > 0 && !entryBefore(m_index[i - 1], m_index[i]))
+            || m_puzzles[m_index[i].record].tag != m_index[i].tag
+            || m_puzzles[m_index[i].record].difficulty != m_index[i].difficulty) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PuzzleDatabase::write(const QString &path, const std::vector<Puzzle> &puzzles)
+{
+    std::vector<IndexEntry> index;
+    index.reserve(puzzles.size());
+    for (std::size_t i = 0; i < puzzles.size(); ++i) {
+        index.push_back({puzzles[i].tag, puzzles[i].difficulty, 0, static_cast<std::uint32_t>(i)});
+    }
+    std::sort(index.begin(), index.end(), entryBefore);
+
+    Header header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.puzzleSize = sizeof(Puzzle);
+    header.count = static_cast<quint32>(puzzles.size());
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(puzzles.data()), qint64(puzzles.size() * sizeof(Puzzle)));
+    file.write(reinterpret_cast<const char *>(index.data()), qint64(index.size() * sizeof(IndexEntry)));
+    return file.commit();
+}
+
+QString PuzzleDatabase::defaultPath()
+{
+    const QString name = QStringLiteral("puzzles.db");
+    const QString local = QDir(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)).filePath(name);
+    if (QFileInfo::exists(local)) return local;
+    return QDir(QCoreApplication::applicationDirPath()).filePath(name);
+}
+
+bool PuzzleDatabase::entryBefore(const IndexEntry &a, const IndexEntry &b)
+{
+    if (a.tag != b.tag) return a.tag < b.tag;
+    if (a.difficulty != b.difficulty) return a.difficulty < b.difficulty;
+    return a.record < b.record;
+}
+
+std::pair<const PuzzleDatabase::IndexEntry *, const PuzzleDatabase::IndexEntry *>
+PuzzleDatabase::range(PuzzleTag tag, int minDifficulty, int maxDifficulty) const
+{
+    if (!m_index || minDifficulty > maxDifficulty) return {m_index, m_index};
+
+    // 记录号取两端的极值，得到 [最低难度的第一道, 最高难度的最后一道]
+    const IndexEntry low = {tag, static_cast<std::uint8_t>(std::clamp(minDifficulty, 0, 255)), 0, 0};
+    const IndexEntry high = {tag, static_cast<std::uint8_t>(std::clamp(maxDifficulty, 0, 255)), 0, UINT32_MAX};
+    const IndexEntry *first = std::lower_bound(m_index, m_index + m_count, low, entryBefore);
+    const IndexEntry *last = std::upper_bound(first, m_index + m_count, high, entryBefore);
+    return {first, last};
+}
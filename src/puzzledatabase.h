@@ -0,0 +1,62 @@
+#ifndef PUZZLEDATABASE_H
+#define PUZZLEDATABASE_H
+
+#include <QFile>
+#include <QString>
+#include <vector>
+#include "puzzle.h"
+
+// 谜题库
+//
+// puzzles.db 由 tetris-puzzlegen 生成：文件头之后是定长的 Puzzle 记录（棋盘为
+// 每行一个 u16 掩码），再之后是按 (标签, 难度, 记录号) 排序的索引。整个文件通过
+// 内存映射打开，不需要解析；按标签和难度范围选题只是在索引上做一次二分查找。
+// 打开时只检查文件头和长度，记录在交出时逐条检查；完整检查见 validate()。
+class PuzzleDatabase
+{
+public:
+    PuzzleDatabase();
+    ~PuzzleDatabase();
+
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const;
+
+    int count() const;
+    // 记录号越界或记录无效时返回 nullptr
+    const Puzzle *puzzle(int index) const;
+
+    // 标签为 tag、难度在 [minDifficulty, maxDifficulty] 内的谜题数
+    int countMatching(PuzzleTag tag, int minDifficulty, int maxDifficulty) const;
+    // 其中按难度、记录号排列的第 n 道，返回记录号；超出范围或索引项指向无效记录返回 -1
+    int find(PuzzleTag tag, int minDifficulty, int maxDifficulty, int n) const;
+
+    // 检查全部记录和索引（有序、记录号不越界、标签和难度与记录一致），供 tetris-puzzlegen --verify 使用
+    bool validate() const;
+
+    // 写出谜题库，索引在写出时排序
+    static bool write(const QString &path, const std::vector<Puzzle> &puzzles);
+
+    // 先找用户数据目录，再找程序所在目录
+    static QString defaultPath();
+
+private:
+    struct IndexEntry {
+        PuzzleTag tag;
+        std::uint8_t difficulty;
+        std::uint16_t reserved;
+        std::uint32_t record;
+    };
+
+    static bool entryBefore(const IndexEntry &a, const IndexEntry &b);
+    std::pair<const IndexEntry *, const IndexEntry *> range(PuzzleTag tag, int minDifficulty,
+                                                            int maxDifficulty) const;
+
+    QFile m_file;
+    uchar *m_map;
+    const Puzzle *m_puzzles;
+    const IndexEntry *m_index;
+    int m_count;
+};
+
+#endif // PUZZLEDATABASE_H
@@ -0,0 +1,251 @@
+#include "puzzlewindow.h"
+#include "theme.h"
+#include "tetrisboard.h"
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+
+namespace {
+
+constexpr char PIECE_NAMES[TETROMINO_COUNT + 1] = "IOTSZJL";
+
+QString goalText(const Puzzle &puzzle)
+{
+    switch (puzzle.tag) {
+    case PuzzleTag::TSpin:
+        return QString("用 T-spin 一次消除 %1 行").arg(puzzle.goalLines);
+    case PuzzleTag::Dig:
+        return QString("消除 %1 行").arg(puzzle.goalLines);
+    case PuzzleTag::PerfectClear:
+        return QString("清空棋盘（%1 行全消）").arg(puzzle.goalLines);
+    }
+    return QString();
+}
+
+} // namespace
+
+PuzzleWindow::PuzzleWindow(QWidget *parent)
+    : QWidget(parent)
+    , m_tag(PuzzleTag::TSpin)
+    , m_minDifficulty(1)
+    , m_matching(0)
+    , m_position(-1)
+    , m_record(-1)
+    , m_status(PuzzleStatus::Failed)
+{
+    setupUI();
+    setFocusPolicy(Qt::StrongFocus);
+
+    setWindowTitle("俄罗斯方块 - 谜题");
+    resize(520, 760);
+
+    m_database.open(PuzzleDatabase::defaultPath());
+    selectionChanged();
+}
+
+PuzzleWindow::~PuzzleWindow()
+{
+}
+
+void PuzzleWindow::setupUI()
+{
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    QHBoxLayout *controls = new QHBoxLayout();
+
+    m_tagBox = new QComboBox(this);
+    m_tagBox->addItem("T-spin 练习", int(PuzzleTag::TSpin));
+    m_tagBox->addItem("挖掘", int(PuzzleTag::Dig));
+    m_tagBox->addItem("全消", int(PuzzleTag::PerfectClear));
+    connect(m_tagBox, &QComboBox::currentIndexChanged, this, &PuzzleWindow::selectionChanged);
+
+    m_difficultyBox = new QSpinBox(this);
+    m_difficultyBox->setRange(1, PUZZLE_MAX_DIFFICULTY);
+    connect(m_difficultyBox, &QSpinBox::valueChanged, this, &PuzzleWindow::selectionChanged);
+
+    // 按钮不抢焦点，方向键和空格始终用于操作方块
+    m_retryButton = new QPushButton("重来", this);
+    m_retryButton->setFocusPolicy(Qt::NoFocus);
+    connect(m_retryButton, &QPushButton::clicked, this, &PuzzleWindow::retryPuzzle);
+
+    m_nextButton = new QPushButton("下一题", this);
+    m_nextButton->setFocusPolicy(Qt::NoFocus);
+    connect(m_nextButton, &QPushButton::clicked, this, &PuzzleWindow::nextPuzzle);
+
+    QLabel *tagLabel = new QLabel("类型:", this);
+    QLabel *difficultyLabel = new QLabel("最低难度:", this);
+    controls->addWidget(tagLabel);
+    controls->addWidget(m_tagBox);
+    controls->addSpacing(20);
+    controls->addWidget(difficultyLabel);
+    controls->addWidget(m_difficultyBox);
+    controls->addStretch(1);
+    controls->addWidget(m_retryButton);
+    controls->addWidget(m_nextButton);
+
+    m_goalLabel = new QLabel(this);
+    Theme::setLabelStyle(m_goalLabel, 16, true, Theme::TEXT);
+
+    // 只显示，按键由窗口处理
+    m_board = new TetrisBoard(nullptr, this);
+    m_board->setFocusPolicy(Qt::NoFocus);
+    m_board->setEngine(&m_display);
+
+    m_statusLabel = new QLabel(this);
+    Theme::setLabelStyle(m_statusLabel, 14, false, Theme::SECONDARY_TEXT);
+
+    mainLayout->addLayout(controls);
+    mainLayout->addWidget(m_goalLabel);
+    mainLayout->addWidget(m_board, 1);
+    mainLayout->addWidget(m_statusLabel);
+}
+
+void PuzzleWindow::selectionChanged()
+{
+    m_tag = static_cast<PuzzleTag>(m_tagBox->currentData().toInt());
+    m_minDifficulty = m_difficultyBox->value();
+    m_matching = m_database.countMatching(m_tag, m_minDifficulty, PUZZLE_MAX_DIFFICULTY);
+    loadPuzzle(0);
+    setFocus();
+}
+
+void PuzzleWindow::nextPuzzle()
+{
+    if (m_matching > 0) {
+        loadPuzzle((m_position + 1) % m_matching);
+    }
+    setFocus();
+}
+
+void PuzzleWindow::retryPuzzle()
+{
+    loadPuzzle(m_position);
+    setFocus();
+}
+
+void PuzzleWindow::loadPuzzle(int n)
+{
+    m_position = n;
+    m_record = m_database.find(m_tag, m_minDifficulty, PUZZLE_MAX_DIFFICULTY, n);
+    if (m_record < 0) {
+        m_engine.reset(0);
+        m_status = PuzzleStatus::Failed;
+    } else {
+        setupPuzzle(m_engine, *m_database.puzzle(m_record));
+        m_status = PuzzleStatus::Playing;
+    }
+    m_retryButton->setEnabled(m_record >= 0);
+    m_nextButton->setEnabled(m_matching > 1);
+    updateDisplay();
+}
+
+void PuzzleWindow::keyPressEvent(QKeyEvent *event)
+{
+    if (m_status != PuzzleStatus::Playing) {
+        // 结束后空格进入下一题，R 重来
+        if (event->key() == Qt::Key_Space && m_status == PuzzleStatus::Solved) {
+            nextPuzzle();
+        } else if (event->key() == Qt::Key_R && m_record >= 0) {
+            retryPuzzle();
+        } else {
+            QWidget::keyPressEvent(event);
+        }
+        return;
+    }
+
+    switch (event->key()) {
+        case Qt::Key_Left:
+        case Qt::Key_H:
+            play([](PuzzleEngine &engine) { engine.moveLeft(); });
+            break;
+        case Qt::Key_Right:
+        case Qt::Key_L:
+            play([](PuzzleEngine &engine) { engine.moveRight(); });
+            break;
+        case Qt::Key_Down:
+        case Qt::Key_J:
+            // 没有重力，软降到底不锁定，留出旋转进缝的机会
+            play([](PuzzleEngine &engine) {
+                if (!engine.checkCollision(engine.getCurrentTetromino(), engine.getCurrentRotation(),
+                                           engine.getPieceX(), engine.getPieceY() + 1)) {
+                    engine.moveDown();
+                }
+            });
+            break;
+        case Qt::Key_Up:
+        case Qt::Key_K:
+            play([](PuzzleEngine &engine) { engine.rotate(RotationDirection::Clockwise); });
+            break;
+        case Qt::Key_Z:
+            play([](PuzzleEngine &engine) { engine.rotate(RotationDirection::CounterClockwise); });
+            break;
+        case Qt::Key_A:
+            play([](PuzzleEngine &engine) { engine.rotate(RotationDirection::Half); });
+            break;
+        case Qt::Key_Space:
+            play([](PuzzleEngine &engine) { engine.hardDrop(); });
+            break;
+        case Qt::Key_R:
+            retryPuzzle();
+            break;
+        default:
+            QWidget::keyPressEvent(event);
+            break;
+    }
+}
+
+template <typename Action>
+void PuzzleWindow::play(Action action)
+{
+    const PuzzleEngine before = m_engine;
+    action(m_engine);
+    if (m_engine.getPieceCount() != before.getPieceCount() || m_engine.isGameOver()) {
+        m_status = puzzleStatus(*m_database.puzzle(m_record), before, m_engine);
+    }
+    updateDisplay();
+}
+
+void PuzzleWindow::updateDisplay()
+{
+    m_display.restoreState(m_engine.saveState());
+    m_board->refresh();
+    updateStatus();
+}
+
+void PuzzleWindow::updateStatus()
+{
+    if (!m_database.isOpen()) {
+        m_goalLabel->setText("没有找到谜题库");
+        m_statusLabel->setText(QString("用 tetris-puzzlegen 生成 puzzles.db，放到 %1")
+                                   .arg(PuzzleDatabase::defaultPath()));
+        return;
+    }
+    if (m_record < 0) {
+        m_goalLabel->setText("没有符合条件的谜题");
+        m_statusLabel->setText(QString("谜题库共 %1 道").arg(m_database.count()));
+        return;
+    }
+
+    const Puzzle &puzzle = *m_database.puzzle(m_record);
+    m_goalLabel->setText(QString("第 %1/%2 题  难度 %3  %4")
+                             .arg(m_position + 1)
+                             .arg(m_matching)
+                             .arg(puzzle.difficulty)
+                             .arg(goalText(puzzle)));
+
+    switch (m_status) {
+    case PuzzleStatus::Solved:
+        m_statusLabel->setText("完成！空格进入下一题");
+        break;
+    case PuzzleStatus::Failed:
+        m_statusLabel->setText("未完成，按 R 重来");
+        break;
+    case PuzzleStatus::Playing: {
+        QString pieces;
+        for (int i = m_engine.getPieceCount(); i < puzzle.pieceCount; ++i) {
+            pieces += QLatin1Char(PIECE_NAMES[int(puzzle.pieces[i])]);
+            pieces += QLatin1Char(' ');
+        }
+        m_statusLabel->setText(QString("剩余方块: %1").arg(pieces.trimmed()));
+        break;
+    }
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef PUZZLEWINDOW_H
+#define PUZZLEWINDOW_H
+
+#include <QComboBox>
+#include <QKeyEvent>
+#include <QLabel>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QWidget>
+#include "puzzle.h"
+#include "puzzledatabase.h"
+
+class TetrisBoard;
+
+// 谜题窗口：从谜题库按类型和难度选题，在给定棋盘和序列上完成目标
+//
+// 谜题按指南规则在 PuzzleEngine 上进行，没有重力，方块只在硬降或软降到底后
+// 锁定；每一步之后把状态复制到 m_display，由 TetrisBoard 显示。
+class PuzzleWindow : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit PuzzleWindow(QWidget *parent = nullptr);
+    ~PuzzleWindow();
+
+protected:
+    void keyPressEvent(QKeyEvent *event) override;
+
+private slots:
+    void selectionChanged();
+    void nextPuzzle();
+    void retryPuzzle();
+
+private:
+    void setupUI();
+    void loadPuzzle(int n);
+    // 执行一步操作，方块锁定时判定结果
+    template <typename Action>
+    void play(Action action);
+    void updateDisplay();
+    void updateStatus();
+
+    PuzzleDatabase m_database;
+    PuzzleTag m_tag;
+    int m_minDifficulty;
+    int m_matching;
+    // 当前谜题在筛选结果中的序号和记录号
+    int m_position;
+    int m_record;
+
+    PuzzleEngine m_engine;
+    PuzzleStatus m_status;
+    TetrisEngine m_display;
+
+    QComboBox *m_tagBox;
+    QSpinBox *m_difficultyBox;
+    QPushButton *m_retryButton;
+    QPushButton *m_nextButton;
+    QLabel *m_goalLabel;
+    TetrisBoard *m_board;
+    QLabel *m_statusLabel;
+};
+
+#endif // PUZZLEWINDOW_H
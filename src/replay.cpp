@@ -0,0 +1,412 @@
+#include "replay.h"
+#include "rotationsystem.h"
+#include <QFile>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+constexpr char MAGIC[4] = {'T', 'R', 'P', 'L'};
+constexpr quint32 VERSION = 2;
+constexpr quint32 VERSION_WITHOUT_KEYFRAMES = 1;
+
+struct Header {
+    char magic[4];
+    quint32 version;
+    quint32 stateSize;
+    quint32 eventCount;
+};
+
+// 版本 2 起紧跟在文件头之后
+struct KeyframeHeader {
+    quint32 interval;
+    quint32 count;
+};
+
+static_assert(sizeof(Replay::Event) == 8);
+
+// 顺序播放时每次从文件读取的事件数
+constexpr quint32 READ_CHUNK = Replay::KEYFRAME_INTERVAL;
+
+} // namespace
+
+Replay::Replay()
+    : m_initial(TetrisEngine().saveState())
+{
+}
+
+void Replay::begin(const TetrisEngine::State &initial)
+{
+    m_initial = initial;
+    m_events.clear();
+}
+
+void Replay::record(quint32 timeMs, Action action, quint8 arg)
+{
+    m_events.append({timeMs, action, arg, 0});
+}
+
+void Replay::clear()
+{
+    m_initial = TetrisEngine().saveState();
+    m_events.clear();
+}
+
+bool Replay::isEmpty() const
+{
+    return m_events.isEmpty();
+}
+
+const TetrisEngine::State &Replay::initialState() const
+{
+    return m_initial;
+}
+
+const QVector<Replay::Event> &Replay::events() const
+{
+    return m_events;
+}
+
+quint32 Replay::durationMs() const
+{
+    return m_events.isEmpty() ? 0 : m_events.last().timeMs;
+}
+
+void Replay::apply(TetrisEngine &engine, const Event &event)
+{
+    switch (event.action) {
+        case MoveLeft:
+            engine.moveLeft();
+            break;
+        case MoveRight:
+            engine.moveRight();
+            break;
+        case MoveDown:
+            engine.moveDown();
+            break;
+        case RotateClockwise:
+            engine.rotate(RotationDirection::Clockwise);
+            break;
+        case RotateCounterClockwise:
+            engine.rotate(RotationDirection::CounterClockwise);
+            break;
+        case Rotate180:
+            engine.rotate(RotationDirection::Half);
+            break;
+        case HardDrop:
+            engine.hardDrop();
+            break;
+        case SetRotationSystem: {
+            const auto systems = RotationSystem::available();
+            if (event.arg < systems.size()) {
+                engine.setRotationSystem(systems[event.arg]);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+bool Replay::write(QIODevice &device) const
+{
+    Header header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.stateSize = sizeof(TetrisEngine::State);
+    header.eventCount = static_cast<quint32>(m_events.size());
+
+    // 重放一遍生成关键帧，录制时不需要额外开销
+    KeyframeHeader keyframeHeader = {KEYFRAME_INTERVAL, header.eventCount / KEYFRAME_INTERVAL};
+    QVector<quint32> keyframeTimes;
+    QVector<TetrisEngine::State> keyframes;
+    keyframeTimes.reserve(keyframeHeader.count);
+    keyframes.reserve(keyframeHeader.count);
+    TetrisEngine engine;
+    engine.restoreState(m_initial);
+    for (qsizetype i = 0; i < m_events.size(); ++i) {
+        apply(engine, m_events[i]);
+        if ((i + 1) % KEYFRAME_INTERVAL == 0) {
+            keyframeTimes.append(m_events[i].timeMs);
+            keyframes.append(engine.saveState());
+        }
+    }
+
+    const qint64 eventBytes = qint64(m_events.size()) * qint64(sizeof(Event));
+    const qint64 timeBytes = qint64(keyframeTimes.size()) * qint64(sizeof(quint32));
+    const qint64 keyframeBytes = qint64(keyframes.size()) * qint64(sizeof(TetrisEngine::State));
+    return device.write(reinterpret_cast<const char *>(&header), sizeof(header)) == qint64(sizeof(header))
+        && device.write(reinterpret_cast<const char *>(&keyframeHeader), sizeof(keyframeHeader))
+               == qint64(sizeof(keyframeHeader))
+        && device.write(reinterpret_cast<const char *>(&m_initial), sizeof(m_initial)) == qint64(sizeof(m_initial))
+        && device.write(reinterpret_cast<const char *>(m_events.constData()), eventBytes) == eventBytes
+        && device.write(reinterpret_cast<const char *>(keyframeTimes.constData()), timeBytes) == timeBytes
+        && device.write(reinterpret_cast<const char *>(keyframes.constData()), keyframeBytes) == keyframeBytes;
+}
+
+bool Replay::read(QIODevice &device)
+{
+    Header header;
+    if (device.read(reinterpret_cast<char *>(&header), sizeof(header)) != qint64(sizeof(header))) {
+        return false;
+    }
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0
+        || (header.version != VERSION && header.version != VERSION_WITHOUT_KEYFRAMES)
+        || header.stateSize != sizeof(TetrisEngine::State)) {
+        return false;
+    }
+    KeyframeHeader keyframeHeader = {0, 0};
+    if (header.version == VERSION
+        && device.read(reinterpret_cast<char *>(&keyframeHeader), sizeof(keyframeHeader))
+               != qint64(sizeof(keyframeHeader))) {
+        return false;
+    }
+
+    TetrisEngine::State initial;
+    if (device.read(reinterpret_cast<char *>(&initial), sizeof(initial)) != qint64(sizeof(initial))
+        || !TetrisEngine::isValidState(initial)) {
+        return false;
+    }
+
+    // 事件数来自文件，先确认剩余数据足够再分配
+    const qint64 eventBytes = qint64(header.eventCount) * qint64(sizeof(Event));
+    if (!device.isSequential() && device.size() - device.pos() < eventBytes) {
+        return false;
+    }
+    QVector<Event> events(header.eventCount);
+    if (device.read(reinterpret_cast<char *>(events.data()), eventBytes) != eventBytes) {
+        return false;
+    }
+
+    // 整段读入时用不到关键帧，跳过后设备正好停在下一段回放的开头
+    const qint64 keyframeBytes = qint64(keyframeHeader.count) * qint64(sizeof(quint32) + sizeof(TetrisEngine::State));
+    if (device.skip(keyframeBytes) != keyframeBytes) {
+        return false;
+    }
+
+    m_initial = initial;
+    m_events = std::move(events);
+    return true;
+}
+
+qint64 Replay::appendToFile(const QString &path) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadWrite)) {
+        return -1;
+    }
+    const qint64 offset = file.size();
+    file.seek(offset);
+    if (!write(file) || !file.flush()) {
+        // 写入不完整时截断，保持文件中只有完整的回放
+        file.resize(offset);
+        return -1;
+    }
+    return offset;
+}
+
+bool Replay::readFromFile(const QString &path, qint64 offset)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(offset)) {
+        return false;
+    }
+    return read(file);
+}
+
+ReplayReader::ReplayReader()
+    : m_initial(TetrisEngine().saveState())
+    , m_eventsOffset(0)
+    , m_keyframesOffset(0)
+    , m_endOffset(0)
+    , m_keyframeInterval(0)
+    , m_eventCount(0)
+    , m_durationMs(0)
+    , m_position(0)
+    , m_bufferStart(0)
+{
+}
+
+bool ReplayReader::open(const QString &path, qint64 offset)
+{
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly) || !m_file.seek(offset)) {
+        close();
+        return false;
+    }
+
+    Header header;
+    KeyframeHeader keyframeHeader = {0, 0};
+    TetrisEngine::State initial;
+    const bool headerOk = m_file.read(reinterpret_cast<char *>(&header), sizeof(header)) == qint64(sizeof(header))
+        && std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0
+        && (header.version == VERSION || header.version == VERSION_WITHOUT_KEYFRAMES)
+        && header.stateSize == sizeof(TetrisEngine::State)
+        && (header.version == VERSION_WITHOUT_KEYFRAMES
+            || m_file.read(reinterpret_cast<char *>(&keyframeHeader), sizeof(keyframeHeader))
+                   == qint64(sizeof(keyframeHeader)))
+        && m_file.read(reinterpret_cast<char *>(&initial), sizeof(initial)) == qint64(sizeof(initial))
+        && TetrisEngine::isValidState(initial);
+    // 关键帧数来自文件，必须和事件数对得上
+    if (!headerOk || (keyframeHeader.count > 0
+                      && (keyframeHeader.interval == 0
+                          || keyframeHeader.count > header.eventCount / keyframeHeader.interval))) {
+        close();
+        return false;
+    }
+
+    m_eventsOffset = m_file.pos();
+    const qint64 indexOffset = m_eventsOffset + qint64(header.eventCount) * qint64(sizeof(Replay::Event));
+    m_keyframesOffset = indexOffset + qint64(keyframeHeader.count) * qint64(sizeof(quint32));
+    m_endOffset = m_keyframesOffset + qint64(keyframeHeader.count) * qint64(sizeof(TetrisEngine::State));
+    if (m_endOffset > m_file.size()) {
+        close();
+        return false;
+    }
+
+    m_keyframeTimes.resize(keyframeHeader.count);
+    const qint64 timeBytes = qint64(keyframeHeader.count) * qint64(sizeof(quint32));
+    if (!m_file.seek(indexOffset)
+        || m_file.read(reinterpret_cast<char *>(m_keyframeTimes.data()), timeBytes) != timeBytes) {
+        close();
+        return false;
+    }
+
+    Replay::Event last = {0, 0, 0, 0};
+    if (header.eventCount > 0
+        && (!m_file.seek(indexOffset - qint64(sizeof(last)))
+            || m_file.read(reinterpret_cast<char *>(&last), sizeof(last)) != qint64(sizeof(last)))) {
+        close();
+        return false;
+    }
+
+    m_initial = initial;
+    m_keyframeInterval = keyframeHeader.interval;
+    m_eventCount = header.eventCount;
+    m_durationMs = last.timeMs;
+    m_position = 0;
+    return true;
+}
+
+void ReplayReader::close()
+{
+    m_file.close();
+    m_keyframeTimes.clear();
+    m_buffer.clear();
+    m_eventCount = 0;
+    m_durationMs = 0;
+    m_position = 0;
+    m_bufferStart = 0;
+}
+
+bool ReplayReader::isOpen() const
+{
+    return m_file.isOpen();
+}
+
+const TetrisEngine::State &ReplayReader::initialState() const
+{
+    return m_initial;
+}
+
+quint32 ReplayReader::eventCount() const
+{
+    return m_eventCount;
+}
+
+quint32 ReplayReader::durationMs() const
+{
+    return m_durationMs;
+}
+
+int ReplayReader::keyframeCount() const
+{
+    return int(m_keyframeTimes.size());
+}
+
+qint64 ReplayReader::endOffset() const
+{
+    return m_endOffset;
+}
+
+quint32 ReplayReader::position() const
+{
+    return m_position;
+}
+
+bool ReplayReader::seek(quint32 timeMs, TetrisEngine &engine)
+{
+    // 时间不早于 timeMs 的关键帧之前的所有事件也都不晚于 timeMs
+    const auto after = std::upper_bound(m_keyframeTimes.cbegin(), m_keyframeTimes.cend(), timeMs);
+    const quint32 keyframes = quint32(after - m_keyframeTimes.cbegin());
+    return restoreKeyframe(keyframes, engine) && play(m_eventCount, timeMs, engine);
+}
+
+bool ReplayReader::seekEvent(quint32 count, TetrisEngine &engine)
+{
+    count = std::min(count, m_eventCount);
+    const quint32 keyframes = m_keyframeInterval == 0
+        ? 0 : std::min(count / m_keyframeInterval, quint32(m_keyframeTimes.size()));
+    return restoreKeyframe(keyframes, engine) && play(count, std::numeric_limits<quint32>::max(), engine);
+}
+
+bool ReplayReader::advanceTo(quint32 timeMs, TetrisEngine &engine)
+{
+    return play(m_eventCount, timeMs, engine);
+}
+
+bool ReplayReader::restoreKeyframe(quint32 keyframes, TetrisEngine &engine)
+{
+    if (!isOpen()) {
+        return false;
+    }
+    if (keyframes == 0) {
+        engine.restoreState(m_initial);
+        m_position = 0;
+        return true;
+    }
+
+    TetrisEngine::State state;
+    const qint64 offset = m_keyframesOffset + qint64(keyframes - 1) * qint64(sizeof(state));
+    if (!m_file.seek(offset) || m_file.read(reinterpret_cast<char *>(&state), sizeof(state)) != qint64(sizeof(state))
+        || !TetrisEngine::isValidState(state)) {
+        return false;
+    }
+    engine.restoreState(state);
+    m_position = keyframes * m_keyframeInterval;
+    return true;
+}
+
+bool ReplayReader::play(quint32 count, quint32 timeMs, TetrisEngine &engine)
+{
+    while (m_position < count) {
+        if (m_position < m_bufferStart || m_position >= m_bufferStart + quint32(m_buffer.size())) {
+            if (!fillBuffer()) {
+                return false;
+            }
+        }
+        const Replay::Event &event = m_buffer[m_position - m_bufferStart];
+        if (event.timeMs > timeMs) {
+            break;
+        }
+        Replay::apply(engine, event);
+        ++m_position;
+    }
+    return true;
+}
+
+bool ReplayReader::fillBuffer()
+{
+    const quint32 count = std::min(READ_CHUNK, m_eventCount - m_position);
+    const qint64 bytes = qint64(count) * qint64(sizeof(Replay::Event));
+    m_buffer.resize(count);
+    if (!m_file.seek(m_eventsOffset + qint64(m_position) * qint64(sizeof(Replay::Event)))
+        || m_file.read(reinterpret_cast<char *>(m_buffer.data()), bytes) != bytes) {
+        m_buffer.clear();
+        return false;
+    }
+    m_bufferStart = m_position;
+    return true;
+}
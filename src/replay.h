@@ -0,0 +1,129 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <QFile>
+#include <QIODevice>
+#include <QString>
+#include <QVector>
+#include "tetrisengine.h"
+
+// 单人对局回放：起始状态 + 带时间戳的操作序列
+//
+// 引擎是确定性的，从同一起始状态按顺序重放操作即可得到完全相同的对局，
+// 不需要保存中间画面。时间戳是不含暂停的游戏时长（毫秒），只用于按时间
+// 对齐画面。多个回放可以首尾相接存放在同一个文件中。
+//
+// 文件格式（版本 2）：
+//   文件头 | 关键帧间隔、关键帧数 | 起始状态 | 事件 × N | 关键帧时间 u32 × K | 关键帧状态 × K
+// 第 k 个关键帧是应用前 (k + 1) × 间隔 个事件之后的完整状态，写盘时重放生成。
+// 事件和关键帧都是定长记录，偏移可以直接算出，定位见 ReplayReader。
+// 版本 1 没有关键帧部分，仍然可以读取。
+class Replay
+{
+public:
+    // 每隔多少个事件保存一个关键帧：定位时最多快进这么多个事件，
+    // 每个关键帧约占事件数据的 5%
+    static constexpr quint32 KEYFRAME_INTERVAL = 256;
+
+    enum Action : quint8 {
+        MoveLeft,
+        MoveRight,
+        MoveDown,           // 软降和重力下落
+        RotateClockwise,
+        RotateCounterClockwise,
+        Rotate180,
+        HardDrop,
+        SetRotationSystem,  // arg 为 RotationSystem::available() 中的序号
+        ActionCount
+    };
+
+    struct Event {
+        quint32 timeMs;
+        quint8 action;
+        quint8 arg;
+        quint16 reserved;
+    };
+
+    Replay();
+
+    void begin(const TetrisEngine::State &initial);
+    void record(quint32 timeMs, Action action, quint8 arg = 0);
+    void clear();
+
+    bool isEmpty() const;
+    const TetrisEngine::State &initialState() const;
+    const QVector<Event> &events() const;
+    quint32 durationMs() const;
+
+    // 把一个操作应用到引擎上
+    static void apply(TetrisEngine &engine, const Event &event);
+
+    // 序列化：写到设备当前位置；读取时校验格式，失败返回 false
+    bool write(QIODevice &device) const;
+    bool read(QIODevice &device);
+
+    // 追加到回放文件末尾，返回写入的偏移，失败返回 -1
+    qint64 appendToFile(const QString &path) const;
+    bool readFromFile(const QString &path, qint64 offset);
+
+private:
+    TetrisEngine::State m_initial;
+    QVector<Event> m_events;
+};
+
+// 从磁盘按需读取一段回放，不把事件整体读入内存
+//
+// 打开时只读文件头和关键帧时间表（每个关键帧 4 字节）。定位到任意时刻
+// 时先恢复之前最近的关键帧，再从文件中读取并快进其后不足一个间隔的事件；
+// 顺序播放时按块读取事件。
+class ReplayReader
+{
+public:
+    ReplayReader();
+
+    // 打开 path 中从 offset 开始的一段回放
+    bool open(const QString &path, qint64 offset);
+    void close();
+    bool isOpen() const;
+
+    const TetrisEngine::State &initialState() const;
+    quint32 eventCount() const;
+    quint32 durationMs() const;
+    int keyframeCount() const;
+    // 这段回放之后的偏移，即同一文件中下一段回放的开头
+    qint64 endOffset() const;
+
+    // 已应用到引擎上的事件数
+    quint32 position() const;
+
+    // 把 engine 置为应用了 timeMs 及之前全部事件的状态
+    bool seek(quint32 timeMs, TetrisEngine &engine);
+    // 把 engine 置为应用了前 count 个事件的状态
+    bool seekEvent(quint32 count, TetrisEngine &engine);
+    // 从当前位置继续应用 timeMs 及之前的事件，用于顺序播放
+    bool advanceTo(quint32 timeMs, TetrisEngine &engine);
+
+private:
+    // 恢复第 keyframes 个关键帧，0 表示起始状态
+    bool restoreKeyframe(quint32 keyframes, TetrisEngine &engine);
+    // 从当前位置应用事件，直到第 count 个或时间晚于 timeMs
+    bool play(quint32 count, quint32 timeMs, TetrisEngine &engine);
+    // 读取从 m_position 开始的一块事件到 m_buffer
+    bool fillBuffer();
+
+    QFile m_file;
+    TetrisEngine::State m_initial;
+    QVector<quint32> m_keyframeTimes;
+    QVector<Replay::Event> m_buffer;
+    qint64 m_eventsOffset;
+    qint64 m_keyframesOffset;
+    qint64 m_endOffset;
+    quint32 m_keyframeInterval;
+    quint32 m_eventCount;
+    quint32 m_durationMs;
+    quint32 m_position;
+    // m_buffer 中第一个事件的序号
+    quint32 m_bufferStart;
+};
+
+#endif // REPLAY_H
@@ -0,0 +1,137 @@
+#include "rotationsystem.h"
+#include <string_view>
+
+namespace {
+
+// 踢表按SRS文档书写（y轴向上），编译期翻转为游戏板坐标（y轴向下）
+template <std::size_t N>
+constexpr std::array<KickOffset, N> flipY(const std::array<KickOffset, N> &table)
+{
+    std::array<KickOffset, N> result{};
+    for (std::size_t i = 0; i < N; ++i) {
+        result[i] = {table[i].x, static_cast<std::int8_t>(-table[i].y)};
+    }
+    return result;
+}
+
+using Kicks5 = std::array<KickOffset, 5>;
+using Kicks6 = std::array<KickOffset, 6>;
+
+// JLSTZ 顺时针/逆时针踢表，下标为起始朝向
+constexpr Kicks5 JLSTZ_CW[ROTATION_COUNT] = {
+    flipY(Kicks5{{{0, 0}, {-1, 0}, {-1, 1}, {0, -2}, {-1, -2}}}),   // 0 -> R
+    flipY(Kicks5{{{0, 0}, {1, 0}, {1, -1}, {0, 2}, {1, 2}}}),       // R -> 2
+    flipY(Kicks5{{{0, 0}, {1, 0}, {1, 1}, {0, -2}, {1, -2}}}),      // 2 -> L
+    flipY(Kicks5{{{0, 0}, {-1, 0}, {-1, -1}, {0, 2}, {-1, 2}}}),    // L -> 0
+};
+
+constexpr Kicks5 JLSTZ_CCW[ROTATION_COUNT] = {
+    flipY(Kicks5{{{0, 0}, {1, 0}, {1, 1}, {0, -2}, {1, -2}}}),      // 0 -> L
+    flipY(Kicks5{{{0, 0}, {1, 0}, {1, -1}, {0, 2}, {1, 2}}}),       // R -> 0
+    flipY(Kicks5{{{0, 0}, {-1, 0}, {-1, 1}, {0, -2}, {-1, -2}}}),   // 2 -> R
+    flipY(Kicks5{{{0, 0}, {-1, 0}, {-1, -1}, {0, 2}, {-1, 2}}}),    // L -> 2
+};
+
+// I 方块踢表
+constexpr Kicks5 I_CW[ROTATION_COUNT] = {
+    flipY(Kicks5{{{0, 0}, {-2, 0}, {1, 0}, {-2, -1}, {1, 2}}}),     // 0 -> R
+    flipY(Kicks5{{{0, 0}, {-1, 0}, {2, 0}, {-1, 2}, {2, -1}}}),     // R -> 2
+    flipY(Kicks5{{{0, 0}, {2, 0}, {-1, 0}, {2, 1}, {-1, -2}}}),     // 2 -> L
+    flipY(Kicks5{{{0, 0}, {1, 0}, {-2, 0}, {1, -2}, {-2, 1}}}),     // L -> 0
+};
+
+constexpr Kicks5 I_CCW[ROTATION_COUNT] = {
+    flipY(Kicks5{{{0, 0}, {-1, 0}, {2, 0}, {-1, 2}, {2, -1}}}),     // 0 -> L
+    flipY(Kicks5{{{0, 0}, {2, 0}, {-1, 0}, {2, 1}, {-1, -2}}}),     // R -> 0
+    flipY(Kicks5{{{0, 0}, {1, 0}, {-2, 0}, {1, -2}, {-2, 1}}}),     // 2 -> R
+    flipY(Kicks5{{{0, 0}, {-2, 0}, {1, 0}, {-2, -1}, {1, 2}}}),     // L -> 2
+};
+
+// 180度踢表，所有方块共用
+constexpr Kicks6 HALF[ROTATION_COUNT] = {
+    flipY(Kicks6{{{0, 0}, {0, 1}, {1, 1}, {-1, 1}, {1, 0}, {-1, 0}}}),      // 0 -> 2
+    flipY(Kicks6{{{0, 0}, {1, 0}, {1, 2}, {1, 1}, {0, 2}, {0, 1}}}),        // R -> L
+    flipY(Kicks6{{{0, 0}, {0, -1}, {-1, -1}, {1, -1}, {-1, 0}, {1, 0}}}),   // 2 -> 0
+    flipY(Kicks6{{{0, 0}, {-1, 0}, {-1, 2}, {-1, 1}, {0, 2}, {0, 1}}}),     // L -> R
+};
+
+constexpr KickOffset NO_KICK[] = {{0, 0}};
+constexpr KickOffset CLASSIC_KICKS[] = {{0, 0}, {-1, 0}, {1, 0}};
+
+const SrsRotationSystem SRS{};
+const ClassicRotationSystem CLASSIC{};
+
+const RotationSystem *const REGISTRY[] = {&SRS, &CLASSIC};
+
+} // namespace
+
+std::span<const RotationSystem *const> RotationSystem::available()
+{
+    return REGISTRY;
+}
+
+const RotationSystem *RotationSystem::find(const char *name)
+{
+    if (!name) return nullptr;
+    for (const RotationSystem *system : REGISTRY) {
+        if (std::string_view(system->name()) == name) {
+            return system;
+        }
+    }
+    return nullptr;
+}
+
+const RotationSystem &RotationSystem::standard()
+{
+    return SRS;
+}
+
+const char *SrsRotationSystem::name() const
+{
+    return "srs";
+}
+
+const char *SrsRotationSystem::displayName() const
+{
+    return "SRS";
+}
+
+std::span<const KickOffset> SrsRotationSystem::kicks(Tetromino type, Rotation from,
+                                                     RotationDirection direction) const
+{
+    if (type == Tetromino::O) {
+        return NO_KICK;
+    }
+
+    const int index = static_cast<int>(from);
+    switch (direction) {
+        case RotationDirection::Clockwise:
+            return type == Tetromino::I ? std::span<const KickOffset>(I_CW[index])
+                                        : std::span<const KickOffset>(JLSTZ_CW[index]);
+        case RotationDirection::CounterClockwise:
+            return type == Tetromino::I ? std::span<const KickOffset>(I_CCW[index])
+                                        : std::span<const KickOffset>(JLSTZ_CCW[index]);
+        case RotationDirection::Half:
+            return HALF[index];
+    }
+    return NO_KICK;
+}
+
+const char *ClassicRotationSystem::name() const
+{
+    return "classic";
+}
+
+const char *ClassicRotationSystem::displayName() const
+{
+    return "经典";
+}
+
+std::span<const KickOffset> ClassicRotationSystem::kicks(Tetromino type, Rotation,
+                                                         RotationDirection) const
+{
+    if (type == Tetromino::O) {
+        return NO_KICK;
+    }
+    return CLASSIC_KICKS;
+}
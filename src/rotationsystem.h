@@ -0,0 +1,53 @@
+#ifndef ROTATIONSYSTEM_H
+#define ROTATIONSYSTEM_H
+
+#include "tetromino.h"
+#include <span>
+
+// 墙踢偏移：y轴向下，与游戏板坐标一致
+struct KickOffset {
+    std::int8_t x;
+    std::int8_t y;
+};
+
+// 旋转系统接口：决定每次旋转依次尝试的墙踢偏移
+// 实现必须是无状态的，偏移表存放在静态存储区，旋转时不分配内存
+class RotationSystem
+{
+public:
+    virtual ~RotationSystem() = default;
+
+    virtual const char *name() const = 0;
+    virtual const char *displayName() const = 0;
+
+    // 返回从 from 朝 direction 旋转时要依次尝试的偏移，第一个成功的生效
+    virtual std::span<const KickOffset> kicks(Tetromino type, Rotation from,
+                                              RotationDirection direction) const = 0;
+
+    // 已注册的旋转系统，第一个为默认
+    static std::span<const RotationSystem *const> available();
+    static const RotationSystem *find(const char *name);
+    static const RotationSystem &standard();
+};
+
+// 标准超级旋转系统（SRS），180度旋转使用常见的扩展踢表
+class SrsRotationSystem : public RotationSystem
+{
+public:
+    const char *name() const override;
+    const char *displayName() const override;
+    std::span<const KickOffset> kicks(Tetromino type, Rotation from,
+                                      RotationDirection direction) const override;
+};
+
+// 经典旋转：原地、左移一格、右移一格
+class ClassicRotationSystem : public RotationSystem
+{
+public:
+    const char *name() const override;
+    const char *displayName() const override;
+    std::span<const KickOffset> kicks(Tetromino type, Rotation from,
+                                      RotationDirection direction) const override;
+};
+
+#endif // ROTATIONSYSTEM_H
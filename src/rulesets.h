@@ -0,0 +1,181 @@
+#ifndef RULESETS_H
+#define RULESETS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+
+// 规则集：重力曲线、计分和升级条件
+//
+// 规则集是只有静态成员的策略类型，引擎以 BasicTetrisEngine<Rules> 实例化，
+// 热路径上的调用全部在编译期确定并内联，没有虚函数分派；关闭的规则
+// （T-spin、背靠背、连击）通过 if constexpr 整段去掉。一个规则集需要提供：
+//   NAME                          名称
+//   gravityTicks(level)           每下落一行的逻辑帧数
+//   dropIntervalMs(level)         每下落一行的毫秒数（界面定时器使用）
+//   levelForLines(lines)          消除总行数对应的等级，从1开始
+//   clearPoints(lines, tSpin)     一次锁定的基础分，未乘等级
+//   T_SPINS / BACK_TO_BACK / COMBOS
+//   comboPoints(combo)            第 combo 次连续消行的奖励分，未乘等级
+//   LINE_GOAL                     消除行数达到该值时结束，0 表示不限
+
+// 逻辑帧率，与 TetrisEngine::TICKS_PER_SECOND 相同
+inline constexpr int RULE_TICKS_PER_SECOND = 60;
+
+enum class TSpin : std::uint8_t {
+    None,
+    Mini,
+    Full
+};
+
+// 本项目原有的规则：等级每级快 100ms，消行分 100/300/500/800
+struct StandardRules {
+    static constexpr const char *NAME = "standard";
+
+    static constexpr int dropIntervalMs(int level)
+    {
+        return std::max(100, 1000 - (level - 1) * 100);
+    }
+
+    static constexpr int gravityTicks(int level)
+    {
+        return std::max(1, dropIntervalMs(level) * RULE_TICKS_PER_SECOND / 1000);
+    }
+
+    static constexpr int levelForLines(int lines)
+    {
+        return lines / 10 + 1;
+    }
+
+    static constexpr int clearPoints(int lines, TSpin)
+    {
+        constexpr int POINTS[] = {0, 100, 300, 500, 800};
+        return POINTS[lines];
+    }
+
+    static constexpr bool T_SPINS = false;
+    static constexpr bool BACK_TO_BACK = false;
+    static constexpr bool COMBOS = false;
+
+    static constexpr int comboPoints(int)
+    {
+        return 0;
+    }
+
+    static constexpr int LINE_GOAL = 0;
+};
+
+// 现代指南规则：指数重力曲线，T-spin（三角判定）、背靠背 1.5 倍、连击奖励
+struct GuidelineRules {
+    static constexpr const char *NAME = "guideline";
+
+    // 每行秒数 (0.8 - (等级-1) * 0.007) ^ (等级-1)，20级之后不再加快
+    static constexpr int dropIntervalMs(int level)
+    {
+        const int clamped = std::clamp(level, 1, 20);
+        const double base = 0.8 - (clamped - 1) * 0.007;
+        double seconds = 1.0;
+        for (int i = 1; i < clamped; ++i) {
+            seconds *= base;
+        }
+        return std::max(1, static_cast<int>(seconds * 1000.0));
+    }
+
+    static constexpr int gravityTicks(int level)
+    {
+        return std::max(1, dropIntervalMs(level) * RULE_TICKS_PER_SECOND / 1000);
+    }
+
+    static constexpr int levelForLines(int lines)
+    {
+        return lines / 10 + 1;
+    }
+
+    static constexpr int clearPoints(int lines, TSpin tSpin)
+    {
+        constexpr int NORMAL[] = {0, 100, 300, 500, 800};
+        constexpr int MINI[] = {100, 200, 400, 400, 400};
+        constexpr int FULL[] = {400, 800, 1200, 1600, 1600};
+        switch (tSpin) {
+        case TSpin::Mini:
+            return MINI[lines];
+        case TSpin::Full:
+            return FULL[lines];
+        case TSpin::None:
+            break;
+        }
+        return NORMAL[lines];
+    }
+
+    static constexpr bool T_SPINS = true;
+    static constexpr bool BACK_TO_BACK = true;
+    static constexpr bool COMBOS = true;
+
+    static constexpr int comboPoints(int combo)
+    {
+        return 50 * (combo - 1);
+    }
+
+    static constexpr int LINE_GOAL = 0;
+};
+
+// NES 风格：按 NTSC 帧数表下落，消行分 40/100/300/1200，没有 T-spin 和连击
+// NES 从0级开始，这里的等级 = NES 等级 + 1，计分公式 (NES等级+1) 恰好是这里的等级
+struct ClassicRules {
+    static constexpr const char *NAME = "classic";
+
+    static constexpr int gravityTicks(int level)
+    {
+        constexpr int FRAMES[] = {48, 43, 38, 33, 28, 23, 18, 13, 8, 6, 5, 5, 5, 4, 4, 4, 3, 3, 3};
+        const int nesLevel = std::max(0, level - 1);
+        if (nesLevel < static_cast<int>(std::size(FRAMES))) {
+            return FRAMES[nesLevel];
+        }
+        return nesLevel < 29 ? 2 : 1;
+    }
+
+    static constexpr int dropIntervalMs(int level)
+    {
+        return (gravityTicks(level) * 1000 + RULE_TICKS_PER_SECOND - 1) / RULE_TICKS_PER_SECOND;
+    }
+
+    static constexpr int levelForLines(int lines)
+    {
+        return lines / 10 + 1;
+    }
+
+    static constexpr int clearPoints(int lines, TSpin)
+    {
+        constexpr int POINTS[] = {0, 40, 100, 300, 1200};
+        return POINTS[lines];
+    }
+
+    static constexpr bool T_SPINS = false;
+    static constexpr bool BACK_TO_BACK = false;
+    static constexpr bool COMBOS = false;
+
+    static constexpr int comboPoints(int)
+    {
+        return 0;
+    }
+
+    static constexpr int LINE_GOAL = 0;
+};
+
+// 马拉松：指南规则，15级封顶，消除150行结束
+struct MarathonRules : GuidelineRules {
+    static constexpr const char *NAME = "marathon";
+
+    static constexpr int levelForLines(int lines)
+    {
+        return std::min(15, lines / 10 + 1);
+    }
+
+    static constexpr int LINE_GOAL = 150;
+};
+
+static_assert(StandardRules::gravityTicks(1) == 60 && StandardRules::gravityTicks(10) == 6);
+static_assert(ClassicRules::gravityTicks(1) == 48 && ClassicRules::gravityTicks(30) == 1);
+static_assert(GuidelineRules::dropIntervalMs(1) == 1000 && GuidelineRules::dropIntervalMs(2) == 793);
+
+#endif // RULESETS_H
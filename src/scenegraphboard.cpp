@@ -0,0 +1,111 @@
+#include "scenegraphboard.h"
+#include "tetrisengine.h"
+#include <QFont>
+#include <QFontMetrics>
+#include <QImage>
+#include <QPainter>
+#include <QQuickWindow>
+#include <QSGGeometryNode>
+#include <QSGImageNode>
+#include <QSGTexture>
+#include <QSGVertexColorMaterial>
+#include <cstring>
+
+static_assert(sizeof(BoardVertex) == sizeof(QSGGeometry::ColoredPoint2D),
+              "顶点布局必须与 ColoredPoint2D 一致");
+
+namespace {
+
+QFont labelFont()
+{
+    return QFont("Arial", 12, QFont::Bold);
+}
+
+QImage renderLabel(qreal devicePixelRatio)
+{
+    const QFont font = labelFont();
+    const QFontMetrics metrics(font);
+    const QString text = QStringLiteral("下一个:");
+    const QSize size(metrics.horizontalAdvance(text) + 2, metrics.height());
+
+    QImage image(size * devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(devicePixelRatio);
+    image.fill(Qt::transparent);
+    QPainter painter(&image);
+    painter.setFont(font);
+    painter.setPen(QColor(255, 255, 255));
+    painter.drawText(0, metrics.ascent(), text);
+    return image;
+}
+
+} // namespace
+
+SceneGraphBoardItem::SceneGraphBoardItem(QQuickItem *parent)
+    : QQuickItem(parent)
+    , m_engine(nullptr)
+    , m_labelAscent(QFontMetrics(labelFont()).ascent())
+{
+    setFlag(ItemHasContents, true);
+}
+
+SceneGraphBoardItem::~SceneGraphBoardItem()
+{
+}
+
+void SceneGraphBoardItem::setEngine(const TetrisEngine *engine)
+{
+    m_engine = engine;
+    update();
+}
+
+int SceneGraphBoardItem::cellSize() const
+{
+    return qMin(int(width()) / (TetrisEngine::BOARD_WIDTH + 4), int(height()) / TetrisEngine::BOARD_HEIGHT);
+}
+
+QSGNode *SceneGraphBoardItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    Q_UNUSED(data);
+
+    if (!m_engine || width() <= 0 || height() <= 0) {
+        delete oldNode;
+        return nullptr;
+    }
+
+    auto *node = static_cast<QSGGeometryNode *>(oldNode);
+    QSGImageNode *label = nullptr;
+    if (!node) {
+        node = new QSGGeometryNode();
+        auto *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_ColoredPoint2D(), 0);
+        geometry->setDrawingMode(QSGGeometry::DrawTriangles);
+        geometry->setVertexDataPattern(QSGGeometry::StreamPattern);
+        node->setGeometry(geometry);
+        node->setFlag(QSGNode::OwnsGeometry);
+        node->setMaterial(new QSGVertexColorMaterial());
+        node->setFlag(QSGNode::OwnsMaterial);
+
+        // 标签纹理只生成一次
+        label = window()->createImageNode();
+        label->setTexture(window()->createTextureFromImage(renderLabel(window()->effectiveDevicePixelRatio())));
+        label->setOwnsTexture(true);
+        node->appendChildNode(label);
+    } else {
+        label = static_cast<QSGImageNode *>(node->firstChild());
+    }
+
+    m_geometry.build(*m_engine, cellSize(), int(width()), int(height()));
+
+    // 顶点数不变时直接覆盖原缓冲
+    QSGGeometry *geometry = node->geometry();
+    if (geometry->vertexCount() != m_geometry.vertexCount()) {
+        geometry->allocate(m_geometry.vertexCount());
+    }
+    std::memcpy(geometry->vertexData(), m_geometry.vertexData(),
+                size_t(m_geometry.vertexCount()) * sizeof(BoardVertex));
+    node->markDirty(QSGNode::DirtyGeometry);
+
+    const QSizeF labelSize = label->texture()->textureSize() / window()->effectiveDevicePixelRatio();
+    label->setRect(QRectF(QPointF(m_geometry.labelX(), m_geometry.labelBaseline() - m_labelAscent), labelSize));
+
+    return node;
+}
@@ -0,0 +1,36 @@
+#ifndef SCENEGRAPHBOARD_H
+#define SCENEGRAPHBOARD_H
+
+#include <QQuickItem>
+#include "boardgeometry.h"
+
+class TetrisEngine;
+
+// 场景图渲染的棋盘
+//
+// 每帧把整块棋盘写入同一个顶点缓冲（QSGVertexColorMaterial），由 QRhi
+// 一次绘制提交；只有“下一个”标签是单独缓存的纹理。显卡不可用时由
+// 软件 OpenGL（Mesa llvmpipe / opengl32sw）作为 RHI 后端。
+class SceneGraphBoardItem : public QQuickItem
+{
+    Q_OBJECT
+
+public:
+    explicit SceneGraphBoardItem(QQuickItem *parent = nullptr);
+    ~SceneGraphBoardItem();
+
+    void setEngine(const TetrisEngine *engine);
+
+    // 与 TetrisBoard::cellSize() 相同的布局规则
+    int cellSize() const;
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+
+private:
+    const TetrisEngine *m_engine;
+    BoardGeometry m_geometry;
+    int m_labelAscent;
+};
+
+#endif // SCENEGRAPHBOARD_H
@@ -0,0 +1,431 @@
+#include "scorestore.h"
+#include <QDir>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+namespace {
+
+constexpr char LOG_MAGIC[4] = {'T', 'S', 'C', 'L'};
+constexpr char INDEX_MAGIC[4] = {'T', 'S', 'C', 'I'};
+constexpr quint32 VERSION = 1;
+
+// 尾部超过该数量时合并写回索引。自助机多是直接断电而不是正常关闭，
+// 这个上限同时决定了下次启动时最多要从日志补读多少条记录
+constexpr int MAX_TAIL = 1024;
+
+// 从日志载入记录时每次读取的记录数
+constexpr int READ_CHUNK = 4096;
+
+struct LogHeader {
+    char magic[4];
+    quint32 version;
+    quint32 recordSize;
+    quint32 reserved;
+};
+
+struct IndexHeader {
+    char magic[4];
+    quint32 version;
+    quint64 recordCount;
+    quint32 playerCount;
+    quint32 reserved;
+};
+
+struct StoredPlayer {
+    char name[16];
+    quint32 games;
+    qint32 bestScore;
+    qint64 totalScore;
+    qint64 totalLines;
+    qint64 totalDurationMs;
+    qint64 totalPieces;
+};
+
+static_assert(sizeof(GameRecord) == 64, "GameRecord 是磁盘格式，大小不能改变");
+static_assert(sizeof(LogHeader) == 16);
+static_assert(sizeof(IndexHeader) == 24);
+static_assert(sizeof(StoredPlayer) == 56);
+static_assert(std::is_trivially_copyable_v<GameRecord>);
+
+constexpr int NAME_BYTES = 16;
+
+QString truncateName(const QString &name)
+{
+    // 按字符截断，避免切开多字节UTF-8序列
+    QString truncated = name;
+    while (truncated.toUtf8().size() > NAME_BYTES) {
+        truncated.chop(1);
+    }
+    return truncated;
+}
+
+void copyName(char (&target)[NAME_BYTES], const QString &name)
+{
+    const QByteArray bytes = truncateName(name).toUtf8();
+    std::memset(target, 0, sizeof(target));
+    std::memcpy(target, bytes.constData(), bytes.size());
+}
+
+QString readName(const char (&source)[NAME_BYTES])
+{
+    return QString::fromUtf8(source, qstrnlen(source, sizeof(source)));
+}
+
+} // namespace
+
+QString GameRecord::playerName() const
+{
+    return readName(player);
+}
+
+void GameRecord::setPlayerName(const QString &name)
+{
+    copyName(player, name);
+}
+
+QString GameRecord::normalizedName(const QString &name)
+{
+    return truncateName(name);
+}
+
+ScoreStore::ScoreStore()
+    : m_recordCount(0)
+    , m_indexMap(nullptr)
+    , m_sorted(nullptr)
+    , m_sortedCount(0)
+{
+}
+
+ScoreStore::~ScoreStore()
+{
+    close();
+}
+
+bool ScoreStore::open(const QString &directory)
+{
+    close();
+
+    QDir().mkpath(directory);
+    m_directory = directory;
+
+    if (!openLog(QDir(directory).filePath("scores.log"))) {
+        return false;
+    }
+
+    // 索引缺失或与日志不一致时从日志重建（只在首次或文件损坏时发生）
+    if (!loadIndex()) {
+        rebuildIndex();
+    }
+    return true;
+}
+
+void ScoreStore::close()
+{
+    if (m_log.isOpen() && !m_tail.isEmpty()) {
+        writeIndex();
+    }
+    unmapIndex();
+    m_tail.clear();
+    m_players.clear();
+    m_recordCount = 0;
+    if (m_log.isOpen()) {
+        m_log.close();
+    }
+}
+
+bool ScoreStore::isOpen() const
+{
+    return m_log.isOpen();
+}
+
+qint64 ScoreStore::append(const GameRecord &record)
+{
+    if (!m_log.isOpen()) return -1;
+
+    const qint64 index = m_recordCount;
+    if (!m_log.seek(sizeof(LogHeader) + index * sizeof(GameRecord))) {
+        return -1;
+    }
+    if (m_log.write(reinterpret_cast<const char *>(&record), sizeof(GameRecord)) != qint64(sizeof(GameRecord))) {
+        return -1;
+    }
+    m_log.flush();
+
+    ++m_recordCount;
+    addToStats(record);
+    addToTail(record, static_cast<quint32>(index));
+
+    if (m_tail.size() > MAX_TAIL) {
+        writeIndex();
+    }
+    return index;
+}
+
+qint64 ScoreStore::recordCount() const
+{
+    return m_recordCount;
+}
+
+bool ScoreStore::readRecord(qint64 index, GameRecord &record) const
+{
+    if (index < 0 || index >= m_recordCount) return false;
+    if (!m_log.seek(sizeof(LogHeader) + index * sizeof(GameRecord))) return false;
+    return m_log.read(reinterpret_cast<char *>(&record), sizeof(GameRecord)) == qint64(sizeof(GameRecord));
+}
+
+QVector<GameRecord> ScoreStore::topScores(int count) const
+{
+    QVector<GameRecord> result;
+    result.reserve(count);
+
+    // 合并映射索引与内存尾部两个有序序列
+    qint64 i = 0;
+    int j = 0;
+    while (result.size() < count && (i < m_sortedCount || j < m_tail.size())) {
+        IndexEntry entry;
+        if (j >= m_tail.size() || (i < m_sortedCount && !entryBefore(m_tail[j], m_sorted[i]))) {
+            entry = m_sorted[i++];
+        } else {
+            entry = m_tail[j++];
+        }
+
+        GameRecord record;
+        if (readRecord(entry.record, record)) {
+            result.append(record);
+        }
+    }
+    return result;
+}
+
+qint64 ScoreStore::rankOf(qint32 score) const
+{
+    auto higher = [score](const IndexEntry &entry) { return entry.score > score; };
+    const qint64 inIndex = std::partition_point(m_sorted, m_sorted + m_sortedCount, higher) - m_sorted;
+    const qint64 inTail = std::partition_point(m_tail.cbegin(), m_tail.cend(), higher) - m_tail.cbegin();
+    return inIndex + inTail + 1;
+}
+
+QStringList ScoreStore::players() const
+{
+    QStringList names = m_players.keys();
+    names.sort();
+    return names;
+}
+
+ScoreStore::PlayerStats ScoreStore::playerStats(const QString &player) const
+{
+    return m_players.value(GameRecord::normalizedName(player));
+}
+
+QString ScoreStore::replayPath() const
+{
+    return QDir(m_directory).filePath("replays.bin");
+}
+
+QString ScoreStore::defaultDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+}
+
+bool ScoreStore::entryBefore(const IndexEntry &a, const IndexEntry &b)
+{
+    // 分数降序，同分按记录号升序
+    if (a.score != b.score) return a.score > b.score;
+    return a.record < b.record;
+}
+
+bool ScoreStore::openLog(const QString &path)
+{
+    m_log.setFileName(path);
+    if (!m_log.open(QIODevice::ReadWrite)) {
+        return false;
+    }
+
+    if (m_log.size() < qint64(sizeof(LogHeader))) {
+        LogHeader header = {};
+        std::memcpy(header.magic, LOG_MAGIC, sizeof(LOG_MAGIC));
+        header.version = VERSION;
+        header.recordSize = sizeof(GameRecord);
+        m_log.resize(0);
+        m_log.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        m_log.flush();
+    } else {
+        LogHeader header;
+        m_log.read(reinterpret_cast<char *>(&header), sizeof(header));
+        if (std::memcmp(header.magic, LOG_MAGIC, sizeof(LOG_MAGIC)) != 0
+            || header.version != VERSION || header.recordSize != sizeof(GameRecord)) {
+            m_log.close();
+            return false;
+        }
+    }
+
+    // 写入中途退出留下的不完整记录直接截掉
+    const qint64 payload = m_log.size() - qint64(sizeof(LogHeader));
+    m_recordCount = payload / qint64(sizeof(GameRecord));
+    if (payload % qint64(sizeof(GameRecord)) != 0) {
+        m_log.resize(sizeof(LogHeader) + m_recordCount * sizeof(GameRecord));
+    }
+    return true;
+}
+
+bool ScoreStore::loadIndex()
+{
+    unmapIndex();
+    m_players.clear();
+    m_tail.clear();
+
+    m_indexFile.setFileName(QDir(m_directory).filePath("scores.idx"));
+    if (!m_indexFile.open(QIODevice::ReadOnly) || m_indexFile.size() < qint64(sizeof(IndexHeader))) {
+        m_indexFile.close();
+        return false;
+    }
+
+    m_indexMap = m_indexFile.map(0, m_indexFile.size());
+    if (!m_indexMap) {
+        m_indexFile.close();
+        return false;
+    }
+
+    const auto *header = reinterpret_cast<const IndexHeader *>(m_indexMap);
+    const qint64 expectedSize = sizeof(IndexHeader) + qint64(header->playerCount) * sizeof(StoredPlayer)
+                              + qint64(header->recordCount) * sizeof(IndexEntry);
+    if (std::memcmp(header->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0
+        || header->version != VERSION
+        || qint64(header->recordCount) > m_recordCount
+        || expectedSize != m_indexFile.size()) {
+        unmapIndex();
+        return false;
+    }
+
+    // 玩家汇总只有少量条目，直接载入哈希表
+    const auto *stored = reinterpret_cast<const StoredPlayer *>(m_indexMap + sizeof(IndexHeader));
+    m_players.reserve(header->playerCount);
+    for (quint32 i = 0; i < header->playerCount; ++i) {
+        PlayerStats stats;
+        stats.games = stored[i].games;
+        stats.bestScore = stored[i].bestScore;
+        stats.totalScore = stored[i].totalScore;
+        stats.totalLines = stored[i].totalLines;
+        stats.totalDurationMs = stored[i].totalDurationMs;
+        stats.totalPieces = stored[i].totalPieces;
+        m_players.insert(readName(stored[i].name), stats);
+    }
+
+    // 排序后的条目原地使用，不复制
+    m_sorted = reinterpret_cast<const IndexEntry *>(stored + header->playerCount);
+    m_sortedCount = qint64(header->recordCount);
+
+    // 补上索引之后追加的记录
+    loadTail(m_sortedCount);
+    return true;
+}
+
+void ScoreStore::rebuildIndex()
+{
+    unmapIndex();
+    m_players.clear();
+    m_tail.clear();
+    loadTail(0);
+
+    writeIndex();
+}
+
+void ScoreStore::loadTail(qint64 first)
+{
+    // 按块顺序读取，全部读完后排序一次，不逐条插入
+    m_tail.reserve(static_cast<int>(m_recordCount - first));
+
+    QVector<GameRecord> chunk(READ_CHUNK);
+    m_log.seek(sizeof(LogHeader) + first * sizeof(GameRecord));
+    for (qint64 start = first; start < m_recordCount; start += READ_CHUNK) {
+        const qint64 count = qMin<qint64>(READ_CHUNK, m_recordCount - start);
+        const qint64 bytes = count * sizeof(GameRecord);
+        if (m_log.read(reinterpret_cast<char *>(chunk.data()), bytes) != bytes) {
+            break;
+        }
+        for (qint64 i = 0; i < count; ++i) {
+            addToStats(chunk[i]);
+            m_tail.append({chunk[i].score, static_cast<quint32>(start + i)});
+        }
+    }
+    std::sort(m_tail.begin(), m_tail.end(), entryBefore);
+}
+
+bool ScoreStore::writeIndex()
+{
+    // 合并映射部分和尾部
+    QVector<IndexEntry> merged(static_cast<int>(m_sortedCount + m_tail.size()));
+    std::merge(m_sorted, m_sorted + m_sortedCount, m_tail.cbegin(), m_tail.cend(), merged.begin(), entryBefore);
+
+    QVector<StoredPlayer> stored;
+    stored.reserve(m_players.size());
+    for (auto it = m_players.cbegin(); it != m_players.cend(); ++it) {
+        StoredPlayer player = {};
+        copyName(player.name, it.key());
+        player.games = it->games;
+        player.bestScore = it->bestScore;
+        player.totalScore = it->totalScore;
+        player.totalLines = it->totalLines;
+        player.totalDurationMs = it->totalDurationMs;
+        player.totalPieces = it->totalPieces;
+        stored.append(player);
+    }
+
+    IndexHeader header = {};
+    std::memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header.version = VERSION;
+    header.recordCount = static_cast<quint64>(merged.size());
+    header.playerCount = static_cast<quint32>(stored.size());
+
+    // 替换前先解除映射（Windows 不允许替换已映射的文件）
+    unmapIndex();
+
+    QSaveFile file(QDir(m_directory).filePath("scores.idx"));
+    bool ok = file.open(QIODevice::WriteOnly);
+    if (ok) {
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(stored.constData()), stored.size() * sizeof(StoredPlayer));
+        file.write(reinterpret_cast<const char *>(merged.constData()), merged.size() * sizeof(IndexEntry));
+        ok = file.commit();
+    }
+    if (!ok) {
+        // 写入失败时全部条目留在内存尾部，下次关闭时重试
+        m_tail = merged;
+        return false;
+    }
+
+    return loadIndex();
+}
+
+void ScoreStore::unmapIndex()
+{
+    if (m_indexMap) {
+        m_indexFile.unmap(m_indexMap);
+        m_indexMap = nullptr;
+    }
+    if (m_indexFile.isOpen()) {
+        m_indexFile.close();
+    }
+    m_sorted = nullptr;
+    m_sortedCount = 0;
+}
+
+void ScoreStore::addToStats(const GameRecord &record)
+{
+    PlayerStats &stats = m_players[record.playerName()];
+    ++stats.games;
+    stats.bestScore = qMax(stats.bestScore, record.score);
+    stats.totalScore += record.score;
+    stats.totalLines += record.lines;
+    stats.totalDurationMs += record.durationMs;
+    stats.totalPieces += record.pieces;
+}
+
+void ScoreStore::addToTail(const GameRecord &record, quint32 index)
+{
+    const IndexEntry entry = {record.score, index};
+    m_tail.insert(std::upper_bound(m_tail.begin(), m_tail.end(), entry, entryBefore), entry);
+}
@@ -0,0 +1,108 @@
+#ifndef SCORESTORE_H
+#define SCORESTORE_H
+
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// 一局结束后的记录，定长64字节，按追加顺序写入日志
+struct GameRecord {
+    qint64 finishedAt;          // 结束时间（毫秒时间戳）
+    quint64 seed;               // 开局种子
+    qint64 replayOffset;        // 回放数据偏移，-1 表示没有回放
+    qint32 score;
+    qint32 lines;
+    qint32 level;
+    quint32 durationMs;
+    quint32 pieces;
+    float piecesPerSecond;
+    char player[16];            // UTF-8 玩家名，不足补零
+
+    QString playerName() const;
+    void setPlayerName(const QString &name);
+
+    // 记录中保存的形式：按字符截断到 16 字节 UTF-8，查询统计前要先经过它
+    static QString normalizedName(const QString &name);
+};
+
+// 成绩与统计存储
+//
+// scores.log 是只追加的 GameRecord 日志；scores.idx 保存按分数排序的
+// (分数, 记录号) 索引和每位玩家的汇总统计，通过内存映射打开，不需要解析。
+// 索引之后新追加的记录保存在内存中的有序尾部，尾部超过约一千条或关闭时合并写回索引，
+// 因此即使没有正常关闭，启动时也只需按块读入索引覆盖范围之后的少量记录。
+class ScoreStore
+{
+public:
+    struct PlayerStats {
+        quint32 games = 0;
+        qint32 bestScore = 0;
+        qint64 totalScore = 0;
+        qint64 totalLines = 0;
+        qint64 totalDurationMs = 0;
+        qint64 totalPieces = 0;
+    };
+
+    ScoreStore();
+    ~ScoreStore();
+
+    bool open(const QString &directory);
+    void close();
+    bool isOpen() const;
+
+    // 追加一局记录，返回记录号，失败返回 -1
+    qint64 append(const GameRecord &record);
+
+    qint64 recordCount() const;
+    bool readRecord(qint64 index, GameRecord &record) const;
+
+    // 排行榜：前 count 名，分数相同时先达成者在前
+    QVector<GameRecord> topScores(int count) const;
+    // 该分数在所有记录中的名次（从1开始）
+    qint64 rankOf(qint32 score) const;
+
+    QStringList players() const;
+    PlayerStats playerStats(const QString &player) const;
+
+    // 回放文件，GameRecord::replayOffset 指向其中的位置
+    QString replayPath() const;
+
+    static QString defaultDirectory();
+
+private:
+    struct IndexEntry {
+        qint32 score;
+        quint32 record;
+    };
+
+    static bool entryBefore(const IndexEntry &a, const IndexEntry &b);
+
+    bool openLog(const QString &path);
+    bool loadIndex();
+    void rebuildIndex();
+    // 从日志按块读入记录号 first 起的全部记录，计入统计并排序放入尾部
+    void loadTail(qint64 first);
+    bool writeIndex();
+    void unmapIndex();
+    void addToStats(const GameRecord &record);
+    void addToTail(const GameRecord &record, quint32 index);
+
+    QString m_directory;
+    mutable QFile m_log;
+    qint64 m_recordCount;
+
+    // 内存映射的已排序索引
+    QFile m_indexFile;
+    uchar *m_indexMap;
+    const IndexEntry *m_sorted;
+    qint64 m_sortedCount;
+
+    // 索引之后追加的记录，保持有序
+    QVector<IndexEntry> m_tail;
+
+    QHash<QString, PlayerStats> m_players;
+};
+
+#endif // SCORESTORE_H
@@ -0,0 +1,160 @@
+#include "serverprotocol.h"
+#include "wireformat.h"
+#include <bit>
+
+namespace {
+
+using namespace WireFormat;
+
+std::uint8_t statusBits(const TetrisEngine::State &state)
+{
+    return static_cast<std::uint8_t>((state.gameOver ? 1 : 0) | (state.gameStarted ? 2 : 0));
+}
+
+} // namespace
+
+CommandPacket encodeCommand(const ClientCommand &command)
+{
+    CommandPacket packet = {static_cast<std::uint8_t>(command.type), command.arg, 0, 0};
+    put32(packet.data() + 4, command.session);
+    return packet;
+}
+
+ClientCommand decodeCommand(const std::uint8_t *packet)
+{
+    ClientCommand command;
+    command.type = static_cast<ClientCommandType>(packet[0]);
+    command.arg = packet[1];
+    command.session = get32(packet + 4);
+    return command;
+}
+
+std::size_t encodeSessionMessage(ServerMessageType type, std::uint32_t session, std::uint8_t *out)
+{
+    return finishMessage(out, type, put32(out + MESSAGE_HEADER_SIZE, session));
+}
+
+std::size_t encodeRejected(std::uint32_t session, RejectReason reason, std::uint8_t *out)
+{
+    std::uint8_t *end = put32(out + MESSAGE_HEADER_SIZE, session);
+    *end++ = static_cast<std::uint8_t>(reason);
+    return finishMessage(out, ServerMessageType::Rejected, end);
+}
+
+std::size_t encodeDelta(std::uint32_t session, const TetrisEngine::State &sent,
+                        const TetrisEngine::State &current, bool full, std::uint8_t *out)
+{
+    std::uint32_t mask = 0;
+    if (full) {
+        mask = DeltaAll;
+    } else {
+        for (int y = 0; y < TetrisEngine::BOARD_HEIGHT; ++y) {
+            if (sent.rows[y] != current.rows[y]) mask |= 1u << y;
+        }
+        if (sent.pieceX != current.pieceX || sent.pieceY != current.pieceY
+            || sent.currentTetromino != current.currentTetromino || sent.currentRotation != current.currentRotation) {
+            mask |= DeltaPiece;
+        }
+        if (sent.queue != current.queue) mask |= DeltaQueue;
+        if (sent.score != current.score || sent.level != current.level || sent.lines != current.lines
+            || sent.pieceCount != current.pieceCount) {
+            mask |= DeltaStats;
+        }
+        if (statusBits(sent) != statusBits(current) || sent.pendingGarbage != current.pendingGarbage) {
+            mask |= DeltaStatus;
+        }
+        if (mask == 0) {
+            return 0;
+        }
+    }
+
+    std::uint8_t *p = put32(out + MESSAGE_HEADER_SIZE, session);
+    p = put32(p, mask);
+    for (int y = 0; y < TetrisEngine::BOARD_HEIGHT; ++y) {
+        if (mask & (1u << y)) p = put16(p, current.rows[y]);
+    }
+    if (mask & DeltaPiece) {
+        *p++ = static_cast<std::uint8_t>(current.pieceX);
+        *p++ = static_cast<std::uint8_t>(current.pieceY);
+        *p++ = static_cast<std::uint8_t>(current.currentTetromino);
+        *p++ = static_cast<std::uint8_t>(current.currentRotation);
+    }
+    if (mask & DeltaQueue) {
+        for (Tetromino type : current.queue) {
+            *p++ = static_cast<std::uint8_t>(type);
+        }
+    }
+    if (mask & DeltaStats) {
+        p = put32(p, static_cast<std::uint32_t>(current.score));
+        p = put32(p, static_cast<std::uint32_t>(current.level));
+        p = put32(p, static_cast<std::uint32_t>(current.lines));
+        p = put32(p, static_cast<std::uint32_t>(current.pieceCount));
+    }
+    if (mask & DeltaStatus) {
+        *p++ = statusBits(current);
+        *p++ = current.pendingGarbage;
+    }
+    return finishMessage(out, ServerMessageType::Delta, p);
+}
+
+std::size_t encodeKeyframe(std::uint32_t session, const TetrisEngine::State &state, std::uint8_t *out)
+{
+    const std::size_t size = encodeDelta(session, state, state, true, out);
+    out[2] = static_cast<std::uint8_t>(ServerMessageType::Keyframe);
+    return size;
+}
+
+bool applyDelta(const std::uint8_t *payload, std::size_t size, std::uint32_t &session, TetrisEngine::State &state)
+{
+    if (size < 8) {
+        return false;
+    }
+    session = get32(payload);
+    const std::uint32_t mask = get32(payload + 4);
+    if (mask & ~std::uint32_t(DeltaAll)) {
+        return false;
+    }
+
+    // 先按掩码算出应有的长度，再逐项读取
+    std::size_t expected = 8 + 2 * static_cast<std::size_t>(std::popcount(mask & DeltaRows));
+    if (mask & DeltaPiece) expected += 4;
+    if (mask & DeltaQueue) expected += TetrisEngine::QUEUE_SIZE;
+    if (mask & DeltaStats) expected += 16;
+    if (mask & DeltaStatus) expected += 2;
+    if (size != expected) {
+        return false;
+    }
+
+    const std::uint8_t *p = payload + 8;
+    for (int y = 0; y < TetrisEngine::BOARD_HEIGHT; ++y) {
+        if (mask & (1u << y)) {
+            state.rows[y] = get16(p) & TetrisEngine::FULL_ROW;
+            p += 2;
+        }
+    }
+    if (mask & DeltaPiece) {
+        state.pieceX = static_cast<std::int8_t>(p[0]);
+        state.pieceY = static_cast<std::int8_t>(p[1]);
+        state.currentTetromino = static_cast<Tetromino>(p[2] % TETROMINO_COUNT);
+        state.currentRotation = static_cast<Rotation>(p[3] % ROTATION_COUNT);
+        p += 4;
+    }
+    if (mask & DeltaQueue) {
+        for (Tetromino &type : state.queue) {
+            type = static_cast<Tetromino>(*p++ % TETROMINO_COUNT);
+        }
+    }
+    if (mask & DeltaStats) {
+        state.score = static_cast<std::int32_t>(get32(p));
+        state.level = static_cast<std::int32_t>(get32(p + 4));
+        state.lines = static_cast<std::int32_t>(get32(p + 8));
+        state.pieceCount = static_cast<std::int32_t>(get32(p + 12));
+        p += 16;
+    }
+    if (mask & DeltaStatus) {
+        state.gameOver = (p[0] & 1) != 0;
+        state.gameStarted = (p[0] & 2) != 0;
+        state.pendingGarbage = p[1];
+    }
+    return true;
+}
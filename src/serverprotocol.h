@@ -0,0 +1,84 @@
+#ifndef SERVERPROTOCOL_H
+#define SERVERPROTOCOL_H
+
+#include "tetrisengine.h"
+#include "wireformat.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// 多会话服务器的线路格式，所有整数为小端
+//
+// 客户端 → 服务器：定长 8 字节命令 [类型][参数][0][0][会话编号 u32]
+// 服务器 → 客户端：[载荷长度 u16][类型 u8][载荷]
+//
+// 状态增量 Delta 的载荷为 [会话编号 u32][字段掩码 u32]，随后按掩码位从低到高
+// 依次给出变化的字段：
+//   位 0..19   对应行的掩码 u16
+//   DeltaPiece   方块 x i8, y i8, 种类 u8, 朝向 u8
+//   DeltaQueue   预览队列 5 × u8
+//   DeltaStats   分数、等级、行数、方块数 4 × i32
+//   DeltaStatus  状态位 u8（位0结束，位1已开始）, 待收垃圾行 u8
+// 新会话先发一条包含全部字段的增量，之后只发和上一次发出的状态相比变化的字段。
+// 观战广播用同样的载荷：Keyframe 包含全部字段，可以从它开始解码；其后的 Delta 相对前一条。
+
+enum class ClientCommandType : std::uint8_t {
+    Create = 1,     // 会话编号字段为种子（0 表示由服务器随机），回复 Created 和完整状态
+    Input = 2,      // 参数为 TetrisEngine::Input 位组合
+    Close = 3
+};
+
+struct ClientCommand {
+    ClientCommandType type;
+    std::uint8_t arg;
+    std::uint32_t session;
+};
+
+constexpr std::size_t COMMAND_SIZE = 8;
+using CommandPacket = std::array<std::uint8_t, COMMAND_SIZE>;
+
+CommandPacket encodeCommand(const ClientCommand &command);
+ClientCommand decodeCommand(const std::uint8_t *packet);
+
+enum class ServerMessageType : std::uint8_t {
+    Created = 1,    // 载荷：会话编号 u32
+    Delta = 2,
+    Closed = 3,     // 载荷：会话编号 u32
+    Rejected = 4,   // 载荷：会话编号 u32（创建失败时为 0）, 原因 u8
+    Keyframe = 5    // 载荷同 Delta，掩码为 DeltaAll
+};
+
+enum class RejectReason : std::uint8_t {
+    ServerFull = 1,
+    UnknownSession = 2,
+    BadCommand = 3
+};
+
+enum DeltaField : std::uint32_t {
+    DeltaRows = (1u << TetrisEngine::BOARD_HEIGHT) - 1,
+    DeltaPiece = 1u << 20,
+    DeltaQueue = 1u << 21,
+    DeltaStats = 1u << 22,
+    DeltaStatus = 1u << 23,
+    DeltaAll = DeltaRows | DeltaPiece | DeltaQueue | DeltaStats | DeltaStatus
+};
+
+constexpr std::size_t MESSAGE_HEADER_SIZE = WireFormat::HEADER_SIZE;
+// 最大的消息是完整增量：头 3 + 编号 4 + 掩码 4 + 行 40 + 方块 4 + 队列 5 + 统计 16 + 状态 2
+constexpr std::size_t MAX_MESSAGE_SIZE = 78;
+
+// 编码一条消息，返回总字节数（含消息头）；out 至少 MAX_MESSAGE_SIZE 字节
+std::size_t encodeSessionMessage(ServerMessageType type, std::uint32_t session, std::uint8_t *out);
+std::size_t encodeRejected(std::uint32_t session, RejectReason reason, std::uint8_t *out);
+
+// 编码 current 相对 sent 的增量，full 为真时给出全部字段；没有变化时返回 0
+std::size_t encodeDelta(std::uint32_t session, const TetrisEngine::State &sent,
+                        const TetrisEngine::State &current, bool full, std::uint8_t *out);
+
+// 编码包含全部字段的关键帧
+std::size_t encodeKeyframe(std::uint32_t session, const TetrisEngine::State &state, std::uint8_t *out);
+
+// 把增量或关键帧载荷（不含消息头）应用到 state，载荷不完整时返回 false
+bool applyDelta(const std::uint8_t *payload, std::size_t size, std::uint32_t &session, TetrisEngine::State &state);
+
+#endif // SERVERPROTOCOL_H
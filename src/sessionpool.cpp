@@ -0,0 +1,215 @@
+#include "sessionpool.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+constexpr std::uint32_t INDEX_MASK = (1u << SessionPool::INDEX_BITS) - 1;
+constexpr std::uint32_t GENERATION_LIMIT = 1u << (32 - SessionPool::INDEX_BITS);
+
+} // namespace
+
+SessionPool::SessionPool(int capacity)
+    : m_slots(static_cast<std::size_t>(std::clamp(capacity, 1, MAX_CAPACITY)))
+    , m_wheel(static_cast<std::uint32_t>(m_slots.size()))
+    , m_freeHead(0)
+    , m_size(0)
+    , m_maxLateness(0)
+    , m_dropCount(0)
+{
+    // 空闲槽位串成链表，按下标顺序分配
+    for (std::size_t i = 0; i < m_slots.size(); ++i) {
+        m_slots[i].generation = 0;
+        m_slots[i].nextFree = i + 1 < m_slots.size() ? static_cast<std::uint32_t>(i + 1) : NO_SLOT;
+        m_slots[i].scheduledLevel = 0;
+        m_slots[i].active = false;
+        m_slots[i].dirty = false;
+    }
+    m_dirty.reserve(m_slots.size());
+}
+
+SessionPool::SessionId SessionPool::create(std::uint64_t seed, std::uint64_t nowMs)
+{
+    if (m_freeHead == NO_SLOT) {
+        return INVALID_SESSION;
+    }
+
+    const std::uint32_t index = m_freeHead;
+    Slot &slot = m_slots[index];
+    m_freeHead = slot.nextFree;
+
+    // 代数从1开始循环，编号永远不为0
+    slot.generation = slot.generation % (GENERATION_LIMIT - 1) + 1;
+    slot.active = true;
+    slot.dirty = false;
+    slot.engine.reset(seed);
+    slot.engine.start();
+    ++m_size;
+
+    reschedule(index, nowMs);
+    markDirty(index);
+    return (slot.generation << INDEX_BITS) | index;
+}
+
+bool SessionPool::destroy(SessionId id)
+{
+    Slot *slot = find(id);
+    if (!slot) {
+        return false;
+    }
+
+    const std::uint32_t index = slotIndex(id);
+    m_wheel.cancel(index);
+    slot->active = false;
+    slot->nextFree = m_freeHead;
+    m_freeHead = index;
+    --m_size;
+    return true;
+}
+
+bool SessionPool::contains(SessionId id) const
+{
+    return find(id) != nullptr;
+}
+
+const TetrisEngine *SessionPool::engine(SessionId id) const
+{
+    const Slot *slot = find(id);
+    return slot ? &slot->engine : nullptr;
+}
+
+bool SessionPool::input(SessionId id, std::uint8_t inputs, std::uint64_t nowMs)
+{
+    Slot *slot = find(id);
+    if (!slot) {
+        return false;
+    }
+
+    // 与 TetrisEngine::tick 的输入处理顺序相同，但不推进重力计数
+    TetrisEngine &engine = slot->engine;
+    if (inputs & TetrisEngine::InputLeft) engine.moveLeft();
+    if (inputs & TetrisEngine::InputRight) engine.moveRight();
+    if (inputs & TetrisEngine::InputRotateCW) engine.rotate(RotationDirection::Clockwise);
+    if (inputs & TetrisEngine::InputRotateCCW) engine.rotate(RotationDirection::CounterClockwise);
+    if (inputs & TetrisEngine::InputRotate180) engine.rotate(RotationDirection::Half);
+    if (inputs & TetrisEngine::InputSoftDrop) engine.moveDown();
+    if (inputs & TetrisEngine::InputHardDrop) engine.hardDrop();
+
+    const std::uint32_t index = slotIndex(id);
+    if (engine.isGameOver()) {
+        m_wheel.cancel(index);
+    } else if (engine.getLevel() != slot->scheduledLevel) {
+        reschedule(index, nowMs);
+    }
+    markDirty(index);
+    return true;
+}
+
+void SessionPool::advance(std::uint64_t nowMs)
+{
+    m_wheel.advance(nowMs, [this, nowMs](std::uint32_t index, std::uint64_t dueMs) {
+        drop(index, dueMs, nowMs);
+    });
+}
+
+void SessionPool::takeDirty(std::vector<SessionId> &sessions)
+{
+    sessions.swap(m_dirty);
+    m_dirty.clear();
+    for (SessionId id : sessions) {
+        m_slots[slotIndex(id)].dirty = false;
+    }
+}
+
+std::uint32_t SessionPool::slotIndex(SessionId id)
+{
+    return id & INDEX_MASK;
+}
+
+int SessionPool::size() const
+{
+    return m_size;
+}
+
+int SessionPool::capacity() const
+{
+    return static_cast<int>(m_slots.size());
+}
+
+int SessionPool::scheduledCount() const
+{
+    return static_cast<int>(m_wheel.size());
+}
+
+std::uint64_t SessionPool::takeMaxLateness()
+{
+    const std::uint64_t lateness = m_maxLateness;
+    m_maxLateness = 0;
+    return lateness;
+}
+
+std::uint64_t SessionPool::dropCount() const
+{
+    return m_dropCount;
+}
+
+std::size_t SessionPool::memoryUsage() const
+{
+    return m_slots.capacity() * sizeof(Slot) + m_wheel.memoryUsage() + m_dirty.capacity() * sizeof(SessionId);
+}
+
+SessionPool::Slot *SessionPool::find(SessionId id)
+{
+    return const_cast<Slot *>(std::as_const(*this).find(id));
+}
+
+const SessionPool::Slot *SessionPool::find(SessionId id) const
+{
+    const std::uint32_t index = slotIndex(id);
+    if (index >= m_slots.size()) {
+        return nullptr;
+    }
+    const Slot &slot = m_slots[index];
+    return (slot.active && slot.generation == id >> INDEX_BITS) ? &slot : nullptr;
+}
+
+void SessionPool::markDirty(std::uint32_t index)
+{
+    Slot &slot = m_slots[index];
+    if (!slot.dirty) {
+        slot.dirty = true;
+        m_dirty.push_back((slot.generation << INDEX_BITS) | index);
+    }
+}
+
+void SessionPool::reschedule(std::uint32_t index, std::uint64_t fromMs)
+{
+    Slot &slot = m_slots[index];
+    slot.scheduledLevel = slot.engine.getLevel();
+    m_wheel.schedule(index, fromMs + TetrisEngine::dropIntervalMs(slot.scheduledLevel));
+}
+
+void SessionPool::drop(std::uint32_t index, std::uint64_t dueMs, std::uint64_t nowMs)
+{
+    Slot &slot = m_slots[index];
+    m_maxLateness = std::max(m_maxLateness, nowMs - dueMs);
+    ++m_dropCount;
+
+    slot.engine.moveDown();
+    markDirty(index);
+    if (slot.engine.isGameOver()) {
+        return;
+    }
+
+    // 按预定时间而不是实际触发时间排下一次，间隔不会累积漂移；
+    // 落后超过一个间隔（进程被挂起等）时不补发，从当前时间重新开始
+    if (slot.engine.getLevel() != slot.scheduledLevel) {
+        reschedule(index, nowMs);
+        return;
+    }
+    std::uint64_t next = dueMs + TetrisEngine::dropIntervalMs(slot.scheduledLevel);
+    if (next <= nowMs) {
+        next = nowMs + TetrisEngine::dropIntervalMs(slot.scheduledLevel);
+    }
+    m_wheel.schedule(index, next);
+}
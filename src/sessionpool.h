@@ -0,0 +1,79 @@
+#ifndef SESSIONPOOL_H
+#define SESSIONPOOL_H
+
+#include "tetrisengine.h"
+#include "timerwheel.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 同一进程内的大量独立对局：引擎按值存放在定长槽位数组中，
+// 所有会话的重力下落由一个时间轮调度，没有每局一个的 QObject 和定时器。
+//
+// 会话编号 = 代数 << INDEX_BITS | 槽位，槽位复用后代数加一，旧编号自然失效。
+// 容量在构造时确定，之后创建和销毁都不分配内存，内存占用与容量成正比。
+// 不依赖 Qt，只在一个线程中使用。
+class SessionPool
+{
+public:
+    using SessionId = std::uint32_t;
+    static constexpr SessionId INVALID_SESSION = 0;
+    static constexpr int INDEX_BITS = 20;
+    static constexpr int MAX_CAPACITY = 1 << INDEX_BITS;
+
+    explicit SessionPool(int capacity);
+
+    // 以给定种子开局并立即开始；已满时返回 INVALID_SESSION
+    SessionId create(std::uint64_t seed, std::uint64_t nowMs);
+    bool destroy(SessionId id);
+    bool contains(SessionId id) const;
+    const TetrisEngine *engine(SessionId id) const;
+
+    // 玩家输入（TetrisEngine::Input 位组合），立即生效，不推进重力
+    bool input(SessionId id, std::uint8_t inputs, std::uint64_t nowMs);
+
+    // 推进时钟：到期的会话各下落一格
+    void advance(std::uint64_t nowMs);
+
+    // 取出自上次调用以来状态可能变化的会话（可能含已销毁的编号）
+    void takeDirty(std::vector<SessionId> &sessions);
+
+    static std::uint32_t slotIndex(SessionId id);
+
+    int size() const;
+    int capacity() const;
+    // 还有重力下落排在时间轮上的会话数；为 0 时不必再推进时钟
+    int scheduledCount() const;
+    // 重力下落相对预定时间的最大延迟（毫秒），调用后清零
+    std::uint64_t takeMaxLateness();
+    std::uint64_t dropCount() const;
+    std::size_t memoryUsage() const;
+
+private:
+    struct Slot {
+        TetrisEngine engine;
+        std::uint32_t generation;
+        std::uint32_t nextFree;
+        std::int32_t scheduledLevel;    // 当前下落间隔对应的等级
+        bool active;
+        bool dirty;
+    };
+
+    static constexpr std::uint32_t NO_SLOT = 0xffffffffu;
+
+    Slot *find(SessionId id);
+    const Slot *find(SessionId id) const;
+    void markDirty(std::uint32_t index);
+    void reschedule(std::uint32_t index, std::uint64_t fromMs);
+    void drop(std::uint32_t index, std::uint64_t dueMs, std::uint64_t nowMs);
+
+    std::vector<Slot> m_slots;
+    TimerWheel m_wheel;
+    std::vector<SessionId> m_dirty;
+    std::uint32_t m_freeHead;
+    int m_size;
+    std::uint64_t m_maxLateness;
+    std::uint64_t m_dropCount;
+};
+
+#endif // SESSIONPOOL_H
@@ -0,0 +1,162 @@
+#include "spectatorfeed.h"
+#include "serverprotocol.h"
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <utility>
+
+SpectatorFeed::SpectatorFeed(TetrisGame *game, QObject *parent)
+    : QObject(parent)
+    , m_game(game)
+    , m_server(new QLocalServer(this))
+    , m_lastState{}
+    , m_skipCount(0)
+{
+    connect(m_server, &QLocalServer::newConnection, this, &SpectatorFeed::acceptSubscribers);
+    connect(m_game, &TetrisGame::stateChanged, this, &SpectatorFeed::broadcast);
+}
+
+SpectatorFeed::~SpectatorFeed()
+{
+    close();
+}
+
+bool SpectatorFeed::listen(const QString &name)
+{
+    close();
+    QLocalServer::removeServer(name);
+    if (!m_server->listen(name)) {
+        return false;
+    }
+
+    // 立即生成第一个关键帧，先连上的观战者不用等到下一次变化
+    broadcast();
+    return true;
+}
+
+void SpectatorFeed::close()
+{
+    m_server->close();
+    for (auto it = m_subscribers.begin(); it != m_subscribers.end(); ++it) {
+        it.key()->disconnect(this);
+        it.key()->disconnectFromServer();
+        it.key()->deleteLater();
+    }
+    m_subscribers.clear();
+    m_group.clear();
+}
+
+bool SpectatorFeed::isListening() const
+{
+    return m_server->isListening();
+}
+
+QString SpectatorFeed::errorString() const
+{
+    return m_server->errorString();
+}
+
+int SpectatorFeed::subscriberCount() const
+{
+    return int(m_subscribers.size());
+}
+
+int SpectatorFeed::skipCount() const
+{
+    return m_skipCount;
+}
+
+QString SpectatorFeed::defaultName()
+{
+    return QStringLiteral("tetris-spectate");
+}
+
+void SpectatorFeed::acceptSubscribers()
+{
+    while (QLocalSocket *socket = m_server->nextPendingConnection()) {
+        Subscriber &subscriber = m_subscribers[socket];
+        connect(socket, &QLocalSocket::disconnected, this, &SpectatorFeed::dropSubscriber);
+        connect(socket, &QLocalSocket::bytesWritten, this, &SpectatorFeed::pumpSubscriber);
+
+        // 当前这组消息以关键帧开头，排进队列后观战者就能立即还原画面
+        for (const QByteArray &message : std::as_const(m_group)) {
+            subscriber.queue.enqueue(message);
+            subscriber.queuedBytes += message.size();
+        }
+        pump(socket, subscriber);
+    }
+}
+
+void SpectatorFeed::dropSubscriber()
+{
+    auto *socket = qobject_cast<QLocalSocket *>(sender());
+    m_subscribers.remove(socket);
+    socket->deleteLater();
+}
+
+void SpectatorFeed::pumpSubscriber()
+{
+    auto *socket = qobject_cast<QLocalSocket *>(sender());
+    const auto it = m_subscribers.find(socket);
+    if (it != m_subscribers.end()) {
+        pump(socket, it.value());
+    }
+}
+
+void SpectatorFeed::broadcast()
+{
+    if (!m_server->isListening()) return;
+
+    const TetrisEngine::State state = m_game->engine().saveState();
+    const bool keyframe = m_group.isEmpty() || m_keyframeClock.elapsed() >= KEYFRAME_INTERVAL_MS;
+
+    std::uint8_t buffer[MAX_MESSAGE_SIZE];
+    std::size_t size;
+    if (keyframe) {
+        size = encodeKeyframe(0, state, buffer);
+        m_group.clear();
+        m_keyframeClock.start();
+    } else {
+        size = encodeDelta(0, m_lastState, state, false, buffer);
+        if (size == 0) return;
+    }
+    m_lastState = state;
+
+    // 只编码一次，之后各队列共享同一块数据
+    const QByteArray message(reinterpret_cast<const char *>(buffer), qsizetype(size));
+    m_group.append(message);
+    for (auto it = m_subscribers.begin(); it != m_subscribers.end(); ++it) {
+        enqueue(it.key(), it.value(), message, keyframe);
+    }
+}
+
+void SpectatorFeed::enqueue(QLocalSocket *socket, Subscriber &subscriber, const QByteArray &message, bool keyframe)
+{
+    if (subscriber.waitingForKeyframe) {
+        if (!keyframe) return;
+        subscriber.waitingForKeyframe = false;
+    }
+
+    if (subscriber.queuedBytes + message.size() > MAX_QUEUED_BYTES) {
+        // 跟不上：丢掉积压的增量，从下一个关键帧继续
+        subscriber.queue.clear();
+        subscriber.queuedBytes = 0;
+        ++m_skipCount;
+        if (!keyframe) {
+            subscriber.waitingForKeyframe = true;
+            return;
+        }
+    }
+
+    subscriber.queue.enqueue(message);
+    subscriber.queuedBytes += message.size();
+    pump(socket, subscriber);
+}
+
+void SpectatorFeed::pump(QLocalSocket *socket, Subscriber &subscriber)
+{
+    while (!subscriber.queue.isEmpty() && socket->bytesToWrite() < SOCKET_HIGH_WATER) {
+        const QByteArray message = subscriber.queue.dequeue();
+        subscriber.queuedBytes -= message.size();
+        socket->write(message);
+    }
+}
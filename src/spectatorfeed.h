@@ -0,0 +1,73 @@
+#ifndef SPECTATORFEED_H
+#define SPECTATORFEED_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QQueue>
+#include <QString>
+#include "tetrisgame.h"
+
+class QLocalServer;
+class QLocalSocket;
+
+// 观战广播：把一局进行中的游戏通过本地套接字推送给任意多个观战窗口
+//
+// 每次 stateChanged 编码一条消息（格式见 serverprotocol.h），每隔
+// KEYFRAME_INTERVAL_MS 发一个包含全部字段的关键帧，其余为相对上一条的增量。
+// 消息只编码一次，各订阅者的发送队列里放的是同一个 QByteArray 的引用。
+// 套接字缓冲超过高水位后消息留在队列里；队列也超过上限的订阅者丢掉
+// 积压的消息，直接从下一个关键帧继续，不会无限缓冲。
+class SpectatorFeed : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr qint64 KEYFRAME_INTERVAL_MS = 1000;
+    // 每个订阅者的套接字缓冲高水位和发送队列上限
+    static constexpr qint64 SOCKET_HIGH_WATER = 16 * 1024;
+    static constexpr qint64 MAX_QUEUED_BYTES = 64 * 1024;
+
+    explicit SpectatorFeed(TetrisGame *game, QObject *parent = nullptr);
+    ~SpectatorFeed();
+
+    bool listen(const QString &name);
+    void close();
+    bool isListening() const;
+    QString errorString() const;
+
+    int subscriberCount() const;
+    // 因跟不上而跳到下一个关键帧的次数
+    int skipCount() const;
+
+    static QString defaultName();
+
+private slots:
+    void acceptSubscribers();
+    void dropSubscriber();
+    void pumpSubscriber();
+    void broadcast();
+
+private:
+    struct Subscriber {
+        QQueue<QByteArray> queue;
+        qint64 queuedBytes = 0;
+        bool waitingForKeyframe = false;
+    };
+
+    void enqueue(QLocalSocket *socket, Subscriber &subscriber, const QByteArray &message, bool keyframe);
+    void pump(QLocalSocket *socket, Subscriber &subscriber);
+
+    TetrisGame *m_game;
+    QLocalServer *m_server;
+    QHash<QLocalSocket *, Subscriber> m_subscribers;
+
+    // 最近一个关键帧起的全部消息，新订阅者从这里开始
+    QList<QByteArray> m_group;
+    QElapsedTimer m_keyframeClock;
+    TetrisEngine::State m_lastState;
+    int m_skipCount;
+};
+
+#endif // SPECTATORFEED_H
@@ -0,0 +1,137 @@
+#include "spectatorwindow.h"
+#include "theme.h"
+#include "serverprotocol.h"
+#include "tetrisboard.h"
+#include <QLocalSocket>
+#include <QVBoxLayout>
+
+namespace {
+
+constexpr int RECONNECT_INTERVAL_MS = 1000;
+
+} // namespace
+
+SpectatorWindow::SpectatorWindow(const QString &feedName, QWidget *parent)
+    : QWidget(parent)
+    , m_feedName(feedName)
+    , m_socket(new QLocalSocket(this))
+    , m_reconnectTimer(new QTimer(this))
+    , m_state(m_engine.saveState())
+    , m_synced(false)
+{
+    setupUI();
+
+    connect(m_socket, &QLocalSocket::readyRead, this, &SpectatorWindow::readMessages);
+    connect(m_socket, &QLocalSocket::disconnected, this, &SpectatorWindow::handleDisconnected);
+    connect(m_socket, &QLocalSocket::errorOccurred, this, &SpectatorWindow::handleDisconnected);
+    connect(m_socket, &QLocalSocket::connected, this, &SpectatorWindow::updateStatus);
+
+    m_reconnectTimer->setSingleShot(true);
+    m_reconnectTimer->setInterval(RECONNECT_INTERVAL_MS);
+    connect(m_reconnectTimer, &QTimer::timeout, this, &SpectatorWindow::connectToFeed);
+
+    setWindowTitle(QString("俄罗斯方块 - 观战 (%1)").arg(m_feedName));
+    resize(500, 700);
+
+    connectToFeed();
+}
+
+SpectatorWindow::~SpectatorWindow()
+{
+    m_reconnectTimer->stop();
+}
+
+void SpectatorWindow::setupUI()
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    m_infoLabel = new QLabel(this);
+    Theme::setLabelStyle(m_infoLabel, 14, true, Theme::TEXT);
+
+    // 只显示，不接收按键
+    m_board = new TetrisBoard(nullptr, this);
+    m_board->setFocusPolicy(Qt::NoFocus);
+    m_board->setEngine(&m_engine);
+
+    m_statusLabel = new QLabel(this);
+    Theme::setLabelStyle(m_statusLabel, 12, false, Theme::SECONDARY_TEXT);
+
+    layout->addWidget(m_infoLabel);
+    layout->addWidget(m_board, 1);
+    layout->addWidget(m_statusLabel);
+
+    updateStatus();
+}
+
+void SpectatorWindow::connectToFeed()
+{
+    m_buffer.clear();
+    m_synced = false;
+    m_socket->abort();
+    m_socket->connectToServer(m_feedName, QIODevice::ReadOnly);
+    updateStatus();
+}
+
+void SpectatorWindow::readMessages()
+{
+    m_buffer.append(m_socket->readAll());
+
+    // 一次读到的多条消息全部应用后只刷新一次
+    bool changed = false;
+    qsizetype offset = 0;
+    while (m_buffer.size() - offset >= qsizetype(MESSAGE_HEADER_SIZE)) {
+        const auto *header = reinterpret_cast<const std::uint8_t *>(m_buffer.constData() + offset);
+        const qsizetype payloadSize = header[0] | (header[1] << 8);
+        if (m_buffer.size() - offset - qsizetype(MESSAGE_HEADER_SIZE) < payloadSize) break;
+
+        const auto type = static_cast<ServerMessageType>(header[2]);
+        const std::uint8_t *payload = header + MESSAGE_HEADER_SIZE;
+        offset += qsizetype(MESSAGE_HEADER_SIZE) + payloadSize;
+
+        // 关键帧从头还原；同步之前的增量没有基准，丢弃
+        if (type == ServerMessageType::Keyframe) {
+            m_synced = true;
+        } else if (type != ServerMessageType::Delta || !m_synced) {
+            continue;
+        }
+
+        std::uint32_t session;
+        if (!applyDelta(payload, std::size_t(payloadSize), session, m_state)) {
+            m_synced = false;
+            continue;
+        }
+        changed = true;
+    }
+    m_buffer.remove(0, offset);
+
+    if (changed && m_synced && TetrisEngine::isValidState(m_state)) {
+        m_engine.restoreState(m_state);
+        m_board->refresh();
+        updateStatus();
+    }
+}
+
+void SpectatorWindow::handleDisconnected()
+{
+    if (!m_reconnectTimer->isActive()) {
+        m_reconnectTimer->start();
+    }
+    updateStatus();
+}
+
+void SpectatorWindow::updateStatus()
+{
+    if (m_synced) {
+        m_infoLabel->setText(QString("分数: %1  等级: %2  行数: %3%4")
+                                 .arg(m_engine.getScore())
+                                 .arg(m_engine.getLevel())
+                                 .arg(m_engine.getLines())
+                                 .arg(m_engine.isGameOver() ? "  游戏结束" : ""));
+    } else {
+        m_infoLabel->setText("等待画面...");
+    }
+
+    const bool connected = m_socket->state() == QLocalSocket::ConnectedState;
+    m_statusLabel->setText(connected ? QString("已连接 %1").arg(m_feedName)
+                                     : QString("未连接 %1，正在重试").arg(m_feedName));
+}
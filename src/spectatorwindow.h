@@ -0,0 +1,48 @@
+#ifndef SPECTATORWINDOW_H
+#define SPECTATORWINDOW_H
+
+#include <QByteArray>
+#include <QLabel>
+#include <QString>
+#include <QTimer>
+#include <QWidget>
+#include "tetrisengine.h"
+
+class QLocalSocket;
+class TetrisBoard;
+
+// 观战窗口：连接 SpectatorFeed，按关键帧和增量还原对局状态，用 TetrisBoard 显示
+// 连接断开后每秒重连一次，对局重新开始或广播重启时自动跟上。
+class SpectatorWindow : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit SpectatorWindow(const QString &feedName, QWidget *parent = nullptr);
+    ~SpectatorWindow();
+
+private slots:
+    void connectToFeed();
+    void readMessages();
+    void handleDisconnected();
+
+private:
+    void setupUI();
+    void updateStatus();
+
+    QString m_feedName;
+    QLocalSocket *m_socket;
+    QTimer *m_reconnectTimer;
+    QByteArray m_buffer;
+
+    // 从关键帧开始还原的状态；收到第一个关键帧之前不显示
+    TetrisEngine m_engine;
+    TetrisEngine::State m_state;
+    bool m_synced;
+
+    TetrisBoard *m_board;
+    QLabel *m_infoLabel;
+    QLabel *m_statusLabel;
+};
+
+#endif // SPECTATORWINDOW_H
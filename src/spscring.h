@@ -0,0 +1,65 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+// 单生产者单消费者无锁环形缓冲
+//
+// 生产者只写 m_head，消费者只写 m_tail，两者各占一条缓存行。写入满时
+// 直接返回 false，由调用方决定丢弃，生产者永远不会等待。
+template <typename T, std::size_t Capacity>
+class SpscRing
+{
+    static_assert(std::is_trivially_copyable_v<T>, "元素按值复制");
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "容量必须是2的幂");
+
+public:
+    bool tryPush(const T &item)
+    {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_cachedTail == Capacity) {
+            // 本地缓存的读位置过期时才去读共享的 m_tail
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head - m_cachedTail == Capacity) {
+                return false;
+            }
+        }
+        m_items[head & (Capacity - 1)] = item;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 消费者一次取出最多 max 个元素，返回实际个数
+    std::size_t popBatch(T *out, std::size_t max)
+    {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        const std::size_t head = m_head.load(std::memory_order_acquire);
+        std::size_t count = head - tail;
+        if (count > max) count = max;
+        for (std::size_t i = 0; i < count; ++i) {
+            out[i] = m_items[(tail + i) & (Capacity - 1)];
+        }
+        m_tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    bool isEmpty() const
+    {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+private:
+    // 生产者一侧
+    alignas(64) std::atomic<std::size_t> m_head{0};
+    std::size_t m_cachedTail = 0;
+
+    // 消费者一侧
+    alignas(64) std::atomic<std::size_t> m_tail{0};
+
+    alignas(64) std::array<T, Capacity> m_items;
+};
+
+#endif // SPSCRING_H
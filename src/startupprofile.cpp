@@ -0,0 +1,66 @@
+#include "startupprofile.h"
+#include <QElapsedTimer>
+#include <QtGlobal>
+#include <cstdio>
+
+namespace StartupProfile {
+
+namespace {
+
+struct Mark {
+    const char *phase;
+    qint64 ns;
+};
+
+constexpr int MAX_MARKS = 16;
+
+QElapsedTimer g_clock;
+Mark g_marks[MAX_MARKS];
+int g_markCount = 0;
+qint64 g_firstFrameNs = -1;
+
+} // namespace
+
+void start()
+{
+    g_clock.start();
+    g_markCount = 0;
+    g_firstFrameNs = -1;
+}
+
+void mark(const char *phase)
+{
+    if (!g_clock.isValid() || g_markCount == MAX_MARKS) return;
+    g_marks[g_markCount++] = {phase, g_clock.nsecsElapsed()};
+}
+
+void markFirstFrame()
+{
+    if (!g_clock.isValid() || g_firstFrameNs >= 0) return;
+    g_firstFrameNs = g_clock.nsecsElapsed();
+
+    if (qEnvironmentVariableIsSet("TETRIS_STARTUP_PROFILE")) {
+        std::fputs(report().toLocal8Bit().constData(), stderr);
+    }
+}
+
+QString report()
+{
+    QString text;
+    qint64 previous = 0;
+    for (int i = 0; i < g_markCount; ++i) {
+        text += QString("%1: %2 ms (+%3 ms)\n")
+                    .arg(QString::fromUtf8(g_marks[i].phase))
+                    .arg(g_marks[i].ns / 1e6, 0, 'f', 1)
+                    .arg((g_marks[i].ns - previous) / 1e6, 0, 'f', 1);
+        previous = g_marks[i].ns;
+    }
+    if (g_firstFrameNs >= 0) {
+        text += QString("第一帧: %1 ms (+%2 ms)\n")
+                    .arg(g_firstFrameNs / 1e6, 0, 'f', 1)
+                    .arg((g_firstFrameNs - previous) / 1e6, 0, 'f', 1);
+    }
+    return text;
+}
+
+} // namespace StartupProfile
@@ -0,0 +1,23 @@
+#ifndef STARTUPPROFILE_H
+#define STARTUPPROFILE_H
+
+#include <QString>
+
+// 启动耗时：从 main() 开始计时，记录各阶段完成的时刻和第一帧棋盘绘制的时刻
+//
+// 设置环境变量 TETRIS_STARTUP_PROFILE 时，第一帧画出后把各阶段耗时输出到 stderr。
+// 只在主线程调用。
+namespace StartupProfile {
+
+void start();
+// phase 必须是字符串字面量；阶段数有上限，超出的忽略
+void mark(const char *phase);
+// 只有第一次调用有效
+void markFirstFrame();
+
+// 每行一个阶段：累计耗时和相对上一阶段的耗时
+QString report();
+
+} // namespace StartupProfile
+
+#endif // STARTUPPROFILE_H
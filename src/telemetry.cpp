@@ -0,0 +1,134 @@
+#include "telemetry.h"
+#include <QDir>
+#include <QFileInfo>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr char MAGIC[4] = {'T', 'T', 'E', 'L'};
+constexpr quint32 VERSION = 1;
+
+struct Header {
+    char magic[4];
+    quint32 version;
+    quint32 eventSize;
+    quint32 reserved;
+};
+
+// 写盘线程每批最多取出的事件数
+constexpr std::size_t BATCH_SIZE = 1024;
+// 缓冲为空时的等待间隔，连续为空时逐次加倍到上限（暂停时几乎不唤醒）
+constexpr unsigned long IDLE_MS = 20;
+constexpr unsigned long MAX_IDLE_MS = 1000;
+
+} // namespace
+
+static_assert(sizeof(TelemetryEvent) == 24);
+static_assert(std::is_trivially_copyable_v<TelemetryEvent>);
+
+Telemetry::Telemetry()
+    : m_ring(std::make_unique<SpscRing<TelemetryEvent, RING_CAPACITY>>())
+    , m_sequence(0)
+    , m_dropped(0)
+    , m_writerThread(nullptr)
+    , m_stopping(false)
+{
+}
+
+Telemetry::~Telemetry()
+{
+    close();
+}
+
+bool Telemetry::open(const QString &path)
+{
+    close();
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadWrite | QIODevice::Append)) {
+        return false;
+    }
+
+    // 新文件写入文件头；已有文件必须是相同格式才追加
+    if (m_file.size() == 0) {
+        Header header = {};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.eventSize = sizeof(TelemetryEvent);
+        if (m_file.write(reinterpret_cast<const char *>(&header), sizeof(header)) != qint64(sizeof(header))) {
+            m_file.close();
+            return false;
+        }
+    } else {
+        Header header;
+        m_file.seek(0);
+        const bool valid = m_file.read(reinterpret_cast<char *>(&header), sizeof(header)) == qint64(sizeof(header))
+                        && std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0
+                        && header.version == VERSION
+                        && header.eventSize == sizeof(TelemetryEvent);
+        if (!valid) {
+            m_file.close();
+            return false;
+        }
+    }
+
+    m_stopping = false;
+    m_writerThread = QThread::create([this]() { writerLoop(); });
+    m_writerThread->start(QThread::LowPriority);
+    return true;
+}
+
+void Telemetry::close()
+{
+    if (m_writerThread) {
+        m_stopping = true;
+        m_wake.release();
+        m_writerThread->wait();
+        delete m_writerThread;
+        m_writerThread = nullptr;
+    }
+    if (m_file.isOpen()) {
+        // 写盘线程已退出，剩余事件在这里写完
+        while (drain()) {
+        }
+        m_file.close();
+    }
+}
+
+bool Telemetry::isOpen() const
+{
+    return m_file.isOpen();
+}
+
+quint64 Telemetry::droppedCount() const
+{
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+void Telemetry::writerLoop()
+{
+    unsigned long idleMs = IDLE_MS;
+    while (!m_stopping.load(std::memory_order_relaxed)) {
+        if (drain()) {
+            idleMs = IDLE_MS;
+        } else {
+            // 关闭时立即醒来，不必等满间隔
+            m_wake.tryAcquire(1, int(idleMs));
+            idleMs = std::min(idleMs * 2, MAX_IDLE_MS);
+        }
+    }
+}
+
+bool Telemetry::drain()
+{
+    TelemetryEvent batch[BATCH_SIZE];
+    const std::size_t count = m_ring->popBatch(batch, BATCH_SIZE);
+    if (count == 0) {
+        m_file.flush();
+        return false;
+    }
+    m_file.write(reinterpret_cast<const char *>(batch), qint64(count * sizeof(TelemetryEvent)));
+    return true;
+}
@@ -0,0 +1,80 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <QFile>
+#include <QSemaphore>
+#include <QString>
+#include <QThread>
+#include <atomic>
+#include <memory>
+#include "spscring.h"
+
+// 遥测事件，定长24字节，按原样写入文件
+struct TelemetryEvent {
+    quint64 value;      // 附加值：开局为种子，锁定/消行/结束为分数
+    quint32 sequence;   // 连续递增，缺号表示缓冲满时丢弃了事件
+    quint32 timeMs;     // 游戏时长（不含暂停）
+    quint8 type;        // Telemetry::EventType
+    quint8 piece;       // Tetromino
+    quint8 rotation;    // Rotation
+    qint8 detail;       // 移动：方向；旋转：踢表序号；消行：行数；升级：新等级
+    qint8 x;
+    qint8 y;
+    quint16 reserved;
+};
+
+// 结构化遥测：游戏线程把事件写入无锁环形缓冲，后台线程批量写盘
+//
+// 记录一个事件只是一次定长结构体复制加两个原子操作，不加锁、不分配、
+// 不进行系统调用；缓冲满时丢弃事件并计数，游戏永远不会因为写盘而等待。
+// 文件格式：16字节文件头（"TTEL"、版本、事件大小）后接连续的事件。
+class Telemetry
+{
+public:
+    enum EventType : quint8 {
+        GameStart,
+        Spawn,
+        Move,
+        Rotate,
+        Lock,
+        LineClear,
+        LevelUp,
+        GameOver
+    };
+
+    static constexpr std::size_t RING_CAPACITY = 1 << 14;
+
+    Telemetry();
+    ~Telemetry();
+
+    // 追加写入到 path
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const;
+
+    // 只能在一个线程（游戏线程）中调用
+    inline void log(TelemetryEvent event)
+    {
+        event.sequence = m_sequence++;
+        if (!m_ring->tryPush(event)) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    quint64 droppedCount() const;
+
+private:
+    void writerLoop();
+    bool drain();
+
+    std::unique_ptr<SpscRing<TelemetryEvent, RING_CAPACITY>> m_ring;
+    quint32 m_sequence;
+    std::atomic<quint64> m_dropped;
+
+    QFile m_file;
+    QThread *m_writerThread;
+    std::atomic<bool> m_stopping;
+    QSemaphore m_wake;
+};
+
+#endif // TELEMETRY_H
@@ -1,181 +1,202 @@
 #include "tetrisboard.h"
 #include "tetrisgame.h"
+#include "boardanimation.h"
+#include "framescheduler.h"
+#include "startupprofile.h"
+#include "trace.h"
+#include <QElapsedTimer>
 #include <QPaintEvent>
 #include <QPainter>
-#include <QBrush>
-#include <QPen>
-#include <QColor>
-#include <QRect>
+#include <QVBoxLayout>
+
+#ifdef TETRIS_HAVE_QUICK
+#include "scenegraphboard.h"
+#include <QQuickWindow>
+#endif
+
+namespace {
+TetrisBoard::Renderer g_defaultRenderer = TetrisBoard::Renderer::Painter;
+}
 
 TetrisBoard::TetrisBoard(TetrisGame *game, QWidget *parent)
     : QWidget(parent)
     , m_game(game)
+    , m_engine(game ? &game->engine() : nullptr)
+    , m_shown{}
+    , m_shownValid(false)
+    , m_renderer(g_defaultRenderer)
+    , m_sceneWindow(nullptr)
+    , m_sceneItem(nullptr)
+    , m_animation(new BoardAnimation(this))
 {
     setMinimumSize(420, 550);
     setFocusPolicy(Qt::StrongFocus);
+
+    // 动画帧每一帧都有变化，不经过内容比较
+    connect(m_animation, &BoardAnimation::frameRequested, this, [this]() {
+        FrameScheduler::instance().requestFrame(this);
+    });
+
+    if (m_renderer == Renderer::SceneGraph) {
+        createSceneGraph();
+    }
 }
 
 TetrisBoard::~TetrisBoard()
 {
 }
 
-void TetrisBoard::setGame(TetrisGame *game)
+void TetrisBoard::setDefaultRenderer(Renderer renderer)
 {
-    m_game = game;
-    update();
+    g_defaultRenderer = isRendererAvailable(renderer) ? renderer : Renderer::Painter;
 }
 
-void TetrisBoard::paintEvent(QPaintEvent *event)
+TetrisBoard::Renderer TetrisBoard::defaultRenderer()
 {
-    Q_UNUSED(event);
-    
-    if (!m_game) {
-        return;
-    }
-
-    QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing);
+    return g_defaultRenderer;
+}
 
-    // 绘制背景
-    painter.fillRect(rect(), QColor(20, 20, 30));
+bool TetrisBoard::isRendererAvailable(Renderer renderer)
+{
+    if (renderer == Renderer::Painter) {
+        return true;
+    }
+#ifdef TETRIS_HAVE_QUICK
+    // Qt Quick 的 software 适配层不绘制自定义几何，只能走 RHI
+    return QQuickWindow::graphicsApi() != QSGRendererInterface::Software;
+#else
+    return false;
+#endif
+}
 
-    // 绘制游戏板
-    drawBoard(painter);
+TetrisBoard::Renderer TetrisBoard::renderer() const
+{
+    return m_renderer;
+}
 
-    // 绘制网格
-    drawGrid(painter);
+void TetrisBoard::createSceneGraph()
+{
+#ifdef TETRIS_HAVE_QUICK
+    m_sceneWindow = new QQuickWindow();
+    m_sceneWindow->setColor(QColor(20, 20, 30));
+    // 按键和鼠标仍由本控件处理
+    m_sceneWindow->setFlag(Qt::WindowTransparentForInput);
+
+    m_sceneItem = new SceneGraphBoardItem(m_sceneWindow->contentItem());
+    m_sceneItem->setEngine(m_engine);
+    connect(m_sceneWindow, &QQuickWindow::widthChanged, m_sceneItem, [this](int w) { m_sceneItem->setWidth(w); });
+    connect(m_sceneWindow, &QQuickWindow::heightChanged, m_sceneItem, [this](int h) { m_sceneItem->setHeight(h); });
+
+    QWidget *container = QWidget::createWindowContainer(m_sceneWindow, this);
+    container->setFocusPolicy(Qt::NoFocus);
+    auto *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(container);
+#else
+    m_renderer = Renderer::Painter;
+#endif
+}
 
-    // 绘制下一个方块
-    drawNextPiece(painter);
+TetrisBoard::VisibleState TetrisBoard::visibleState(const TetrisEngine &engine)
+{
+    VisibleState state;
+    for (int y = 0; y < TetrisEngine::BOARD_HEIGHT; ++y) {
+        state.rows[y] = engine.getRowMask(y);
+    }
+    state.pieceCount = engine.getPieceCount();
+    state.pieceX = engine.getPieceX();
+    state.pieceY = engine.getPieceY();
+    state.type = engine.getCurrentTetromino();
+    state.rotation = engine.getCurrentRotation();
+    state.next = engine.getNextTetromino();
+    state.active = engine.isGameStarted() && !engine.isGameOver();
+    return state;
 }
 
-void TetrisBoard::drawBoard(QPainter &painter)
+void TetrisBoard::refresh()
 {
-    if (!m_game) return;
-
-    const QVector<QVector<int>>& board = m_game->getBoard();
-    QVector<QPoint> currentPiece = m_game->getCurrentPiece();
-    QColor currentColor = m_game->getCurrentPieceColor();
-    QPoint currentPos = m_game->getCurrentPos();
-    QPoint shadowPos = m_game->getShadowPos();
-
-    // 绘制已放置的方块
-    for (int y = 0; y < board.size(); ++y) {
-        for (int x = 0; x < board[y].size(); ++x) {
-            if (board[y][x] != 0) {
-                QRect cell(x * cellSize(), y * cellSize(), cellSize(), cellSize());
-                painter.fillRect(cell, QColor(100, 100, 150));
-                painter.setPen(QColor(150, 150, 200));
-                painter.drawRect(cell);
-            }
+    // 画面没变（下落计时、对战帧推进、重复的状态通知）时不重绘，也不做动画快照
+    if (m_engine) {
+        const VisibleState state = visibleState(*m_engine);
+        if (m_shownValid && state == m_shown) {
+            FrameScheduler::instance().reportSkipped();
+            return;
         }
+        m_shown = state;
+        m_shownValid = true;
     }
 
-    // 绘制阴影（如果阴影位置与当前位置不同）
-    if (!m_game->isGameOver() && !currentPiece.isEmpty() && shadowPos != currentPos) {
-        drawShadow(painter, currentPiece, shadowPos, currentColor);
+#ifdef TETRIS_HAVE_QUICK
+    if (m_sceneItem) {
+        // 场景图自己按垂直同步合并更新
+        m_sceneItem->update();
+        return;
     }
-
-    // 绘制当前方块
-    if (!m_game->isGameOver() && !currentPiece.isEmpty()) {
-        drawPiece(painter, currentPiece, currentPos, currentColor);
+#endif
+    // 动画只在 QPainter 后端绘制
+    if (m_engine) {
+        m_animation->observe(*m_engine, m_game ? &m_game->lastLock() : nullptr);
     }
+    FrameScheduler::instance().requestFrame(this);
 }
 
-void TetrisBoard::drawPiece(QPainter &painter, const QVector<QPoint> &piece,
-                           const QPoint &pos, const QColor &color)
+void TetrisBoard::setGame(TetrisGame *game)
 {
-    for (const auto& point : piece) {
-        int x = (pos.x() + point.x()) * cellSize();
-        int y = (pos.y() + point.y()) * cellSize();
-        
-        QRect cell(x, y, cellSize(), cellSize());
-        
-        // 绘制方块主体
-        painter.fillRect(cell, color);
-        
-        // 绘制高光效果
-        painter.setPen(QColor(255, 255, 255, 100));
-        painter.drawLine(cell.topLeft(), cell.topRight());
-        painter.drawLine(cell.topLeft(), cell.bottomLeft());
-        
-        // 绘制阴影效果
-        painter.setPen(QColor(0, 0, 0, 100));
-        painter.drawLine(cell.bottomRight(), cell.bottomLeft());
-        painter.drawLine(cell.bottomRight(), cell.topRight());
-        
-        // 绘制边框
-        painter.setPen(QColor(0, 0, 0));
-        painter.drawRect(cell);
-    }
+    m_game = game;
+    m_engine = game ? &game->engine() : nullptr;
+    m_animation->reset();
+#ifdef TETRIS_HAVE_QUICK
+    if (m_sceneItem) m_sceneItem->setEngine(m_engine);
+#endif
+    m_shownValid = false;
+    refresh();
 }
 
-void TetrisBoard::drawShadow(QPainter &painter, const QVector<QPoint> &piece,
-                            const QPoint &pos, const QColor &color)
+void TetrisBoard::setEngine(const TetrisEngine *engine)
 {
-    for (const auto& point : piece) {
-        int x = (pos.x() + point.x()) * cellSize();
-        int y = (pos.y() + point.y()) * cellSize();
-        
-        QRect cell(x, y, cellSize(), cellSize());
-        
-        // 绘制半透明阴影
-        QColor shadowColor = color;
-        shadowColor.setAlpha(80);
-        painter.fillRect(cell, shadowColor);
-        
-        // 绘制虚线边框
-        QPen pen(QColor(255, 255, 255, 150), 1);
-        pen.setStyle(Qt::DashLine);
-        painter.setPen(pen);
-        painter.drawRect(cell);
-    }
+    m_game = nullptr;
+    m_engine = engine;
+    m_animation->reset();
+#ifdef TETRIS_HAVE_QUICK
+    if (m_sceneItem) m_sceneItem->setEngine(m_engine);
+#endif
+    m_shownValid = false;
+    refresh();
 }
 
-void TetrisBoard::drawGrid(QPainter &painter)
+void TetrisBoard::paintEvent(QPaintEvent *event)
 {
-    painter.setPen(QPen(QColor(50, 50, 70), 1));
-
-    // 绘制垂直线
-    for (int x = 0; x <= boardWidth(); ++x) {
-        painter.drawLine(x * cellSize(), 0, x * cellSize(), boardHeight() * cellSize());
+    TRACE_SCOPE("TetrisBoard::paintEvent");
+    Q_UNUSED(event);
+    
+    // 场景图后端由子窗口绘制
+    if (!m_engine || m_renderer == Renderer::SceneGraph) {
+        return;
     }
 
-    // 绘制水平线
-    for (int y = 0; y <= boardHeight(); ++y) {
-        painter.drawLine(0, y * cellSize(), boardWidth() * cellSize(), y * cellSize());
+    QElapsedTimer timer;
+    timer.start();
+    QPainter painter(this);
+    if (!m_animation->isAnimating()) {
+        m_painter.paint(painter, *m_engine, size(), devicePixelRatioF());
+        FrameScheduler::instance().reportPaint(timer.nsecsElapsed());
+        StartupProfile::markFirstFrame();
+        return;
     }
-}
 
-void TetrisBoard::drawNextPiece(QPainter &painter)
-{
-    if (!m_game) return;
-
-    QVector<QPoint> nextPiece = m_game->getNextPiece();
-    QColor nextColor = m_game->getNextPieceColor();
-
-    if (nextPiece.isEmpty()) return;
-
-    // 计算下一个方块的显示位置
-    int startX = boardWidth() * cellSize() + 20;
-    int startY = 50;
-
-    // 绘制标签
-    painter.setPen(QColor(255, 255, 255));
-    painter.setFont(QFont("Arial", 12, QFont::Bold));
-    painter.drawText(startX, startY - 10, "下一个:");
-
-    // 绘制下一个方块
-    for (const auto& point : nextPiece) {
-        int x = startX + point.x() * nextPieceSize();
-        int y = startY + point.y() * nextPieceSize();
-        
-        QRect cell(x, y, nextPieceSize(), nextPieceSize());
-        
-        painter.fillRect(cell, nextColor);
-        painter.setPen(QColor(0, 0, 0));
-        painter.drawRect(cell);
+    // 动画帧：检查绘制预算
+    const qreal ratio = devicePixelRatioF();
+    if (m_animation->isClearing()) {
+        m_painter.paint(painter, *m_engine, size(), ratio, [this, ratio](QPainter &p, int cell) {
+            m_animation->paintRows(p, cell, ratio);
+        });
+    } else {
+        m_painter.paint(painter, *m_engine, size(), ratio);
     }
+    m_animation->paintOverlay(painter, BoardPainter::cellSize(size()));
+    const qint64 elapsed = timer.nsecsElapsed();
+    m_animation->reportPaintTime(elapsed);
+    FrameScheduler::instance().reportPaint(elapsed);
 }
 
 void TetrisBoard::keyPressEvent(QKeyEvent *event)
@@ -203,7 +224,7 @@ void TetrisBoard::keyPressEvent(QKeyEvent *event)
             m_game->moveDown();
             break;
         case Qt::Key_Up:
-            m_game->rotate();
+            m_game->rotate(RotationDirection::Clockwise);
             break;
         case Qt::Key_Space:
             m_game->hardDrop();
@@ -219,30 +240,17 @@ void TetrisBoard::keyPressEvent(QKeyEvent *event)
             m_game->moveDown();
             break;
         case Qt::Key_K:
-            m_game->rotate();
+            m_game->rotate(RotationDirection::Clockwise);
+            break;
+        // 逆时针 / 180度旋转
+        case Qt::Key_Z:
+            m_game->rotate(RotationDirection::CounterClockwise);
+            break;
+        case Qt::Key_A:
+            m_game->rotate(RotationDirection::Half);
             break;
         default:
             QWidget::keyPressEvent(event);
             break;
     }
 }
-
-int TetrisBoard::cellSize() const
-{
-    return qMin(width() / (boardWidth() + 4), height() / boardHeight());
-}
-
-int TetrisBoard::boardWidth() const
-{
-    return 10;
-}
-
-int TetrisBoard::boardHeight() const
-{
-    return 20;
-}
-
-int TetrisBoard::nextPieceSize() const
-{
-    return cellSize();
-}
\ No newline at end of file
@@ -5,40 +5,81 @@
 #include <QPainter>
 #include <QKeyEvent>
 #include <QTimer>
+#include <array>
+#include "boardpainter.h"
+#include "tetrisengine.h"
 
 class TetrisGame;
+class QQuickWindow;
+class SceneGraphBoardItem;
+class BoardAnimation;
 
 class TetrisBoard : public QWidget
 {
     Q_OBJECT
 
 public:
+    // 渲染后端：立即模式 QPainter，或批量提交的 Qt Quick 场景图
+    enum class Renderer {
+        Painter,
+        SceneGraph
+    };
+
     explicit TetrisBoard(TetrisGame *game, QWidget *parent = nullptr);
     ~TetrisBoard();
 
+    // 启动时选择后端，之后创建的棋盘都使用它；场景图不可用时退回 QPainter
+    static void setDefaultRenderer(Renderer renderer);
+    static Renderer defaultRenderer();
+    static bool isRendererAvailable(Renderer renderer);
+    Renderer renderer() const;
+
     void setGame(TetrisGame *game);
 
+    // 只显示引擎状态、不处理按键（对战模式中显示各方的棋盘）
+    void setEngine(const TetrisEngine *engine);
+
+public slots:
+    // 按当前后端请求重绘；画面内容没有变化时跳过，变化时由帧调度合并到下一个刷新时刻
+    void refresh();
+
 protected:
     void paintEvent(QPaintEvent *event) override;
     void keyPressEvent(QKeyEvent *event) override;
 
 private:
+    // 决定画面的引擎状态，阴影由棋盘和方块决定，不必单独比较
+    struct VisibleState {
+        std::array<quint16, TetrisEngine::BOARD_HEIGHT> rows;
+        int pieceCount;
+        int pieceX;
+        int pieceY;
+        Tetromino type;
+        Rotation rotation;
+        Tetromino next;
+        bool active;
+
+        bool operator==(const VisibleState &other) const = default;
+    };
+
+    static VisibleState visibleState(const TetrisEngine &engine);
+
     TetrisGame *m_game;
+    const TetrisEngine *m_engine;
+
+    // 最近一次请求重绘时的画面，切换引擎后作废
+    VisibleState m_shown;
+    bool m_shownValid;
+
+    // 场景图后端（仅 Renderer::SceneGraph）
+    Renderer m_renderer;
+    QQuickWindow *m_sceneWindow;
+    SceneGraphBoardItem *m_sceneItem;
+    void createSceneGraph();
 
-    // 绘制相关
-    void drawBoard(QPainter &painter);
-    void drawPiece(QPainter &painter, const QVector<QPoint> &piece,
-                   const QPoint &pos, const QColor &color);
-    void drawShadow(QPainter &painter, const QVector<QPoint> &piece,
-                    const QPoint &pos, const QColor &color);
-    void drawGrid(QPainter &painter);
-    void drawNextPiece(QPainter &painter);
-
-    // 尺寸计算
-    int cellSize() const;
-    int boardWidth() const;
-    int boardHeight() const;
-    int nextPieceSize() const;
+    // QPainter 后端，带缓存图层和消行/锁定动画
+    BoardPainter m_painter;
+    BoardAnimation *m_animation;
 };
 
 #endif // TETRISBOARD_H
\ No newline at end of file
@@ -0,0 +1,808 @@
+#include "tetrisengine.h"
+#include "rotationsystem.h"
+#include "trace.h"
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable_v<TetrisEngine>,
+              "TetrisEngine 必须可按字节复制，回滚和快照依赖这一点");
+static_assert(std::is_trivially_copyable_v<TetrisEngine::State>
+              && std::has_unique_object_representations_v<TetrisEngineBase::State>,
+              "State 不能含有隐式填充，存档和校验按字节进行");
+static_assert(sizeof(TetrisEngine::State) == 104, "State 布局改变时需要同步存档格式版本");
+
+namespace {
+
+// 消除行数对应发送给对手的垃圾行数
+constexpr int ATTACK_LINES[] = {0, 0, 1, 2, 4};
+
+int rotationSystemIndex(const RotationSystem *system)
+{
+    const auto systems = RotationSystem::available();
+    for (std::size_t i = 0; i < systems.size(); ++i) {
+        if (systems[i] == system) {
+            return static_cast<int>(i);
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+TetrisEngineBase::TetrisEngineBase()
+{
+    m_state.rotationSystem = 0;
+    m_state.randomizer = Randomizer::Uniform;
+    reset(0);
+}
+
+void TetrisEngineBase::reset(std::uint64_t seed)
+{
+    m_state.rows.fill(0);
+
+    // 方块序列与垃圾行缺口使用独立的随机流，收到垃圾行不会改变后续方块
+    m_state.seed = seed;
+    m_state.pieceRng = seed;
+    m_state.garbageRng = seed ^ 0x9e3779b97f4a7c15ull;
+
+    m_state.score = 0;
+    m_state.level = 1;
+    m_state.lines = 0;
+    m_state.pieceCount = 0;
+    m_state.gravityTicks = 0;
+
+    m_state.pieceX = 0;
+    m_state.pieceY = 0;
+    m_state.currentTetromino = Tetromino::I;
+    m_state.currentRotation = Rotation::North;
+
+    m_state.pendingGarbage = 0;
+    m_state.outgoingGarbage = 0;
+    m_state.gameOver = false;
+    m_state.gameStarted = false;
+    m_state.lastKick = -1;
+    m_state.bagRemaining = 0;
+    m_state.combo = 0;
+    m_state.ruleFlags = 0;
+    std::fill(std::begin(m_state.reserved), std::end(m_state.reserved), 0);
+
+    for (Tetromino &type : m_state.queue) {
+        type = randomTetromino();
+    }
+    m_features = computeFeatures(m_state.rows);
+}
+
+TetrisEngineBase::State TetrisEngineBase::saveState() const
+{
+    return m_state;
+}
+
+void TetrisEngineBase::restoreState(const State &state)
+{
+    m_state = state;
+    m_features = computeFeatures(m_state.rows);
+}
+
+bool TetrisEngineBase::isValidState(const State &state)
+{
+    for (std::uint16_t row : state.rows) {
+        if (row & ~FULL_ROW) return false;
+    }
+    for (Tetromino type : state.queue) {
+        if (static_cast<int>(type) >= TETROMINO_COUNT) return false;
+    }
+    return static_cast<int>(state.currentTetromino) < TETROMINO_COUNT
+        && static_cast<int>(state.currentRotation) < ROTATION_COUNT
+        && state.rotationSystem < RotationSystem::available().size()
+        && static_cast<int>(state.randomizer) < RANDOMIZER_COUNT
+        && (state.bagRemaining >> TETROMINO_COUNT) == 0
+        && state.level >= 1 && state.score >= 0 && state.lines >= 0 && state.pieceCount >= 0
+        && state.pieceX > -4 && state.pieceX < BOARD_WIDTH
+        && state.pieceY > -4 && state.pieceY < BOARD_HEIGHT
+        && state.pendingGarbage <= BOARD_HEIGHT && state.outgoingGarbage <= BOARD_HEIGHT;
+}
+
+void TetrisEngineBase::start()
+{
+    m_state.gameStarted = true;
+    spawnPiece();
+}
+
+bool TetrisEngineBase::moveLeft()
+{
+    if (m_state.gameOver || !m_state.gameStarted) return false;
+    if (checkCollision(m_state.currentTetromino, m_state.currentRotation, m_state.pieceX - 1, m_state.pieceY)) {
+        return false;
+    }
+    --m_state.pieceX;
+    m_state.ruleFlags &= ~LastMoveRotate;
+    return true;
+}
+
+bool TetrisEngineBase::moveRight()
+{
+    if (m_state.gameOver || !m_state.gameStarted) return false;
+    if (checkCollision(m_state.currentTetromino, m_state.currentRotation, m_state.pieceX + 1, m_state.pieceY)) {
+        return false;
+    }
+    ++m_state.pieceX;
+    m_state.ruleFlags &= ~LastMoveRotate;
+    return true;
+}
+
+bool TetrisEngineBase::stepDown()
+{
+    // 下方被挡住时不移动，由调用方锁定
+    if (checkCollision(m_state.currentTetromino, m_state.currentRotation, m_state.pieceX, m_state.pieceY + 1)) {
+        return false;
+    }
+    ++m_state.pieceY;
+    m_state.ruleFlags &= ~LastMoveRotate;
+    return true;
+}
+
+bool TetrisEngineBase::rotate(RotationDirection direction)
+{
+    if (m_state.gameOver || !m_state.gameStarted) return false;
+
+    // O方块不需要旋转
+    if (m_state.currentTetromino == Tetromino::O) {
+        return false;
+    }
+
+    const Rotation newRotation = rotated(m_state.currentRotation, direction);
+    const auto kicks = rotationSystem()->kicks(m_state.currentTetromino, m_state.currentRotation, direction);
+    for (std::size_t i = 0; i < kicks.size(); ++i) {
+        const int x = m_state.pieceX + kicks[i].x;
+        const int y = m_state.pieceY + kicks[i].y;
+        if (!checkCollision(m_state.currentTetromino, newRotation, x, y)) {
+            m_state.pieceX = static_cast<std::int8_t>(x);
+            m_state.pieceY = static_cast<std::int8_t>(y);
+            m_state.currentRotation = newRotation;
+            m_state.lastKick = static_cast<std::int8_t>(i);
+            m_state.ruleFlags |= LastMoveRotate;
+            if (direction == RotationDirection::Half) {
+                m_state.ruleFlags |= LastRotateHalf;
+            } else {
+                m_state.ruleFlags &= ~LastRotateHalf;
+            }
+            return true;
+        }
+    }
+
+    // 所有墙踢都失败，不旋转
+    return false;
+}
+
+void TetrisEngineBase::dropToShadow()
+{
+    const int shadowY = getShadowY();
+    if (shadowY != m_state.pieceY) {
+        m_state.pieceY = static_cast<std::int8_t>(shadowY);
+        m_state.ruleFlags &= ~LastMoveRotate;
+    }
+}
+
+void TetrisEngineBase::queueGarbage(int lines)
+{
+    m_state.pendingGarbage = static_cast<std::uint8_t>(std::clamp(m_state.pendingGarbage + lines, 0, BOARD_HEIGHT));
+}
+
+int TetrisEngineBase::takeOutgoingGarbage()
+{
+    const int lines = m_state.outgoingGarbage;
+    m_state.outgoingGarbage = 0;
+    return lines;
+}
+
+int TetrisEngineBase::getPendingGarbage() const
+{
+    return m_state.pendingGarbage;
+}
+
+void TetrisEngineBase::setRotationSystem(const RotationSystem *system)
+{
+    m_state.rotationSystem = static_cast<std::uint8_t>(rotationSystemIndex(system));
+}
+
+const RotationSystem *TetrisEngineBase::rotationSystem() const
+{
+    return RotationSystem::available()[m_state.rotationSystem];
+}
+
+void TetrisEngineBase::setRandomizer(Randomizer randomizer)
+{
+    m_state.randomizer = randomizer;
+}
+
+TetrisEngineBase::Randomizer TetrisEngineBase::randomizer() const
+{
+    return m_state.randomizer;
+}
+
+bool TetrisEngineBase::isGameOver() const
+{
+    return m_state.gameOver;
+}
+
+bool TetrisEngineBase::isGameStarted() const
+{
+    return m_state.gameStarted;
+}
+
+int TetrisEngineBase::getScore() const
+{
+    return m_state.score;
+}
+
+int TetrisEngineBase::getLevel() const
+{
+    return m_state.level;
+}
+
+int TetrisEngineBase::getLines() const
+{
+    return m_state.lines;
+}
+
+int TetrisEngineBase::getPieceCount() const
+{
+    return m_state.pieceCount;
+}
+
+int TetrisEngineBase::getCombo() const
+{
+    return m_state.combo;
+}
+
+bool TetrisEngineBase::isBackToBack() const
+{
+    return m_state.ruleFlags & BackToBack;
+}
+
+bool TetrisEngineBase::isGoalReached() const
+{
+    return m_state.ruleFlags & GoalReached;
+}
+
+std::uint64_t TetrisEngineBase::getSeed() const
+{
+    return m_state.seed;
+}
+
+int TetrisEngineBase::getLastKick() const
+{
+    return m_state.lastKick;
+}
+
+std::uint16_t TetrisEngineBase::getRowMask(int y) const
+{
+    if (y < 0 || y >= BOARD_HEIGHT) return 0;
+    return m_state.rows[y];
+}
+
+bool TetrisEngineBase::isCellFilled(int x, int y) const
+{
+    if (x < 0 || x >= BOARD_WIDTH) return false;
+    return (getRowMask(y) >> x) & 1u;
+}
+
+Tetromino TetrisEngineBase::getCurrentTetromino() const
+{
+    return m_state.currentTetromino;
+}
+
+Rotation TetrisEngineBase::getCurrentRotation() const
+{
+    return m_state.currentRotation;
+}
+
+int TetrisEngineBase::getPieceX() const
+{
+    return m_state.pieceX;
+}
+
+int TetrisEngineBase::getPieceY() const
+{
+    return m_state.pieceY;
+}
+
+int TetrisEngineBase::getShadowY() const
+{
+    // 当前位置合法时最多下移 BOARD_HEIGHT 次就会触底
+    int y = m_state.pieceY;
+    for (int i = 0; i < BOARD_HEIGHT + 4; ++i) {
+        if (checkCollision(m_state.currentTetromino, m_state.currentRotation, m_state.pieceX, y + 1)) {
+            break;
+        }
+        ++y;
+    }
+    return y;
+}
+
+Tetromino TetrisEngineBase::getNextTetromino() const
+{
+    return m_state.queue[0];
+}
+
+Tetromino TetrisEngineBase::getQueuedTetromino(int index) const
+{
+    return m_state.queue[std::clamp(index, 0, QUEUE_SIZE - 1)];
+}
+
+const TetrisEngineBase::Features &TetrisEngineBase::getFeatures() const
+{
+    return m_features;
+}
+
+TetrisEngineBase::Features TetrisEngineBase::computeFeatures(const std::array<std::uint16_t, BOARD_HEIGHT> &rows)
+{
+    Features features{};
+
+    // 自上而下扫描：covered 为上方已有方块的列，其下的空格即为空洞
+    std::uint16_t covered = 0;
+    for (int y = 0; y < BOARD_HEIGHT; ++y) {
+        const std::uint16_t row = rows[y];
+        features.holes += static_cast<std::int16_t>(std::popcount<unsigned>(covered & ~row & FULL_ROW));
+        features.rowTransitions += static_cast<std::int16_t>(rowTransitions(row));
+
+        for (unsigned top = row & ~covered & FULL_ROW; top; top &= top - 1) {
+            features.columnHeights[std::countr_zero(top)] = static_cast<std::uint8_t>(BOARD_HEIGHT - y);
+        }
+        covered |= row;
+    }
+
+    features.columnTransitions = static_cast<std::int16_t>(columnTransitions(rows));
+    for (int x = 0; x < BOARD_WIDTH; ++x) {
+        features.columnWells[x] = static_cast<std::uint8_t>(columnWellSum(rows, x));
+        features.wells += features.columnWells[x];
+    }
+
+    updateHeightSums(features);
+    return features;
+}
+
+bool TetrisEngineBase::checkCollision(Tetromino type, Rotation rotation, int x, int y) const
+{
+    // 包围盒完全在左右边界之外时必然碰撞，同时保证下面的移位合法
+    if (x <= -4 || x >= BOARD_WIDTH) {
+        return true;
+    }
+
+    const PieceMasks &masks = tetrominoMasks(type, rotation);
+    for (int row = 0; row < 4; ++row) {
+        const std::uint32_t mask = masks[row];
+        if (mask == 0) continue;
+
+        // 检查上下边界
+        const int boardY = y + row;
+        if (boardY < 0 || boardY >= BOARD_HEIGHT) {
+            return true;
+        }
+
+        // 移出左边界的格子在右移时会被丢弃，需要单独检查
+        std::uint32_t shifted;
+        if (x < 0) {
+            if (mask & ((1u << -x) - 1)) {
+                return true;
+            }
+            shifted = mask >> -x;
+        } else {
+            shifted = mask << x;
+        }
+
+        // 超出右边界或与已放置的方块碰撞
+        if ((shifted & ~std::uint32_t(FULL_ROW)) || (shifted & m_state.rows[boardY])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::uint64_t TetrisEngineBase::nextRandom(std::uint64_t &state)
+{
+    // splitmix64
+    std::uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+Tetromino TetrisEngineBase::randomTetromino()
+{
+    const std::uint64_t value = nextRandom(m_state.pieceRng) >> 32;
+    if (m_state.randomizer == Randomizer::Uniform) {
+        return static_cast<Tetromino>((value * TETROMINO_COUNT) >> 32);
+    }
+
+    // 7-bag：从袋中剩余的方块里均匀取一个，袋空时重新装满
+    if (m_state.bagRemaining == 0) {
+        m_state.bagRemaining = (1u << TETROMINO_COUNT) - 1;
+    }
+    unsigned remaining = m_state.bagRemaining;
+    for (auto pick = (value * std::popcount(remaining)) >> 32; pick > 0; --pick) {
+        remaining &= remaining - 1;
+    }
+    const int type = std::countr_zero(remaining);
+    m_state.bagRemaining = static_cast<std::uint8_t>(m_state.bagRemaining & ~(1u << type));
+    return static_cast<Tetromino>(type);
+}
+
+void TetrisEngineBase::spawnPiece()
+{
+    TRACE_SCOPE("TetrisEngine::spawnPiece");
+    m_state.currentTetromino = m_state.queue[0];
+    m_state.currentRotation = Rotation::North;
+
+    // SRS出生位置：包围盒左上角位于第4列，I方块的格子在包围盒第二行，上移一行使其贴顶
+    m_state.pieceX = BOARD_WIDTH / 2 - 2;
+    m_state.pieceY = (m_state.currentTetromino == Tetromino::I) ? -1 : 0;
+
+    std::copy(m_state.queue.begin() + 1, m_state.queue.end(), m_state.queue.begin());
+    m_state.queue[QUEUE_SIZE - 1] = randomTetromino();
+    m_state.gravityTicks = 0;
+    m_state.ruleFlags &= ~LastMoveRotate;
+
+    // 检查游戏结束
+    if (checkCollision(m_state.currentTetromino, m_state.currentRotation, m_state.pieceX, m_state.pieceY)) {
+        m_state.gameOver = true;
+    }
+}
+
+TSpin TetrisEngineBase::detectTSpin() const
+{
+    // 三角判定：T 方块以旋转结束移动，3x3 包围盒的四个角至少有三个被占（墙和底算占用）；
+    // 朝向一侧的两个角都被占为完整 T-spin，否则为 mini；90 度旋转用到 SRS 最后一个踢位（TST 踢）
+    // 视为完整，180 度踢表的序号 4 只是普通的横向踢，不算
+    if (m_state.currentTetromino != Tetromino::T || !(m_state.ruleFlags & LastMoveRotate)) {
+        return TSpin::None;
+    }
+
+    auto occupied = [this](int dx, int dy) {
+        const int x = m_state.pieceX + dx;
+        const int y = m_state.pieceY + dy;
+        if (x < 0 || x >= BOARD_WIDTH || y >= BOARD_HEIGHT) return true;
+        return y >= 0 && ((m_state.rows[y] >> x) & 1u);
+    };
+    // 角的顺序：左上、右上、右下、左下；朝向 r 的正面是第 r 和 r+1 个角
+    const bool corners[4] = {occupied(0, 0), occupied(2, 0), occupied(2, 2), occupied(0, 2)};
+    if (corners[0] + corners[1] + corners[2] + corners[3] < 3) {
+        return TSpin::None;
+    }
+
+    const int facing = static_cast<int>(m_state.currentRotation);
+    const bool tstKick = m_state.lastKick == 4 && !(m_state.ruleFlags & LastRotateHalf);
+    if ((corners[facing] && corners[(facing + 1) % 4]) || tstKick) {
+        return TSpin::Full;
+    }
+    return TSpin::Mini;
+}
+
+int TetrisEngineBase::placePiece()
+{
+    // 记录方块覆盖的行（最多4行）锁定前的内容，用于增量更新特征
+    const PieceCells &cells = tetrominoCells(m_state.currentTetromino, m_state.currentRotation);
+    int top = BOARD_HEIGHT;
+    int bottom = -1;
+    for (const PieceCell &cell : cells) {
+        const int y = m_state.pieceY + cell.y;
+        if (y >= 0 && y < BOARD_HEIGHT) {
+            top = std::min(top, y);
+            bottom = std::max(bottom, y);
+        }
+    }
+    std::uint16_t before[4] = {};
+    for (int y = top; y <= bottom; ++y) {
+        before[y - top] = m_state.rows[y];
+    }
+
+    // 将当前方块锁定到游戏板
+    for (const PieceCell &cell : cells) {
+        const int x = m_state.pieceX + cell.x;
+        const int y = m_state.pieceY + cell.y;
+        if (y >= 0 && y < BOARD_HEIGHT && x >= 0 && x < BOARD_WIDTH) {
+            m_state.rows[y] |= static_cast<std::uint16_t>(1u << x);
+        }
+    }
+    ++m_state.pieceCount;
+    if (top <= bottom) {
+        updateFeaturesAfterLock(top, bottom, before);
+    }
+
+    return clearLines();
+}
+
+void TetrisEngineBase::finishLock(int linesCleared)
+{
+    if (linesCleared > 0) {
+        // 消行先抵消待插入的垃圾行，剩余部分发给对手
+        int attack = ATTACK_LINES[linesCleared];
+        const int cancelled = std::min<int>(attack, m_state.pendingGarbage);
+        m_state.pendingGarbage = static_cast<std::uint8_t>(m_state.pendingGarbage - cancelled);
+        attack -= cancelled;
+        m_state.outgoingGarbage = static_cast<std::uint8_t>(std::min(m_state.outgoingGarbage + attack, BOARD_HEIGHT));
+    } else {
+        applyGarbage();
+    }
+
+    if (m_state.gameOver) return;
+
+    // 生成新方块
+    spawnPiece();
+}
+
+int TetrisEngineBase::clearLines()
+{
+    TRACE_SCOPE("TetrisEngine::clearLines");
+    int linesCleared = 0;
+
+    // 自底向上压缩：跳过满行，其余行下移
+    int writeRow = BOARD_HEIGHT - 1;
+    for (int y = BOARD_HEIGHT - 1; y >= 0; --y) {
+        if (m_state.rows[y] == FULL_ROW) {
+            ++linesCleared;
+            continue;
+        }
+        m_state.rows[writeRow--] = m_state.rows[y];
+    }
+    // 在顶部补空行
+    while (writeRow >= 0) {
+        m_state.rows[writeRow--] = 0;
+    }
+
+    if (linesCleared > 0) {
+        // 消行后被满行遮住的空洞可能重新露出，列高也不一定只降 linesCleared，
+        // 按行掩码整体重算（20行逐位运算，代价与一次增量更新相当）
+        m_features = computeFeatures(m_state.rows);
+    }
+    return linesCleared;
+}
+
+void TetrisEngineBase::applyGarbage()
+{
+    const int count = m_state.pendingGarbage;
+    if (count == 0) return;
+    m_state.pendingGarbage = 0;
+
+    // 被顶出游戏板的行中有方块则判负
+    for (int y = 0; y < count; ++y) {
+        if (m_state.rows[y] != 0) {
+            m_state.gameOver = true;
+        }
+    }
+
+    std::copy(m_state.rows.begin() + count, m_state.rows.end(), m_state.rows.begin());
+
+    // 同一批垃圾行共用一个缺口
+    const int hole = static_cast<int>((nextRandom(m_state.garbageRng) >> 32) % BOARD_WIDTH);
+    const std::uint16_t garbageRow = FULL_ROW & static_cast<std::uint16_t>(~(1u << hole));
+    for (int y = BOARD_HEIGHT - count; y < BOARD_HEIGHT; ++y) {
+        m_state.rows[y] = garbageRow;
+    }
+    m_features = computeFeatures(m_state.rows);
+}
+
+int TetrisEngineBase::rowTransitions(std::uint16_t row)
+{
+    // 两侧补上实心墙后，相邻位不同的次数
+    const unsigned bits = (static_cast<unsigned>(row) << 1) | 1u | (1u << (BOARD_WIDTH + 1));
+    return std::popcount((bits ^ (bits >> 1)) & ((1u << (BOARD_WIDTH + 1)) - 1));
+}
+
+int TetrisEngineBase::columnTransitions(const std::array<std::uint16_t, BOARD_HEIGHT> &rows)
+{
+    // 逐行异或，一次处理整行的10列
+    int transitions = std::popcount<unsigned>(rows[0]);
+    for (int y = 1; y < BOARD_HEIGHT; ++y) {
+        transitions += std::popcount<unsigned>(rows[y - 1] ^ rows[y]);
+    }
+    return transitions + std::popcount<unsigned>(~rows[BOARD_HEIGHT - 1] & FULL_ROW);
+}
+
+int TetrisEngineBase::columnWellSum(const std::array<std::uint16_t, BOARD_HEIGHT> &rows, int x)
+{
+    // 井格：本格为空，左右都是方块或墙；连续 n 格的井计 1+2+...+n
+    const unsigned bit = 1u << x;
+    int sum = 0;
+    int depth = 0;
+    for (int y = 0; y < BOARD_HEIGHT; ++y) {
+        const unsigned row = rows[y];
+        const unsigned walled = (row << 1) | 1u;
+        const unsigned walledRight = (row >> 1) | (1u << (BOARD_WIDTH - 1));
+        if (~row & walled & walledRight & bit) {
+            sum += ++depth;
+        } else {
+            depth = 0;
+        }
+    }
+    return sum;
+}
+
+void TetrisEngineBase::updateFeaturesAfterLock(int top, int bottom, const std::uint16_t *before)
+{
+    Features &features = m_features;
+    const auto &rows = m_state.rows;
+    auto oldRow = [&](int y) {
+        return (y >= top && y <= bottom) ? before[y - top] : rows[y];
+    };
+
+    unsigned touched = 0;
+    for (int y = top; y <= bottom; ++y) {
+        const unsigned added = rows[y] & ~before[y - top];
+        touched |= added;
+        features.rowTransitions += static_cast<std::int16_t>(rowTransitions(rows[y]) - rowTransitions(before[y - top]));
+
+        // 新方块格若在列顶之下，说明填上了一个空洞
+        for (unsigned cells = added; cells; cells &= cells - 1) {
+            const int x = std::countr_zero(cells);
+            if (y > BOARD_HEIGHT - features.columnHeights[x]) {
+                --features.holes;
+            }
+        }
+    }
+
+    // 落在列顶之上的部分：与原列顶之间的空格成为新空洞，列高随之增加
+    for (unsigned columns = touched; columns; columns &= columns - 1) {
+        const int x = std::countr_zero(columns);
+        const unsigned bit = 1u << x;
+        int pieceTop = bottom;
+        int pieceBottom = top;
+        for (int y = top; y <= bottom; ++y) {
+            if ((rows[y] & ~before[y - top]) & bit) {
+                pieceTop = std::min(pieceTop, y);
+                pieceBottom = std::max(pieceBottom, y);
+            }
+        }
+        const int oldTop = BOARD_HEIGHT - features.columnHeights[x];
+        if (pieceBottom < oldTop) {
+            features.holes += static_cast<std::int16_t>(oldTop - pieceBottom - 1);
+            features.columnHeights[x] = static_cast<std::uint8_t>(BOARD_HEIGHT - pieceTop);
+        }
+    }
+
+    // 列变换只涉及与受影响行相邻的行对；顶部之上视为空，底部之下视为满
+    auto pairTransitions = [&](auto rowAt) {
+        int sum = 0;
+        for (int y = top - 1; y <= bottom; ++y) {
+            const unsigned upper = y < 0 ? 0u : rowAt(y);
+            const unsigned lower = y + 1 >= BOARD_HEIGHT ? unsigned(FULL_ROW) : rowAt(y + 1);
+            sum += std::popcount(upper ^ lower);
+        }
+        return sum;
+    };
+    features.columnTransitions += static_cast<std::int16_t>(
+        pairTransitions([&](int y) { return rows[y]; }) - pairTransitions(oldRow));
+
+    // 井只受本列和左右相邻列的影响
+    const unsigned wellColumns = (touched | (touched << 1) | (touched >> 1)) & FULL_ROW;
+    for (unsigned columns = wellColumns; columns; columns &= columns - 1) {
+        const int x = std::countr_zero(columns);
+        features.wells -= features.columnWells[x];
+        features.columnWells[x] = static_cast<std::uint8_t>(columnWellSum(rows, x));
+        features.wells += features.columnWells[x];
+    }
+
+    updateHeightSums(features);
+}
+
+void TetrisEngineBase::updateHeightSums(Features &features)
+{
+    // 总高度和相邻列高度差之和，只有10列，直接由列高度重算
+    std::int16_t aggregate = 0;
+    std::int16_t bumpiness = 0;
+    for (int x = 0; x < BOARD_WIDTH; ++x) {
+        aggregate += features.columnHeights[x];
+        if (x > 0) {
+            bumpiness += static_cast<std::int16_t>(std::abs(features.columnHeights[x] - features.columnHeights[x - 1]));
+        }
+    }
+    features.aggregateHeight = aggregate;
+    features.bumpiness = bumpiness;
+}
+
+template <typename Rules>
+bool BasicTetrisEngine<Rules>::moveDown()
+{
+    if (m_state.gameOver || !m_state.gameStarted) return false;
+    if (stepDown()) return true;
+    lockPiece();
+    return false;
+}
+
+template <typename Rules>
+void BasicTetrisEngine<Rules>::hardDrop()
+{
+    if (m_state.gameOver || !m_state.gameStarted) return;
+
+    dropToShadow();
+    lockPiece();
+}
+
+template <typename Rules>
+void BasicTetrisEngine<Rules>::tick(std::uint8_t inputs)
+{
+    if (m_state.gameOver || !m_state.gameStarted) return;
+
+    if (inputs & InputLeft) moveLeft();
+    if (inputs & InputRight) moveRight();
+    if (inputs & InputRotateCW) rotate(RotationDirection::Clockwise);
+    if (inputs & InputRotateCCW) rotate(RotationDirection::CounterClockwise);
+    if (inputs & InputRotate180) rotate(RotationDirection::Half);
+    if (inputs & InputSoftDrop) {
+        moveDown();
+        m_state.gravityTicks = 0;
+    }
+    if (inputs & InputHardDrop) {
+        hardDrop();
+        m_state.gravityTicks = 0;
+    }
+
+    if (++m_state.gravityTicks >= Rules::gravityTicks(m_state.level)) {
+        m_state.gravityTicks = 0;
+        moveDown();
+    }
+}
+
+template <typename Rules>
+void BasicTetrisEngine<Rules>::lockPiece()
+{
+    TRACE_SCOPE("TetrisEngine::lockPiece");
+    // T-spin 要在方块写入棋盘之前判定
+    TSpin tSpin = TSpin::None;
+    if constexpr (Rules::T_SPINS) {
+        tSpin = detectTSpin();
+    }
+    const int linesCleared = placePiece();
+    scoreLock(linesCleared, tSpin);
+    finishLock(linesCleared);
+}
+
+template <typename Rules>
+void BasicTetrisEngine<Rules>::scoreLock(int linesCleared, TSpin tSpin)
+{
+    if (linesCleared == 0) {
+        m_state.combo = 0;
+        if (tSpin == TSpin::None) return;
+    }
+
+    // 分数按消行前的等级计算
+    int points = Rules::clearPoints(linesCleared, tSpin);
+    if (linesCleared > 0) {
+        if constexpr (Rules::BACK_TO_BACK) {
+            const bool difficult = linesCleared == 4 || tSpin != TSpin::None;
+            if (difficult && (m_state.ruleFlags & BackToBack)) {
+                points = points * 3 / 2;
+            }
+            if (difficult) {
+                m_state.ruleFlags |= BackToBack;
+            } else {
+                m_state.ruleFlags &= ~BackToBack;
+            }
+        }
+        if constexpr (Rules::COMBOS) {
+            if (m_state.combo < 255) ++m_state.combo;
+            if (m_state.combo > 1) {
+                points += Rules::comboPoints(m_state.combo);
+            }
+        }
+    }
+    m_state.score += points * m_state.level;
+
+    if (linesCleared > 0) {
+        m_state.lines += linesCleared;
+        m_state.level = std::max<std::int32_t>(m_state.level, Rules::levelForLines(m_state.lines));
+        if constexpr (Rules::LINE_GOAL > 0) {
+            if (m_state.lines >= Rules::LINE_GOAL) {
+                m_state.gameOver = true;
+                m_state.ruleFlags |= GoalReached;
+            }
+        }
+    }
+}
+
+template class BasicTetrisEngine<StandardRules>;
+template class BasicTetrisEngine<GuidelineRules>;
+template class BasicTetrisEngine<ClassicRules>;
+template class BasicTetrisEngine<MarathonRules>;
@@ -0,0 +1,226 @@
+#ifndef TETRISENGINE_H
+#define TETRISENGINE_H
+
+#include "rulesets.h"
+#include "tetromino.h"
+#include <array>
+#include <cstdint>
+
+class RotationSystem;
+
+// 无Qt依赖的游戏核心：全部状态为定长成员，可直接按值复制（用于回滚、快照和搜索）
+// 随机数由种子决定，相同种子和相同输入序列得到完全相同的对局
+//
+// 与规则无关的部分（棋盘、移动、旋转、出块、垃圾行）在 TetrisEngineBase 中；
+// 下落、锁定计分和升级由 BasicTetrisEngine<Rules> 按规则集在编译期展开。
+// 所有实例化共用同一个 State，状态可以在不同规则的引擎之间直接恢复。
+class TetrisEngineBase
+{
+public:
+    static constexpr int BOARD_WIDTH = 10;
+    static constexpr int BOARD_HEIGHT = 20;
+    static constexpr std::uint16_t FULL_ROW = (1u << BOARD_WIDTH) - 1;
+    static constexpr int QUEUE_SIZE = 5;
+
+    // 方块序列的生成方式
+    enum class Randomizer : std::uint8_t {
+        Uniform,    // 每个方块独立均匀抽取
+        Bag7        // 7种方块为一袋，袋内随机排列
+    };
+    static constexpr int RANDOMIZER_COUNT = 2;
+
+    // 引擎的全部状态：定长、无指针、无隐式填充，快照和恢复就是一次结构体复制
+    struct State {
+        std::array<std::uint16_t, BOARD_HEIGHT> rows;
+
+        // 开局种子（用于记录和回放）与两条随机流的当前状态
+        std::uint64_t seed;
+        std::uint64_t pieceRng;
+        std::uint64_t garbageRng;
+
+        std::int32_t score;
+        std::int32_t level;
+        std::int32_t lines;
+        std::int32_t pieceCount;
+        std::int32_t gravityTicks;
+
+        std::int8_t pieceX;
+        std::int8_t pieceY;
+        Tetromino currentTetromino;
+        Rotation currentRotation;
+        // 预览队列，queue[0] 为下一个方块
+        std::array<Tetromino, QUEUE_SIZE> queue;
+
+        std::uint8_t rotationSystem;
+        std::uint8_t pendingGarbage;
+        std::uint8_t outgoingGarbage;
+        bool gameOver;
+        bool gameStarted;
+        // 最近一次成功旋转使用的踢表序号，-1 表示还没有旋转过
+        std::int8_t lastKick;
+        Randomizer randomizer;
+        // 7-bag 当前袋中尚未发出的方块（位掩码）
+        std::uint8_t bagRemaining;
+        // 连续消行的锁定次数（0 表示上一次锁定没有消行）
+        std::uint8_t combo;
+        std::uint8_t ruleFlags;
+        std::uint8_t reserved[1];
+    };
+
+    // 棋盘特征（AI 评估和统计用）：锁定时按受影响的行和列增量更新，不属于 State，
+    // 消行、垃圾行和恢复状态时重新计算。井深为每列连续井格的累加和（1+2+...+深度）。
+    struct Features {
+        std::array<std::uint8_t, BOARD_WIDTH> columnHeights;
+        std::array<std::uint8_t, BOARD_WIDTH> columnWells;
+        std::int16_t aggregateHeight;
+        std::int16_t holes;
+        std::int16_t rowTransitions;      // 左右墙视为实心
+        std::int16_t columnTransitions;   // 底部视为实心，顶部之上视为空
+        std::int16_t wells;
+        std::int16_t bumpiness;
+    };
+
+    // 每个逻辑帧的输入，按位组合
+    enum Input : std::uint8_t {
+        InputNone = 0,
+        InputLeft = 1 << 0,
+        InputRight = 1 << 1,
+        InputSoftDrop = 1 << 2,
+        InputRotateCW = 1 << 3,
+        InputRotateCCW = 1 << 4,
+        InputRotate180 = 1 << 5,
+        InputHardDrop = 1 << 6,
+    };
+
+    // State::ruleFlags
+    enum RuleFlag : std::uint8_t {
+        LastMoveRotate = 1 << 0,    // 最后一次成功的移动是旋转（T-spin 判定）
+        BackToBack = 1 << 1,        // 上一次消行是四消或 T-spin
+        GoalReached = 1 << 2,       // 达到规则集的目标行数而结束，不是堆满
+        LastRotateHalf = 1 << 3     // 最近一次成功旋转是 180 度（踢表序号与 90 度旋转不同）
+    };
+
+    // 逻辑帧率，用于把下落间隔换算成帧数
+    static constexpr int TICKS_PER_SECOND = RULE_TICKS_PER_SECOND;
+
+    void reset(std::uint64_t seed);
+    void start();
+
+    // 快照与恢复：复制整个 State，用于回滚、撤销和搜索
+    State saveState() const;
+    void restoreState(const State &state);
+
+    // 检查来自外部（存档文件等）的状态是否自洽，恢复前调用
+    static bool isValidState(const State &state);
+
+    // 方块操作，返回是否发生了移动
+    bool moveLeft();
+    bool moveRight();
+    bool rotate(RotationDirection direction);
+
+    // 对战垃圾行：收到的行数先排队，锁定时若未消行则插入
+    void queueGarbage(int lines);
+    int takeOutgoingGarbage();
+    int getPendingGarbage() const;
+
+    void setRotationSystem(const RotationSystem *system);
+    const RotationSystem *rotationSystem() const;
+
+    // 随机器在 reset 时保留，和种子一起决定方块序列
+    void setRandomizer(Randomizer randomizer);
+    Randomizer randomizer() const;
+
+    // 状态查询
+    bool isGameOver() const;
+    bool isGameStarted() const;
+    int getScore() const;
+    int getLevel() const;
+    int getLines() const;
+    int getPieceCount() const;
+    int getCombo() const;
+    bool isBackToBack() const;
+    bool isGoalReached() const;
+    std::uint64_t getSeed() const;
+    int getLastKick() const;
+    std::uint16_t getRowMask(int y) const;
+    bool isCellFilled(int x, int y) const;
+
+    Tetromino getCurrentTetromino() const;
+    Rotation getCurrentRotation() const;
+    int getPieceX() const;
+    int getPieceY() const;
+    int getShadowY() const;
+    Tetromino getNextTetromino() const;
+    Tetromino getQueuedTetromino(int index) const;
+
+    const Features &getFeatures() const;
+    // 从行掩码完整计算特征（增量结果与之一致）
+    static Features computeFeatures(const std::array<std::uint16_t, BOARD_HEIGHT> &rows);
+
+    bool checkCollision(Tetromino type, Rotation rotation, int x, int y) const;
+
+protected:
+    TetrisEngineBase();
+
+    // 锁定的三个阶段，计分夹在中间，由 BasicTetrisEngine 按规则组合
+    TSpin detectTSpin() const;
+    int placePiece();
+    void finishLock(int linesCleared);
+    bool stepDown();
+    void dropToShadow();
+
+    State m_state;
+
+private:
+    static std::uint64_t nextRandom(std::uint64_t &state);
+    Tetromino randomTetromino();
+    void spawnPiece();
+    int clearLines();
+    void applyGarbage();
+
+    // 特征的增量更新
+    static int rowTransitions(std::uint16_t row);
+    static int columnTransitions(const std::array<std::uint16_t, BOARD_HEIGHT> &rows);
+    static int columnWellSum(const std::array<std::uint16_t, BOARD_HEIGHT> &rows, int x);
+    void updateFeaturesAfterLock(int top, int bottom, const std::uint16_t *before);
+    static void updateHeightSums(Features &features);
+
+    Features m_features;
+};
+
+// 按规则集实例化的引擎
+template <typename Rules>
+class BasicTetrisEngine : public TetrisEngineBase
+{
+public:
+    using RuleSet = Rules;
+
+    BasicTetrisEngine() = default;
+
+    // 方块下移，触底时锁定；返回是否发生了移动
+    bool moveDown();
+    void hardDrop();
+
+    // 推进一个逻辑帧：先处理输入，再按等级累积重力
+    void tick(std::uint8_t inputs);
+
+    // 等级对应的下落间隔（毫秒）
+    static constexpr int dropIntervalMs(int level) { return Rules::dropIntervalMs(level); }
+
+private:
+    void lockPiece();
+    void scoreLock(int linesCleared, TSpin tSpin);
+};
+
+// 随附的规则集在 tetrisengine.cpp 中显式实例化
+extern template class BasicTetrisEngine<StandardRules>;
+extern template class BasicTetrisEngine<GuidelineRules>;
+extern template class BasicTetrisEngine<ClassicRules>;
+extern template class BasicTetrisEngine<MarathonRules>;
+
+// 游戏界面、对战和工具默认使用的引擎；定义成类而不是别名，其他头文件可以前置声明
+class TetrisEngine : public BasicTetrisEngine<StandardRules>
+{
+};
+
+#endif // TETRISENGINE_H
@@ -1,30 +1,23 @@
 #include "tetrisgame.h"
+#include "rotationsystem.h"
+#include "trace.h"
 #include <QRandomGenerator>
-#include <algorithm>
 
 TetrisGame::TetrisGame(QObject *parent)
     : QObject(parent)
-    , m_gameOver(false)
+    , m_flushScheduled(false)
+    , m_lastLock{}
     , m_paused(false)
-    , m_gameStarted(false)
-    , m_score(0)
-    , m_level(1)
-    , m_lines(0)
-    , m_dropInterval(1000)
-{
-    // 初始化游戏板
-    m_board.resize(BOARD_HEIGHT);
-    for (int i = 0; i < BOARD_HEIGHT; ++i) {
-        m_board[i].resize(BOARD_WIDTH, 0);
-    }
+    , m_dropInterval(TetrisEngine::dropIntervalMs(1))
+    , m_playTimeMs(0)
+    , m_telemetry(nullptr)
+{
+    // 初始化游戏核心，生成第一个方块
+    m_engine.reset(QRandomGenerator::global()->generate64());
 
     // 创建游戏定时器
     m_gameTimer = new QTimer(this);
     connect(m_gameTimer, &QTimer::timeout, this, &TetrisGame::gameLoop);
-
-    // 生成第一个方块
-    m_nextTetromino = getRandomTetromino();
-    m_nextColor = getTetrominoColor(m_nextTetromino);
 }
 
 TetrisGame::~TetrisGame()
@@ -37,145 +30,140 @@ TetrisGame::~TetrisGame()
 void TetrisGame::start()
 {
     reset();
-    m_gameStarted = true;
-    spawnPiece();
+    m_engine.start();
+    m_replay.begin(m_engine.saveState());
+    if (m_telemetry) {
+        logEvent(0, Telemetry::GameStart, 0, m_engine.getSeed());
+        logEvent(0, Telemetry::Spawn);
+    }
+    markChanged(PieceChange | BoardChange);
+    if (m_engine.isGameOver()) {
+        markChanged(GameOverChange);
+        return;
+    }
     m_gameTimer->start(m_dropInterval);
+    m_playClock.start();
 }
 
 void TetrisGame::pause()
 {
-    if (!m_gameOver && !m_paused) {
+    if (!m_engine.isGameOver() && !m_paused) {
         m_paused = true;
         m_gameTimer->stop();
+        stopPlayClock();
     }
 }
 
 void TetrisGame::resume()
 {
-    if (!m_gameOver && m_paused) {
+    if (!m_engine.isGameOver() && m_paused) {
         m_paused = false;
         m_gameTimer->start(m_dropInterval);
+        m_playClock.start();
     }
 }
 
 void TetrisGame::reset()
 {
-    // 清空游戏板
-    for (int i = 0; i < BOARD_HEIGHT; ++i) {
-        for (int j = 0; j < BOARD_WIDTH; ++j) {
-            m_board[i][j] = 0;
-        }
-    }
+    // 每局使用新的随机种子，旋转系统设置保留
+    m_engine.reset(QRandomGenerator::global()->generate64());
 
     // 重置游戏状态
-    m_gameOver = false;
     m_paused = false;
-    m_gameStarted = false;
-    m_score = 0;
-    m_level = 1;
-    m_lines = 0;
-    m_dropInterval = 1000;
+    m_dropInterval = TetrisEngine::dropIntervalMs(m_engine.getLevel());
 
     m_gameTimer->stop();
+    m_playClock.invalidate();
+    m_playTimeMs = 0;
+    m_replay.clear();
 
-    emit scoreChanged(m_score);
-    emit levelChanged(m_level);
-    emit linesChanged(m_lines);
+    markChanged(BoardChange | PieceChange | ScoreChange | LevelChange | LinesChange);
 }
 
 void TetrisGame::moveLeft()
 {
-    if (m_gameOver || m_paused) return;
+    if (m_paused) return;
 
-    QPoint newPos = m_currentPos;
-    newPos.setX(newPos.x() - 1);
-
-    if (isValidPosition(getCurrentPiece(), newPos)) {
-        m_currentPos = newPos;
-        emit boardChanged();
+    record(Replay::MoveLeft);
+    if (m_engine.moveLeft()) {
+        if (m_telemetry) logEvent(quint32(getPlayTimeMs()), Telemetry::Move, -1);
+        markChanged(BoardChange);
     }
 }
 
 void TetrisGame::moveRight()
 {
-    if (m_gameOver || m_paused) return;
-
-    QPoint newPos = m_currentPos;
-    newPos.setX(newPos.x() + 1);
+    if (m_paused) return;
 
-    if (isValidPosition(getCurrentPiece(), newPos)) {
-        m_currentPos = newPos;
-        emit boardChanged();
+    record(Replay::MoveRight);
+    if (m_engine.moveRight()) {
+        if (m_telemetry) logEvent(quint32(getPlayTimeMs()), Telemetry::Move, 1);
+        markChanged(BoardChange);
     }
 }
 
 void TetrisGame::moveDown()
 {
-    if (m_gameOver || m_paused) return;
+    if (m_paused) return;
 
-    QPoint newPos = m_currentPos;
-    newPos.setY(newPos.y() + 1);
-
-    if (isValidPosition(getCurrentPiece(), newPos)) {
-        m_currentPos = newPos;
-        emit boardChanged();
+    record(Replay::MoveDown);
+    const Summary before = summary();
+    if (m_engine.moveDown()) {
+        if (m_telemetry) logEvent(quint32(getPlayTimeMs()), Telemetry::Move, 0);
+        markChanged(BoardChange);
     } else {
-        lockPiece();
+        applyChanges(before);
     }
 }
 
-void TetrisGame::rotate()
+void TetrisGame::rotate(RotationDirection direction)
 {
-    if (m_gameOver || m_paused) return;
+    if (m_paused) return;
 
-    // O方块不需要旋转
-    if (m_currentTetromino == Tetromino::O) {
-        return;
+    switch (direction) {
+        case RotationDirection::Clockwise:
+            record(Replay::RotateClockwise);
+            break;
+        case RotationDirection::CounterClockwise:
+            record(Replay::RotateCounterClockwise);
+            break;
+        case RotationDirection::Half:
+            record(Replay::Rotate180);
+            break;
     }
-
-    Rotation newRotation = static_cast<Rotation>((static_cast<int>(m_currentRotation) + 1) % 4);
-    QVector<QPoint> newShape = getTetrominoShape(m_currentTetromino, newRotation);
-
-    // 尝试墙踢：先尝试原地，再尝试左右移动
-    QVector<int> kickTests = {0, -1, 1};
-
-    for (int kick : kickTests) {
-        QPoint testPos = m_currentPos;
-        testPos.setX(testPos.x() + kick);
-        if (isValidPosition(newShape, testPos)) {
-            m_currentPos = testPos;
-            m_currentRotation = newRotation;
-            emit boardChanged();
-            return;
-        }
+    if (m_engine.rotate(direction)) {
+        if (m_telemetry) logEvent(quint32(getPlayTimeMs()), Telemetry::Rotate, qint8(m_engine.getLastKick()));
+        markChanged(BoardChange);
     }
-
-    // 所有墙踢都失败，不旋转
 }
 
 void TetrisGame::hardDrop()
 {
-    if (m_gameOver || m_paused) return;
+    if (m_paused) return;
 
-    // 添加最大迭代次数防止无限循环
-    int maxIterations = BOARD_HEIGHT + 10;
-    int iterations = 0;
-    
-    while (isValidPosition(getCurrentPiece(), m_currentPos) && iterations < maxIterations) {
-        m_currentPos.setY(m_currentPos.y() + 1);
-        iterations++;
-    }
-    
-    if (iterations > 0) {
-        m_currentPos.setY(m_currentPos.y() - 1);
+    record(Replay::HardDrop);
+    Summary before = summary();
+    if (m_engine.isGameStarted() && !m_engine.isGameOver()) {
+        before.pieceY = m_engine.getShadowY();
     }
-    
-    lockPiece();
+    m_engine.hardDrop();
+    applyChanges(before);
+}
+
+void TetrisGame::setRotationSystem(const RotationSystem *system)
+{
+    m_engine.setRotationSystem(system ? system : &RotationSystem::standard());
+    record(Replay::SetRotationSystem, m_engine.saveState().rotationSystem);
+}
+
+const RotationSystem *TetrisGame::rotationSystem() const
+{
+    return m_engine.rotationSystem();
 }
 
 bool TetrisGame::isGameOver() const
 {
-    return m_gameOver;
+    return m_engine.isGameOver();
 }
 
 bool TetrisGame::isPaused() const
@@ -185,342 +173,280 @@ bool TetrisGame::isPaused() const
 
 bool TetrisGame::isGameStarted() const
 {
-    return m_gameStarted;
+    return m_engine.isGameStarted();
 }
 
 int TetrisGame::getScore() const
 {
-    return m_score;
+    return m_engine.getScore();
 }
 
 int TetrisGame::getLevel() const
 {
-    return m_level;
+    return m_engine.getLevel();
 }
 
 int TetrisGame::getLines() const
 {
-    return m_lines;
+    return m_engine.getLines();
+}
+
+int TetrisGame::getPieceCount() const
+{
+    return m_engine.getPieceCount();
+}
+
+quint64 TetrisGame::getSeed() const
+{
+    return m_engine.getSeed();
+}
+
+qint64 TetrisGame::getPlayTimeMs() const
+{
+    return m_playTimeMs + (m_playClock.isValid() ? m_playClock.elapsed() : 0);
+}
+
+void TetrisGame::stopPlayClock()
+{
+    if (m_playClock.isValid()) {
+        m_playTimeMs += m_playClock.elapsed();
+        m_playClock.invalidate();
+    }
 }
 
-const QVector<QVector<int>>& TetrisGame::getBoard() const
+quint16 TetrisGame::getRowMask(int y) const
 {
-    return m_board;
+    return m_engine.getRowMask(y);
+}
+
+bool TetrisGame::isCellFilled(int x, int y) const
+{
+    return m_engine.isCellFilled(x, y);
 }
 
 QVector<QPoint> TetrisGame::getCurrentPiece() const
 {
-    if (m_gameOver || !m_gameStarted) return QVector<QPoint>();
-    return getTetrominoShape(m_currentTetromino, m_currentRotation);
+    if (m_engine.isGameOver() || !m_engine.isGameStarted()) return QVector<QPoint>();
+    return getTetrominoShape(m_engine.getCurrentTetromino(), m_engine.getCurrentRotation());
 }
 
 QColor TetrisGame::getCurrentPieceColor() const
 {
-    return m_currentColor;
+    return getTetrominoColor(m_engine.getCurrentTetromino());
 }
 
 QVector<QPoint> TetrisGame::getNextPiece() const
 {
-    return getTetrominoShape(m_nextTetromino, Rotation::North);
+    return getTetrominoShape(m_engine.getNextTetromino(), Rotation::North);
 }
 
 QColor TetrisGame::getNextPieceColor() const
 {
-    return m_nextColor;
+    return getTetrominoColor(m_engine.getNextTetromino());
 }
 
 QPoint TetrisGame::getCurrentPos() const
 {
-    return m_currentPos;
+    return QPoint(m_engine.getPieceX(), m_engine.getPieceY());
 }
 
 QPoint TetrisGame::getShadowPos() const
 {
-    if (m_gameOver || !m_gameStarted) return m_currentPos;
-
-    QVector<QPoint> piece = getTetrominoShape(m_currentTetromino, m_currentRotation);
-    if (piece.isEmpty()) return m_currentPos;
-    
-    QPoint shadowPos = m_currentPos;
-    
-    // 向下移动直到碰撞，添加最大迭代次数防止无限循环
-    int maxIterations = BOARD_HEIGHT + 10;
-    int iterations = 0;
-    
-    while (isValidPosition(piece, shadowPos) && iterations < maxIterations) {
-        shadowPos.setY(shadowPos.y() + 1);
-        iterations++;
-    }
-    
-    // 回退一步到有效位置
-    if (iterations > 0) {
-        shadowPos.setY(shadowPos.y() - 1);
-    }
-    
-    return shadowPos;
+    if (m_engine.isGameOver() || !m_engine.isGameStarted()) return getCurrentPos();
+    return QPoint(m_engine.getPieceX(), m_engine.getShadowY());
 }
 
-void TetrisGame::gameLoop()
+const TetrisEngine &TetrisGame::engine() const
 {
-    moveDown();
+    return m_engine;
 }
 
-QVector<QPoint> TetrisGame::getTetrominoShape(Tetromino type, Rotation rotation) const
+TetrisEngine::State TetrisGame::saveState() const
 {
-    QVector<QPoint> shape;
-
-    // 方块坐标定义：所有坐标相对于方块的某个基准点
-    // 避免使用负坐标，确保方块生成时不会超出边界
-    switch (type) {
-        case Tetromino::I:
-            // I型: 竖直4格
-            shape = {{0, 0}, {0, 1}, {0, 2}, {0, 3}};
-            break;
-        case Tetromino::O:
-            // O型: 2x2正方形
-            shape = {{0, 0}, {0, 1}, {1, 0}, {1, 1}};
-            break;
-        case Tetromino::T:
-            // T型: T字形
-            shape = {{0, 0}, {1, 0}, {2, 0}, {1, 1}};
-            break;
-        case Tetromino::S:
-            // S型: S字形
-            shape = {{1, 0}, {2, 0}, {0, 1}, {1, 1}};
-            break;
-        case Tetromino::Z:
-            // Z型: Z字形
-            shape = {{0, 0}, {1, 0}, {1, 1}, {2, 1}};
-            break;
-        case Tetromino::J:
-            // J型: J字形
-            shape = {{0, 0}, {0, 1}, {1, 1}, {2, 1}};
-            break;
-        case Tetromino::L:
-            // L型: L字形
-            shape = {{2, 0}, {0, 1}, {1, 1}, {2, 1}};
-            break;
-    }
+    return m_engine.saveState();
+}
 
-    // O型不需要旋转
-    if (type == Tetromino::O) {
-        return shape;
-    }
+void TetrisGame::restoreState(const TetrisEngine::State &state, qint64 playTimeMs)
+{
+    m_engine.restoreState(state);
+    m_replay.begin(state);
 
-    // I型特殊处理：围绕中心旋转
-    if (type == Tetromino::I) {
-        // I型的4个旋转状态
-        switch (rotation) {
-            case Rotation::North:
-                shape = {{0, 0}, {0, 1}, {0, 2}, {0, 3}};
-                break;
-            case Rotation::East:
-                shape = {{0, 0}, {1, 0}, {2, 0}, {3, 0}};
-                break;
-            case Rotation::South:
-                shape = {{0, 0}, {0, 1}, {0, 2}, {0, 3}};
-                break;
-            case Rotation::West:
-                shape = {{0, 0}, {1, 0}, {2, 0}, {3, 0}};
-                break;
-        }
-        return shape;
-    }
+    // 已进行的时长由调用方保存，不沿用恢复前这一局的计时
+    m_playClock.invalidate();
+    m_playTimeMs = playTimeMs;
 
-    // 其他方块：围绕中心点旋转
-    // 定义旋转中心（相对于基准点）
-    QPoint center;
-    switch (type) {
-        case Tetromino::T:
-            center = QPoint(1, 0);
-            break;
-        case Tetromino::S:
-            center = QPoint(1, 0);
-            break;
-        case Tetromino::Z:
-            center = QPoint(1, 0);
-            break;
-        case Tetromino::J:
-            center = QPoint(1, 1);
-            break;
-        case Tetromino::L:
-            center = QPoint(1, 1);
-            break;
-        default:
-            center = QPoint(0, 0);
-            break;
+    // 定时器不属于快照，按恢复后的等级和状态重新设置
+    m_dropInterval = TetrisEngine::dropIntervalMs(m_engine.getLevel());
+    if (m_engine.isGameStarted() && !m_engine.isGameOver() && !m_paused) {
+        m_gameTimer->start(m_dropInterval);
+        m_playClock.start();
+    } else {
+        m_gameTimer->stop();
+        stopPlayClock();
     }
 
-    // 应用旋转
-    for (int i = 0; i < static_cast<int>(rotation); ++i) {
-        for (auto& point : shape) {
-            // 先平移到原点
-            int x = point.x() - center.x();
-            int y = point.y() - center.y();
-            // 旋转
-            int newX = -y;
-            int newY = x;
-            // 平移回中心
-            point.setX(newX + center.x());
-            point.setY(newY + center.y());
-        }
-    }
+    markChanged(BoardChange | PieceChange | ScoreChange | LevelChange | LinesChange);
+}
 
-    return shape;
+const Replay &TetrisGame::replay() const
+{
+    return m_replay;
 }
 
-QColor TetrisGame::getTetrominoColor(Tetromino type) const
+void TetrisGame::record(Replay::Action action, quint8 arg)
 {
-    switch (type) {
-        case Tetromino::I: return QColor(0, 255, 255);    // 青色
-        case Tetromino::O: return QColor(255, 255, 0);    // 黄色
-        case Tetromino::T: return QColor(128, 0, 128);    // 紫色
-        case Tetromino::S: return QColor(0, 255, 0);      // 绿色
-        case Tetromino::Z: return QColor(255, 0, 0);      // 红色
-        case Tetromino::J: return QColor(0, 0, 255);      // 蓝色
-        case Tetromino::L: return QColor(255, 165, 0);    // 橙色
-        default: return QColor(255, 255, 255);
+    if (m_engine.isGameStarted() && !m_engine.isGameOver()) {
+        m_replay.record(static_cast<quint32>(getPlayTimeMs()), action, arg);
     }
 }
 
-Tetromino TetrisGame::getRandomTetromino() const
+const TetrisGame::LockedPiece &TetrisGame::lastLock() const
 {
-    return static_cast<Tetromino>(QRandomGenerator::global()->bounded(0, 7));
+    return m_lastLock;
 }
 
-bool TetrisGame::isValidPosition(const QVector<QPoint>& piece, const QPoint& pos) const
+void TetrisGame::setTelemetry(Telemetry *telemetry)
 {
-    return !checkCollision(piece, pos);
+    m_telemetry = telemetry;
 }
 
-bool TetrisGame::checkCollision(const QVector<QPoint>& piece, const QPoint& pos) const
+void TetrisGame::logEvent(quint32 timeMs, Telemetry::EventType type, qint8 detail, quint64 value)
 {
-    for (const auto& point : piece) {
-        int x = pos.x() + point.x();
-        int y = pos.y() + point.y();
-
-        // 检查边界（包括负坐标）
-        if (x < 0 || x >= BOARD_WIDTH || y < 0 || y >= BOARD_HEIGHT) {
-            return true;
-        }
-
-        // 检查是否与已放置的方块碰撞
-        if (m_board[y][x] != 0) {
-            return true;
-        }
-    }
-    return false;
+    TelemetryEvent event;
+    event.value = value;
+    event.sequence = 0;
+    event.timeMs = timeMs;
+    event.type = type;
+    event.piece = static_cast<quint8>(m_engine.getCurrentTetromino());
+    event.rotation = static_cast<quint8>(m_engine.getCurrentRotation());
+    event.detail = detail;
+    event.x = static_cast<qint8>(m_engine.getPieceX());
+    event.y = static_cast<qint8>(m_engine.getPieceY());
+    event.reserved = 0;
+    m_telemetry->log(event);
 }
 
-void TetrisGame::spawnPiece()
+void TetrisGame::logLock(const Summary &before, const Summary &after)
 {
-    m_currentTetromino = m_nextTetromino;
-    m_currentColor = m_nextColor;
-    m_currentRotation = Rotation::North;
-
-    // 根据方块类型调整生成位置
-    int xOffset = 0;
-    switch (m_currentTetromino) {
-        case Tetromino::I:
-        case Tetromino::O:
-            xOffset = BOARD_WIDTH / 2 - 1;
-            break;
-        case Tetromino::T:
-        case Tetromino::S:
-        case Tetromino::Z:
-        case Tetromino::J:
-        case Tetromino::L:
-            xOffset = BOARD_WIDTH / 2 - 2;
-            break;
-    }
-
-    m_currentPos = QPoint(xOffset, 0);
+    // 同一次锁定产生的事件共用一个时间戳
+    const quint32 timeMs = static_cast<quint32>(getPlayTimeMs());
 
-    m_nextTetromino = getRandomTetromino();
-    m_nextColor = getTetrominoColor(m_nextTetromino);
+    TelemetryEvent lock = {};
+    lock.value = static_cast<quint64>(after.score);
+    lock.timeMs = timeMs;
+    lock.type = Telemetry::Lock;
+    lock.piece = static_cast<quint8>(before.piece);
+    lock.rotation = static_cast<quint8>(before.rotation);
+    lock.x = static_cast<qint8>(before.pieceX);
+    lock.y = static_cast<qint8>(before.pieceY);
+    m_telemetry->log(lock);
 
-    emit pieceChanged();
-
-    // 检查游戏结束
-    if (checkCollision(getCurrentPiece(), m_currentPos)) {
-        m_gameOver = true;
-        m_gameTimer->stop();
-        emit gameOverSignal();
+    if (after.lines != before.lines) {
+        logEvent(timeMs, Telemetry::LineClear, qint8(after.lines - before.lines), quint64(after.score));
+    }
+    if (after.level != before.level) {
+        logEvent(timeMs, Telemetry::LevelUp, qint8(after.level));
+    }
+    if (after.gameOver) {
+        logEvent(timeMs, Telemetry::GameOver, 0, quint64(after.score));
+    } else {
+        logEvent(timeMs, Telemetry::Spawn);
     }
 }
 
-void TetrisGame::lockPiece()
+void TetrisGame::gameLoop()
 {
-    // 将当前方块锁定到游戏板
-    for (const auto& point : getCurrentPiece()) {
-        int x = m_currentPos.x() + point.x();
-        int y = m_currentPos.y() + point.y();
+    TRACE_SCOPE("TetrisGame::gameLoop");
+    moveDown();
+}
 
-        if (y >= 0 && y < BOARD_HEIGHT && x >= 0 && x < BOARD_WIDTH) {
-            m_board[y][x] = 1;
-        }
+QVector<QPoint> TetrisGame::getTetrominoShape(Tetromino type, Rotation rotation)
+{
+    // 方块坐标来自编译期生成的SRS形状表，相对于4x4包围盒左上角
+    QVector<QPoint> shape;
+    shape.reserve(4);
+    for (const PieceCell &cell : tetrominoCells(type, rotation)) {
+        shape.append(QPoint(cell.x, cell.y));
     }
+    return shape;
+}
 
-    // 清除完整的行
-    clearLines();
-
-    // 生成新方块
-    spawnPiece();
-
-    emit boardChanged();
+QColor TetrisGame::getTetrominoColor(Tetromino type)
+{
+    switch (type) {
+        case Tetromino::I: return QColor(0, 255, 255);    // 青色
+        case Tetromino::O: return QColor(255, 255, 0);    // 黄色
+        case Tetromino::T: return QColor(128, 0, 128);    // 紫色
+        case Tetromino::S: return QColor(0, 255, 0);      // 绿色
+        case Tetromino::Z: return QColor(255, 0, 0);      // 红色
+        case Tetromino::J: return QColor(0, 0, 255);      // 蓝色
+        case Tetromino::L: return QColor(255, 165, 0);    // 橙色
+        default: return QColor(255, 255, 255);
+    }
 }
 
-void TetrisGame::clearLines()
+TetrisGame::Summary TetrisGame::summary() const
 {
-    int linesCleared = 0;
+    return {m_engine.getScore(), m_engine.getLevel(), m_engine.getLines(),
+            m_engine.getPieceCount(), m_engine.isGameOver(),
+            m_engine.getCurrentTetromino(), m_engine.getCurrentRotation(),
+            m_engine.getPieceX(), m_engine.getPieceY()};
+}
 
-    for (int y = BOARD_HEIGHT - 1; y >= 0; --y) {
-        bool fullLine = true;
-        for (int x = 0; x < BOARD_WIDTH; ++x) {
-            if (m_board[y][x] == 0) {
-                fullLine = false;
-                break;
-            }
-        }
+void TetrisGame::applyChanges(const Summary &before)
+{
+    const Summary after = summary();
 
-        if (fullLine) {
-            // 移除该行
-            m_board.removeAt(y);
-            // 在顶部添加空行
-            m_board.prepend(QVector<int>(BOARD_WIDTH, 0));
-            // 重新检查当前行
-            ++y;
-            ++linesCleared;
-        }
+    // 没有方块锁定，只可能是位置变化
+    if (after.pieceCount == before.pieceCount) {
+        return;
     }
 
-    if (linesCleared > 0) {
-        // 更新分数
-        int points[] = {0, 100, 300, 500, 800};
-        m_score += points[linesCleared] * m_level;
-        m_lines += linesCleared;
+    m_lastLock = {before.piece, before.rotation, before.pieceX, before.pieceY, after.pieceCount};
+    if (m_telemetry) {
+        logLock(before, after);
+    }
 
-        // 更新等级
-        updateLevel();
+    // 锁定后生成了新方块
+    Changes changes = BoardChange | PieceChange;
+    if (after.level != before.level) {
+        // 加快下落速度
+        m_dropInterval = TetrisEngine::dropIntervalMs(after.level);
+        m_gameTimer->setInterval(m_dropInterval);
+        changes |= LevelChange;
+    }
+    if (after.score != before.score) {
+        changes |= ScoreChange;
+    }
+    if (after.lines != before.lines) {
+        changes |= LinesChange;
+    }
 
-        emit scoreChanged(m_score);
-        emit linesChanged(m_lines);
+    // 检查游戏结束
+    if (after.gameOver && !before.gameOver) {
+        m_gameTimer->stop();
+        stopPlayClock();
+        changes |= GameOverChange;
     }
+
+    markChanged(changes);
 }
 
-void TetrisGame::updateLevel()
+void TetrisGame::markChanged(Changes changes)
 {
-    int newLevel = (m_lines / 10) + 1;
-    if (newLevel > m_level) {
-        m_level = newLevel;
-        // 加快下落速度
-        m_dropInterval = qMax(100, 1000 - (m_level - 1) * 100);
-        m_gameTimer->setInterval(m_dropInterval);
-        emit levelChanged(m_level);
+    m_pendingChanges |= changes;
+    if (!m_flushScheduled) {
+        m_flushScheduled = true;
+        QMetaObject::invokeMethod(this, &TetrisGame::flushChanges, Qt::QueuedConnection);
     }
 }
 
-void TetrisGame::updateBoard()
+void TetrisGame::flushChanges()
 {
-    emit boardChanged();
-}
\ No newline at end of file
+    const Changes changes = m_pendingChanges;
+    m_pendingChanges = {};
+    m_flushScheduled = false;
+    if (changes) {
+        emit stateChanged(changes);
+    }
+}
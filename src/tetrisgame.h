@@ -6,22 +6,40 @@
 #include <QColor>
 #include <QTimer>
 #include <QObject>
+#include <QElapsedTimer>
+#include "tetromino.h"
+#include "tetrisengine.h"
+#include "replay.h"
+#include "telemetry.h"
 
-// 方块形状定义
-enum class Tetromino {
-    I, O, T, S, Z, J, L
-};
-
-// 方块旋转状态
-enum class Rotation {
-    North, East, South, West
-};
+class RotationSystem;
 
 class TetrisGame : public QObject
 {
     Q_OBJECT
 
 public:
+    // 变化类型，按位组合
+    enum Change {
+        BoardChange = 1 << 0,   // 方块位置或棋盘内容
+        PieceChange = 1 << 1,   // 方块锁定，生成了新方块
+        ScoreChange = 1 << 2,
+        LevelChange = 1 << 3,
+        LinesChange = 1 << 4,
+        GameOverChange = 1 << 5
+    };
+    Q_DECLARE_FLAGS(Changes, Change)
+    Q_FLAG(Changes)
+
+    // 最近一次锁定的方块落点
+    struct LockedPiece {
+        Tetromino type;
+        Rotation rotation;
+        int x;
+        int y;
+        int pieceCount;     // 锁定后的方块计数
+    };
+
     explicit TetrisGame(QObject *parent = nullptr);
     ~TetrisGame();
 
@@ -35,9 +53,13 @@ public:
     void moveLeft();
     void moveRight();
     void moveDown();
-    void rotate();
+    void rotate(RotationDirection direction = RotationDirection::Clockwise);
     void hardDrop();
 
+    // 旋转系统（墙踢规则），可在运行时切换
+    void setRotationSystem(const RotationSystem *system);
+    const RotationSystem *rotationSystem() const;
+
     // 游戏状态查询
     bool isGameOver() const;
     bool isPaused() const;
@@ -45,9 +67,16 @@ public:
     int getScore() const;
     int getLevel() const;
     int getLines() const;
+    int getPieceCount() const;
+    quint64 getSeed() const;
+    // 实际游戏时长（不含暂停）
+    qint64 getPlayTimeMs() const;
 
     // 获取游戏板数据
-    const QVector<QVector<int>>& getBoard() const;
+    static constexpr int boardWidth() { return TetrisEngine::BOARD_WIDTH; }
+    static constexpr int boardHeight() { return TetrisEngine::BOARD_HEIGHT; }
+    quint16 getRowMask(int y) const;
+    bool isCellFilled(int x, int y) const;
     QVector<QPoint> getCurrentPiece() const;
     QColor getCurrentPieceColor() const;
     QVector<QPoint> getNextPiece() const;
@@ -55,62 +84,84 @@ public:
     QPoint getCurrentPos() const;
     QPoint getShadowPos() const;
 
+    // 底层引擎状态（只读）
+    const TetrisEngine &engine() const;
+
+    // 快照与恢复：复制引擎的定长状态结构，恢复后按新状态刷新定时器和界面；
+    // playTimeMs 为快照时已进行的时长，恢复后从它接着计时
+    TetrisEngine::State saveState() const;
+    void restoreState(const TetrisEngine::State &state, qint64 playTimeMs);
+
+    // 本局回放（从开局或最近一次恢复开始）
+    const Replay &replay() const;
+
+    // 遥测事件流，nullptr 表示不记录；记录器由调用方持有
+    void setTelemetry(Telemetry *telemetry);
+
+    const LockedPiece &lastLock() const;
+
+    // 方块形状与颜色
+    static QVector<QPoint> getTetrominoShape(Tetromino type, Rotation rotation);
+    static QColor getTetrominoColor(Tetromino type);
+
 signals:
-    void boardChanged();
-    void scoreChanged(int score);
-    void levelChanged(int level);
-    void linesChanged(int lines);
-    void gameOverSignal();
-    void pieceChanged();
+    // 同一轮事件循环中的所有变化合并为一次通知，连续输入不会逐次触发界面更新
+    void stateChanged(TetrisGame::Changes changes);
 
 private slots:
     void gameLoop();
+    void flushChanges();
 
 private:
-    // 游戏板
-    static const int BOARD_WIDTH = 10;
-    static const int BOARD_HEIGHT = 20;
-    QVector<QVector<int>> m_board;
-
-    // 当前方块
-    Tetromino m_currentTetromino;
-    Rotation m_currentRotation;
-    QPoint m_currentPos;
-    QColor m_currentColor;
-
-    // 下一个方块
-    Tetromino m_nextTetromino;
-    QColor m_nextColor;
+    // 引擎操作前的状态摘要，用于比较后发出对应信号
+    struct Summary {
+        int score;
+        int level;
+        int lines;
+        int pieceCount;
+        bool gameOver;
+        // 操作前的方块，用于记录锁定事件（硬降时 pieceY 为落点）
+        Tetromino piece;
+        Rotation rotation;
+        int pieceX;
+        int pieceY;
+    };
+
+    Summary summary() const;
+    void applyChanges(const Summary &before);
+
+    // 待发出的变化
+    Changes m_pendingChanges;
+    bool m_flushScheduled;
+    void markChanged(Changes changes);
+
+    LockedPiece m_lastLock;
+
+    // 游戏核心
+    TetrisEngine m_engine;
 
     // 游戏状态
-    bool m_gameOver;
     bool m_paused;
-    bool m_gameStarted;
-    int m_score;
-    int m_level;
-    int m_lines;
 
     // 游戏循环
     QTimer *m_gameTimer;
     int m_dropInterval;
 
-    // 方块定义
-    QVector<QPoint> getTetrominoShape(Tetromino type, Rotation rotation) const;
-    QColor getTetrominoColor(Tetromino type) const;
-    Tetromino getRandomTetromino() const;
-
-    // 碰撞检测
-    bool isValidPosition(const QVector<QPoint>& piece, const QPoint& pos) const;
-    bool checkCollision(const QVector<QPoint>& piece, const QPoint& pos) const;
+    // 游戏计时：暂停前累计的时长 + 当前连续进行的时长
+    QElapsedTimer m_playClock;
+    qint64 m_playTimeMs;
+    void stopPlayClock();
 
-    // 方块操作
-    void spawnPiece();
-    void lockPiece();
-    void clearLines();
-    void updateLevel();
+    // 回放记录：只记录进行中对局的操作
+    Replay m_replay;
+    void record(Replay::Action action, quint8 arg = 0);
 
-    // 辅助函数
-    void updateBoard();
+    // 遥测
+    Telemetry *m_telemetry;
+    void logEvent(quint32 timeMs, Telemetry::EventType type, qint8 detail = 0, quint64 value = 0);
+    void logLock(const Summary &before, const Summary &after);
 };
 
-#endif // TETRISGAME_H
\ No newline at end of file
+Q_DECLARE_OPERATORS_FOR_FLAGS(TetrisGame::Changes)
+
+#endif // TETRISGAME_H
@@ -0,0 +1,118 @@
+#ifndef TETROMINO_H
+#define TETROMINO_H
+
+#include <array>
+#include <cstdint>
+
+// 方块形状定义
+enum class Tetromino : std::uint8_t {
+    I, O, T, S, Z, J, L
+};
+
+// 方块旋转状态
+enum class Rotation : std::uint8_t {
+    North, East, South, West
+};
+
+// 旋转方向
+enum class RotationDirection {
+    Clockwise, CounterClockwise, Half
+};
+
+constexpr int TETROMINO_COUNT = 7;
+constexpr int ROTATION_COUNT = 4;
+
+// 方块格子坐标：相对于4x4包围盒左上角，y轴向下
+struct PieceCell {
+    std::int8_t x;
+    std::int8_t y;
+};
+
+using PieceCells = std::array<PieceCell, 4>;
+
+// 方块在包围盒内每一行的位掩码（bit x 表示第x列）
+using PieceMasks = std::array<std::uint8_t, 4>;
+
+namespace TetrominoData {
+
+// SRS出生朝向（North）下的格子坐标
+constexpr PieceCells SPAWN_CELLS[TETROMINO_COUNT] = {
+    {{{0, 1}, {1, 1}, {2, 1}, {3, 1}}},   // I
+    {{{1, 0}, {2, 0}, {1, 1}, {2, 1}}},   // O
+    {{{1, 0}, {0, 1}, {1, 1}, {2, 1}}},   // T
+    {{{1, 0}, {2, 0}, {0, 1}, {1, 1}}},   // S
+    {{{0, 0}, {1, 0}, {1, 1}, {2, 1}}},   // Z
+    {{{0, 0}, {0, 1}, {1, 1}, {2, 1}}},   // J
+    {{{2, 0}, {0, 1}, {1, 1}, {2, 1}}},   // L
+};
+
+// 旋转包围盒边长：I为4x4，JLSTZ为3x3，O不旋转
+constexpr int BOX_SIZE[TETROMINO_COUNT] = {4, 0, 3, 3, 3, 3, 3};
+
+constexpr PieceCells rotateClockwise(PieceCells cells, int box)
+{
+    if (box == 0) {
+        return cells;
+    }
+    for (auto &cell : cells) {
+        const std::int8_t x = cell.x;
+        cell.x = static_cast<std::int8_t>(box - 1 - cell.y);
+        cell.y = x;
+    }
+    return cells;
+}
+
+constexpr auto buildCells()
+{
+    std::array<std::array<PieceCells, ROTATION_COUNT>, TETROMINO_COUNT> table{};
+    for (int t = 0; t < TETROMINO_COUNT; ++t) {
+        PieceCells cells = SPAWN_CELLS[t];
+        for (int r = 0; r < ROTATION_COUNT; ++r) {
+            table[t][r] = cells;
+            cells = rotateClockwise(cells, BOX_SIZE[t]);
+        }
+    }
+    return table;
+}
+
+constexpr auto CELLS = buildCells();
+
+constexpr auto buildMasks()
+{
+    std::array<std::array<PieceMasks, ROTATION_COUNT>, TETROMINO_COUNT> table{};
+    for (int t = 0; t < TETROMINO_COUNT; ++t) {
+        for (int r = 0; r < ROTATION_COUNT; ++r) {
+            for (const auto &cell : CELLS[t][r]) {
+                table[t][r][cell.y] |= static_cast<std::uint8_t>(1u << cell.x);
+            }
+        }
+    }
+    return table;
+}
+
+constexpr auto MASKS = buildMasks();
+
+} // namespace TetrominoData
+
+constexpr const PieceCells &tetrominoCells(Tetromino type, Rotation rotation)
+{
+    return TetrominoData::CELLS[static_cast<int>(type)][static_cast<int>(rotation)];
+}
+
+constexpr const PieceMasks &tetrominoMasks(Tetromino type, Rotation rotation)
+{
+    return TetrominoData::MASKS[static_cast<int>(type)][static_cast<int>(rotation)];
+}
+
+constexpr Rotation rotated(Rotation rotation, RotationDirection direction)
+{
+    int steps = 1;
+    switch (direction) {
+        case RotationDirection::Clockwise: steps = 1; break;
+        case RotationDirection::CounterClockwise: steps = 3; break;
+        case RotationDirection::Half: steps = 2; break;
+    }
+    return static_cast<Rotation>((static_cast<int>(rotation) + steps) % ROTATION_COUNT);
+}
+
+#endif // TETROMINO_H
@@ -0,0 +1,61 @@
+#include "theme.h"
+#include <QApplication>
+#include <QLabel>
+#include <QPalette>
+#include <QPushButton>
+#include <QStyleFactory>
+
+namespace Theme {
+
+void apply(QApplication &app)
+{
+    if (QStyle *style = QStyleFactory::create("Fusion")) {
+        QApplication::setStyle(style);
+    }
+
+    QPalette palette;
+    palette.setColor(QPalette::Window, QColor(BACKGROUND));
+    palette.setColor(QPalette::WindowText, QColor(TEXT));
+    palette.setColor(QPalette::Base, QColor(PANEL));
+    palette.setColor(QPalette::AlternateBase, QColor(BACKGROUND));
+    palette.setColor(QPalette::Text, QColor(TEXT));
+    palette.setColor(QPalette::Button, QColor(PANEL));
+    palette.setColor(QPalette::ButtonText, QColor(TEXT));
+    palette.setColor(QPalette::Highlight, QColor(START));
+    palette.setColor(QPalette::HighlightedText, QColor(TEXT));
+    palette.setColor(QPalette::ToolTipBase, QColor(PANEL));
+    palette.setColor(QPalette::ToolTipText, QColor(TEXT));
+    palette.setColor(QPalette::Disabled, QPalette::WindowText, QColor(SECONDARY_TEXT).darker(150));
+    palette.setColor(QPalette::Disabled, QPalette::ButtonText, QColor(SECONDARY_TEXT).darker(150));
+    palette.setColor(QPalette::Disabled, QPalette::Text, QColor(SECONDARY_TEXT).darker(150));
+    app.setPalette(palette);
+}
+
+void setLabelStyle(QLabel *label, int pixelSize, bool bold, QRgb color)
+{
+    QFont font = label->font();
+    font.setPixelSize(pixelSize);
+    font.setBold(bold);
+    label->setFont(font);
+
+    QPalette palette = label->palette();
+    palette.setColor(QPalette::WindowText, QColor(color));
+    label->setPalette(palette);
+}
+
+void setButtonColor(QPushButton *button, QRgb color)
+{
+    QFont font = button->font();
+    font.setPixelSize(14);
+    button->setFont(font);
+    // 与原来 12px 内边距的按钮同高
+    button->setMinimumHeight(42);
+
+    QPalette palette = button->palette();
+    palette.setColor(QPalette::Button, QColor(color));
+    palette.setColor(QPalette::ButtonText, QColor(TEXT));
+    palette.setColor(QPalette::Disabled, QPalette::Button, QColor(color).darker(180));
+    button->setPalette(palette);
+}
+
+} // namespace Theme
@@ -0,0 +1,36 @@
+#ifndef THEME_H
+#define THEME_H
+
+#include <QColor>
+#include <QRgb>
+
+class QApplication;
+class QLabel;
+class QPushButton;
+
+// 界面配色：启动时设置一次 Fusion 风格和深色调色板，各控件只改字体和调色板
+//
+// 不使用样式表。样式表要在每个控件上解析、匹配规则并重新 polish，
+// 启动时全部控件都要走一遍；调色板和字体只是复制几个值。
+namespace Theme {
+
+constexpr QRgb BACKGROUND = qRgb(0x1a, 0x1a, 0x2e);
+constexpr QRgb PANEL = qRgb(0x2a, 0x2a, 0x40);
+constexpr QRgb TEXT = qRgb(0xff, 0xff, 0xff);
+constexpr QRgb SECONDARY_TEXT = qRgb(0xcc, 0xcc, 0xcc);
+
+// 按钮底色
+constexpr QRgb START = qRgb(0x4c, 0xaf, 0x50);
+constexpr QRgb PAUSE = qRgb(0xff, 0x98, 0x00);
+constexpr QRgb RESET = qRgb(0xf4, 0x43, 0x36);
+
+// 在创建任何窗口之前调用
+void apply(QApplication &app);
+
+void setLabelStyle(QLabel *label, int pixelSize, bool bold, QRgb color);
+// 按钮底色，文字为白色，禁用时变暗
+void setButtonColor(QPushButton *button, QRgb color);
+
+} // namespace Theme
+
+#endif // THEME_H
@@ -0,0 +1,76 @@
+#include "timerwheel.h"
+#include <algorithm>
+
+TimerWheel::TimerWheel(std::uint32_t capacity, std::uint32_t slotCount)
+    : m_nodes(capacity, Node{0, NONE, IDLE, 0})
+    , m_heads(slotCount, NONE)
+    , m_mask(slotCount - 1)
+    , m_now(0)
+    , m_size(0)
+{
+    m_firing.reserve(capacity);
+}
+
+void TimerWheel::schedule(std::uint32_t id, std::uint64_t dueMs)
+{
+    Node &node = m_nodes[id];
+    if (node.prev == IDLE) {
+        ++m_size;
+    } else if (node.prev != FIRING) {
+        unlink(id);
+    }
+
+    node.due = dueMs;
+    const std::uint32_t slot = static_cast<std::uint32_t>(std::max(dueMs, m_now + 1) & m_mask);
+    node.slot = slot;
+    node.prev = NONE;
+    node.next = m_heads[slot];
+    if (node.next != NONE) {
+        m_nodes[node.next].prev = id;
+    }
+    m_heads[slot] = id;
+}
+
+void TimerWheel::cancel(std::uint32_t id)
+{
+    Node &node = m_nodes[id];
+    if (node.prev == IDLE) return;
+    if (node.prev != FIRING) {
+        unlink(id);
+    }
+    node.prev = IDLE;
+    --m_size;
+}
+
+bool TimerWheel::isScheduled(std::uint32_t id) const
+{
+    return m_nodes[id].prev != IDLE;
+}
+
+std::uint64_t TimerWheel::now() const
+{
+    return m_now;
+}
+
+std::size_t TimerWheel::size() const
+{
+    return m_size;
+}
+
+std::size_t TimerWheel::memoryUsage() const
+{
+    return m_nodes.capacity() * sizeof(Node) + (m_heads.capacity() + m_firing.capacity()) * sizeof(std::uint32_t);
+}
+
+void TimerWheel::unlink(std::uint32_t id)
+{
+    Node &node = m_nodes[id];
+    if (node.next != NONE) {
+        m_nodes[node.next].prev = node.prev;
+    }
+    if (node.prev == NONE) {
+        m_heads[node.slot] = node.next;
+    } else {
+        m_nodes[node.prev].next = node.next;
+    }
+}
@@ -0,0 +1,95 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 毫秒精度的哈希时间轮：成千上万个周期定时器共用一个时钟源
+//
+// 定时器用 0..capacity-1 的编号表示，节点在构造时一次分配，之后安排和取消
+// 都是 O(1) 的链表操作，不再分配内存。到期时间超过一圈的定时器留在槽里，
+// 转到对应的那一圈才触发。
+class TimerWheel
+{
+public:
+    // slotCount 必须是2的幂，一圈的毫秒数
+    explicit TimerWheel(std::uint32_t capacity, std::uint32_t slotCount = 2048);
+
+    // 安排编号 id 在 dueMs 到期，已安排的先取消；不晚于当前时间的在下一次推进时触发
+    void schedule(std::uint32_t id, std::uint64_t dueMs);
+    void cancel(std::uint32_t id);
+    bool isScheduled(std::uint32_t id) const;
+
+    // 最近一次推进到的时间
+    std::uint64_t now() const;
+    std::size_t size() const;
+    std::size_t memoryUsage() const;
+
+    // 推进到 nowMs，按槽依次对到期的编号调用 fire(id, dueMs)；
+    // 回调中可以重新安排或取消任意定时器，包括同一毫秒内尚未触发的
+    template <typename Fire>
+    void advance(std::uint64_t nowMs, Fire &&fire);
+
+private:
+    static constexpr std::uint32_t NONE = 0xffffffffu;
+    // Node::prev 的特殊值：未安排、已取出等待触发
+    static constexpr std::uint32_t IDLE = 0xfffffffeu;
+    static constexpr std::uint32_t FIRING = 0xfffffffdu;
+
+    struct Node {
+        std::uint64_t due;
+        std::uint32_t next;
+        std::uint32_t prev;     // 链表头的 prev 为 NONE
+        std::uint32_t slot;
+    };
+
+    void unlink(std::uint32_t id);
+
+    std::vector<Node> m_nodes;
+    std::vector<std::uint32_t> m_heads;
+    std::vector<std::uint32_t> m_firing;
+    std::uint64_t m_mask;
+    std::uint64_t m_now;
+    std::size_t m_size;
+};
+
+template <typename Fire>
+void TimerWheel::advance(std::uint64_t nowMs, Fire &&fire)
+{
+    if (nowMs <= m_now) return;
+
+    // 停顿超过一圈时每个槽只需要走一遍，到期的全部按 nowMs 判定
+    const std::uint64_t steps = nowMs - m_now;
+    const bool wrapped = steps > m_mask;
+    const std::uint64_t first = wrapped ? nowMs - m_mask : m_now + 1;
+
+    for (std::uint64_t t = first; t <= nowMs; ++t) {
+        const std::uint64_t limit = wrapped ? nowMs : t;
+        std::uint32_t id = m_heads[t & m_mask];
+        if (id == NONE) continue;
+
+        // 先把到期的全部摘下再触发，回调对链表的修改不会影响遍历
+        m_firing.clear();
+        while (id != NONE) {
+            const std::uint32_t next = m_nodes[id].next;
+            if (m_nodes[id].due <= limit) {
+                unlink(id);
+                m_nodes[id].prev = FIRING;
+                m_firing.push_back(id);
+            }
+            id = next;
+        }
+        for (std::uint32_t firing : m_firing) {
+            // 已被回调取消或重新安排的不再触发
+            if (m_nodes[firing].prev != FIRING) continue;
+            m_nodes[firing].prev = IDLE;
+            --m_size;
+            m_now = t;
+            fire(firing, m_nodes[firing].due);
+        }
+    }
+    m_now = nowMs;
+}
+
+#endif // TIMERWHEEL_H
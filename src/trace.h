@@ -0,0 +1,211 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+// 函数级追踪：作用域计时片段，导出为 Chrome trace JSON，可在 Perfetto 或 chrome://tracing 中查看时间线
+//
+// 以 -DTETRIS_TRACE=ON 构建时，TRACE_SCOPE 记录所在作用域的起止时间；否则展开为空语句，
+// 不产生任何代码。设置环境变量 TETRIS_TRACE_FILE 后，第一个片段出现时开始记录，进程退出时
+// 写完文件。每个线程第一次记录时分配自己的无锁环形缓冲，之后记录一个片段只是两次读时钟
+// 和一次入队，不加锁、不分配；后台线程定期取出各缓冲中的片段写成 JSON，缓冲满时丢弃并计数。
+// 不依赖 Qt，引擎和 AI 中同样可用。片段名必须是不含引号的字符串字面量（只保存指针）。
+
+#ifdef TETRIS_TRACE
+
+#include "spscring.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Trace {
+
+struct Event {
+    const char *name;
+    std::uint64_t startNs;
+    std::uint64_t durationNs;
+};
+
+class Recorder
+{
+public:
+    static constexpr std::size_t RING_CAPACITY = 1 << 16;
+    // 后台线程取出片段的间隔
+    static constexpr int FLUSH_INTERVAL_MS = 20;
+
+    static Recorder &instance()
+    {
+        static Recorder recorder;
+        return recorder;
+    }
+
+    bool start(const char *path)
+    {
+        stop();
+        m_file = std::fopen(path, "wb");
+        if (!m_file) return false;
+
+        std::fputs("{\"traceEvents\":[\n", m_file);
+        m_firstEvent = true;
+        m_origin = std::chrono::steady_clock::now();
+        m_stopping.store(false, std::memory_order_relaxed);
+        m_collector = std::thread([this]() { collectorLoop(); });
+        m_enabled.store(true, std::memory_order_release);
+        return true;
+    }
+
+    void stop()
+    {
+        if (!m_file) return;
+
+        m_enabled.store(false, std::memory_order_relaxed);
+        m_stopping.store(true, std::memory_order_release);
+        m_collector.join();
+        drain();
+        std::fprintf(m_file, "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped\":\"%llu\"}}\n",
+                     static_cast<unsigned long long>(m_dropped.load(std::memory_order_relaxed)));
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+
+    bool isEnabled() const
+    {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t now() const
+    {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_origin).count());
+    }
+
+    void record(const char *name, std::uint64_t startNs, std::uint64_t endNs)
+    {
+        if (!threadBuffer()->ring.tryPush({name, startNs, endNs - startNs})) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    std::uint64_t droppedCount() const
+    {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct ThreadBuffer {
+        SpscRing<Event, RING_CAPACITY> ring;
+        std::uint32_t threadId;
+    };
+
+    Recorder()
+    {
+        if (const char *path = std::getenv("TETRIS_TRACE_FILE")) {
+            start(path);
+        }
+    }
+
+    ~Recorder()
+    {
+        stop();
+    }
+
+    // 每个线程只在第一次记录时加锁登记
+    ThreadBuffer *threadBuffer()
+    {
+        thread_local ThreadBuffer *buffer = nullptr;
+        if (!buffer) {
+            auto created = std::make_unique<ThreadBuffer>();
+            buffer = created.get();
+            std::lock_guard<std::mutex> lock(m_buffersMutex);
+            created->threadId = static_cast<std::uint32_t>(m_buffers.size() + 1);
+            m_buffers.push_back(std::move(created));
+        }
+        return buffer;
+    }
+
+    void collectorLoop()
+    {
+        while (!m_stopping.load(std::memory_order_acquire)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(FLUSH_INTERVAL_MS));
+            drain();
+        }
+    }
+
+    void drain()
+    {
+        Event events[256];
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+        for (const std::unique_ptr<ThreadBuffer> &buffer : m_buffers) {
+            std::size_t count;
+            while ((count = buffer->ring.popBatch(events, std::size(events))) > 0) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    // Chrome trace 的时间单位是微秒
+                    std::fprintf(m_file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                                 m_firstEvent ? "" : ",\n", events[i].name, events[i].startNs / 1000.0,
+                                 events[i].durationNs / 1000.0, buffer->threadId);
+                    m_firstEvent = false;
+                }
+            }
+        }
+    }
+
+    std::atomic<bool> m_enabled{false};
+    std::atomic<bool> m_stopping{false};
+    std::atomic<std::uint64_t> m_dropped{0};
+    std::chrono::steady_clock::time_point m_origin;
+
+    // 只在线程登记和后台线程取出时加锁
+    std::mutex m_buffersMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+
+    std::thread m_collector;
+    std::FILE *m_file = nullptr;
+    bool m_firstEvent = true;
+};
+
+// 作用域片段：构造时读时钟，析构时入队
+class Span
+{
+public:
+    explicit Span(const char *name)
+        : m_name(name)
+        , m_active(Recorder::instance().isEnabled())
+        , m_start(m_active ? Recorder::instance().now() : 0)
+    {
+    }
+
+    ~Span()
+    {
+        if (m_active) {
+            Recorder &recorder = Recorder::instance();
+            recorder.record(m_name, m_start, recorder.now());
+        }
+    }
+
+    Span(const Span &) = delete;
+    Span &operator=(const Span &) = delete;
+
+private:
+    const char *m_name;
+    bool m_active;
+    std::uint64_t m_start;
+};
+
+} // namespace Trace
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) ::Trace::Span TRACE_CONCAT(traceSpan, __LINE__)(name)
+
+#else
+
+#define TRACE_SCOPE(name) static_cast<void>(0)
+
+#endif // TETRIS_TRACE
+
+#endif // TRACE_H
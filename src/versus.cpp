@@ -0,0 +1,235 @@
+#include "versus.h"
+#include <limits>
+
+namespace {
+
+constexpr std::uint32_t NO_FRAME = std::numeric_limits<std::uint32_t>::max();
+
+// 远端输入的预测值：按键是边沿触发的，重复上一帧反而更容易猜错
+constexpr std::uint8_t PREDICTED_INPUT = TetrisEngine::InputNone;
+
+} // namespace
+
+void resetVersus(VersusState &state, std::uint64_t seed)
+{
+    for (TetrisEngine &player : state.players) {
+        player.reset(seed);
+        player.start();
+    }
+    state.frame = 0;
+    state.winner = -1;
+    state.endFrame = 0;
+}
+
+void stepVersus(VersusState &state, std::uint8_t input0, std::uint8_t input1)
+{
+    ++state.frame;
+    if (state.winner >= 0) return;
+
+    TetrisEngine &first = state.players[0];
+    TetrisEngine &second = state.players[1];
+
+    first.tick(input0);
+    second.tick(input1);
+
+    // 同一帧内双方的攻击同时生效
+    const int attack0 = first.takeOutgoingGarbage();
+    const int attack1 = second.takeOutgoingGarbage();
+    second.queueGarbage(attack0);
+    first.queueGarbage(attack1);
+
+    if (first.isGameOver() && second.isGameOver()) {
+        state.winner = 2;
+    } else if (first.isGameOver()) {
+        state.winner = 1;
+    } else if (second.isGameOver()) {
+        state.winner = 0;
+    }
+    if (state.winner >= 0) {
+        state.endFrame = state.frame;
+    }
+}
+
+InputPacket encodeInputFrame(const InputFrame &frame)
+{
+    return {static_cast<std::uint8_t>(frame.frame),
+            static_cast<std::uint8_t>(frame.frame >> 8),
+            static_cast<std::uint8_t>(frame.frame >> 16),
+            static_cast<std::uint8_t>(frame.frame >> 24),
+            frame.player,
+            frame.inputs};
+}
+
+InputFrame decodeInputFrame(const InputPacket &packet)
+{
+    InputFrame frame;
+    frame.frame = std::uint32_t(packet[0]) | (std::uint32_t(packet[1]) << 8)
+                | (std::uint32_t(packet[2]) << 16) | (std::uint32_t(packet[3]) << 24);
+    frame.player = packet[4];
+    frame.inputs = packet[5];
+    return frame;
+}
+
+LoopbackLink::LoopbackLink(int latencyTicks)
+    : m_now(0)
+    , m_latency(latencyTicks)
+{
+    m_endpoints[0] = std::make_unique<Endpoint>(this, 0);
+    m_endpoints[1] = std::make_unique<Endpoint>(this, 1);
+}
+
+MatchTransport *LoopbackLink::endpoint(int side)
+{
+    return m_endpoints[side & 1].get();
+}
+
+void LoopbackLink::tick()
+{
+    ++m_now;
+}
+
+void LoopbackLink::setLatency(int latencyTicks)
+{
+    m_latency = latencyTicks < 0 ? 0 : latencyTicks;
+}
+
+int LoopbackLink::latency() const
+{
+    return m_latency;
+}
+
+LoopbackLink::Endpoint::Endpoint(LoopbackLink *link, int side)
+    : m_link(link)
+    , m_side(side)
+{
+}
+
+void LoopbackLink::Endpoint::send(const InputPacket &packet)
+{
+    // 投递到对端的接收队列
+    m_link->m_queues[m_side ^ 1].push_back({m_link->m_now + m_link->m_latency, packet});
+}
+
+bool LoopbackLink::Endpoint::receive(InputPacket &packet)
+{
+    auto &queue = m_link->m_queues[m_side];
+    if (queue.empty() || queue.front().deliverAt > m_link->m_now) {
+        return false;
+    }
+    packet = queue.front().packet;
+    queue.pop_front();
+    return true;
+}
+
+VersusSession::VersusSession(int localPlayer, std::uint64_t seed, MatchTransport *transport)
+    : m_localPlayer(localPlayer & 1)
+    , m_transport(transport)
+    , m_confirmedFrame(0)
+    , m_mispredictFrame(NO_FRAME)
+    , m_rollbackCount(0)
+    , m_rollbackFrames(0)
+{
+    resetVersus(m_state, seed);
+    m_localInputs.fill(0);
+    m_remoteInputs.fill(0);
+    m_usedRemoteInputs.fill(0);
+    m_remoteFrames.fill(NO_FRAME);
+}
+
+bool VersusSession::advance(std::uint8_t localInput)
+{
+    receiveRemote();
+
+    // 预测错误：恢复到出错帧开始前的快照，用已知输入重新模拟到当前帧。
+    // 窗口已满时也先回滚，保证返回后的状态与已确认的输入一致
+    if (m_mispredictFrame != NO_FRAME) {
+        const std::uint32_t target = m_state.frame;
+        m_state = m_history[m_mispredictFrame % MAX_ROLLBACK];
+        ++m_rollbackCount;
+        m_rollbackFrames += static_cast<int>(target - m_mispredictFrame);
+        m_mispredictFrame = NO_FRAME;
+        while (m_state.frame < target) {
+            simulateFrame();
+        }
+    }
+
+    // 回滚窗口已满：不能再预测更多帧
+    if (m_state.frame >= m_confirmedFrame + MAX_ROLLBACK - 1) {
+        return false;
+    }
+
+    const std::uint32_t frame = m_state.frame;
+    m_localInputs[frame % MAX_ROLLBACK] = localInput;
+    m_transport->send(encodeInputFrame({frame, static_cast<std::uint8_t>(m_localPlayer), localInput}));
+
+    simulateFrame();
+    return true;
+}
+
+const VersusState &VersusSession::state() const
+{
+    return m_state;
+}
+
+int VersusSession::localPlayer() const
+{
+    return m_localPlayer;
+}
+
+std::uint32_t VersusSession::confirmedFrame() const
+{
+    return m_confirmedFrame;
+}
+
+int VersusSession::rollbackCount() const
+{
+    return m_rollbackCount;
+}
+
+int VersusSession::rollbackFrames() const
+{
+    return m_rollbackFrames;
+}
+
+void VersusSession::receiveRemote()
+{
+    InputPacket packet;
+    while (m_transport->receive(packet)) {
+        const InputFrame input = decodeInputFrame(packet);
+        if (input.player == m_localPlayer || input.frame < m_confirmedFrame) {
+            continue;
+        }
+
+        const std::size_t slot = input.frame % MAX_ROLLBACK;
+        m_remoteInputs[slot] = input.inputs;
+        m_remoteFrames[slot] = input.frame;
+
+        // 该帧已按预测值模拟过，且预测错误
+        if (input.frame < m_state.frame && m_usedRemoteInputs[slot] != input.inputs
+            && input.frame < m_mispredictFrame) {
+            m_mispredictFrame = input.frame;
+        }
+
+        while (m_remoteFrames[m_confirmedFrame % MAX_ROLLBACK] == m_confirmedFrame) {
+            ++m_confirmedFrame;
+        }
+    }
+}
+
+void VersusSession::simulateFrame()
+{
+    const std::uint32_t frame = m_state.frame;
+    const std::size_t slot = frame % MAX_ROLLBACK;
+
+    m_history[slot] = m_state;
+
+    const std::uint8_t remote = m_remoteFrames[slot] == frame ? m_remoteInputs[slot] : PREDICTED_INPUT;
+    m_usedRemoteInputs[slot] = remote;
+
+    const std::uint8_t local = m_localInputs[slot];
+    if (m_localPlayer == 0) {
+        stepVersus(m_state, local, remote);
+    } else {
+        stepVersus(m_state, remote, local);
+    }
+}
@@ -0,0 +1,129 @@
+#ifndef VERSUS_H
+#define VERSUS_H
+
+#include "tetrisengine.h"
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+// 双人对战的完整模拟状态：两个引擎加帧号，可按字节复制，回滚时直接整体覆盖
+struct VersusState {
+    std::array<TetrisEngine, 2> players;
+    std::uint32_t frame;
+    // -1 未结束，0/1 为胜者，2 为平局
+    std::int8_t winner;
+    // 分出胜负的那一帧推进之后的帧号；之前的输入全部确认后结局不会再被回滚改变
+    std::uint32_t endFrame;
+};
+
+// 以相同种子开始一局，双方方块序列相同
+void resetVersus(VersusState &state, std::uint64_t seed);
+
+// 推进一帧：双方各自处理输入，再交换本帧产生的垃圾行
+void stepVersus(VersusState &state, std::uint8_t input0, std::uint8_t input1);
+
+// 输入帧：帧号 + 玩家 + 输入位，编码为定长6字节
+struct InputFrame {
+    std::uint32_t frame;
+    std::uint8_t player;
+    std::uint8_t inputs;
+};
+
+constexpr std::size_t INPUT_PACKET_SIZE = 6;
+using InputPacket = std::array<std::uint8_t, INPUT_PACKET_SIZE>;
+
+InputPacket encodeInputFrame(const InputFrame &frame);
+InputFrame decodeInputFrame(const InputPacket &packet);
+
+// 抽象消息传输：对战会话只通过它收发输入帧，可替换为网络实现
+class MatchTransport
+{
+public:
+    virtual ~MatchTransport() = default;
+
+    virtual void send(const InputPacket &packet) = 0;
+    // 无可读消息时返回 false，不阻塞
+    virtual bool receive(InputPacket &packet) = 0;
+};
+
+// 进程内回环链路：两个端点互相投递，可模拟固定帧数的延迟以触发回滚
+class LoopbackLink
+{
+public:
+    explicit LoopbackLink(int latencyTicks = 0);
+
+    MatchTransport *endpoint(int side);
+
+    // 推进链路时钟一帧，延迟到期的消息变为可读
+    void tick();
+
+    void setLatency(int latencyTicks);
+    int latency() const;
+
+private:
+    struct Pending {
+        std::uint64_t deliverAt;
+        InputPacket packet;
+    };
+
+    class Endpoint : public MatchTransport
+    {
+    public:
+        Endpoint(LoopbackLink *link, int side);
+        void send(const InputPacket &packet) override;
+        bool receive(InputPacket &packet) override;
+
+    private:
+        LoopbackLink *m_link;
+        int m_side;
+    };
+
+    std::array<std::deque<Pending>, 2> m_queues;
+    std::array<std::unique_ptr<Endpoint>, 2> m_endpoints;
+    std::uint64_t m_now;
+    int m_latency;
+};
+
+// 一方的对战会话：本地模拟双方引擎，远端输入未到时预测为无输入，
+// 实际输入与预测不符时恢复到该帧的快照并重新模拟到当前帧
+class VersusSession
+{
+public:
+    // 可回滚的最大帧数，超过时本地暂停推进等待远端
+    static constexpr int MAX_ROLLBACK = 32;
+
+    VersusSession(int localPlayer, std::uint64_t seed, MatchTransport *transport);
+
+    // 推进一帧，返回 false 表示因等待远端输入而停顿
+    bool advance(std::uint8_t localInput);
+
+    const VersusState &state() const;
+    int localPlayer() const;
+    std::uint32_t confirmedFrame() const;
+    int rollbackCount() const;
+    int rollbackFrames() const;
+
+private:
+    void receiveRemote();
+    void simulateFrame();
+
+    VersusState m_state;
+    int m_localPlayer;
+    MatchTransport *m_transport;
+
+    // 以帧号取模索引的环形缓冲：帧开始前的状态、本地输入、远端输入
+    std::array<VersusState, MAX_ROLLBACK> m_history;
+    std::array<std::uint8_t, MAX_ROLLBACK> m_localInputs;
+    std::array<std::uint8_t, MAX_ROLLBACK> m_remoteInputs;
+    std::array<std::uint8_t, MAX_ROLLBACK> m_usedRemoteInputs;
+    std::array<std::uint32_t, MAX_ROLLBACK> m_remoteFrames;
+
+    // 远端输入已连续确认到的下一帧
+    std::uint32_t m_confirmedFrame;
+    std::uint32_t m_mispredictFrame;
+    int m_rollbackCount;
+    int m_rollbackFrames;
+};
+
+#endif // VERSUS_H
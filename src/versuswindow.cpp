@@ -0,0 +1,168 @@
+#include "versuswindow.h"
+#include "theme.h"
+#include "tetrisboard.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QRandomGenerator>
+
+namespace {
+
+// 回环链路模拟的单向延迟（帧），让回滚路径在本地也能被触发
+constexpr int LOOPBACK_LATENCY = 4;
+
+} // namespace
+
+VersusWindow::VersusWindow(QWidget *parent)
+    : QWidget(parent)
+    , m_pendingInputs{0, 0}
+{
+    setupUI();
+
+    m_tickTimer = new QTimer(this);
+    m_tickTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_tickTimer, &QTimer::timeout, this, &VersusWindow::tick);
+
+    setWindowTitle("俄罗斯方块 - 双人对战");
+    setFocusPolicy(Qt::StrongFocus);
+    resize(1000, 700);
+
+    startMatch();
+}
+
+VersusWindow::~VersusWindow()
+{
+    m_tickTimer->stop();
+}
+
+void VersusWindow::setupUI()
+{
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    QHBoxLayout *boardsLayout = new QHBoxLayout();
+
+    for (int i = 0; i < 2; ++i) {
+        QVBoxLayout *column = new QVBoxLayout();
+
+        m_infoLabels[i] = new QLabel(this);
+        Theme::setLabelStyle(m_infoLabels[i], 14, true, Theme::TEXT);
+
+        // 棋盘只负责显示，按键统一由窗口分配给两名玩家
+        m_boards[i] = new TetrisBoard(nullptr, this);
+        m_boards[i]->setFocusPolicy(Qt::NoFocus);
+
+        column->addWidget(m_infoLabels[i]);
+        column->addWidget(m_boards[i], 1);
+        boardsLayout->addLayout(column);
+    }
+
+    m_statusLabel = new QLabel(this);
+    Theme::setLabelStyle(m_statusLabel, 12, false, Theme::SECONDARY_TEXT);
+
+    QLabel *helpLabel = new QLabel(
+        "玩家1: A/D 移动  S 下落  W/Q/E 旋转  空格 直接落地    "
+        "玩家2: ←/→ 移动  ↓ 下落  ↑/./ 旋转  回车 直接落地    F2 重新开始", this);
+    Theme::setLabelStyle(helpLabel, 12, false, Theme::SECONDARY_TEXT);
+
+    mainLayout->addLayout(boardsLayout, 1);
+    mainLayout->addWidget(m_statusLabel);
+    mainLayout->addWidget(helpLabel);
+}
+
+void VersusWindow::startMatch()
+{
+    // 双方使用同一种子，方块序列相同
+    const quint64 seed = QRandomGenerator::global()->generate64();
+
+    m_link = std::make_unique<LoopbackLink>(LOOPBACK_LATENCY);
+    for (int i = 0; i < 2; ++i) {
+        m_sessions[i] = std::make_unique<VersusSession>(i, seed, m_link->endpoint(i));
+        m_boards[i]->setEngine(&m_sessions[i]->state().players[i]);
+        m_pendingInputs[i] = 0;
+    }
+
+    updateStatus();
+    m_tickTimer->start(1000 / TetrisEngine::TICKS_PER_SECOND);
+}
+
+void VersusWindow::keyPressEvent(QKeyEvent *event)
+{
+    quint8 input = TetrisEngine::InputNone;
+    int player = 0;
+
+    switch (event->key()) {
+        // 玩家1
+        case Qt::Key_A: input = TetrisEngine::InputLeft; break;
+        case Qt::Key_D: input = TetrisEngine::InputRight; break;
+        case Qt::Key_S: input = TetrisEngine::InputSoftDrop; break;
+        case Qt::Key_W: input = TetrisEngine::InputRotateCW; break;
+        case Qt::Key_Q: input = TetrisEngine::InputRotateCCW; break;
+        case Qt::Key_E: input = TetrisEngine::InputRotate180; break;
+        case Qt::Key_Space: input = TetrisEngine::InputHardDrop; break;
+        // 玩家2
+        case Qt::Key_Left: input = TetrisEngine::InputLeft; player = 1; break;
+        case Qt::Key_Right: input = TetrisEngine::InputRight; player = 1; break;
+        case Qt::Key_Down: input = TetrisEngine::InputSoftDrop; player = 1; break;
+        case Qt::Key_Up: input = TetrisEngine::InputRotateCW; player = 1; break;
+        case Qt::Key_Period: input = TetrisEngine::InputRotateCCW; player = 1; break;
+        case Qt::Key_Slash: input = TetrisEngine::InputRotate180; player = 1; break;
+        case Qt::Key_Return:
+        case Qt::Key_Enter: input = TetrisEngine::InputHardDrop; player = 1; break;
+        case Qt::Key_F2:
+            startMatch();
+            return;
+        default:
+            QWidget::keyPressEvent(event);
+            return;
+    }
+
+    m_pendingInputs[player] |= input;
+}
+
+void VersusWindow::tick()
+{
+    m_link->tick();
+
+    // 被回滚窗口卡住的一方保留输入到下一帧
+    for (int i = 0; i < 2; ++i) {
+        if (m_sessions[i]->advance(m_pendingInputs[i])) {
+            m_pendingInputs[i] = 0;
+        }
+    }
+
+    m_boards[0]->refresh();
+    m_boards[1]->refresh();
+    updateStatus();
+
+    // 两方都已确认到分出胜负的那一帧、结局一致后停止；之后的帧不会再改变结局
+    const VersusState &state0 = m_sessions[0]->state();
+    const VersusState &state1 = m_sessions[1]->state();
+    if (state0.winner >= 0 && state0.winner == state1.winner && state0.endFrame == state1.endFrame
+        && m_sessions[0]->confirmedFrame() >= state0.endFrame
+        && m_sessions[1]->confirmedFrame() >= state1.endFrame) {
+        m_tickTimer->stop();
+    }
+}
+
+void VersusWindow::updateStatus()
+{
+    for (int i = 0; i < 2; ++i) {
+        const TetrisEngine &engine = m_sessions[i]->state().players[i];
+        m_infoLabels[i]->setText(QString("玩家%1  分数: %2  行数: %3  待接收垃圾行: %4")
+                                     .arg(i + 1)
+                                     .arg(engine.getScore())
+                                     .arg(engine.getLines())
+                                     .arg(engine.getPendingGarbage()));
+    }
+
+    QString status = QString("回环延迟: %1 帧  回滚: %2 次 / %3 帧")
+                         .arg(m_link->latency())
+                         .arg(m_sessions[0]->rollbackCount() + m_sessions[1]->rollbackCount())
+                         .arg(m_sessions[0]->rollbackFrames() + m_sessions[1]->rollbackFrames());
+
+    const int winner = m_sessions[0]->state().winner;
+    if (winner == 2) {
+        status += "    平局！按F2重新开始";
+    } else if (winner >= 0) {
+        status += QString("    玩家%1 获胜！按F2重新开始").arg(winner + 1);
+    }
+    m_statusLabel->setText(status);
+}
@@ -0,0 +1,46 @@
+#ifndef VERSUSWINDOW_H
+#define VERSUSWINDOW_H
+
+#include <QWidget>
+#include <QLabel>
+#include <QTimer>
+#include <QKeyEvent>
+#include <memory>
+#include "versus.h"
+
+class TetrisBoard;
+
+// 本地双人对战窗口：两个会话通过进程内回环链路交换输入，各自运行引擎
+class VersusWindow : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit VersusWindow(QWidget *parent = nullptr);
+    ~VersusWindow();
+
+    void startMatch();
+
+protected:
+    void keyPressEvent(QKeyEvent *event) override;
+
+private slots:
+    void tick();
+
+private:
+    void setupUI();
+    void updateStatus();
+
+    TetrisBoard *m_boards[2];
+    QLabel *m_infoLabels[2];
+    QLabel *m_statusLabel;
+    QTimer *m_tickTimer;
+
+    std::unique_ptr<LoopbackLink> m_link;
+    std::unique_ptr<VersusSession> m_sessions[2];
+
+    // 两次逻辑帧之间收集的按键
+    quint8 m_pendingInputs[2];
+};
+
+#endif // VERSUSWINDOW_H
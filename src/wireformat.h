@@ -0,0 +1,56 @@
+#ifndef WIREFORMAT_H
+#define WIREFORMAT_H
+
+// 管道和套接字协议共用的小端读写与消息分帧
+//
+// 服务器协议（serverprotocol.h）和外部 AI 协议（botprotocol.h）的消息都是
+// [载荷长度 u16][类型 u8][载荷]，整数一律小端。编码函数先跳过消息头写载荷，
+// 写完后用 finishMessage 回填头部。
+
+#include <cstddef>
+#include <cstdint>
+
+namespace WireFormat {
+
+constexpr std::size_t HEADER_SIZE = 3;
+
+// 小端写入，返回写入后的位置
+inline std::uint8_t *put16(std::uint8_t *out, std::uint16_t value)
+{
+    out[0] = static_cast<std::uint8_t>(value);
+    out[1] = static_cast<std::uint8_t>(value >> 8);
+    return out + 2;
+}
+
+inline std::uint8_t *put32(std::uint8_t *out, std::uint32_t value)
+{
+    for (int i = 0; i < 4; ++i) {
+        out[i] = static_cast<std::uint8_t>(value >> (8 * i));
+    }
+    return out + 4;
+}
+
+inline std::uint16_t get16(const std::uint8_t *in)
+{
+    return static_cast<std::uint16_t>(in[0] | (in[1] << 8));
+}
+
+inline std::uint32_t get32(const std::uint8_t *in)
+{
+    return std::uint32_t(in[0]) | (std::uint32_t(in[1]) << 8) | (std::uint32_t(in[2]) << 16)
+         | (std::uint32_t(in[3]) << 24);
+}
+
+// 填写消息头，返回总长度；Type 为各协议的消息类型枚举
+template <typename Type>
+std::size_t finishMessage(std::uint8_t *out, Type type, const std::uint8_t *end)
+{
+    const std::size_t size = static_cast<std::size_t>(end - out);
+    put16(out, static_cast<std::uint16_t>(size - HEADER_SIZE));
+    out[2] = static_cast<std::uint8_t>(type);
+    return size;
+}
+
+} // namespace WireFormat
+
+#endif // WIREFORMAT_H
@@ -0,0 +1,519 @@
+// 外部 AI 对比：外部 AI 进程和内置 AI 在同一批种子上对局
+//
+// 用法：tetris-botmatch --bot="命令 参数..." [--json] [--games=N] [--seed-base=S]
+//                       [--max-pieces=N] [--pipeline=N]
+//       tetris-botmatch --serve [--json]
+// 外部 AI 由本程序启动，经 stdin/stdout 通信，协议见 src/botprotocol.h。
+// 所有对局同时进行：每局需要决策时把局面排入发送队列，最多 --pipeline 条请求
+// 同时在途，一次写出，回复到达后立即执行并发出该局的下一条请求，
+// 不会每步等一个往返。对局没有重力，每个决策直接硬降，只比较选点。
+// --serve 让本程序以内置 AI 充当外部 AI，用来检验协议和测量管道开销。
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QTextStream>
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <vector>
+#include "bot.h"
+#include "botprotocol.h"
+#include "tetrisengine.h"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace {
+
+constexpr char TETROMINO_NAMES[] = "IOTSZJL";
+// 外部 AI 迟迟不回复时放弃
+constexpr int REPLY_TIMEOUT_MS = 30000;
+
+struct Options {
+    int games = 64;
+    quint64 seedBase = 1;
+    int maxPieces = 1000;
+    int pipeline = 64;
+    bool json = false;
+};
+
+struct Game {
+    TetrisEngine engine;
+    std::vector<Bot::Placement> placements;
+    qint64 sentAtNs = 0;
+    bool awaiting = false;
+    bool forfeited = false;
+};
+
+struct Summary {
+    std::vector<Game> games;
+    qint64 decisions = 0;
+    qint64 elapsedMs = 0;
+    // 每个决策的往返时间（微秒），仅外部 AI
+    std::vector<double> latencies;
+};
+
+void startGames(std::vector<Game> &games, const Options &options)
+{
+    games.assign(std::size_t(options.games), Game());
+    for (std::size_t i = 0; i < games.size(); ++i) {
+        games[i].engine.reset(options.seedBase + i);
+        games[i].engine.start();
+    }
+}
+
+bool isFinished(const Game &game, const Options &options)
+{
+    return game.forfeited || game.engine.isGameOver() || game.engine.getPieceCount() >= options.maxPieces;
+}
+
+// 请求的 JSON 形式，一行一条
+QByteArray requestJson(const BotRequest &request)
+{
+    QByteArray line = "{\"id\":" + QByteArray::number(request.id) + ",\"rows\":[";
+    for (int y = 0; y < TetrisEngine::BOARD_HEIGHT; ++y) {
+        if (y > 0) line += ',';
+        line += QByteArray::number(request.rows[y]);
+    }
+    line += "],\"piece\":\"";
+    line += TETROMINO_NAMES[int(request.piece)];
+    line += "\",\"rotation\":" + QByteArray::number(int(request.rotation));
+    line += ",\"x\":" + QByteArray::number(request.x) + ",\"y\":" + QByteArray::number(request.y);
+    line += ",\"queue\":\"";
+    for (Tetromino type : request.queue) {
+        line += TETROMINO_NAMES[int(type)];
+    }
+    line += "\",\"score\":" + QByteArray::number(request.score);
+    line += ",\"level\":" + QByteArray::number(request.level);
+    line += ",\"lines\":" + QByteArray::number(request.lines);
+    line += ",\"combo\":" + QByteArray::number(request.combo);
+    line += request.backToBack ? ",\"backToBack\":true" : ",\"backToBack\":false";
+    line += ",\"placements\":[";
+    for (int i = 0; i < request.placementCount; ++i) {
+        const BotPlacement &placement = request.placements[i];
+        if (i > 0) line += ',';
+        line += '[' + QByteArray::number(int(placement.rotation)) + ',' + QByteArray::number(placement.x) + ','
+              + QByteArray::number(placement.y) + ']';
+    }
+    line += "]}\n";
+    return line;
+}
+
+int tetrominoIndex(const QString &name)
+{
+    if (name.size() != 1) return -1;
+    for (int i = 0; i < TETROMINO_COUNT; ++i) {
+        if (name[0] == QLatin1Char(TETROMINO_NAMES[i])) return i;
+    }
+    return -1;
+}
+
+bool parseRequestJson(const QByteArray &line, BotRequest &request)
+{
+    const QJsonObject object = QJsonDocument::fromJson(line).object();
+    const QJsonArray rows = object.value("rows").toArray();
+    const QString queue = object.value("queue").toString();
+    const QJsonArray placements = object.value("placements").toArray();
+    const int piece = tetrominoIndex(object.value("piece").toString());
+    const int rotation = object.value("rotation").toInt(-1);
+    if (!object.contains("id") || rows.size() != TetrisEngine::BOARD_HEIGHT || queue.size() != TetrisEngine::QUEUE_SIZE
+        || placements.size() > BotRequest::MAX_PLACEMENTS || piece < 0 || rotation < 0 || rotation > 3) {
+        return false;
+    }
+
+    request = {};
+    request.id = quint32(object.value("id").toInteger());
+    for (int y = 0; y < TetrisEngine::BOARD_HEIGHT; ++y) {
+        request.rows[y] = quint16(rows[y].toInt() & TetrisEngine::FULL_ROW);
+    }
+    request.piece = Tetromino(piece);
+    request.rotation = Rotation(rotation);
+    request.x = qint8(object.value("x").toInt());
+    request.y = qint8(object.value("y").toInt());
+    for (int i = 0; i < TetrisEngine::QUEUE_SIZE; ++i) {
+        const int type = tetrominoIndex(queue.mid(i, 1));
+        if (type < 0) return false;
+        request.queue[i] = Tetromino(type);
+    }
+    request.score = object.value("score").toInt();
+    request.level = object.value("level").toInt();
+    request.lines = object.value("lines").toInt();
+    request.combo = quint8(object.value("combo").toInt());
+    request.backToBack = object.value("backToBack").toBool();
+    request.placementCount = quint8(placements.size());
+    for (int i = 0; i < placements.size(); ++i) {
+        const QJsonArray placement = placements[i].toArray();
+        const int placementRotation = placement.at(0).toInt(-1);
+        if (placement.size() != 3 || placementRotation < 0 || placementRotation > 3) return false;
+        request.placements[i] = {Rotation(placementRotation), qint8(placement.at(1).toInt()),
+                                 qint8(placement.at(2).toInt())};
+    }
+    return true;
+}
+
+// 本程序启动的外部 AI 进程
+class ExternalBot
+{
+public:
+    explicit ExternalBot(bool json)
+        : m_json(json)
+    {
+        // 外部 AI 的诊断输出直接转到本程序的 stderr
+        m_process.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    }
+
+    ~ExternalBot()
+    {
+        m_process.closeWriteChannel();
+        if (!m_process.waitForFinished(1000)) {
+            m_process.kill();
+            m_process.waitForFinished();
+        }
+    }
+
+    bool start(const QString &command, QString *error)
+    {
+        QStringList arguments = QProcess::splitCommand(command);
+        if (arguments.isEmpty()) {
+            *error = "外部 AI 命令为空";
+            return false;
+        }
+        const QString program = arguments.takeFirst();
+        m_process.start(program, arguments);
+        if (!m_process.waitForStarted()) {
+            *error = "无法启动 " + program + ": " + m_process.errorString();
+            return false;
+        }
+        return true;
+    }
+
+    // 请求先攒在缓冲里，flush 时一次写出
+    void send(const BotRequest &request)
+    {
+        if (m_json) {
+            m_output += requestJson(request);
+        } else {
+            std::uint8_t message[BOT_MAX_MESSAGE_SIZE];
+            m_output.append(reinterpret_cast<const char *>(message), qsizetype(encodeBotRequest(request, message)));
+        }
+    }
+
+    void flush()
+    {
+        if (m_output.isEmpty()) return;
+        m_process.write(m_output);
+        m_output.truncate(0);
+    }
+
+    // 等到至少一条回复，取出已到达的全部回复
+    bool receive(std::vector<BotReply> &replies, QString *error)
+    {
+        replies.clear();
+        while (replies.empty()) {
+            if (m_process.bytesAvailable() == 0 && !m_process.waitForReadyRead(REPLY_TIMEOUT_MS)) {
+                *error = m_process.state() == QProcess::NotRunning ? "外部 AI 已退出" : "等待外部 AI 回复超时";
+                return false;
+            }
+            m_input += m_process.readAll();
+            if (!(m_json ? parseJson(replies, error) : parseBinary(replies, error))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    bool parseBinary(std::vector<BotReply> &replies, QString *error)
+    {
+        qsizetype offset = 0;
+        while (m_input.size() - offset >= qsizetype(BOT_HEADER_SIZE)) {
+            const auto *header = reinterpret_cast<const std::uint8_t *>(m_input.constData() + offset);
+            const std::size_t size = std::size_t(header[0] | (header[1] << 8));
+            if (m_input.size() - offset < qsizetype(BOT_HEADER_SIZE + size)) break;
+
+            BotReply reply;
+            if (BotMessageType(header[2]) != BotMessageType::Reply
+                || !decodeBotReply(header + BOT_HEADER_SIZE, size, reply)) {
+                *error = "外部 AI 的回复格式无效";
+                return false;
+            }
+            replies.push_back(reply);
+            offset += qsizetype(BOT_HEADER_SIZE + size);
+        }
+        m_input.remove(0, offset);
+        return true;
+    }
+
+    bool parseJson(std::vector<BotReply> &replies, QString *error)
+    {
+        qsizetype start = 0;
+        for (qsizetype end = m_input.indexOf('\n'); end >= 0; end = m_input.indexOf('\n', start)) {
+            const QJsonObject object = QJsonDocument::fromJson(m_input.mid(start, end - start)).object();
+            start = end + 1;
+            if (!object.contains("id") || !object.contains("placement")) {
+                *error = "外部 AI 的回复格式无效";
+                return false;
+            }
+            const int placement = object.value("placement").toInt(-1);
+            replies.push_back({quint32(object.value("id").toInteger()),
+                               placement < 0 ? BotReply::NO_PLACEMENT : quint16(placement)});
+        }
+        m_input.remove(0, start);
+        return true;
+    }
+
+    QProcess m_process;
+    bool m_json;
+    QByteArray m_output;
+    QByteArray m_input;
+};
+
+Summary runInternal(const Options &options)
+{
+    Summary summary;
+    startGames(summary.games, options);
+
+    QElapsedTimer timer;
+    timer.start();
+    Bot bot;
+    for (Game &game : summary.games) {
+        while (!isFinished(game, options)) {
+            Bot::Placement placement;
+            if (!bot.choose(game.engine, placement)) break;
+            Bot::applyPath(game.engine, placement);
+            game.engine.hardDrop();
+            ++summary.decisions;
+        }
+    }
+    summary.elapsedMs = timer.elapsed();
+    return summary;
+}
+
+bool runExternal(const QString &command, const Options &options, Summary &summary, QString *error)
+{
+    ExternalBot bot(options.json);
+    if (!bot.start(command, error)) {
+        return false;
+    }
+    startGames(summary.games, options);
+
+    QElapsedTimer timer;
+    timer.start();
+    std::deque<std::uint32_t> ready;
+    for (std::size_t i = 0; i < summary.games.size(); ++i) {
+        ready.push_back(std::uint32_t(i));
+    }
+    int inflight = 0;
+
+    // 在途请求不足 pipeline 条时继续发，一批请求一次写出
+    auto sendReady = [&]() {
+        while (!ready.empty() && inflight < options.pipeline) {
+            const std::uint32_t index = ready.front();
+            ready.pop_front();
+            Game &game = summary.games[index];
+            Bot::generatePlacements(game.engine, game.placements);
+            if (game.placements.empty()) continue;
+
+            bot.send(makeBotRequest(index, game.engine, game.placements));
+            game.sentAtNs = timer.nsecsElapsed();
+            game.awaiting = true;
+            ++inflight;
+        }
+        bot.flush();
+    };
+
+    sendReady();
+    std::vector<BotReply> replies;
+    while (inflight > 0) {
+        if (!bot.receive(replies, error)) {
+            return false;
+        }
+        for (const BotReply &reply : replies) {
+            if (reply.id >= summary.games.size() || !summary.games[reply.id].awaiting) {
+                *error = QString("外部 AI 回复了未知的请求 %1").arg(reply.id);
+                return false;
+            }
+            Game &game = summary.games[reply.id];
+            game.awaiting = false;
+            --inflight;
+            ++summary.decisions;
+            summary.latencies.push_back((timer.nsecsElapsed() - game.sentAtNs) / 1000.0);
+
+            if (reply.placement >= game.placements.size()) {
+                game.forfeited = true;
+                continue;
+            }
+            Bot::applyPath(game.engine, game.placements[reply.placement]);
+            game.engine.hardDrop();
+            if (!isFinished(game, options)) {
+                ready.push_back(reply.id);
+            }
+        }
+        sendReady();
+    }
+    summary.elapsedMs = timer.elapsed();
+    return true;
+}
+
+// 以内置 AI 回复 stdin 上的请求
+int serve(bool json)
+{
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    Bot bot;
+    TetrisEngine engine;
+
+    auto answer = [&](const BotRequest &request) {
+        BotReply reply = {request.id, BotReply::NO_PLACEMENT};
+        Bot::Placement best;
+        if (restoreBotRequest(request, engine) && bot.choose(engine, best)) {
+            for (int i = 0; i < request.placementCount; ++i) {
+                const BotPlacement &placement = request.placements[i];
+                if (placement.rotation == best.rotation && placement.x == best.x && placement.y == best.y) {
+                    reply.placement = quint16(i);
+                    break;
+                }
+            }
+        }
+        return reply;
+    };
+
+    BotRequest request;
+    if (json) {
+        QByteArray line;
+        char buffer[4096];
+        while (std::fgets(buffer, sizeof(buffer), stdin)) {
+            line += buffer;
+            if (!line.endsWith('\n')) continue;
+            if (!parseRequestJson(line, request)) {
+                std::fprintf(stderr, "无效的请求: %s", line.constData());
+                return 1;
+            }
+            const BotReply reply = answer(request);
+            std::fprintf(stdout, "{\"id\":%u,\"placement\":%d}\n", unsigned(reply.id),
+                         reply.placement == BotReply::NO_PLACEMENT ? -1 : int(reply.placement));
+            std::fflush(stdout);
+            line.clear();
+        }
+        return 0;
+    }
+
+    std::uint8_t message[BOT_MAX_MESSAGE_SIZE];
+    while (std::fread(message, 1, BOT_HEADER_SIZE, stdin) == BOT_HEADER_SIZE) {
+        const std::size_t size = std::size_t(message[0] | (message[1] << 8));
+        if (size > BOT_MAX_MESSAGE_SIZE - BOT_HEADER_SIZE || std::fread(message, 1, size, stdin) != size
+            || !decodeBotRequest(message, size, request)) {
+            std::fprintf(stderr, "无效的请求\n");
+            return 1;
+        }
+        const std::size_t replySize = encodeBotReply(answer(request), message);
+        std::fwrite(message, 1, replySize, stdout);
+        std::fflush(stdout);
+    }
+    return 0;
+}
+
+double percentile(std::vector<double> values, int percent)
+{
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, values.size() * std::size_t(percent) / 100)];
+}
+
+void printSummary(QTextStream &out, const QString &name, const Summary &summary)
+{
+    qint64 score = 0, lines = 0, pieces = 0;
+    int toppedOut = 0, forfeited = 0;
+    for (const Game &game : summary.games) {
+        score += game.engine.getScore();
+        lines += game.engine.getLines();
+        pieces += game.engine.getPieceCount();
+        toppedOut += game.engine.isGameOver() ? 1 : 0;
+        forfeited += game.forfeited ? 1 : 0;
+    }
+    const double count = qMax<double>(1, summary.games.size());
+    out << name << ": 平均分数 " << QString::number(score / count, 'f', 0) << ", 平均行数 "
+        << QString::number(lines / count, 'f', 1) << ", 平均方块 " << QString::number(pieces / count, 'f', 1)
+        << ", 堆满 " << toppedOut << " 局, 放弃 " << forfeited << " 局, " << summary.decisions << " 次决策 / "
+        << summary.elapsedMs << " ms";
+    if (summary.elapsedMs > 0) {
+        out << " (" << QString::number(summary.decisions * 1000.0 / summary.elapsedMs, 'f', 0) << " 次/秒)";
+    }
+    if (!summary.latencies.empty()) {
+        out << ", 往返 p50 " << QString::number(percentile(summary.latencies, 50), 'f', 0) << " us, p99 "
+            << QString::number(percentile(summary.latencies, 99), 'f', 0) << " us";
+    }
+    out << "\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("外部 AI 与内置 AI 同种子对比");
+    parser.addHelpOption();
+    parser.addOption({"bot", "外部 AI 的命令行", "command"});
+    parser.addOption({"json", "使用 JSON 行协议（默认二进制）"});
+    parser.addOption({"games", "对局数，种子依次递增", "n", "64"});
+    parser.addOption({"seed-base", "第一个种子", "seed", "1"});
+    parser.addOption({"max-pieces", "每局方块数上限", "n", "1000"});
+    parser.addOption({"pipeline", "同时在途的请求数上限", "n", "64"});
+    parser.addOption({"serve", "以内置 AI 充当外部 AI，读 stdin 写 stdout"});
+    parser.process(app);
+
+    Options options;
+    options.json = parser.isSet("json");
+    if (parser.isSet("serve")) {
+        return serve(options.json);
+    }
+    if (!parser.isSet("bot")) {
+        err << "需要 --bot 指定外部 AI，或 --serve\n";
+        return 1;
+    }
+    options.games = parser.value("games").toInt();
+    options.seedBase = parser.value("seed-base").toULongLong();
+    options.maxPieces = parser.value("max-pieces").toInt();
+    options.pipeline = parser.value("pipeline").toInt();
+    if (options.games <= 0 || options.maxPieces <= 0 || options.pipeline <= 0) {
+        err << "--games、--max-pieces 和 --pipeline 需要正整数\n";
+        return 1;
+    }
+
+    const Summary internal = runInternal(options);
+    Summary external;
+    QString error;
+    if (!runExternal(parser.value("bot"), options, external, &error)) {
+        err << error << "\n";
+        return 1;
+    }
+
+    out << options.games << " 局, 种子 " << options.seedBase << ".." << options.seedBase + quint64(options.games) - 1
+        << ", 每局至多 " << options.maxPieces << " 个方块\n";
+    printSummary(out, "内置 AI", internal);
+    printSummary(out, "外部 AI", external);
+
+    // 同一种子逐局比较
+    int wins = 0, losses = 0;
+    for (int i = 0; i < options.games; ++i) {
+        const int a = external.games[i].engine.getScore();
+        const int b = internal.games[i].engine.getScore();
+        wins += a > b ? 1 : 0;
+        losses += a < b ? 1 : 0;
+    }
+    out << "逐局比较: 外部 AI 胜 " << wins << ", 负 " << losses << ", 平 " << options.games - wins - losses << "\n";
+    return 0;
+}
@@ -0,0 +1,355 @@
+// 回放离屏导出：不创建窗口，把回放逐帧绘制到 QImage 并编码
+//
+// 用法：tetris-export [--format=y4m|png|thumbnail] [--fps=N] [--size=WxH]
+//                      [--start=秒] [--out=DIR] [--jobs=N] <回放文件>...
+//   y4m        YUV4MPEG2 流，可直接交给 ffmpeg/mpv：ffmpeg -i clip.y4m clip.mp4
+//   png        PNG 图片序列，每段回放一个目录
+//   thumbnail  只导出终局画面
+// 每个文件可以包含多段首尾相接的回放（例如 replays.bin），每段是一个导出任务，
+// 任务在线程池中并行执行；不设置 QT_QPA_PLATFORM 时使用 offscreen 平台插件。
+// 回放从磁盘按块流式读取，--start 和缩略图借助关键帧直接定位，不从头重放。
+
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QImage>
+#include <QPainter>
+#include <QTextStream>
+#include <QThreadPool>
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include "boardpainter.h"
+#include "replay.h"
+
+namespace {
+
+enum class Format {
+    Y4m,
+    Png,
+    Thumbnail
+};
+
+struct Options {
+    Format format = Format::Y4m;
+    int fps = 30;
+    QSize size = QSize(420, 550);
+    QString outputDirectory;
+    // 结尾停留的时长，便于剪辑
+    int holdMs = 1000;
+    // 从回放的这一时刻开始导出
+    quint32 startMs = 0;
+};
+
+struct Job {
+    QString name;
+    QString path;
+    qint64 offset = 0;
+    quint32 durationMs = 0;
+};
+
+struct Result {
+    bool ok = false;
+    qint64 frames = 0;
+    qint64 elapsedMs = 0;
+    QString error;
+};
+
+// 帧输出
+class FrameSink
+{
+public:
+    virtual ~FrameSink() = default;
+    virtual bool writeFrame(const QImage &frame) = 0;
+    virtual bool finish() { return true; }
+};
+
+// YUV4MPEG2：文件头 + 每帧 "FRAME\n" 和 4:2:0 的 Y/U/V 平面
+class Y4mSink : public FrameSink
+{
+public:
+    Y4mSink(const QString &path, const QSize &size, int fps)
+        : m_file(path)
+        , m_size(size)
+        , m_planes(size.width() * size.height() * 3 / 2, 0)
+    {
+        if (m_file.open(QIODevice::WriteOnly)) {
+            const QByteArray header = QString("YUV4MPEG2 W%1 H%2 F%3:1 Ip A1:1 C420jpeg\n")
+                                          .arg(size.width()).arg(size.height()).arg(fps).toLatin1();
+            m_ok = m_file.write(header) == header.size();
+        }
+    }
+
+    bool writeFrame(const QImage &frame) override
+    {
+        if (!m_ok) return false;
+
+        const int width = m_size.width();
+        const int height = m_size.height();
+        quint8 *yPlane = m_planes.data();
+        quint8 *uPlane = yPlane + width * height;
+        quint8 *vPlane = uPlane + (width / 2) * (height / 2);
+
+        // BT.601 全范围，色度取 2x2 像素的平均值
+        for (int y = 0; y < height; y += 2) {
+            const QRgb *rows[2] = {reinterpret_cast<const QRgb *>(frame.constScanLine(y)),
+                                   reinterpret_cast<const QRgb *>(frame.constScanLine(y + 1))};
+            for (int x = 0; x < width; x += 2) {
+                int r = 0, g = 0, b = 0;
+                for (int dy = 0; dy < 2; ++dy) {
+                    for (int dx = 0; dx < 2; ++dx) {
+                        const QRgb pixel = rows[dy][x + dx];
+                        const int pr = qRed(pixel), pg = qGreen(pixel), pb = qBlue(pixel);
+                        yPlane[(y + dy) * width + x + dx] = quint8((77 * pr + 150 * pg + 29 * pb + 128) >> 8);
+                        r += pr;
+                        g += pg;
+                        b += pb;
+                    }
+                }
+                const int chroma = (y / 2) * (width / 2) + x / 2;
+                uPlane[chroma] = quint8(qBound(0, ((-43 * r - 85 * g + 128 * b + 512) >> 10) + 128, 255));
+                vPlane[chroma] = quint8(qBound(0, ((128 * r - 107 * g - 21 * b + 512) >> 10) + 128, 255));
+            }
+        }
+
+        const qint64 bytes = qint64(m_planes.size());
+        m_ok = m_file.write("FRAME\n", 6) == 6
+            && m_file.write(reinterpret_cast<const char *>(m_planes.data()), bytes) == bytes;
+        return m_ok;
+    }
+
+    bool finish() override
+    {
+        return m_ok && m_file.flush();
+    }
+
+private:
+    QFile m_file;
+    QSize m_size;
+    std::vector<quint8> m_planes;
+    bool m_ok = false;
+};
+
+class PngSequenceSink : public FrameSink
+{
+public:
+    explicit PngSequenceSink(const QString &directory)
+        : m_directory(directory)
+        , m_index(0)
+    {
+        QDir().mkpath(directory);
+    }
+
+    bool writeFrame(const QImage &frame) override
+    {
+        const QString path = QDir(m_directory).filePath(QString("frame_%1.png").arg(m_index++, 6, 10, QChar('0')));
+        return frame.save(path, "PNG");
+    }
+
+private:
+    QString m_directory;
+    int m_index;
+};
+
+Result exportReplay(const Job &job, const Options &options)
+{
+    Result result;
+    QElapsedTimer timer;
+    timer.start();
+
+    // 每个任务独立打开文件，按需读取
+    ReplayReader reader;
+    if (!reader.open(job.path, job.offset)) {
+        result.error = "无法读取回放";
+        return result;
+    }
+    TetrisEngine engine;
+
+    // 每个任务一个绘制器和一张复用的帧图像，缓存图层在帧之间保留
+    BoardPainter boardPainter;
+    QImage frame(options.size, QImage::Format_RGB32);
+    auto render = [&]() {
+        QPainter painter(&frame);
+        boardPainter.paint(painter, engine, options.size);
+    };
+
+    const QString base = QDir(options.outputDirectory).filePath(job.name);
+    if (options.format == Format::Thumbnail) {
+        if (!reader.seekEvent(reader.eventCount(), engine)) {
+            result.error = "读取回放失败";
+            result.elapsedMs = timer.elapsed();
+            return result;
+        }
+        render();
+        result.frames = 1;
+        result.ok = frame.save(base + ".png", "PNG");
+        if (!result.ok) result.error = "无法写入 " + base + ".png";
+        result.elapsedMs = timer.elapsed();
+        return result;
+    }
+
+    std::unique_ptr<FrameSink> sink;
+    if (options.format == Format::Y4m) {
+        sink = std::make_unique<Y4mSink>(base + ".y4m", options.size, options.fps);
+    } else {
+        sink = std::make_unique<PngSequenceSink>(base);
+    }
+
+    const quint32 startMs = std::min(options.startMs, reader.durationMs());
+    const qint64 totalMs = qint64(reader.durationMs() - startMs) + options.holdMs;
+    const qint64 frameCount = totalMs * options.fps / 1000 + 1;
+    if (!reader.seek(startMs, engine)) {
+        result.error = "读取回放失败";
+        result.elapsedMs = timer.elapsed();
+        return result;
+    }
+    for (qint64 i = 0; i < frameCount; ++i) {
+        const qint64 timeMs = std::min<qint64>(qint64(startMs) + i * 1000 / options.fps, reader.durationMs());
+        if (!reader.advanceTo(quint32(timeMs), engine)) {
+            result.error = "读取回放失败";
+            result.elapsedMs = timer.elapsed();
+            return result;
+        }
+        render();
+        if (!sink->writeFrame(frame)) {
+            result.error = "写入帧失败";
+            result.elapsedMs = timer.elapsed();
+            return result;
+        }
+        ++result.frames;
+    }
+
+    result.ok = sink->finish();
+    if (!result.ok) result.error = "写入失败";
+    result.elapsedMs = timer.elapsed();
+    return result;
+}
+
+QVector<Job> loadJobs(const QStringList &files, QTextStream &err)
+{
+    QVector<Job> jobs;
+    for (const QString &path : files) {
+        const QFileInfo info(path);
+        if (!info.isReadable()) {
+            err << "无法打开 " << path << "\n";
+            continue;
+        }
+        // 只读各段的文件头和关键帧索引，事件留到导出时再读
+        const QString baseName = info.completeBaseName();
+        ReplayReader reader;
+        int index = 0;
+        for (qint64 offset = 0; offset < info.size(); offset = reader.endOffset()) {
+            if (!reader.open(path, offset)) {
+                err << path << ": 偏移 " << offset << " 处的回放格式无效，跳过剩余部分\n";
+                break;
+            }
+            Job job;
+            job.name = QString("%1-%2").arg(baseName).arg(index++, 3, 10, QChar('0'));
+            job.path = path;
+            job.offset = offset;
+            job.durationMs = reader.durationMs();
+            jobs.append(std::move(job));
+        }
+    }
+    return jobs;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("离屏导出俄罗斯方块回放");
+    parser.addHelpOption();
+    parser.addOption({"format", "输出格式：y4m、png 或 thumbnail", "format", "y4m"});
+    parser.addOption({"fps", "帧率", "fps", "30"});
+    parser.addOption({"size", "画面尺寸 WxH", "size", "420x550"});
+    parser.addOption({"start", "从回放的第几秒开始导出", "seconds", "0"});
+    parser.addOption({"out", "输出目录", "dir", "."});
+    parser.addOption({"jobs", "并行任务数（默认为 CPU 核数）", "n"});
+    parser.addPositionalArgument("replays", "回放文件，可包含多段回放");
+    parser.process(app);
+
+    Options options;
+    const QString format = parser.value("format");
+    if (format == "y4m") {
+        options.format = Format::Y4m;
+    } else if (format == "png") {
+        options.format = Format::Png;
+    } else if (format == "thumbnail") {
+        options.format = Format::Thumbnail;
+    } else {
+        err << "未知格式: " << format << "\n";
+        return 1;
+    }
+    options.fps = qBound(1, parser.value("fps").toInt(), 240);
+    const QStringList size = parser.value("size").split('x');
+    if (size.size() != 2 || size[0].toInt() < 2 || size[1].toInt() < 2) {
+        err << "无效尺寸: " << parser.value("size") << "\n";
+        return 1;
+    }
+    // 4:2:0 色度采样要求宽高为偶数
+    options.size = QSize(size[0].toInt() & ~1, size[1].toInt() & ~1);
+    options.startMs = quint32(qBound(0.0, parser.value("start").toDouble(), 4.0e6) * 1000.0);
+    options.outputDirectory = parser.value("out");
+    QDir().mkpath(options.outputDirectory);
+
+    const QVector<Job> jobs = loadJobs(parser.positionalArguments(), err);
+    if (jobs.isEmpty()) {
+        err << "没有可导出的回放\n";
+        return 1;
+    }
+
+    QThreadPool pool;
+    if (parser.isSet("jobs")) {
+        pool.setMaxThreadCount(qMax(1, parser.value("jobs").toInt()));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QVector<Result> results(jobs.size());
+    for (int i = 0; i < jobs.size(); ++i) {
+        // 每个任务只写自己的结果槽位
+        pool.start([&jobs, &results, &options, i]() {
+            results[i] = exportReplay(jobs[i], options);
+        });
+    }
+    pool.waitForDone();
+    const qint64 wallMs = timer.elapsed();
+
+    int failed = 0;
+    qint64 replayMs = 0;
+    for (int i = 0; i < jobs.size(); ++i) {
+        const Result &result = results[i];
+        const qint64 durationMs = qint64(jobs[i].durationMs) - qMin(jobs[i].durationMs, options.startMs);
+        replayMs += durationMs;
+        if (!result.ok) {
+            ++failed;
+            err << jobs[i].name << ": " << result.error << "\n";
+            continue;
+        }
+        out << jobs[i].name << ": " << result.frames << " 帧, 回放 "
+            << QString::number(durationMs / 1000.0, 'f', 1) << " 秒, 用时 " << result.elapsedMs << " ms";
+        if (result.elapsedMs > 0 && options.format != Format::Thumbnail) {
+            out << " (" << QString::number(double(durationMs) / result.elapsedMs, 'f', 1) << "x 实时)";
+        }
+        out << "\n";
+    }
+    out << jobs.size() << " 段回放, " << pool.maxThreadCount() << " 线程, 总用时 " << wallMs << " ms";
+    if (wallMs > 0) {
+        out << ", 合计 " << QString::number(double(replayMs) / wallMs, 'f', 1) << "x 实时";
+    }
+    out << "\n";
+
+    return failed == 0 ? 0 : 1;
+}
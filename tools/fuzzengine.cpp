@@ -0,0 +1,184 @@
+// 引擎输入接口的模糊测试目标（libFuzzer）
+//
+// 输入字节流的格式：
+//   字节 0      规则集（低2位）和随机器（第3位）
+//   字节 1..8   开局种子，不足时补0
+//   其余        每两个字节一个操作（类型、参数），按 EngineAction::decode 解码；
+//               类型取模后多出的一种为"挂起/恢复"：状态存入快照，在新引擎上恢复后继续
+// 每个操作前后检查：
+//   状态      isValidState()，增量特征与重新计算一致，快照往返逐字节相同
+//   方块      进行中的方块完全在棋盘内且不与已有格子重叠
+//   影子      getShadowY() 停在第一个会碰撞的位置之上，不是靠循环上限停下
+//   锁定      没有垃圾行时，锁定后格子数 = 锁定前 + 4 - 10 * 消除行数（没有格子被写到棋盘外）
+// 违反时打印原因并 abort()，由 libFuzzer 保存输入。
+//
+// 用 Clang 以 -fsanitize=fuzzer,address,undefined 编译；定义 TETRIS_FUZZ_MAIN 时
+// 自带一个 main，逐个执行命令行给出的输入文件，用于在没有 libFuzzer 的环境复现。
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "referenceengine.h"
+
+namespace {
+
+[[noreturn]] void fail(const char *message, std::size_t step)
+{
+    std::fprintf(stderr, "不变量被破坏（第 %zu 个操作）：%s\n", step, message);
+    std::abort();
+}
+
+int cellCount(const TetrisEngineBase &engine)
+{
+    int count = 0;
+    for (int y = 0; y < TetrisEngineBase::BOARD_HEIGHT; ++y) {
+        count += std::popcount(engine.getRowMask(y));
+    }
+    return count;
+}
+
+// 最近一次完整计算特征时的棋盘；大多数操作只移动方块，棋盘不变时直接比较缓存结果
+struct FeatureCache {
+    std::array<std::uint16_t, TetrisEngineBase::BOARD_HEIGHT> rows{};
+    TetrisEngineBase::Features features = emptyFeatures();
+
+    static const TetrisEngineBase::Features &emptyFeatures()
+    {
+        static const TetrisEngineBase::Features features = TetrisEngineBase::computeFeatures({});
+        return features;
+    }
+};
+
+void checkState(const TetrisEngineBase &engine, FeatureCache &cache, std::size_t step)
+{
+    const TetrisEngineBase::State state = engine.saveState();
+    if (!TetrisEngineBase::isValidState(state)) {
+        fail("isValidState 拒绝了引擎产生的状态", step);
+    }
+    if (state.rows != cache.rows) {
+        cache.rows = state.rows;
+        cache.features = TetrisEngineBase::computeFeatures(state.rows);
+    }
+    if (std::memcmp(&cache.features, &engine.getFeatures(), sizeof(cache.features)) != 0) {
+        fail("增量特征与重新计算的结果不一致", step);
+    }
+
+    if (!engine.isGameStarted() || engine.isGameOver()) return;
+
+    const Tetromino type = engine.getCurrentTetromino();
+    const Rotation rotation = engine.getCurrentRotation();
+    const int x = engine.getPieceX();
+    const int y = engine.getPieceY();
+    for (const PieceCell &cell : tetrominoCells(type, rotation)) {
+        const int cellX = x + cell.x;
+        const int cellY = y + cell.y;
+        if (cellX < 0 || cellX >= TetrisEngineBase::BOARD_WIDTH || cellY < 0 || cellY >= TetrisEngineBase::BOARD_HEIGHT) {
+            fail("进行中的方块有格子在棋盘外", step);
+        }
+        if (engine.isCellFilled(cellX, cellY)) {
+            fail("进行中的方块与已有格子重叠", step);
+        }
+    }
+
+    const int shadowY = engine.getShadowY();
+    if (shadowY < y || engine.checkCollision(type, rotation, x, shadowY)
+        || !engine.checkCollision(type, rotation, x, shadowY + 1)) {
+        fail("影子位置没有停在触底处", step);
+    }
+}
+
+template <typename Rules>
+void run(const std::uint8_t *data, std::size_t size)
+{
+    BasicTetrisEngine<Rules> engine;
+    engine.setRandomizer(static_cast<TetrisEngineBase::Randomizer>((data[0] >> 2) & 1));
+
+    std::uint64_t seed = 0;
+    std::size_t offset = 1;
+    for (; offset < 9 && offset < size; ++offset) {
+        seed = (seed << 8) | data[offset];
+    }
+    engine.reset(seed);
+    engine.start();
+    FeatureCache cache;
+    checkState(engine, cache, 0);
+
+    for (std::size_t step = 1; offset + 1 < size; offset += 2, ++step) {
+        const std::uint8_t typeByte = data[offset] % (EngineAction::TypeCount + 1);
+        if (typeByte == EngineAction::TypeCount) {
+            // 挂起/恢复：对应 TetrisGame 的暂停、存档和读档，引擎层面就是一次快照往返
+            const TetrisEngineBase::State saved = engine.saveState();
+            BasicTetrisEngine<Rules> resumed;
+            resumed.restoreState(saved);
+            const TetrisEngineBase::State restored = resumed.saveState();
+            if (std::memcmp(&saved, &restored, sizeof(saved)) != 0) {
+                fail("快照往返后状态不同", step);
+            }
+            engine = resumed;
+            checkState(engine, cache, step);
+            continue;
+        }
+
+        const EngineAction action = EngineAction::decode(typeByte, data[offset + 1]);
+        const int cellsBefore = cellCount(engine);
+        const int linesBefore = engine.getLines();
+        const int piecesBefore = engine.getPieceCount();
+        const bool active = engine.isGameStarted() && !engine.isGameOver();
+        const bool garbagePending = engine.getPendingGarbage() > 0;
+
+        applyAction(engine, action);
+
+        // 硬降必然锁定恰好一个方块
+        if (action.type == EngineAction::HardDrop && active && engine.getPieceCount() != piecesBefore + 1) {
+            fail("硬降没有锁定方块", step);
+        }
+        // tick 可能连续锁定多个方块（软降、硬降和重力），每个方块都是4格
+        const int locked = engine.getPieceCount() - piecesBefore;
+        if (action.type != EngineAction::Reset && locked > 0 && !garbagePending) {
+            const int cleared = engine.getLines() - linesBefore;
+            if (cellCount(engine) != cellsBefore + 4 * locked - TetrisEngineBase::BOARD_WIDTH * cleared) {
+                fail("锁定前后格子数不守恒", step);
+            }
+        }
+        checkState(engine, cache, step);
+    }
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, std::size_t size)
+{
+    if (size == 0) return 0;
+
+    switch (data[0] & 3) {
+    case 0: run<StandardRules>(data, size); break;
+    case 1: run<GuidelineRules>(data, size); break;
+    case 2: run<ClassicRules>(data, size); break;
+    case 3: run<MarathonRules>(data, size); break;
+    }
+    return 0;
+}
+
+#ifdef TETRIS_FUZZ_MAIN
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+int main(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        std::ifstream file(argv[i], std::ios::binary);
+        if (!file) {
+            std::fprintf(stderr, "无法打开 %s\n", argv[i]);
+            return 1;
+        }
+        const std::vector<std::uint8_t> data{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+        LLVMFuzzerTestOneInput(data.data(), data.size());
+    }
+    std::printf("%d 个输入，没有发现问题\n", argc - 1);
+    return 0;
+}
+#endif
@@ -0,0 +1,348 @@
+// 差分校验：同一操作序列同时驱动引擎和参照引擎，每一步比较全部可见状态
+//
+// 用法：tetris-lockstep [--runs=N] [--length=N] [--seed=S]
+// 各轮依次使用四个规则集（标准、指南、经典、马拉松）的 BasicTetrisEngine 实例，
+// 参照引擎按同一规则集计分，比较分数、T-spin 和背靠背、连击、目标行数。
+// 随机操作几乎摆不出 T-spin，所以一半的轮次是旋转场景：每个新方块出现时换成一块
+// 嵌在随机密集棋盘中间的 T，操作以旋转和下移为主，专门覆盖 T-spin 与踢表判定。
+// 每一步还检查：
+//   快照    从上一步的 saveState() 恢复出的副本执行同一操作，状态逐字节相同
+//   特征    增量维护的棋盘特征与按行掩码重新计算的结果一致
+//   自洽    isValidState() 接受引擎产生的每个状态
+// 出现分歧时把操作序列缩减到仍能复现的最短形式并打印，返回码为 1。
+// 不依赖 Qt，可以在没有图形环境的机器上运行。
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "referenceengine.h"
+
+namespace {
+
+using RuleSet = ReferenceEngine::RuleSet;
+
+const char *const RULE_SET_NAMES[ReferenceEngine::RULE_SET_COUNT] = {
+    StandardRules::NAME, GuidelineRules::NAME, ClassicRules::NAME, MarathonRules::NAME};
+
+struct Scenario {
+    RuleSet rules;
+    std::uint64_t seed;
+    TetrisEngine::Randomizer randomizer;
+    bool spins;         // 旋转场景：每个新方块换成嵌在密集棋盘中的 T
+    std::vector<EngineAction> actions;
+};
+
+struct Failure {
+    int step = -1;      // -1 表示没有分歧
+    std::string message;
+};
+
+std::string compare(const TetrisEngineBase &engine, const ReferenceEngine &reference)
+{
+    char buffer[160];
+    auto mismatch = [&](const char *field, long long actual, long long expected) {
+        std::snprintf(buffer, sizeof(buffer), "%s: 引擎 %lld, 参照 %lld", field, actual, expected);
+        return std::string(buffer);
+    };
+
+    for (int y = 0; y < TetrisEngine::BOARD_HEIGHT; ++y) {
+        if (engine.getRowMask(y) != reference.rowMask(y)) {
+            std::snprintf(buffer, sizeof(buffer), "第 %d 行: 引擎 %03x, 参照 %03x", y, engine.getRowMask(y),
+                          reference.rowMask(y));
+            return buffer;
+        }
+    }
+    if (engine.isGameOver() != reference.gameOver) return mismatch("gameOver", engine.isGameOver(), reference.gameOver);
+    if (engine.isGameStarted() != reference.gameStarted) {
+        return mismatch("gameStarted", engine.isGameStarted(), reference.gameStarted);
+    }
+    if (engine.getScore() != reference.score) return mismatch("score", engine.getScore(), reference.score);
+    if (engine.getLines() != reference.lines) return mismatch("lines", engine.getLines(), reference.lines);
+    if (engine.getLevel() != reference.level) return mismatch("level", engine.getLevel(), reference.level);
+    if (engine.getPieceCount() != reference.pieceCount) {
+        return mismatch("pieceCount", engine.getPieceCount(), reference.pieceCount);
+    }
+    if (engine.getCurrentTetromino() != reference.piece) {
+        return mismatch("piece", int(engine.getCurrentTetromino()), int(reference.piece));
+    }
+    if (engine.getCurrentRotation() != reference.rotation) {
+        return mismatch("rotation", int(engine.getCurrentRotation()), int(reference.rotation));
+    }
+    if (engine.getPieceX() != reference.pieceX) return mismatch("pieceX", engine.getPieceX(), reference.pieceX);
+    if (engine.getPieceY() != reference.pieceY) return mismatch("pieceY", engine.getPieceY(), reference.pieceY);
+    for (int i = 0; i < TetrisEngine::QUEUE_SIZE; ++i) {
+        if (engine.getQueuedTetromino(i) != reference.queue[i]) {
+            return mismatch("queue", int(engine.getQueuedTetromino(i)), int(reference.queue[i]));
+        }
+    }
+    if (engine.getCombo() != reference.combo) return mismatch("combo", engine.getCombo(), reference.combo);
+    if (engine.isBackToBack() != reference.backToBack) {
+        return mismatch("backToBack", engine.isBackToBack(), reference.backToBack);
+    }
+    if (engine.isGoalReached() != reference.goalReached) {
+        return mismatch("goalReached", engine.isGoalReached(), reference.goalReached);
+    }
+    if (engine.getPendingGarbage() != reference.pendingGarbage) {
+        return mismatch("pendingGarbage", engine.getPendingGarbage(), reference.pendingGarbage);
+    }
+    const TetrisEngine::State state = engine.saveState();
+    if (state.outgoingGarbage != reference.outgoingGarbage) {
+        return mismatch("outgoingGarbage", state.outgoingGarbage, reference.outgoingGarbage);
+    }
+    if (state.gravityTicks != reference.gravityTicks) {
+        return mismatch("gravityTicks", state.gravityTicks, reference.gravityTicks);
+    }
+    return std::string();
+}
+
+std::string checkInvariants(const TetrisEngineBase &engine)
+{
+    const TetrisEngine::State state = engine.saveState();
+    if (!TetrisEngine::isValidState(state)) {
+        return "isValidState 拒绝了引擎产生的状态";
+    }
+    const TetrisEngine::Features expected = TetrisEngine::computeFeatures(state.rows);
+    if (std::memcmp(&expected, &engine.getFeatures(), sizeof(expected)) != 0) {
+        return "增量特征与重新计算的结果不一致";
+    }
+    return std::string();
+}
+
+// 旋转场景的布局：底部若干行按七成密度随机填充（不留满行），再在其中挖出一块 T 的位置，
+// T 四周大多有格子，旋转时容易用到踢表并满足三角判定。同时写入参照引擎和被测引擎
+void plantTSpin(TetrisEngineBase &engine, ReferenceEngine &reference, std::mt19937_64 &rng)
+{
+    constexpr int WIDTH = ReferenceEngine::WIDTH;
+    constexpr int HEIGHT = ReferenceEngine::HEIGHT;
+    const int height = 4 + int(rng() % 8);
+    for (int y = 0; y < HEIGHT; ++y) {
+        for (int x = 0; x < WIDTH; ++x) reference.cells[y][x] = y >= HEIGHT - height && rng() % 100 < 70;
+        reference.cells[y][rng() % WIDTH] = false;
+    }
+
+    // 3x3 包围盒完整落在填充区内（含其上一行）
+    const Rotation rotation = Rotation(rng() % ROTATION_COUNT);
+    const int x = int(rng() % (WIDTH - 2));
+    const int y = HEIGHT - height - 1 + int(rng() % (height - 1));
+    for (const PieceCell &cell : tetrominoCells(Tetromino::T, rotation)) {
+        reference.cells[y + cell.y][x + cell.x] = false;
+    }
+    reference.piece = Tetromino::T;
+    reference.rotation = rotation;
+    reference.pieceX = x;
+    reference.pieceY = y;
+    reference.lastMoveRotate = false;
+
+    TetrisEngine::State state = engine.saveState();
+    for (int row = 0; row < HEIGHT; ++row) state.rows[row] = reference.rowMask(row);
+    state.currentTetromino = Tetromino::T;
+    state.currentRotation = rotation;
+    state.pieceX = std::int8_t(x);
+    state.pieceY = std::int8_t(y);
+    state.ruleFlags &= ~TetrisEngineBase::LastMoveRotate;
+    engine.restoreState(state);
+}
+
+template <typename Rules>
+Failure runWith(const Scenario &scenario)
+{
+    BasicTetrisEngine<Rules> engine;
+    ReferenceEngine reference;
+    reference.rules = scenario.rules;
+    engine.setRandomizer(scenario.randomizer);
+    reference.randomizer = scenario.randomizer;
+    engine.reset(scenario.seed);
+    reference.reset(scenario.seed);
+    engine.start();
+    reference.start();
+
+    // 布局只取决于种子和已经摆过的次数，缩减时同一前缀得到同样的棋盘
+    std::mt19937_64 layoutRng(scenario.seed);
+    int plantedPiece = -1;
+
+    Failure failure;
+    for (std::size_t i = 0; i < scenario.actions.size(); ++i) {
+        const EngineAction &action = scenario.actions[i];
+        if (scenario.spins && reference.active() && reference.pieceCount != plantedPiece) {
+            plantTSpin(engine, reference, layoutRng);
+            plantedPiece = reference.pieceCount;
+        }
+
+        // 快照副本：从状态恢复后执行同一操作
+        BasicTetrisEngine<Rules> restored;
+        restored.restoreState(engine.saveState());
+
+        applyAction(engine, action);
+        applyAction(reference, action);
+        applyAction(restored, action);
+
+        std::string message = compare(engine, reference);
+        if (message.empty()) message = checkInvariants(engine);
+        if (message.empty()) {
+            const TetrisEngine::State a = engine.saveState();
+            const TetrisEngine::State b = restored.saveState();
+            if (std::memcmp(&a, &b, sizeof(a)) != 0) message = "从快照恢复的副本与原引擎不一致";
+        }
+        if (!message.empty()) {
+            failure.step = int(i);
+            failure.message = message;
+            return failure;
+        }
+    }
+    return failure;
+}
+
+Failure run(const Scenario &scenario)
+{
+    switch (scenario.rules) {
+    case RuleSet::Standard: return runWith<StandardRules>(scenario);
+    case RuleSet::Guideline: return runWith<GuidelineRules>(scenario);
+    case RuleSet::Classic: return runWith<ClassicRules>(scenario);
+    case RuleSet::Marathon: return runWith<MarathonRules>(scenario);
+    }
+    return Failure();
+}
+
+// 操作分布：以逐帧输入和单步移动为主，偶尔插入垃圾行、切换旋转系统或重开
+std::vector<EngineAction> generate(std::mt19937_64 &rng, int length)
+{
+    std::vector<EngineAction> actions;
+    actions.reserve(length);
+    for (int i = 0; i < length; ++i) {
+        const std::uint64_t roll = rng() % 1000;
+        const std::uint8_t arg = std::uint8_t(rng());
+        std::uint8_t type;
+        if (roll < 500) {
+            type = EngineAction::Tick;
+        } else if (roll < 900) {
+            type = std::uint8_t(EngineAction::MoveLeft + roll % 5);     // 左右、下、旋转、硬降
+        } else if (roll < 960) {
+            type = EngineAction::QueueGarbage;
+        } else if (roll < 985) {
+            type = EngineAction::TakeGarbage;
+        } else if (roll < 995) {
+            type = EngineAction::SetRotationSystem;
+        } else {
+            type = EngineAction::Reset;
+        }
+        actions.push_back(EngineAction::decode(type, arg));
+    }
+    return actions;
+}
+
+// 旋转场景的操作分布：旋转和单步下移为主，少量左右移动、逐帧输入和硬降
+std::vector<EngineAction> generateSpins(std::mt19937_64 &rng, int length)
+{
+    std::vector<EngineAction> actions;
+    actions.reserve(length);
+    for (int i = 0; i < length; ++i) {
+        const std::uint64_t roll = rng() % 1000;
+        const std::uint8_t arg = std::uint8_t(rng());
+        std::uint8_t type;
+        if (roll < 450) {
+            type = EngineAction::Rotate;
+        } else if (roll < 750) {
+            type = EngineAction::MoveDown;
+        } else if (roll < 900) {
+            type = std::uint8_t(EngineAction::MoveLeft + roll % 2);
+        } else if (roll < 950) {
+            type = EngineAction::Tick;
+        } else {
+            type = EngineAction::HardDrop;
+        }
+        actions.push_back(EngineAction::decode(type, arg));
+    }
+    return actions;
+}
+
+// 缩减：分歧之后的操作无关，先截断；再按块删除，块从一半缩到单个操作；
+// 最后把剩余逐帧输入的参数尽量化简
+Scenario shrink(Scenario scenario, Failure failure)
+{
+    auto stillFails = [&](Scenario &candidate) {
+        const Failure result = run(candidate);
+        if (result.step < 0) return false;
+        candidate.actions.resize(result.step + 1);
+        failure = result;
+        return true;
+    };
+
+    scenario.actions.resize(failure.step + 1);
+    for (std::size_t chunk = scenario.actions.size() / 2; chunk >= 1; chunk /= 2) {
+        for (std::size_t begin = 0; begin + chunk <= scenario.actions.size();) {
+            Scenario candidate = scenario;
+            candidate.actions.erase(candidate.actions.begin() + begin, candidate.actions.begin() + begin + chunk);
+            if (!candidate.actions.empty() && stillFails(candidate)) {
+                scenario = candidate;
+            } else {
+                begin += chunk;
+            }
+        }
+    }
+
+    for (std::size_t i = 0; i < scenario.actions.size(); ++i) {
+        if (scenario.actions[i].type != EngineAction::Tick || scenario.actions[i].arg == 0) continue;
+        Scenario candidate = scenario;
+        candidate.actions[i].arg = 0;
+        if (stillFails(candidate)) scenario = candidate;
+    }
+    return scenario;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    int runs = 1000;
+    int length = 2000;
+    std::uint64_t seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--runs=", 7) == 0) {
+            runs = std::max(1, std::atoi(argv[i] + 7));
+        } else if (std::strncmp(argv[i], "--length=", 9) == 0) {
+            length = std::max(1, std::atoi(argv[i] + 9));
+        } else if (std::strncmp(argv[i], "--seed=", 7) == 0) {
+            seed = std::strtoull(argv[i] + 7, nullptr, 10);
+        } else {
+            std::fprintf(stderr, "用法: %s [--runs=N] [--length=N] [--seed=S]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::mt19937_64 rng(seed);
+    long long steps = 0;
+    for (int r = 0; r < runs; ++r) {
+        Scenario scenario;
+        scenario.rules = RuleSet(r % ReferenceEngine::RULE_SET_COUNT);
+        scenario.seed = rng();
+        scenario.spins = r / ReferenceEngine::RULE_SET_COUNT % 2 == 1;
+        scenario.randomizer =
+            TetrisEngine::Randomizer(r / (2 * ReferenceEngine::RULE_SET_COUNT) % TetrisEngine::RANDOMIZER_COUNT);
+        scenario.actions = scenario.spins ? generateSpins(rng, length) : generate(rng, length);
+
+        const Failure failure = run(scenario);
+        if (failure.step < 0) {
+            steps += length;
+            continue;
+        }
+
+        std::printf("第 %d 轮（%s%s）第 %d 步出现分歧: %s\n", r, RULE_SET_NAMES[int(scenario.rules)],
+                    scenario.spins ? "，旋转场景" : "", failure.step, failure.message.c_str());
+        const Scenario minimal = shrink(scenario, failure);
+        const Failure minimalFailure = run(minimal);
+        std::printf("最短复现（规则集 %s%s，种子 %llu，随机器 %d，%zu 步）:\n", RULE_SET_NAMES[int(minimal.rules)],
+                    minimal.spins ? "，旋转场景" : "", static_cast<unsigned long long>(minimal.seed),
+                    int(minimal.randomizer), minimal.actions.size());
+        for (const EngineAction &action : minimal.actions) {
+            std::printf("  %s\n", action.toString().c_str());
+        }
+        std::printf("分歧: %s\n", minimalFailure.message.c_str());
+        return 1;
+    }
+
+    std::printf("%d 轮, %lld 步, 没有分歧\n", runs, steps);
+    return 0;
+}
@@ -0,0 +1,429 @@
+// 谜题生成：按类型随机构造候选谜题，用求解器验证可解并评定难度，写出谜题库
+//
+// 用法：tetris-puzzlegen [--tag=tspin,dig,pc] [--count=N] [--seed=S] [--node-limit=N]
+//                        [--jobs=N] [--out=FILE]
+//       tetris-puzzlegen --verify=FILE [--node-limit=N] [--jobs=N]
+//   --count 为每种类型的谜题数；谜题库格式见 src/puzzledatabase.h
+//
+// 第 i 个候选由 (种子, 类型, i) 决定。候选按批并行验证，每批结束后按编号顺序
+// 收下可解且不重复的谜题，因此结果与线程数无关，同样的参数总是生成同样的谜题库。
+// --verify 先完整检查谜题库的记录和索引，再重新求解每道题，检查是否仍然可解（例如修改规则之后）。
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QThreadPool>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <iterator>
+#include <optional>
+#include <unordered_set>
+#include <vector>
+#include "puzzle.h"
+#include "puzzledatabase.h"
+
+namespace {
+
+constexpr int WIDTH = TetrisEngine::BOARD_WIDTH;
+constexpr int HEIGHT = TetrisEngine::BOARD_HEIGHT;
+constexpr std::uint16_t FULL_ROW = TetrisEngine::FULL_ROW;
+
+const char *const TAG_NAMES[PUZZLE_TAG_COUNT] = {"tspin", "dig", "pc"};
+
+// 每批候选数为线程数的倍数
+constexpr int BATCH_PER_THREAD = 16;
+// 候选数超过目标的这么多倍仍未凑够时放弃
+constexpr int MAX_ATTEMPTS_PER_PUZZLE = 1000;
+
+class Random
+{
+public:
+    explicit Random(std::uint64_t seed)
+        : m_state(seed)
+    {
+    }
+
+    std::uint64_t next()
+    {
+        // splitmix64
+        std::uint64_t z = (m_state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    // [low, high]
+    int range(int low, int high)
+    {
+        return low + int(next() % std::uint64_t(high - low + 1));
+    }
+
+private:
+    std::uint64_t m_state;
+};
+
+std::uint64_t candidateSeed(std::uint64_t seed, PuzzleTag tag, std::uint64_t index)
+{
+    Random random(seed ^ (std::uint64_t(tag) << 56) ^ index * 0x2545f4914f6cdd1dull);
+    return random.next();
+}
+
+// 从 7-bag 中依次取出方块
+void fillFromBag(Random &random, Puzzle &puzzle, int first, int count)
+{
+    std::array<Tetromino, TETROMINO_COUNT> bag;
+    int left = 0;
+    for (int i = first; i < first + count; ++i) {
+        if (left == 0) {
+            for (int t = 0; t < TETROMINO_COUNT; ++t) {
+                bag[t] = static_cast<Tetromino>(t);
+            }
+            left = TETROMINO_COUNT;
+        }
+        const int pick = random.range(0, left - 1);
+        puzzle.pieces[i] = bag[pick];
+        bag[pick] = bag[--left];
+    }
+}
+
+// 一行垃圾：满行去掉 holes 个不同的格子
+std::uint16_t garbageRow(Random &random, int holes)
+{
+    std::uint16_t row = FULL_ROW;
+    while (std::popcount(unsigned(FULL_ROW & ~row)) < holes) {
+        row &= ~std::uint16_t(1u << random.range(0, WIDTH - 1));
+    }
+    return row;
+}
+
+bool hasCoveredHole(const TetrisEngineBase &engine)
+{
+    std::uint16_t covered = 0;
+    for (int y = 0; y < HEIGHT; ++y) {
+        const std::uint16_t row = engine.getRowMask(y);
+        if (covered & ~row) return true;
+        covered |= row;
+    }
+    return false;
+}
+
+// 挖掘：底部 2..4 行垃圾，每行 1..2 个洞，消完全部垃圾行
+Puzzle makeDig(Random &random)
+{
+    Puzzle puzzle = {};
+    const int garbage = random.range(2, 4);
+    for (int i = 0; i < garbage; ++i) {
+        puzzle.rows[HEIGHT - 1 - i] = garbageRow(random, random.range(1, 2));
+    }
+    puzzle.tag = PuzzleTag::Dig;
+    puzzle.goalLines = std::uint8_t(garbage);
+    puzzle.pieceCount = Puzzle::MAX_PIECES;
+    fillFromBag(random, puzzle, 0, puzzle.pieceCount);
+    return puzzle;
+}
+
+// T-spin：底部若干垃圾行上搭一个 TSD 槽，T 在序列的前几个方块中
+Puzzle makeTSpin(Random &random)
+{
+    Puzzle puzzle = {};
+    const int garbage = random.range(0, 3);
+    int y = HEIGHT - 1;
+    for (int i = 0; i < garbage; ++i) {
+        puzzle.rows[y--] = garbageRow(random, 1);
+    }
+
+    // 槽底一格、槽身三格，悬挑在槽身上方的一侧
+    const int column = random.range(1, WIDTH - 2);
+    puzzle.rows[y--] = FULL_ROW & ~std::uint16_t(1u << column);
+    puzzle.rows[y--] = FULL_ROW & ~std::uint16_t(7u << (column - 1));
+    if (random.range(0, 1) == 0) {
+        puzzle.rows[y] = std::uint16_t((1u << column) - 1);
+    } else {
+        puzzle.rows[y] = FULL_ROW & ~std::uint16_t((2u << column) - 1);
+    }
+
+    puzzle.tag = PuzzleTag::TSpin;
+    puzzle.goalLines = 2;
+    const int tIndex = random.range(0, 3);
+    puzzle.pieceCount = std::uint8_t(tIndex + 1);
+    fillFromBag(random, puzzle, 0, puzzle.pieceCount);
+    for (int i = 0; i < puzzle.pieceCount; ++i) {
+        if (puzzle.pieces[i] == Tetromino::T) std::swap(puzzle.pieces[i], puzzle.pieces[tIndex]);
+    }
+    puzzle.pieces[tIndex] = Tetromino::T;
+    return puzzle;
+}
+
+// 全消：先随机搭出一个完整的 2 行或 4 行全消（不留洞、不超出高度），再把前几个方块
+// 预先放在棋盘上，其余的作为序列
+class PerfectClearBuilder
+{
+public:
+    // 随机搜索的节点上限，搭不出来时放弃这个候选
+    static constexpr int NODE_LIMIT = 500;
+
+    explicit PerfectClearBuilder(Random &random)
+        : m_random(random)
+        , m_height(0)
+        , m_nodes(0)
+    {
+    }
+
+    std::optional<Puzzle> build()
+    {
+        m_height = m_random.range(0, 1) ? 4 : 2;
+        const int pieces = m_height * WIDTH / 4;
+        const int placed = m_height == 2 ? m_random.range(0, 2) : m_random.range(4, 7);
+        m_nodes = 0;
+        m_boards.assign(std::size_t(pieces + 1), Puzzle());
+        m_linesBefore.assign(std::size_t(pieces + 1), 0);
+        if (!extend(0, pieces)) return std::nullopt;
+
+        Puzzle puzzle = m_boards[std::size_t(placed)];
+        puzzle.tag = PuzzleTag::PerfectClear;
+        puzzle.goalLines = std::uint8_t(m_height - m_linesBefore[std::size_t(placed)]);
+        puzzle.pieceCount = std::uint8_t(pieces - placed);
+        for (int i = 0; i < puzzle.pieceCount; ++i) {
+            puzzle.pieces[i] = m_sequence[std::size_t(placed + i)];
+        }
+        return puzzle;
+    }
+
+private:
+    // m_boards[depth] 为放下 depth 个方块后的棋盘，m_linesBefore[depth] 为此时已消的行数
+    bool extend(int depth, int pieces)
+    {
+        if (++m_nodes > NODE_LIMIT) return false;
+        if (depth == pieces) return m_linesBefore[std::size_t(depth)] == m_height;
+
+        const Puzzle &board = m_boards[std::size_t(depth)];
+        const int lines = m_linesBefore[std::size_t(depth)];
+        const int firstType = m_random.range(0, TETROMINO_COUNT - 1);
+        for (int t = 0; t < TETROMINO_COUNT; ++t) {
+            Puzzle step = board;
+            step.pieceCount = 1;
+            step.pieces[0] = static_cast<Tetromino>((firstType + t) % TETROMINO_COUNT);
+            PuzzleEngine engine;
+            setupPuzzle(engine, step);
+            std::vector<PuzzleEngine> placements;
+            PuzzleSolver::lockedPlacements(engine, placements);
+
+            // 随机顺序尝试，只保留不超高、不留洞的落点
+            for (std::size_t i = placements.size(); i > 1; --i) {
+                std::swap(placements[i - 1], placements[std::size_t(m_random.range(0, int(i) - 1))]);
+            }
+            for (const PuzzleEngine &after : placements) {
+                const int cleared = lines + after.getLines();
+                if (after.getRowMask(HEIGHT - 1 - (m_height - cleared)) != 0 || hasCoveredHole(after)) continue;
+
+                m_sequence[std::size_t(depth)] = step.pieces[0];
+                Puzzle &next = m_boards[std::size_t(depth + 1)];
+                for (int row = 0; row < HEIGHT; ++row) {
+                    next.rows[row] = after.getRowMask(row);
+                }
+                m_linesBefore[std::size_t(depth + 1)] = cleared;
+                if (extend(depth + 1, pieces)) return true;
+                if (m_nodes > NODE_LIMIT) return false;
+            }
+        }
+        return false;
+    }
+
+    Random &m_random;
+    int m_height;
+    int m_nodes;
+    std::vector<Puzzle> m_boards;
+    std::vector<int> m_linesBefore;
+    std::array<Tetromino, 10> m_sequence;
+};
+
+std::optional<Puzzle> makeCandidate(PuzzleTag tag, std::uint64_t seed)
+{
+    Random random(seed);
+    std::optional<Puzzle> puzzle;
+    switch (tag) {
+    case PuzzleTag::TSpin:
+        puzzle = makeTSpin(random);
+        break;
+    case PuzzleTag::Dig:
+        puzzle = makeDig(random);
+        break;
+    case PuzzleTag::PerfectClear:
+        puzzle = PerfectClearBuilder(random).build();
+        break;
+    }
+    if (puzzle) {
+        puzzle->id = std::uint32_t(seed);
+        puzzle->difficulty = 1;
+    }
+    return puzzle;
+}
+
+// 题面相同（棋盘、序列、目标）的谜题只收一道
+std::uint64_t contentKey(const Puzzle &puzzle)
+{
+    std::uint64_t hash = 1469598103934665603ull;
+    auto mix = [&hash](std::uint64_t value) {
+        hash ^= value;
+        hash *= 1099511628211ull;
+    };
+    for (std::uint16_t row : puzzle.rows) mix(row);
+    for (int i = 0; i < puzzle.pieceCount; ++i) mix(std::uint64_t(puzzle.pieces[i]) + 16);
+    mix(std::uint64_t(puzzle.tag) << 8 | puzzle.goalLines);
+    return hash;
+}
+
+int generate(PuzzleTag tag, int count, std::uint64_t seed, std::uint64_t nodeLimit, QThreadPool &pool,
+             std::vector<Puzzle> &puzzles, QTextStream &out, QTextStream &err)
+{
+    const int batchSize = pool.maxThreadCount() * BATCH_PER_THREAD;
+    const std::uint64_t maxCandidates = std::uint64_t(count) * MAX_ATTEMPTS_PER_PUZZLE;
+    std::vector<std::optional<Puzzle>> batch(std::size_t(batchSize), std::nullopt);
+    std::unordered_set<std::uint64_t> seen;
+    std::array<int, PUZZLE_MAX_DIFFICULTY + 1> histogram = {};
+    int accepted = 0;
+    std::uint64_t candidates = 0;
+    std::atomic<std::uint64_t> nodes{0};
+
+    QElapsedTimer timer;
+    timer.start();
+    while (accepted < count && candidates < maxCandidates) {
+        // 每个线程领取候选编号，结果放在对应位置，批内顺序与线程调度无关
+        std::atomic<int> next{0};
+        for (int t = 0; t < pool.maxThreadCount(); ++t) {
+            pool.start([&]() {
+                PuzzleSolver solver;
+                for (int i = next.fetch_add(1); i < batchSize; i = next.fetch_add(1)) {
+                    std::optional<Puzzle> puzzle = makeCandidate(tag, candidateSeed(seed, tag, candidates + i));
+                    if (puzzle) {
+                        const PuzzleSolver::Result result = solver.solve(*puzzle, nodeLimit);
+                        nodes += result.nodes;
+                        if (result.solved) {
+                            puzzle->difficulty = std::uint8_t(PuzzleSolver::difficultyFor(result.nodes));
+                        } else {
+                            puzzle.reset();
+                        }
+                    }
+                    batch[std::size_t(i)] = puzzle;
+                }
+            });
+        }
+        pool.waitForDone();
+        candidates += std::uint64_t(batchSize);
+
+        for (const std::optional<Puzzle> &puzzle : batch) {
+            if (accepted == count) break;
+            if (!puzzle || !seen.insert(contentKey(*puzzle)).second) continue;
+            puzzles.push_back(*puzzle);
+            ++histogram[puzzle->difficulty];
+            ++accepted;
+        }
+        err << "\r" << TAG_NAMES[int(tag)] << ": " << accepted << "/" << count << " 道, 候选 " << candidates;
+        err.flush();
+    }
+    err << "\n";
+
+    out << TAG_NAMES[int(tag)] << ": " << accepted << " 道, 候选 " << candidates << " 个, 求解展开 "
+         << nodes.load() << " 个局面, 用时 " << timer.elapsed() << " ms\n  难度分布:";
+    for (int d = 1; d <= PUZZLE_MAX_DIFFICULTY; ++d) {
+        if (histogram[d]) out << " " << d << ":" << histogram[d];
+    }
+    out << "\n";
+    return accepted;
+}
+
+int verify(const QString &path, std::uint64_t nodeLimit, QThreadPool &pool, QTextStream &out, QTextStream &err)
+{
+    PuzzleDatabase database;
+    if (!database.open(path)) {
+        err << "无法打开谜题库 " << path << "\n";
+        return 1;
+    }
+    if (!database.validate()) {
+        err << "谜题库 " << path << " 中有无效的记录或索引\n";
+        return 1;
+    }
+
+    std::atomic<int> next{0};
+    std::atomic<int> failed{0};
+    for (int t = 0; t < pool.maxThreadCount(); ++t) {
+        pool.start([&]() {
+            PuzzleSolver solver;
+            for (int i = next.fetch_add(1); i < database.count(); i = next.fetch_add(1)) {
+                if (!solver.solve(*database.puzzle(i), nodeLimit).solved) {
+                    ++failed;
+                }
+            }
+        });
+    }
+    pool.waitForDone();
+
+    out << database.count() << " 道谜题";
+    for (int t = 0; t < PUZZLE_TAG_COUNT; ++t) {
+        out << ", " << TAG_NAMES[t] << " "
+            << database.countMatching(static_cast<PuzzleTag>(t), 1, PUZZLE_MAX_DIFFICULTY);
+    }
+    out << "; 未能解出 " << failed.load() << " 道\n";
+    return failed.load() == 0 ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("俄罗斯方块谜题生成");
+    parser.addHelpOption();
+    parser.addOption({"tag", "谜题类型：tspin、dig、pc，逗号分隔", "list", "tspin,dig,pc"});
+    parser.addOption({"count", "每种类型的谜题数", "n", "200"});
+    parser.addOption({"seed", "生成种子", "seed", "1"});
+    parser.addOption({"node-limit", "每道题求解展开的局面数上限", "n",
+                      QString::number(PuzzleSolver::DEFAULT_NODE_LIMIT)});
+    parser.addOption({"jobs", "并行线程数（默认为 CPU 核数）", "n"});
+    parser.addOption({"out", "谜题库文件", "file", "puzzles.db"});
+    parser.addOption({"verify", "重新求解已有谜题库中的每道题", "file"});
+    parser.process(app);
+
+    QThreadPool pool;
+    if (parser.isSet("jobs")) {
+        pool.setMaxThreadCount(qMax(1, parser.value("jobs").toInt()));
+    }
+    const std::uint64_t nodeLimit = qMax<qulonglong>(1, parser.value("node-limit").toULongLong());
+
+    if (parser.isSet("verify")) {
+        return verify(parser.value("verify"), nodeLimit, pool, out, err);
+    }
+
+    std::vector<PuzzleTag> tags;
+    for (const QString &name : parser.value("tag").split(',', Qt::SkipEmptyParts)) {
+        const auto it = std::find_if(std::begin(TAG_NAMES), std::end(TAG_NAMES),
+                                     [&](const char *tag) { return name.trimmed() == QLatin1String(tag); });
+        if (it == std::end(TAG_NAMES)) {
+            err << "未知的谜题类型: " << name << "\n";
+            return 1;
+        }
+        tags.push_back(static_cast<PuzzleTag>(it - std::begin(TAG_NAMES)));
+    }
+    const int count = qMax(1, parser.value("count").toInt());
+    const std::uint64_t seed = parser.value("seed").toULongLong();
+
+    std::vector<Puzzle> puzzles;
+    for (PuzzleTag tag : tags) {
+        generate(tag, count, seed, nodeLimit, pool, puzzles, out, err);
+    }
+
+    const QString path = parser.value("out");
+    if (!PuzzleDatabase::write(path, puzzles)) {
+        err << "写入 " << path << " 失败\n";
+        return 1;
+    }
+    out << "共 " << puzzles.size() << " 道谜题写入 " << path << "\n";
+    return 0;
+}
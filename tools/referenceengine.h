@@ -0,0 +1,465 @@
+#ifndef REFERENCEENGINE_H
+#define REFERENCEENGINE_H
+
+// 参照引擎与操作序列，供 tetris-lockstep 等校验工具使用
+//
+// ReferenceEngine 用最直接的方式实现：棋盘是 bool 二维数组，碰撞逐格检查，
+// 消行逐行复制，不维护任何增量数据。它不追求速度，只作为 BasicTetrisEngine 各规则实例
+// （位掩码棋盘、增量特征、快照）的对照。计分、T-spin 判定、背靠背、连击和目标行数
+// 按规则集在这里重新写一遍；方块形状、踢表和重力曲线与引擎共用。
+
+#include "rotationsystem.h"
+#include "tetrisengine.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <string>
+
+class ReferenceEngine
+{
+public:
+    static constexpr int WIDTH = TetrisEngine::BOARD_WIDTH;
+    static constexpr int HEIGHT = TetrisEngine::BOARD_HEIGHT;
+
+    enum class RuleSet : std::uint8_t {
+        Standard,
+        Guideline,
+        Classic,
+        Marathon
+    };
+    static constexpr int RULE_SET_COUNT = 4;
+
+    RuleSet rules = RuleSet::Standard;
+
+    bool cells[HEIGHT][WIDTH] = {};
+    std::uint64_t pieceRng = 0;
+    std::uint64_t garbageRng = 0;
+    TetrisEngine::Randomizer randomizer = TetrisEngine::Randomizer::Uniform;
+    std::uint8_t bagRemaining = 0;
+    int rotationSystem = 0;
+
+    int score = 0;
+    int level = 1;
+    int lines = 0;
+    int pieceCount = 0;
+    int gravityTicks = 0;
+    Tetromino piece = Tetromino::I;
+    Rotation rotation = Rotation::North;
+    int pieceX = 0;
+    int pieceY = 0;
+    std::array<Tetromino, TetrisEngine::QUEUE_SIZE> queue = {};
+    int pendingGarbage = 0;
+    int outgoingGarbage = 0;
+    bool gameOver = false;
+    bool gameStarted = false;
+    bool goalReached = false;
+    bool backToBack = false;
+    int combo = 0;
+
+    // T-spin 判定：最后一次成功的移动是否为旋转，以及那次旋转的方向和踢表序号
+    bool lastMoveRotate = false;
+    bool lastRotateHalf = false;
+    int lastKick = -1;
+
+    void reset(std::uint64_t seed)
+    {
+        for (auto &row : cells) std::fill(std::begin(row), std::end(row), false);
+        pieceRng = seed;
+        garbageRng = seed ^ 0x9e3779b97f4a7c15ull;
+        bagRemaining = 0;
+        score = 0;
+        level = 1;
+        lines = 0;
+        pieceCount = 0;
+        gravityTicks = 0;
+        piece = Tetromino::I;
+        rotation = Rotation::North;
+        pieceX = 0;
+        pieceY = 0;
+        pendingGarbage = 0;
+        outgoingGarbage = 0;
+        gameOver = false;
+        gameStarted = false;
+        goalReached = false;
+        backToBack = false;
+        combo = 0;
+        lastMoveRotate = false;
+        lastRotateHalf = false;
+        lastKick = -1;
+        for (Tetromino &type : queue) type = randomPiece();
+    }
+
+    void start()
+    {
+        gameStarted = true;
+        spawn();
+    }
+
+    bool active() const { return gameStarted && !gameOver; }
+
+    bool collides(Tetromino type, Rotation rot, int x, int y) const
+    {
+        for (const PieceCell &cell : tetrominoCells(type, rot)) {
+            const int cx = x + cell.x;
+            const int cy = y + cell.y;
+            if (cx < 0 || cx >= WIDTH || cy < 0 || cy >= HEIGHT || cells[cy][cx]) return true;
+        }
+        return false;
+    }
+
+    bool moveBy(int dx)
+    {
+        if (!active() || collides(piece, rotation, pieceX + dx, pieceY)) return false;
+        pieceX += dx;
+        lastMoveRotate = false;
+        return true;
+    }
+
+    bool moveDown()
+    {
+        if (!active()) return false;
+        if (collides(piece, rotation, pieceX, pieceY + 1)) {
+            lock();
+            return false;
+        }
+        ++pieceY;
+        lastMoveRotate = false;
+        return true;
+    }
+
+    bool rotate(RotationDirection direction)
+    {
+        if (!active() || piece == Tetromino::O) return false;
+        const Rotation target = rotated(rotation, direction);
+        const auto kicks = RotationSystem::available()[rotationSystem]->kicks(piece, rotation, direction);
+        for (std::size_t i = 0; i < kicks.size(); ++i) {
+            const KickOffset &kick = kicks[i];
+            if (!collides(piece, target, pieceX + kick.x, pieceY + kick.y)) {
+                pieceX += kick.x;
+                pieceY += kick.y;
+                rotation = target;
+                lastMoveRotate = true;
+                lastRotateHalf = direction == RotationDirection::Half;
+                lastKick = int(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void hardDrop()
+    {
+        if (!active()) return;
+        while (!collides(piece, rotation, pieceX, pieceY + 1)) {
+            ++pieceY;
+            lastMoveRotate = false;
+        }
+        lock();
+    }
+
+    void tick(std::uint8_t inputs)
+    {
+        if (!active()) return;
+        if (inputs & TetrisEngine::InputLeft) moveBy(-1);
+        if (inputs & TetrisEngine::InputRight) moveBy(1);
+        if (inputs & TetrisEngine::InputRotateCW) rotate(RotationDirection::Clockwise);
+        if (inputs & TetrisEngine::InputRotateCCW) rotate(RotationDirection::CounterClockwise);
+        if (inputs & TetrisEngine::InputRotate180) rotate(RotationDirection::Half);
+        if (inputs & TetrisEngine::InputSoftDrop) {
+            moveDown();
+            gravityTicks = 0;
+        }
+        if (inputs & TetrisEngine::InputHardDrop) {
+            hardDrop();
+            gravityTicks = 0;
+        }
+        if (++gravityTicks >= gravityInterval()) {
+            gravityTicks = 0;
+            moveDown();
+        }
+    }
+
+    void queueGarbage(int count)
+    {
+        pendingGarbage = std::clamp(pendingGarbage + count, 0, HEIGHT);
+    }
+
+    int takeOutgoingGarbage()
+    {
+        const int count = outgoingGarbage;
+        outgoingGarbage = 0;
+        return count;
+    }
+
+    std::uint16_t rowMask(int y) const
+    {
+        std::uint16_t mask = 0;
+        for (int x = 0; x < WIDTH; ++x) {
+            if (cells[y][x]) mask |= std::uint16_t(1u << x);
+        }
+        return mask;
+    }
+
+private:
+    static std::uint64_t splitmix(std::uint64_t &state)
+    {
+        std::uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    Tetromino randomPiece()
+    {
+        const std::uint64_t value = splitmix(pieceRng) >> 32;
+        if (randomizer == TetrisEngine::Randomizer::Uniform) {
+            return static_cast<Tetromino>((value * TETROMINO_COUNT) >> 32);
+        }
+        if (bagRemaining == 0) bagRemaining = (1u << TETROMINO_COUNT) - 1;
+        // 袋中剩余方块按编号排列，取第 pick 个
+        std::uint64_t pick = (value * std::uint64_t(std::popcount(unsigned(bagRemaining)))) >> 32;
+        for (int type = 0; type < TETROMINO_COUNT; ++type) {
+            if (!(bagRemaining & (1u << type))) continue;
+            if (pick-- == 0) {
+                bagRemaining = std::uint8_t(bagRemaining & ~(1u << type));
+                return static_cast<Tetromino>(type);
+            }
+        }
+        return Tetromino::I;
+    }
+
+    bool tSpinRules() const
+    {
+        return rules == RuleSet::Guideline || rules == RuleSet::Marathon;
+    }
+
+    int gravityInterval() const
+    {
+        switch (rules) {
+        case RuleSet::Standard: return StandardRules::gravityTicks(level);
+        case RuleSet::Guideline: return GuidelineRules::gravityTicks(level);
+        case RuleSet::Classic: return ClassicRules::gravityTicks(level);
+        case RuleSet::Marathon: return MarathonRules::gravityTicks(level);
+        }
+        return 1;
+    }
+
+    // 0 = 不是 T-spin，1 = mini，2 = 完整；在方块写入棋盘之前调用
+    int tSpinKind() const
+    {
+        if (piece != Tetromino::T || !lastMoveRotate) return 0;
+        auto filled = [this](int x, int y) {
+            if (x < 0 || x >= WIDTH || y >= HEIGHT) return true;
+            return y >= 0 && cells[y][x];
+        };
+        const bool topLeft = filled(pieceX, pieceY);
+        const bool topRight = filled(pieceX + 2, pieceY);
+        const bool bottomRight = filled(pieceX + 2, pieceY + 2);
+        const bool bottomLeft = filled(pieceX, pieceY + 2);
+        if (topLeft + topRight + bottomRight + bottomLeft < 3) return 0;
+
+        // T 的尖端朝向的两个角
+        bool front = false;
+        switch (rotation) {
+        case Rotation::North: front = topLeft && topRight; break;
+        case Rotation::East: front = topRight && bottomRight; break;
+        case Rotation::South: front = bottomRight && bottomLeft; break;
+        case Rotation::West: front = bottomLeft && topLeft; break;
+        }
+        // SRS 90 度旋转的第 5 个踢位（TST 踢）总是完整 T-spin
+        if (front || (lastKick == 4 && !lastRotateHalf)) return 2;
+        return 1;
+    }
+
+    int clearPoints(int cleared, int tSpin) const
+    {
+        static constexpr int STANDARD[] = {0, 100, 300, 500, 800};
+        static constexpr int CLASSIC[] = {0, 40, 100, 300, 1200};
+        static constexpr int MINI[] = {100, 200, 400, 400, 400};
+        static constexpr int FULL[] = {400, 800, 1200, 1600, 1600};
+        if (rules == RuleSet::Classic) return CLASSIC[cleared];
+        if (tSpin == 1) return MINI[cleared];
+        if (tSpin == 2) return FULL[cleared];
+        return STANDARD[cleared];
+    }
+
+    void scoreLock(int cleared, int tSpin)
+    {
+        if (cleared == 0) {
+            combo = 0;
+            if (tSpin == 0) return;
+            score += clearPoints(0, tSpin) * level;
+            return;
+        }
+
+        int points = clearPoints(cleared, tSpin);
+        if (tSpinRules()) {
+            const bool difficult = cleared == 4 || tSpin != 0;
+            if (difficult && backToBack) points = points * 3 / 2;
+            backToBack = difficult;
+            combo = std::min(combo + 1, 255);
+            if (combo > 1) points += 50 * (combo - 1);
+        }
+        score += points * level;
+
+        lines += cleared;
+        int lineLevel = lines / 10 + 1;
+        if (rules == RuleSet::Marathon) lineLevel = std::min(lineLevel, 15);
+        level = std::max(level, lineLevel);
+        if (rules == RuleSet::Marathon && lines >= 150) {
+            gameOver = true;
+            goalReached = true;
+        }
+    }
+
+    void spawn()
+    {
+        piece = queue[0];
+        rotation = Rotation::North;
+        pieceX = WIDTH / 2 - 2;
+        pieceY = piece == Tetromino::I ? -1 : 0;
+        std::rotate(queue.begin(), queue.begin() + 1, queue.end());
+        queue.back() = randomPiece();
+        gravityTicks = 0;
+        lastMoveRotate = false;
+        if (collides(piece, rotation, pieceX, pieceY)) gameOver = true;
+    }
+
+    void lock()
+    {
+        const int tSpin = tSpinRules() ? tSpinKind() : 0;
+        for (const PieceCell &cell : tetrominoCells(piece, rotation)) {
+            const int cx = pieceX + cell.x;
+            const int cy = pieceY + cell.y;
+            if (cx >= 0 && cx < WIDTH && cy >= 0 && cy < HEIGHT) cells[cy][cx] = true;
+        }
+        ++pieceCount;
+
+        int cleared = 0;
+        for (int y = HEIGHT - 1; y >= 0;) {
+            if (std::all_of(std::begin(cells[y]), std::end(cells[y]), [](bool cell) { return cell; })) {
+                for (int above = y; above > 0; --above) {
+                    std::copy(std::begin(cells[above - 1]), std::end(cells[above - 1]), std::begin(cells[above]));
+                }
+                std::fill(std::begin(cells[0]), std::end(cells[0]), false);
+                ++cleared;
+            } else {
+                --y;
+            }
+        }
+
+        scoreLock(cleared, tSpin);
+        if (cleared > 0) {
+            static constexpr int ATTACK[] = {0, 0, 1, 2, 4};
+            int attack = ATTACK[cleared];
+            const int cancelled = std::min(attack, pendingGarbage);
+            pendingGarbage -= cancelled;
+            attack -= cancelled;
+            outgoingGarbage = std::min(outgoingGarbage + attack, HEIGHT);
+        } else if (pendingGarbage > 0) {
+            const int count = pendingGarbage;
+            pendingGarbage = 0;
+            for (int y = 0; y < count; ++y) {
+                for (bool cell : cells[y]) gameOver = gameOver || cell;
+            }
+            for (int y = 0; y + count < HEIGHT; ++y) {
+                std::copy(std::begin(cells[y + count]), std::end(cells[y + count]), std::begin(cells[y]));
+            }
+            const int hole = int((splitmix(garbageRng) >> 32) % WIDTH);
+            for (int y = HEIGHT - count; y < HEIGHT; ++y) {
+                for (int x = 0; x < WIDTH; ++x) cells[y][x] = x != hole;
+            }
+        }
+
+        if (!gameOver) spawn();
+    }
+};
+
+// 一步操作：工具从随机数或任意字节流解码得到操作序列
+struct EngineAction {
+    enum Type : std::uint8_t {
+        Tick,           // arg 为输入位
+        MoveLeft,
+        MoveRight,
+        MoveDown,
+        Rotate,         // arg 为 RotationDirection
+        HardDrop,
+        QueueGarbage,   // arg 为行数
+        TakeGarbage,
+        Reset,          // arg 为新种子，随后立即开始
+        SetRotationSystem,
+        TypeCount
+    };
+
+    Type type;
+    std::uint8_t arg;
+
+    // 从两个字节解码，保证落在合法范围内
+    static EngineAction decode(std::uint8_t typeByte, std::uint8_t argByte)
+    {
+        EngineAction action{static_cast<Type>(typeByte % TypeCount), argByte};
+        switch (action.type) {
+        case Tick: action.arg &= 0x7f; break;
+        case Rotate: action.arg %= 3; break;
+        case QueueGarbage: action.arg = std::uint8_t(1 + action.arg % 4); break;
+        case SetRotationSystem: action.arg = std::uint8_t(action.arg % RotationSystem::available().size()); break;
+        case Reset: break;
+        default: action.arg = 0; break;
+        }
+        return action;
+    }
+
+    std::string toString() const
+    {
+        static const char *const NAMES[] = {"tick", "left", "right", "down", "rotate", "hardDrop",
+                                            "garbage", "takeGarbage", "reset", "rotationSystem"};
+        return std::string(NAMES[type]) + " " + std::to_string(arg);
+    }
+};
+
+// 对任一引擎执行操作（TetrisEngine 各规则实例或 ReferenceEngine）
+template <typename Rules>
+void applyAction(BasicTetrisEngine<Rules> &engine, const EngineAction &action)
+{
+    switch (action.type) {
+    case EngineAction::Tick: engine.tick(action.arg); break;
+    case EngineAction::MoveLeft: engine.moveLeft(); break;
+    case EngineAction::MoveRight: engine.moveRight(); break;
+    case EngineAction::MoveDown: engine.moveDown(); break;
+    case EngineAction::Rotate: engine.rotate(static_cast<RotationDirection>(action.arg)); break;
+    case EngineAction::HardDrop: engine.hardDrop(); break;
+    case EngineAction::QueueGarbage: engine.queueGarbage(action.arg); break;
+    case EngineAction::TakeGarbage: engine.takeOutgoingGarbage(); break;
+    case EngineAction::Reset:
+        engine.reset(action.arg);
+        engine.start();
+        break;
+    case EngineAction::SetRotationSystem:
+        engine.setRotationSystem(RotationSystem::available()[action.arg]);
+        break;
+    case EngineAction::TypeCount: break;
+    }
+}
+
+inline void applyAction(ReferenceEngine &engine, const EngineAction &action)
+{
+    switch (action.type) {
+    case EngineAction::Tick: engine.tick(action.arg); break;
+    case EngineAction::MoveLeft: engine.moveBy(-1); break;
+    case EngineAction::MoveRight: engine.moveBy(1); break;
+    case EngineAction::MoveDown: engine.moveDown(); break;
+    case EngineAction::Rotate: engine.rotate(static_cast<RotationDirection>(action.arg)); break;
+    case EngineAction::HardDrop: engine.hardDrop(); break;
+    case EngineAction::QueueGarbage: engine.queueGarbage(action.arg); break;
+    case EngineAction::TakeGarbage: engine.takeOutgoingGarbage(); break;
+    case EngineAction::Reset:
+        engine.reset(action.arg);
+        engine.start();
+        break;
+    case EngineAction::SetRotationSystem: engine.rotationSystem = action.arg; break;
+    case EngineAction::TypeCount: break;
+    }
+}
+
+#endif // REFERENCEENGINE_H
@@ -0,0 +1,166 @@
+// 渲染后端基准：比较 QPainter 与场景图批量渲染的每帧耗时
+//
+// 用法：tetris-renderbench [--frames=N] [--software-gl]
+// 每种窗口尺寸下让引擎逐帧推进（内容每帧都变化），分别测量：
+//   painter     TetrisBoard::repaint()，立即模式绘制并刷新到窗口
+//   scenegraph  SceneGraphBoardItem，每帧重建顶点缓冲，以 frameSwapped 计帧
+// 交换间隔设为 0，结果不受显示器刷新率限制。
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QQuickWindow>
+#include <QSurfaceFormat>
+#include <QTextStream>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include "scenegraphboard.h"
+#include "tetrisboard.h"
+#include "tetrisengine.h"
+
+namespace {
+
+// 生成一个有一定高度堆叠的对局，并按固定规律推进
+class BenchGame
+{
+public:
+    BenchGame()
+        : m_frame(0)
+    {
+        restart();
+        while (m_engine.getPieceCount() < 40) {
+            step();
+        }
+    }
+
+    const TetrisEngine &engine() const { return m_engine; }
+
+    void step()
+    {
+        static constexpr quint8 PATTERN[] = {
+            TetrisEngine::InputLeft, 0, TetrisEngine::InputRotateCW, TetrisEngine::InputRight,
+            0, TetrisEngine::InputRight, TetrisEngine::InputSoftDrop, 0,
+        };
+        quint8 inputs = PATTERN[m_frame % std::size(PATTERN)];
+        if (m_frame % 45 == 44) inputs |= TetrisEngine::InputHardDrop;
+        ++m_frame;
+
+        m_engine.tick(inputs);
+        if (m_engine.isGameOver()) {
+            restart();
+        }
+    }
+
+private:
+    void restart()
+    {
+        m_engine.reset(0x5eed + m_frame);
+        m_engine.start();
+    }
+
+    TetrisEngine m_engine;
+    quint64 m_frame;
+};
+
+struct Result {
+    double msPerFrame;
+    double fps;
+};
+
+Result benchPainter(const QSize &size, int frames)
+{
+    BenchGame game;
+    TetrisBoard board(nullptr);
+    board.setEngine(&game.engine());
+    board.setFixedSize(size);
+    board.show();
+    QCoreApplication::processEvents();
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < frames; ++i) {
+        game.step();
+        board.repaint();
+    }
+    const double elapsed = timer.nsecsElapsed() / 1e6;
+    return {elapsed / frames, frames * 1000.0 / elapsed};
+}
+
+Result benchSceneGraph(const QSize &size, int frames)
+{
+    BenchGame game;
+    QQuickWindow window;
+    window.setColor(QColor(20, 20, 30));
+    SceneGraphBoardItem item(window.contentItem());
+    item.setEngine(&game.engine());
+    item.setSize(size);
+    window.resize(size);
+
+    // 先让窗口完成首帧和图形资源初始化，再开始计时
+    QEventLoop loop;
+    int swapped = -1;
+    QElapsedTimer timer;
+    QObject::connect(&window, &QQuickWindow::frameSwapped, &loop, [&]() {
+        if (swapped < 0) {
+            timer.start();
+        }
+        if (++swapped == frames) {
+            loop.quit();
+            return;
+        }
+        game.step();
+        item.update();
+    }, Qt::QueuedConnection);
+    window.show();
+    loop.exec();
+
+    const double elapsed = timer.nsecsElapsed() / 1e6;
+    return {elapsed / frames, frames * 1000.0 / elapsed};
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    int frames = 2000;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--frames=", 9) == 0) {
+            frames = qMax(1, std::atoi(argv[i] + 9));
+        } else if (std::strcmp(argv[i], "--software-gl") == 0) {
+            QCoreApplication::setAttribute(Qt::AA_UseSoftwareOpenGL);
+            qputenv("LIBGL_ALWAYS_SOFTWARE", "1");
+            QQuickWindow::setGraphicsApi(QSGRendererInterface::OpenGL);
+        }
+    }
+
+    // 关闭垂直同步，测量实际吞吐
+    QSurfaceFormat format = QSurfaceFormat::defaultFormat();
+    format.setSwapInterval(0);
+    QSurfaceFormat::setDefaultFormat(format);
+
+    QApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    const QSize sizes[] = {QSize(420, 550), QSize(840, 1100), QSize(1680, 2200), QSize(2520, 3300)};
+
+    out << "frames per run: " << frames << "\n";
+    out << qSetFieldWidth(12) << Qt::left << "size" << "backend" << "ms/frame" << "fps"
+        << "144Hz" << "240Hz" << qSetFieldWidth(0) << "\n";
+    for (const QSize &size : sizes) {
+        const Result results[] = {benchPainter(size, frames), benchSceneGraph(size, frames)};
+        const char *names[] = {"painter", "scenegraph"};
+        for (int i = 0; i < 2; ++i) {
+            out << qSetFieldWidth(12) << Qt::left
+                << QString("%1x%2").arg(size.width()).arg(size.height())
+                << names[i]
+                << QString::number(results[i].msPerFrame, 'f', 3)
+                << QString::number(results[i].fps, 'f', 0)
+                << (results[i].fps >= 144 ? "ok" : "miss")
+                << (results[i].fps >= 240 ? "ok" : "miss")
+                << qSetFieldWidth(0) << "\n";
+        }
+        out.flush();
+    }
+    return 0;
+}
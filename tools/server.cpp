@@ -0,0 +1,144 @@
+// 无界面的多会话服务器
+//
+// 用法：tetris-server [--name=tetris] [--max-sessions=N] [--stats=秒]
+//       tetris-server --bench=N [--seconds=S]
+// 客户端通过本地套接字（Windows 命名管道 / Unix 域套接字）连接，协议见 src/serverprotocol.h。
+// --bench 不开套接字，直接在会话池中跑 N 局随机输入的对局，按 1ms 节拍推进，
+// 统计每个节拍的处理时间、下落延迟和每局内存，用来确认单机容量。
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QTextStream>
+#include <QTimer>
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <random>
+#include <thread>
+#include <vector>
+#include "gameserver.h"
+#include "serverprotocol.h"
+#include "sessionpool.h"
+
+namespace {
+
+int runBench(int sessions, int seconds, QTextStream &out)
+{
+    using Clock = std::chrono::steady_clock;
+
+    SessionPool pool(sessions);
+    std::vector<SessionPool::SessionId> ids(std::size_t(sessions), SessionPool::INVALID_SESSION);
+    std::vector<TetrisEngine::State> sent(std::size_t(sessions));
+    std::vector<SessionPool::SessionId> dirty;
+    std::mt19937_64 rng(1);
+
+    for (int i = 0; i < sessions; ++i) {
+        ids[i] = pool.create(rng(), 0);
+        sent[i] = pool.engine(ids[i])->saveState();
+    }
+
+    // 平均每局每秒 4 次输入
+    const std::uint8_t INPUTS[] = {TetrisEngine::InputLeft, TetrisEngine::InputRight, TetrisEngine::InputRotateCW,
+                                   TetrisEngine::InputSoftDrop, TetrisEngine::InputHardDrop};
+    const int inputsPerTick = std::max(1, sessions * 4 / 1000);
+
+    std::vector<double> tickMicros;
+    tickMicros.reserve(std::size_t(seconds) * 1000);
+    std::uint64_t deltaBytes = 0;
+    std::uint64_t maxLateness = 0;
+    std::uint8_t message[MAX_MESSAGE_SIZE];
+
+    const Clock::time_point start = Clock::now();
+    for (std::uint64_t now = 1; now <= std::uint64_t(seconds) * 1000; ++now) {
+        std::this_thread::sleep_until(start + std::chrono::milliseconds(now));
+        const Clock::time_point tickStart = Clock::now();
+
+        for (int i = 0; i < inputsPerTick; ++i) {
+            const std::size_t slot = rng() % std::size_t(sessions);
+            pool.input(ids[slot], INPUTS[rng() % std::size(INPUTS)], now);
+        }
+        pool.advance(now);
+
+        // 与服务器相同的增量编码；结束的对局重新开一局
+        pool.takeDirty(dirty);
+        for (SessionPool::SessionId id : dirty) {
+            const TetrisEngine *engine = pool.engine(id);
+            if (!engine) continue;
+            const std::uint32_t index = SessionPool::slotIndex(id);
+            const TetrisEngine::State current = engine->saveState();
+            deltaBytes += encodeDelta(id, sent[index], current, false, message);
+            sent[index] = current;
+            if (engine->isGameOver()) {
+                pool.destroy(id);
+                const SessionPool::SessionId next = pool.create(rng(), now);
+                ids[SessionPool::slotIndex(next)] = next;
+                sent[SessionPool::slotIndex(next)] = pool.engine(next)->saveState();
+            }
+        }
+
+        tickMicros.push_back(std::chrono::duration<double, std::micro>(Clock::now() - tickStart).count());
+        maxLateness = std::max(maxLateness, pool.takeMaxLateness());
+    }
+
+    std::sort(tickMicros.begin(), tickMicros.end());
+    const double wallSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    out << sessions << " 局, " << seconds << " 秒 (实际 " << QString::number(wallSeconds, 'f', 2) << " 秒)\n"
+        << "每节拍处理时间 中位 " << QString::number(tickMicros[tickMicros.size() / 2], 'f', 1)
+        << " us, p99 " << QString::number(tickMicros[tickMicros.size() * 99 / 100], 'f', 1)
+        << " us, 最大 " << QString::number(tickMicros.back(), 'f', 1) << " us\n"
+        << "下落 " << pool.dropCount() << " 次, 最大延迟 " << maxLateness << " ms\n"
+        << "增量 " << QString::number(double(deltaBytes) / wallSeconds / 1024.0, 'f', 1) << " KiB/s\n"
+        << "会话池内存 " << pool.memoryUsage() / 1024 << " KiB, 每局 " << pool.memoryUsage() / std::size_t(sessions)
+        << " 字节\n";
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("俄罗斯方块多会话服务器");
+    parser.addHelpOption();
+    parser.addOption({"name", "本地套接字名", "name", "tetris"});
+    parser.addOption({"max-sessions", "会话数上限", "n", "16384"});
+    parser.addOption({"stats", "每隔若干秒输出一次统计，0 表示不输出", "seconds", "0"});
+    parser.addOption({"bench", "不开套接字，跑 N 局随机输入的对局并统计", "n"});
+    parser.addOption({"seconds", "--bench 的时长", "seconds", "10"});
+    parser.process(app);
+
+    if (parser.isSet("bench")) {
+        const int sessions = parser.value("bench").toInt();
+        const int seconds = parser.value("seconds").toInt();
+        if (sessions <= 0 || sessions > SessionPool::MAX_CAPACITY || seconds <= 0) {
+            err << "--bench 和 --seconds 需要正整数\n";
+            return 1;
+        }
+        return runBench(sessions, seconds, out);
+    }
+
+    GameServer server(parser.value("max-sessions").toInt());
+    if (!server.listen(parser.value("name"))) {
+        err << "无法监听 " << parser.value("name") << ": " << server.errorString() << "\n";
+        return 1;
+    }
+    out << "正在监听 " << parser.value("name") << Qt::endl;
+
+    const int statsSeconds = parser.value("stats").toInt();
+    QTimer statsTimer;
+    if (statsSeconds > 0) {
+        QObject::connect(&statsTimer, &QTimer::timeout, [&]() {
+            const GameServer::Stats stats = server.takeStats();
+            out << "会话 " << stats.sessions << ", 客户端 " << stats.clients << ", 下落 " << stats.drops
+                << ", 最大延迟 " << stats.maxLatenessMs << " ms, 已发送 " << stats.bytesSent / 1024 << " KiB, 内存 "
+                << stats.memoryBytes / 1024 << " KiB" << Qt::endl;
+        });
+        statsTimer.start(statsSeconds * 1000);
+    }
+
+    return app.exec();
+}
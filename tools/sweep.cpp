@@ -0,0 +1,755 @@
+// 参数网格批量对局：规则集 × 随机器 × 有效高度 × 重力曲线 × AI 权重，每组配置跑相同的一批种子
+//
+// 用法：tetris-sweep [--rules=standard,guideline,classic,marathon] [--randomizer=uniform,bag7]
+//                     [--height=20,16] [--gravity=rules,standard,guideline,nes,none]
+//                     [--weights=W1;W2...] [--seeds=N] [--seed-base=S] [--max-pieces=N]
+//                     [--jobs=N] [--out=FILE] [--resume]
+//       tetris-sweep --csv <结果文件>
+//   权重每组 7 个数，依次为 总高度,空洞,凹凸度,消行,井深,行变换,列变换，缺省项为 0
+//   有效高度：堆叠超过该高度即视为结束（棋盘本身固定为 10x20）
+//   重力曲线 rules 表示使用规则集自己的曲线，其余取对应规则集的曲线，便于单独比较
+//
+// 结果按列存储：每攒够 BLOCK_ROWS 局或每隔 FLUSH_INTERVAL_MS 写出一个块，
+// 块内每列连续存放并带校验和，内存占用与总局数无关。文件头保存参数网格，
+// --resume 时按文件头继续，跳过已有结果的对局，截掉写到一半的块。
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QThreadPool>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <vector>
+#include "bot.h"
+#include "tetrisengine.h"
+
+namespace {
+
+constexpr char FILE_MAGIC[4] = {'T', 'S', 'W', 'P'};
+constexpr char BLOCK_MAGIC[4] = {'T', 'B', 'L', 'K'};
+constexpr quint32 VERSION = 1;
+constexpr int BLOCK_ROWS = 1 << 16;
+constexpr qint64 FLUSH_INTERVAL_MS = 5000;
+// 工作线程攒够这么多局再交给写入器，减少锁竞争
+constexpr int WORKER_BATCH = 256;
+
+quint64 fnv1a(const void *data, std::size_t size, quint64 hash = 1469598103934665603ull)
+{
+    const auto *bytes = static_cast<const unsigned char *>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// 重力曲线：每下落一行需要的逻辑帧数，0 表示没有重力
+enum class Gravity {
+    Rules,      // 规则集自己的曲线
+    Standard,
+    Guideline,
+    Nes,
+    None
+};
+
+template <typename Rules>
+int gravityFrames(Gravity gravity, int level)
+{
+    switch (gravity) {
+    case Gravity::Rules:
+        return Rules::gravityTicks(level);
+    case Gravity::Standard:
+        return StandardRules::gravityTicks(level);
+    case Gravity::Guideline:
+        return GuidelineRules::gravityTicks(level);
+    case Gravity::Nes:
+        return ClassicRules::gravityTicks(level);
+    case Gravity::None:
+        break;
+    }
+    return 0;
+}
+
+const char *const RULES_NAMES[] = {StandardRules::NAME, GuidelineRules::NAME, ClassicRules::NAME, MarathonRules::NAME};
+const char *const RANDOMIZER_NAMES[] = {"uniform", "bag7"};
+const char *const GRAVITY_NAMES[] = {"rules", "standard", "guideline", "nes", "none"};
+
+template <std::size_t N>
+int nameIndex(const char *const (&names)[N], const QString &name)
+{
+    for (std::size_t i = 0; i < N; ++i) {
+        if (name == QLatin1String(names[i])) return int(i);
+    }
+    return -1;
+}
+
+// 一组配置
+struct Config {
+    int rules;      // RULES_NAMES 的下标
+    TetrisEngine::Randomizer randomizer;
+    int height;
+    Gravity gravity;
+    int weightsIndex;
+};
+
+// 参数网格。以 "键=值" 的文本形式写入文件头，命令行使用同样的值语法
+struct Grid {
+    QVector<int> rules = {0};
+    QVector<TetrisEngine::Randomizer> randomizers = {TetrisEngine::Randomizer::Uniform};
+    QVector<int> heights = {TetrisEngine::BOARD_HEIGHT};
+    QVector<Gravity> gravities = {Gravity::Rules};
+    QVector<Bot::Weights> weights = {Bot::Weights()};
+    quint32 seeds = 100;
+    quint64 seedBase = 0;
+    int maxPieces = 10000;
+
+    int configCount() const
+    {
+        return rules.size() * randomizers.size() * heights.size() * gravities.size() * weights.size();
+    }
+
+    quint64 jobCount() const
+    {
+        return quint64(configCount()) * seeds;
+    }
+
+    // 权重变化最快，规则集变化最慢
+    Config config(int index) const
+    {
+        Config config;
+        config.weightsIndex = index % weights.size();
+        index /= weights.size();
+        config.gravity = gravities[index % gravities.size()];
+        index /= gravities.size();
+        config.height = heights[index % heights.size()];
+        index /= heights.size();
+        config.randomizer = randomizers[index % randomizers.size()];
+        index /= randomizers.size();
+        config.rules = rules[index];
+        return config;
+    }
+
+    bool set(const QString &key, const QString &value, QString *error)
+    {
+        const QStringList items = value.split(key == "weights" ? ';' : ',', Qt::SkipEmptyParts);
+        bool ok = !items.isEmpty();
+        if (key == "rules") {
+            rules.clear();
+            for (const QString &item : items) {
+                const int index = nameIndex(RULES_NAMES, item.trimmed());
+                ok = ok && index >= 0;
+                rules.append(qMax(0, index));
+            }
+        } else if (key == "randomizer") {
+            randomizers.clear();
+            for (const QString &item : items) {
+                const int index = nameIndex(RANDOMIZER_NAMES, item.trimmed());
+                ok = ok && index >= 0;
+                randomizers.append(TetrisEngine::Randomizer(qMax(0, index)));
+            }
+        } else if (key == "height") {
+            heights.clear();
+            for (const QString &item : items) {
+                const int height = item.toInt();
+                ok = ok && height >= 4 && height <= TetrisEngine::BOARD_HEIGHT;
+                heights.append(height);
+            }
+        } else if (key == "gravity") {
+            gravities.clear();
+            for (const QString &item : items) {
+                const int index = nameIndex(GRAVITY_NAMES, item.trimmed());
+                ok = ok && index >= 0;
+                gravities.append(Gravity(qMax(0, index)));
+            }
+        } else if (key == "weights") {
+            weights.clear();
+            for (const QString &item : items) {
+                const QStringList numbers = item.split(',');
+                float values[7] = {};
+                ok = ok && numbers.size() <= 7;
+                for (int i = 0; i < qMin(7, int(numbers.size())); ++i) {
+                    bool numberOk = false;
+                    values[i] = numbers[i].toFloat(&numberOk);
+                    ok = ok && numberOk;
+                }
+                weights.append({values[0], values[1], values[2], values[3], values[4], values[5], values[6]});
+            }
+        } else if (key == "seeds") {
+            seeds = value.toUInt(&ok);
+            ok = ok && seeds > 0;
+        } else if (key == "seed-base") {
+            seedBase = value.toULongLong(&ok);
+        } else if (key == "max-pieces") {
+            maxPieces = value.toInt(&ok);
+            ok = ok && maxPieces > 0;
+        } else {
+            ok = false;
+        }
+        if (!ok && error) {
+            *error = QString("无效参数 %1=%2").arg(key, value);
+        }
+        return ok;
+    }
+
+    QString toSpec() const
+    {
+        QStringList lines;
+        QStringList names;
+        for (int index : rules) names << RULES_NAMES[index];
+        lines << "rules=" + names.join(',');
+        names.clear();
+        for (TetrisEngine::Randomizer randomizer : randomizers) names << RANDOMIZER_NAMES[int(randomizer)];
+        lines << "randomizer=" + names.join(',');
+        names.clear();
+        for (int height : heights) names << QString::number(height);
+        lines << "height=" + names.join(',');
+        names.clear();
+        for (Gravity gravity : gravities) names << GRAVITY_NAMES[int(gravity)];
+        lines << "gravity=" + names.join(',');
+        names.clear();
+        for (const Bot::Weights &w : weights) {
+            // float 需要 9 位有效数字才能原样读回，续跑时权重与首次运行完全相同
+            QStringList values;
+            for (float value : {w.aggregateHeight, w.holes, w.bumpiness, w.lines, w.wells, w.rowTransitions,
+                                w.columnTransitions}) {
+                values << QString::number(value, 'g', 9);
+            }
+            names << values.join(',');
+        }
+        lines << "weights=" + names.join(';');
+        lines << "seeds=" + QString::number(seeds);
+        lines << "seed-base=" + QString::number(seedBase);
+        lines << "max-pieces=" + QString::number(maxPieces);
+        return lines.join('\n');
+    }
+
+    bool fromSpec(const QString &spec, QString *error)
+    {
+        for (const QString &line : spec.split('\n', Qt::SkipEmptyParts)) {
+            const int equals = line.indexOf('=');
+            if (equals < 0 || !set(line.left(equals), line.mid(equals + 1), error)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// 一局的结果，即文件中的一行
+struct GameRow {
+    quint64 seed;
+    quint32 job;
+    quint32 frames;
+    qint32 score;
+    qint32 lines;
+    qint32 level;
+    qint32 pieces;
+    quint32 tetrises;
+    quint16 config;
+    quint8 toppedOut;    // 0 表示达到方块数上限
+};
+
+enum class ColumnType : quint8 {
+    U8,
+    U16,
+    U32,
+    U64,
+    I32
+};
+
+struct Column {
+    const char *name;
+    ColumnType type;
+    quint8 size;
+    std::size_t offset;
+};
+
+#define SWEEP_COLUMN(field, type) {#field, ColumnType::type, quint8(sizeof(GameRow::field)), offsetof(GameRow, field)}
+const Column COLUMNS[] = {
+    SWEEP_COLUMN(job, U32),
+    SWEEP_COLUMN(config, U16),
+    SWEEP_COLUMN(seed, U64),
+    SWEEP_COLUMN(score, I32),
+    SWEEP_COLUMN(lines, I32),
+    SWEEP_COLUMN(level, I32),
+    SWEEP_COLUMN(pieces, I32),
+    SWEEP_COLUMN(tetrises, U32),
+    SWEEP_COLUMN(frames, U32),
+    SWEEP_COLUMN(toppedOut, U8),
+};
+#undef SWEEP_COLUMN
+constexpr int COLUMN_COUNT = int(std::size(COLUMNS));
+
+// 文件头之后的列描述
+struct ColumnHeader {
+    char name[16];
+    quint8 type;
+    quint8 size;
+    quint16 reserved;
+};
+
+struct BlockHeader {
+    char magic[4];
+    quint32 rowCount;
+    quint64 checksum;   // 覆盖块内全部列数据
+};
+
+// 按列缓冲并分块写出，多个工作线程共用
+class ColumnWriter
+{
+public:
+    explicit ColumnWriter(QFile &file)
+        : m_file(file)
+        , m_rows(0)
+        , m_ok(true)
+    {
+        for (const Column &column : COLUMNS) {
+            m_columns.emplace_back();
+            m_columns.back().reserve(std::size_t(BLOCK_ROWS) * column.size);
+        }
+        m_sinceFlush.start();
+    }
+
+    void append(const GameRow *rows, int count)
+    {
+        QMutexLocker locker(&m_mutex);
+        for (int i = 0; i < count; ++i) {
+            const auto *bytes = reinterpret_cast<const char *>(&rows[i]);
+            for (int c = 0; c < COLUMN_COUNT; ++c) {
+                m_columns[c].insert(m_columns[c].end(), bytes + COLUMNS[c].offset,
+                                    bytes + COLUMNS[c].offset + COLUMNS[c].size);
+            }
+            if (++m_rows == BLOCK_ROWS) {
+                flushLocked();
+            }
+        }
+    }
+
+    // 定期落盘，中断时最多丢失一个间隔内的结果
+    void flushIfStale()
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_sinceFlush.elapsed() >= FLUSH_INTERVAL_MS) {
+            flushLocked();
+        }
+    }
+
+    bool finish()
+    {
+        QMutexLocker locker(&m_mutex);
+        flushLocked();
+        return m_ok;
+    }
+
+private:
+    void flushLocked()
+    {
+        m_sinceFlush.restart();
+        if (m_rows == 0) return;
+
+        BlockHeader header;
+        std::memcpy(header.magic, BLOCK_MAGIC, sizeof(BLOCK_MAGIC));
+        header.rowCount = quint32(m_rows);
+        header.checksum = 1469598103934665603ull;
+        for (const std::vector<char> &column : m_columns) {
+            header.checksum = fnv1a(column.data(), column.size(), header.checksum);
+        }
+
+        m_ok = m_ok && m_file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == qint64(sizeof(header));
+        for (std::vector<char> &column : m_columns) {
+            m_ok = m_ok && m_file.write(column.data(), qint64(column.size())) == qint64(column.size());
+            column.clear();
+        }
+        m_ok = m_ok && m_file.flush();
+        m_rows = 0;
+    }
+
+    QFile &m_file;
+    QMutex m_mutex;
+    std::vector<std::vector<char>> m_columns;
+    int m_rows;
+    QElapsedTimer m_sinceFlush;
+    bool m_ok;
+};
+
+bool writeFileHeader(QFile &file, const QString &spec)
+{
+    const QByteArray specBytes = spec.toUtf8();
+    QByteArray header;
+    header.append(FILE_MAGIC, sizeof(FILE_MAGIC));
+    const quint32 fields[] = {VERSION, quint32(COLUMN_COUNT), quint32(specBytes.size())};
+    header.append(reinterpret_cast<const char *>(fields), sizeof(fields));
+    for (const Column &column : COLUMNS) {
+        ColumnHeader columnHeader = {};
+        qstrncpy(columnHeader.name, column.name, sizeof(columnHeader.name));
+        columnHeader.type = quint8(column.type);
+        columnHeader.size = column.size;
+        header.append(reinterpret_cast<const char *>(&columnHeader), sizeof(columnHeader));
+    }
+    header.append(specBytes);
+    return file.write(header) == header.size() && file.flush();
+}
+
+// 读取结果文件：校验文件头，逐块回调；遇到不完整或校验失败的块时停止，
+// validEnd 为最后一个完整块的结尾
+class ColumnReader
+{
+public:
+    explicit ColumnReader(QFile &file)
+        : m_file(file)
+        , m_validEnd(0)
+    {
+    }
+
+    bool readHeader(QString &spec, QString *error)
+    {
+        char magic[4];
+        quint32 fields[3];
+        if (m_file.read(magic, sizeof(magic)) != qint64(sizeof(magic))
+            || std::memcmp(magic, FILE_MAGIC, sizeof(magic)) != 0
+            || m_file.read(reinterpret_cast<char *>(fields), sizeof(fields)) != qint64(sizeof(fields))
+            || fields[0] != VERSION || fields[1] != quint32(COLUMN_COUNT)) {
+            *error = "不是本版本的结果文件";
+            return false;
+        }
+        for (const Column &column : COLUMNS) {
+            ColumnHeader columnHeader;
+            if (m_file.read(reinterpret_cast<char *>(&columnHeader), sizeof(columnHeader)) != qint64(sizeof(columnHeader))
+                || qstrncmp(columnHeader.name, column.name, sizeof(columnHeader.name)) != 0
+                || columnHeader.type != quint8(column.type) || columnHeader.size != column.size) {
+                *error = "列定义不一致";
+                return false;
+            }
+        }
+        const QByteArray specBytes = m_file.read(fields[2]);
+        if (specBytes.size() != qint64(fields[2])) {
+            *error = "文件头不完整";
+            return false;
+        }
+        spec = QString::fromUtf8(specBytes);
+        m_validEnd = m_file.pos();
+        return true;
+    }
+
+    // 读入下一块并转回行，rows 复用调用方的缓冲
+    bool nextBlock(std::vector<GameRow> &rows)
+    {
+        BlockHeader header;
+        if (m_file.read(reinterpret_cast<char *>(&header), sizeof(header)) != qint64(sizeof(header))
+            || std::memcmp(header.magic, BLOCK_MAGIC, sizeof(BLOCK_MAGIC)) != 0
+            || header.rowCount == 0 || header.rowCount > quint32(BLOCK_ROWS)) {
+            return false;
+        }
+
+        rows.assign(header.rowCount, GameRow{});
+        quint64 checksum = 1469598103934665603ull;
+        for (const Column &column : COLUMNS) {
+            const qint64 bytes = qint64(header.rowCount) * column.size;
+            m_buffer.resize(std::size_t(bytes));
+            if (m_file.read(m_buffer.data(), bytes) != bytes) {
+                return false;
+            }
+            checksum = fnv1a(m_buffer.data(), m_buffer.size(), checksum);
+            for (quint32 i = 0; i < header.rowCount; ++i) {
+                std::memcpy(reinterpret_cast<char *>(&rows[i]) + column.offset,
+                            m_buffer.data() + std::size_t(i) * column.size, column.size);
+            }
+        }
+        if (checksum != header.checksum) {
+            return false;
+        }
+        m_validEnd = m_file.pos();
+        return true;
+    }
+
+    qint64 validEnd() const { return m_validEnd; }
+
+private:
+    QFile &m_file;
+    qint64 m_validEnd;
+    std::vector<char> m_buffer;
+};
+
+// 按帧执行一个输入，与 TetrisEngine::tick 的输入部分相同，重力由调用方施加
+template <typename Rules>
+void applyInput(BasicTetrisEngine<Rules> &engine, quint8 input)
+{
+    if (input & TetrisEngine::InputLeft) engine.moveLeft();
+    if (input & TetrisEngine::InputRight) engine.moveRight();
+    if (input & TetrisEngine::InputRotateCW) engine.rotate(RotationDirection::Clockwise);
+    if (input & TetrisEngine::InputHardDrop) engine.hardDrop();
+}
+
+int stackHeight(const TetrisEngineBase &engine)
+{
+    const TetrisEngine::Features &features = engine.getFeatures();
+    return *std::max_element(features.columnHeights.begin(), features.columnHeights.end());
+}
+
+// AI 每帧执行一个动作；重力在动作之间生效，高速时原定的路径可能走不完
+template <typename Rules>
+GameRow playGame(const Grid &grid, const Config &config, GameRow row, Bot &bot)
+{
+    BasicTetrisEngine<Rules> engine;
+    engine.setRandomizer(config.randomizer);
+    engine.reset(row.seed);
+    engine.start();
+
+    quint8 inputs[Bot::MAX_INPUTS];
+    int gravityCounter = 0;
+    while (!engine.isGameOver() && engine.getPieceCount() < grid.maxPieces) {
+        Bot::Placement placement;
+        if (!bot.choose(engine, placement)) break;
+
+        const int pieceCount = engine.getPieceCount();
+        const int linesBefore = engine.getLines();
+        const int inputCount = Bot::inputsFor(placement, inputs);
+        for (int i = 0; i < inputCount && engine.getPieceCount() == pieceCount; ++i) {
+            applyInput(engine, inputs[i]);
+            ++row.frames;
+
+            const int frames = gravityFrames<Rules>(config.gravity, engine.getLevel());
+            if (frames > 0 && ++gravityCounter >= frames) {
+                gravityCounter = 0;
+                engine.moveDown();
+            }
+        }
+        if (engine.getPieceCount() != pieceCount) {
+            gravityCounter = 0;
+        }
+        if (engine.getLines() - linesBefore == 4) {
+            ++row.tetrises;
+        }
+        if (stackHeight(engine) > config.height) {
+            break;
+        }
+    }
+
+    row.score = engine.getScore();
+    row.lines = engine.getLines();
+    row.level = engine.getLevel();
+    row.pieces = engine.getPieceCount();
+    // 马拉松达到目标行数不算堆满
+    row.toppedOut = engine.getPieceCount() < grid.maxPieces && !engine.isGoalReached() ? 1 : 0;
+    return row;
+}
+
+// 规则集在这里从运行时参数分派到编译期实例，对局内部没有分支
+GameRow playGame(const Grid &grid, quint64 job, Bot &bot)
+{
+    const int configIndex = int(job / grid.seeds);
+    const Config config = grid.config(configIndex);
+    bot.setWeights(grid.weights[config.weightsIndex]);
+
+    GameRow row = {};
+    row.job = quint32(job);
+    row.config = quint16(configIndex);
+    row.seed = grid.seedBase + job % grid.seeds;
+
+    switch (config.rules) {
+    case 1:
+        return playGame<GuidelineRules>(grid, config, row, bot);
+    case 2:
+        return playGame<ClassicRules>(grid, config, row, bot);
+    case 3:
+        return playGame<MarathonRules>(grid, config, row, bot);
+    default:
+        return playGame<StandardRules>(grid, config, row, bot);
+    }
+}
+
+int exportCsv(const QString &path, QTextStream &out, QTextStream &err)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        err << "无法打开 " << path << "\n";
+        return 1;
+    }
+    ColumnReader reader(file);
+    QString spec;
+    QString error;
+    Grid grid;
+    if (!reader.readHeader(spec, &error) || !grid.fromSpec(spec, &error)) {
+        err << path << ": " << error << "\n";
+        return 1;
+    }
+
+    for (const Column &column : COLUMNS) {
+        out << column.name << ',';
+    }
+    out << "rules,randomizer,height,gravity,weights\n";
+
+    std::vector<GameRow> rows;
+    while (reader.nextBlock(rows)) {
+        for (const GameRow &row : rows) {
+            const Config config = grid.config(row.config);
+            out << row.job << ',' << row.config << ',' << row.seed << ',' << row.score << ',' << row.lines << ','
+                << row.level << ',' << row.pieces << ',' << row.tetrises << ',' << row.frames << ','
+                << int(row.toppedOut) << ',' << RULES_NAMES[config.rules] << ',' << RANDOMIZER_NAMES[int(config.randomizer)] << ',' << config.height << ','
+                << GRAVITY_NAMES[int(config.gravity)] << ',' << config.weightsIndex << '\n';
+        }
+    }
+    if (reader.validEnd() != file.size()) {
+        err << path << ": 偏移 " << reader.validEnd() << " 之后的数据不完整，已忽略\n";
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("俄罗斯方块参数网格批量对局");
+    parser.addHelpOption();
+    parser.addOption({"rules", "规则集：standard、guideline、classic、marathon，逗号分隔", "list"});
+    parser.addOption({"randomizer", "随机器：uniform、bag7，逗号分隔", "list"});
+    parser.addOption({"height", "有效高度，逗号分隔", "list"});
+    parser.addOption({"gravity", "重力曲线：rules、standard、guideline、nes、none，逗号分隔", "list"});
+    parser.addOption({"weights", "AI 权重组，组间用分号分隔", "sets"});
+    parser.addOption({"seeds", "每组配置的种子数", "n"});
+    parser.addOption({"seed-base", "第一个种子", "seed"});
+    parser.addOption({"max-pieces", "每局方块数上限", "n"});
+    parser.addOption({"jobs", "并行线程数（默认为 CPU 核数）", "n"});
+    parser.addOption({"out", "结果文件", "file", "sweep.tsw"});
+    parser.addOption({"resume", "按已有结果文件的参数继续"});
+    parser.addOption({"csv", "把结果文件转换为 CSV 输出到标准输出"});
+    parser.addPositionalArgument("file", "--csv 时的结果文件");
+    parser.process(app);
+
+    if (parser.isSet("csv")) {
+        const QStringList files = parser.positionalArguments();
+        if (files.size() != 1) {
+            err << "--csv 需要一个结果文件\n";
+            return 1;
+        }
+        return exportCsv(files.first(), out, err);
+    }
+
+    const QString path = parser.value("out");
+    QFile file(path);
+    Grid grid;
+    QString error;
+    std::vector<bool> done;
+    quint64 doneCount = 0;
+
+    if (parser.isSet("resume") && file.exists()) {
+        // 网格以文件头为准，收集已完成的对局并截掉不完整的尾部
+        if (!file.open(QIODevice::ReadWrite)) {
+            err << "无法打开 " << path << "\n";
+            return 1;
+        }
+        ColumnReader reader(file);
+        QString spec;
+        if (!reader.readHeader(spec, &error) || !grid.fromSpec(spec, &error)) {
+            err << path << ": " << error << "\n";
+            return 1;
+        }
+        done.assign(grid.jobCount(), false);
+        std::vector<GameRow> rows;
+        while (reader.nextBlock(rows)) {
+            for (const GameRow &row : rows) {
+                if (row.job < done.size() && !done[row.job]) {
+                    done[row.job] = true;
+                    ++doneCount;
+                }
+            }
+        }
+        if (reader.validEnd() != file.size()) {
+            err << "截掉 " << file.size() - reader.validEnd() << " 字节不完整的数据\n";
+            file.resize(reader.validEnd());
+        }
+        file.seek(reader.validEnd());
+    } else {
+        if (file.exists()) {
+            err << path << " 已存在，使用 --resume 继续或先删除\n";
+            return 1;
+        }
+        const char *const keys[] = {"rules", "randomizer", "height", "gravity", "weights", "seeds", "seed-base", "max-pieces"};
+        for (const char *key : keys) {
+            if (parser.isSet(key) && !grid.set(key, parser.value(key), &error)) {
+                err << error << "\n";
+                return 1;
+            }
+        }
+        if (grid.jobCount() > 0xffffffffull || grid.configCount() > 0xffff) {
+            err << "网格过大\n";
+            return 1;
+        }
+        if (!file.open(QIODevice::WriteOnly) || !writeFileHeader(file, grid.toSpec())) {
+            err << "无法写入 " << path << "\n";
+            return 1;
+        }
+        done.assign(grid.jobCount(), false);
+    }
+
+    const quint64 jobCount = grid.jobCount();
+    out << grid.configCount() << " 组配置 x " << grid.seeds << " 个种子 = " << jobCount << " 局";
+    if (doneCount > 0) {
+        out << "，已完成 " << doneCount << " 局";
+    }
+    out << "\n";
+    out.flush();
+
+    QThreadPool pool;
+    if (parser.isSet("jobs")) {
+        pool.setMaxThreadCount(qMax(1, parser.value("jobs").toInt()));
+    }
+
+    // 每个线程按块领取任务，done 在运行期间只读
+    ColumnWriter writer(file);
+    std::atomic<quint64> nextJob{0};
+    std::atomic<quint64> finished{0};
+    constexpr quint64 CLAIM = 64;
+    for (int t = 0; t < pool.maxThreadCount(); ++t) {
+        pool.start([&]() {
+            Bot bot;
+            std::vector<GameRow> batch;
+            batch.reserve(WORKER_BATCH);
+            for (quint64 first = nextJob.fetch_add(CLAIM); first < jobCount; first = nextJob.fetch_add(CLAIM)) {
+                const quint64 last = qMin(first + CLAIM, jobCount);
+                for (quint64 job = first; job < last; ++job) {
+                    if (done[job]) continue;
+                    batch.push_back(playGame(grid, job, bot));
+                    if (int(batch.size()) == WORKER_BATCH) {
+                        writer.append(batch.data(), int(batch.size()));
+                        finished += batch.size();
+                        batch.clear();
+                    }
+                }
+            }
+            writer.append(batch.data(), int(batch.size()));
+            finished += batch.size();
+        });
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    while (!pool.waitForDone(1000)) {
+        writer.flushIfStale();
+        const quint64 count = finished;
+        err << "\r" << doneCount + count << "/" << jobCount << " 局, "
+            << QString::number(count * 1000.0 / qMax<qint64>(1, timer.elapsed()), 'f', 0) << " 局/秒";
+        err.flush();
+    }
+    const bool ok = writer.finish();
+    err << "\n";
+
+    out << finished << " 局完成, " << pool.maxThreadCount() << " 线程, 用时 " << timer.elapsed() << " ms\n";
+    if (!ok) {
+        err << "写入 " << path << " 失败\n";
+        return 1;
+    }
+    return 0;
+}